@@ -0,0 +1,130 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Times reading a local file through CDVDInputStreamFile, with CFile and
+// with the memory mapped path, see README.txt
+
+#include <chrono>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "FileItem.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStreamFile.h"
+#include "settings/AdvancedSettings.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double Elapsed(const Clock::time_point &start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// drops the file from the page cache, so the next read comes from the disk
+static bool DropCache(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  bool dropped = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(fd);
+  return dropped;
+}
+
+// reads the whole file the way the demuxer does, returns the time in ms or -1
+static double ReadFile(const std::string &path, bool mapped, int readSize, int64_t &bytes)
+{
+  g_advancedSettings.m_videoMemoryMapLocalFiles = mapped;
+
+  CFileItem item(path, false);
+  CDVDInputStreamFile input(item);
+  if (!input.Open())
+    return -1.0;
+
+  std::vector<uint8_t> buffer(readSize);
+  int read;
+  bytes = 0;
+  Clock::time_point start = Clock::now();
+  while ((read = input.Read(buffer.data(), readSize)) > 0)
+    bytes += read;
+  double elapsed = Elapsed(start);
+
+  input.Close();
+  return read < 0 ? -1.0 : elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <file> [passes] [read size]\n", argv[0]);
+    return 1;
+  }
+  std::string path = argv[1];
+  int passes = argc > 2 ? atoi(argv[2]) : 3;
+  // what DVDDemuxFFmpeg asks for with FFMPEG_FILE_BUFFER_SIZE
+  int readSize = argc > 3 ? atoi(argv[3]) : 32768;
+  if (passes < 1 || readSize < 1)
+  {
+    fprintf(stderr, "usage: %s <file> [passes] [read size]\n", argv[0]);
+    return 1;
+  }
+
+  printf("mode,cache,bytes,avg_ms,mb_per_s\n");
+  for (int cold = 1; cold >= 0; cold--)
+  {
+    for (int mapped = 0; mapped <= 1; mapped++)
+    {
+      int64_t bytes = 0;
+      double total = 0.0;
+      // a pass to fill the page cache first when timing warm reads
+      if (!cold && ReadFile(path, mapped != 0, readSize, bytes) < 0.0)
+      {
+        fprintf(stderr, "failed to read %s\n", path.c_str());
+        return 1;
+      }
+
+      for (int pass = 0; pass < passes; pass++)
+      {
+        if (cold && !DropCache(path))
+        {
+          fprintf(stderr, "failed to drop %s from the page cache\n", path.c_str());
+          return 1;
+        }
+        double elapsed = ReadFile(path, mapped != 0, readSize, bytes);
+        if (elapsed < 0.0)
+        {
+          fprintf(stderr, "failed to read %s\n", path.c_str());
+          return 1;
+        }
+        total += elapsed;
+      }
+
+      double avg = total / passes;
+      printf("%s,%s,%" PRId64",%.1f,%.1f\n", mapped ? "mmap" : "cfile", cold ? "cold" : "warm",
+             bytes, avg, avg > 0.0 ? bytes / avg * 1000.0 / (1024 * 1024) : 0.0);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Times CDVDMessageQueue the way the demuxer and the players use it, see README.txt
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double Elapsed(const Clock::time_point &start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static int g_packetSize = 4096;
+
+static CDVDMsg* NewPacket(int index)
+{
+  // 25 fps worth of timestamps, so the time based level moves
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(g_packetSize);
+  packet->iSize = g_packetSize;
+  packet->dts = packet->pts = index * DVD_TIME_BASE / 25.0;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+static void InitQueue(CDVDMessageQueue &queue)
+{
+  // what CDVDPlayerVideo sets up
+  queue.Init();
+  queue.SetMaxDataSize(80 * 1024 * 1024);
+  queue.SetMaxTimeSize(10.0);
+}
+
+static bool Drain(CDVDMessageQueue &queue, int count)
+{
+  CDVDMsg *msg;
+  for (int i = 0; i < count; i++)
+  {
+    if (queue.Get(&msg, 1000) != MSGQ_OK)
+      return false;
+    msg->Release();
+  }
+  return true;
+}
+
+// single thread, the demuxer fills a buffer's worth of packets,
+// then the player empties it
+static bool RunFifo(CDVDMessageQueue &queue, int count)
+{
+  const int block = 1000;
+  for (int done = 0; done < count; done += block)
+  {
+    for (int i = 0; i < block; i++)
+      queue.Put(NewPacket(done + i));
+    if (!Drain(queue, block))
+      return false;
+  }
+  return true;
+}
+
+// demuxer and player on threads of their own, the demuxer backs off while
+// the queue is full and the player polls the level like CDVDPlayer's
+// buffering check does
+static bool RunThreaded(CDVDMessageQueue &queue, int count)
+{
+  queue.SetMaxTimeSize(1.0);
+  std::thread demuxer([&queue, count]
+  {
+    for (int i = 0; i < count; i++)
+    {
+      while (queue.IsFull())
+        std::this_thread::yield();
+      queue.Put(NewPacket(i));
+    }
+  });
+
+  bool ok = true;
+  CDVDMsg *msg;
+  for (int i = 0; i < count && ok; i++)
+  {
+    ok = queue.Get(&msg, 1000) == MSGQ_OK;
+    if (ok)
+      msg->Release();
+    queue.GetLevel();
+  }
+  demuxer.join();
+  queue.SetMaxTimeSize(10.0);
+  return ok;
+}
+
+// every 16th message is a priority message, like the resync and speed
+// messages CDVDPlayer sends while the data keeps flowing
+static bool RunPriority(CDVDMessageQueue &queue, int count)
+{
+  const int block = 1000;
+  int priority;
+  CDVDMsg *msg;
+  for (int done = 0; done < count; done += block)
+  {
+    for (int i = 0; i < block; i++)
+    {
+      if (i % 16 == 15)
+        queue.Put(new CDVDMsg(CDVDMsg::GENERAL_SYNCHRONIZE), 1);
+      else
+        queue.Put(NewPacket(done + i));
+    }
+    for (int i = 0; i < block; i++)
+    {
+      priority = 0;
+      if (queue.Get(&msg, 1000, priority) != MSGQ_OK)
+        return false;
+      msg->Release();
+    }
+  }
+  return true;
+}
+
+// seeking, the queue is filled and then flushed of its data packets
+// while a control message stays queued
+static bool RunFlush(CDVDMessageQueue &queue, int count)
+{
+  const int block = 1000;
+  for (int done = 0; done < count; done += block)
+  {
+    queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+    for (int i = 0; i < block; i++)
+      queue.Put(NewPacket(done + i));
+    queue.Flush(CDVDMsg::DEMUXER_PACKET);
+    if (queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET) != 0 || !Drain(queue, 1))
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 200000;
+  int passes = argc > 2 ? atoi(argv[2]) : 5;
+  if (argc > 3)
+    g_packetSize = atoi(argv[3]);
+  if (count < 1000 || passes < 1 || g_packetSize < 1)
+  {
+    fprintf(stderr, "usage: %s [messages >= 1000] [passes] [packet size]\n", argv[0]);
+    return 1;
+  }
+  count -= count % 1000;
+
+  static const struct
+  {
+    const char *name;
+    bool (*run)(CDVDMessageQueue &queue, int count);
+  } scenarios[] =
+  {
+    { "fifo",     RunFifo     },
+    { "threaded", RunThreaded },
+    { "priority", RunPriority },
+    { "flush",    RunFlush    },
+  };
+
+  printf("scenario,messages,packet_size,avg_ms,msgs_per_ms\n");
+  for (const auto &scenario : scenarios)
+  {
+    CDVDMessageQueue queue("benchmark");
+    InitQueue(queue);
+    // warm up the packet pool
+    if (!scenario.run(queue, 1000))
+    {
+      fprintf(stderr, "%s: queue returned an error\n", scenario.name);
+      return 1;
+    }
+
+    double total = 0.0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+      Clock::time_point start = Clock::now();
+      if (!scenario.run(queue, count))
+      {
+        fprintf(stderr, "%s: queue returned an error\n", scenario.name);
+        return 1;
+      }
+      total += Elapsed(start);
+    }
+    queue.End();
+
+    double avg = total / passes;
+    printf("%s,%d,%d,%.3f,%.1f\n", scenario.name, count, g_packetSize, avg, count / avg);
+  }
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Times every CAEMixKernels implementation against the C reference, see README.txt
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
+
+typedef std::chrono::steady_clock Clock;
+typedef CAEMixKernels::KernelSet KernelSet;
+
+static double Elapsed(const Clock::time_point &start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Buffers
+{
+  Buffers(uint32_t frames, uint32_t stride)
+    : data(frames * stride), src(frames * stride), negated(frames * stride), gain(frames), inverse(frames), peak(frames, 0.0f)
+  {
+    srand(frames * stride);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+      data[i] = (2.0f * rand() / RAND_MAX - 1.0f) * 0.5f;
+      src[i] = (2.0f * rand() / RAND_MAX - 1.0f) * 0.5f;
+      negated[i] = -src[i];
+    }
+    // gains and sources are applied and undone on alternate passes,
+    // so the samples stay in range
+    for (uint32_t i = 0; i < frames; i++)
+    {
+      gain[i] = 0.5f + (float)i / frames;
+      inverse[i] = 1.0f / gain[i];
+    }
+  }
+
+  std::vector<float> data, src, negated, gain, inverse, peak;
+};
+
+// runs one kernel passes times over a period of frames, returns ns per sample
+static double TimeKernel(const KernelSet &set, const char *kernel, uint32_t frames, uint32_t stride, int passes)
+{
+  Buffers buffers(frames, stride);
+  float *data = buffers.data.data();
+  const float *src = buffers.src.data();
+  const float *negated = buffers.negated.data();
+  const float *gain = buffers.gain.data();
+  const float *inverse = buffers.inverse.data();
+  float *peak = buffers.peak.data();
+  const uint32_t count = frames * stride;
+
+  Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    switch (kernel[0])
+    {
+    case 'g':
+      set.mulGain(data, pass % 2 ? inverse : gain, frames, stride);
+      break;
+    case 'm':
+      set.mulAddGain(data, pass % 2 ? negated : src, gain, frames, stride);
+      break;
+    case 'p':
+      set.framePeak(peak, data, frames, stride);
+      break;
+    case 'c':
+      set.softClamp(data, count);
+      break;
+    }
+  }
+  return Elapsed(start) * 1e6 / ((double)passes * count);
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t frames = argc > 1 ? atoi(argv[1]) : 1024;
+  int passes = argc > 2 ? atoi(argv[2]) : 20000;
+  if (frames < 1 || passes < 1)
+  {
+    fprintf(stderr, "usage: %s [frames] [passes]\n", argv[0]);
+    return 1;
+  }
+
+  // planar, stereo, 5.1 and 7.1 interleaved
+  static const uint32_t strides[] = { 1, 2, 6, 8 };
+  static const char *kernels[] = { "gain", "muladd", "peak", "clamp" };
+  std::vector<KernelSet> sets = CAEMixKernels::GetKernelSets();
+
+  printf("kernel,implementation,frames,stride,ns_per_sample,speedup\n");
+  for (const char *kernel : kernels)
+  {
+    for (uint32_t stride : strides)
+    {
+      // the clamp works on whole buffers, the stride only changes the size
+      if (kernel[0] == 'c' && stride != strides[0])
+        continue;
+
+      double reference = 0.0;
+      for (const KernelSet &set : sets)
+      {
+        // once to warm up the caches
+        TimeKernel(set, kernel, frames, stride, 1 + passes / 10);
+        double ns = TimeKernel(set, kernel, frames, stride, passes);
+        if (reference == 0.0)
+          reference = ns;
+        printf("%s,%s,%u,%u,%.4f,%.2f\n", kernel, set.name, frames, stride, ns, reference / ns);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Times the Plex and Emby response parsers on recorded payloads, see README.txt
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "contrib/xml2json/xml2json.hpp"
+#include "utils/JSONVariantParser.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+#include "utils/XMLVariantParser.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double Elapsed(const Clock::time_point &start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static long PeakRSS()
+{
+  // kilobytes on linux
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return usage.ru_maxrss;
+}
+
+static bool ReadFile(const char *path, std::string &data)
+{
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+
+  char buffer[64 * 1024];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data.append(buffer, read);
+  fclose(file);
+  return true;
+}
+
+// hands out the file in the chunk size CCurlFile reads with,
+// the way PlexResponseReader and EmbyResponseReader do
+static CJSONVariantParser::ReadCallback FileReader(FILE *file)
+{
+  return [file](char *buffer, size_t size) -> size_t
+  {
+    return fread(buffer, 1, std::min(size, (size_t)16 * 1024), file);
+  };
+}
+
+static size_t CountItems(const CVariant &items)
+{
+  if (items.isArray())
+    return items.size();
+  return items.isObject() ? 1 : 0;
+}
+
+// parses the payload once, the way the old (whole response, xml2json for
+// plex) or the streaming code does, into a whole tree or item by item
+static bool Parse(bool plex, bool stream, bool tree, const char *path, size_t &items)
+{
+  const std::vector<std::string> itemsPath = plex ? std::vector<std::string>{ "MediaContainer", "Video" }
+                                                  : std::vector<std::string>{ "Items" };
+  CVariant data;
+  items = 0;
+  CJSONVariantParser::ItemCallback count = [&items](CVariant &item)
+  {
+    items++;
+    return true;
+  };
+
+  bool parsed;
+  if (stream)
+  {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+      return false;
+
+    CJSONVariantParser::ReadCallback read = FileReader(file);
+    if (plex)
+      parsed = tree ? CXMLVariantParser::Parse(read, data) : CXMLVariantParser::Parse(read, itemsPath, count, data);
+    else
+      parsed = tree ? CJSONVariantParser::Parse(read, data) : CJSONVariantParser::Parse(read, itemsPath, count, data);
+    fclose(file);
+  }
+  else
+  {
+    std::string response;
+    if (!ReadFile(path, response))
+      return false;
+
+    std::string json;
+    if (plex)
+    {
+      json = xml2json(response.c_str());
+      response.clear();
+    }
+    const std::string &body = plex ? json : response;
+    parsed = tree ? CJSONVariantParser::Parse(body, data) : CJSONVariantParser::Parse(body, itemsPath, count, data);
+  }
+
+  if (parsed && tree)
+    items = plex ? CountItems(data["MediaContainer"]["Video"]) : CountItems(data["Items"]);
+  return parsed;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 5 ||
+      (strcmp(argv[1], "plex") != 0 && strcmp(argv[1], "emby") != 0) ||
+      (strcmp(argv[2], "old") != 0 && strcmp(argv[2], "stream") != 0) ||
+      (strcmp(argv[3], "tree") != 0 && strcmp(argv[3], "items") != 0))
+  {
+    fprintf(stderr, "usage: %s plex|emby old|stream tree|items <payload> [passes]\n", argv[0]);
+    return 1;
+  }
+
+  bool plex = strcmp(argv[1], "plex") == 0;
+  bool stream = strcmp(argv[2], "stream") == 0;
+  bool tree = strcmp(argv[3], "tree") == 0;
+  const char *path = argv[4];
+  int passes = argc > 5 ? atoi(argv[5]) : 5;
+  if (passes <= 0)
+    passes = 1;
+
+  // don't load the payload here, that would raise the peak before we measure
+  struct stat info;
+  if (stat(path, &info) != 0)
+  {
+    fprintf(stderr, "unable to read %s\n", path);
+    return 1;
+  }
+  size_t bytes = info.st_size;
+
+  // peak memory is per process, run every parser in a process of its own
+  long baseRSS = PeakRSS();
+  size_t items = 0;
+  double total = 0.0;
+  for (int pass = 0; pass < passes; pass++)
+  {
+    Clock::time_point start = Clock::now();
+    if (!Parse(plex, stream, tree, path, items))
+    {
+      fprintf(stderr, "unable to parse %s\n", path);
+      return 1;
+    }
+    total += Elapsed(start);
+  }
+
+  printf("%s,%s,%s,%zu,%zu,%.3f,%ld\n", argv[1], argv[2], argv[3], bytes, items,
+         total / passes, PeakRSS() - baseRSS);
+  return 0;
+}
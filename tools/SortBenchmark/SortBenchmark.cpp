@@ -0,0 +1,159 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Times CFileItemList::Sort on a synthetic library, see README.txt
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "FileItem.h"
+#include "utils/LabelFormatter.h"
+#include "utils/StringUtils.h"
+#include "video/VideoInfoTag.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double Elapsed(const Clock::time_point &start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void FillList(CFileItemList &items, int count)
+{
+  static const char *articles[] = { "", "The ", "A " };
+
+  items.Clear();
+  srand(count);
+  for (int i = 0; i < count; i++)
+  {
+    std::string label = StringUtils::Format("%sItem %d %08x", articles[i % 3], rand() % 1000, rand());
+    CFileItemPtr item(new CFileItem(label));
+    item->SetPath(StringUtils::Format("/media/library/%d.mkv", i));
+    item->m_dwSize = rand();
+    item->GetVideoInfoTag()->SetYear(1950 + rand() % 70);
+    item->GetVideoInfoTag()->m_strTitle = label;
+    items.Add(item);
+  }
+}
+
+enum Change
+{
+  ChangeNone,
+  ChangeTouch,
+  ChangeFormat
+};
+
+// sorts the list by the given method, alternating the order so every
+// pass has to reorder the items. reused is set to the share of items
+// that were unchanged since the previous sort, whose keys are kept.
+static double TimeSort(CFileItemList &items, SortBy sortBy, int passes, Change change, double &reused)
+{
+  // the masks of a movie listing, the title is the label already
+  CLabelFormatter formatter("%T", "%Y");
+  std::vector<uint64_t> generations;
+  for (int i = 0; i < items.Size(); i++)
+    generations.push_back(items[i]->GetGeneration());
+
+  SortOrder order = SortOrderAscending;
+  double total = 0.0;
+  int64_t unchanged = 0;
+  for (int pass = 0; pass < passes; pass++)
+  {
+    if (change == ChangeTouch)
+    {
+      // in-place changes through the setters have to invalidate the cached keys
+      for (int i = 0; i < items.Size(); i++)
+        items[i]->SetPath(items[i]->GetPath() + ".old");
+    }
+    else if (change == ChangeFormat)
+    {
+      // what CGUIMediaWindow::FormatAndSort does before every sort
+      for (int i = 0; i < items.Size(); i++)
+        formatter.FormatLabels(items[i].get());
+      items.ClearSortState();
+    }
+
+    for (int i = 0; i < items.Size(); i++)
+    {
+      if (items[i]->GetGeneration() == generations[i])
+        unchanged++;
+    }
+
+    Clock::time_point start = Clock::now();
+    items.Sort(sortBy, order, SortAttributeIgnoreArticle);
+    total += Elapsed(start);
+    order = order == SortOrderAscending ? SortOrderDescending : SortOrderAscending;
+
+    for (int i = 0; i < items.Size(); i++)
+      generations[i] = items[i]->GetGeneration();
+  }
+  reused = 100.0 * unchanged / ((double)passes * items.Size());
+  return total / passes;
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 20000;
+  int passes = argc > 2 ? atoi(argv[2]) : 10;
+  if (count <= 0 || passes <= 0)
+  {
+    fprintf(stderr, "usage: %s [items] [passes]\n", argv[0]);
+    return 1;
+  }
+
+  static const struct
+  {
+    const char *name;
+    SortBy sortBy;
+  } methods[] = {
+    { "label", SortByLabel },
+    { "title", SortByTitle },
+    { "year",  SortByYear  },
+    { "size",  SortBySize  },
+  };
+
+  printf("method,items,first_ms,cached_ms,cached_reused,formatted_ms,formatted_reused,touched_ms\n");
+  for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+  {
+    CFileItemList items;
+    FillList(items, count);
+
+    // key extraction plus sort
+    Clock::time_point start = Clock::now();
+    items.Sort(methods[m].sortBy, SortOrderAscending, SortAttributeIgnoreArticle);
+    double first = Elapsed(start);
+
+    double cachedReused, formattedReused, touchedReused;
+    // order flips on the same items reuse the keys
+    double cached = TimeSort(items, methods[m].sortBy, passes, ChangeNone, cachedReused);
+    // the labels are formatted again before every sort, to the same values
+    double formatted = TimeSort(items, methods[m].sortBy, passes, ChangeFormat, formattedReused);
+    // every item changed since the last sort, the keys get rebuilt
+    double touched = TimeSort(items, methods[m].sortBy, passes, ChangeTouch, touchedReused);
+
+    printf("%s,%d,%.3f,%.3f,%.1f%%,%.3f,%.1f%%,%.3f\n", methods[m].name, count, first,
+           cached, cachedReused, formatted, formattedReused, touched);
+  }
+
+  return 0;
+}
@@ -102,6 +102,7 @@ void CAppParamParser::DisplayHelp()
   printf("  --debug\t\tEnable debug logging\n");
   printf("  --version\t\tPrint version information\n");
   printf("  --test\t\tEnable test mode. [FILE] required.\n");
+  printf("  --audiobenchmark\tBenchmark the audio pipeline, write special://temp/aebenchmark.csv and quit\n");
   printf("  --settings=<filename>\t\tLoads specified file after advancedsettings.xml replacing any settings specified\n");
   printf("  \t\t\t\tspecified file must exist in special://xbmc/system/\n");
   exit(0);
@@ -136,6 +137,8 @@ void CAppParamParser::ParseArg(const std::string &arg)
     g_advancedSettings.AddSettingsFile(arg.substr(11));
   else if (arg == "--headless")
     g_application.SetRenderGUI(false);
+  else if (arg == "--audiobenchmark")
+    CApplicationMessenger::GetInstance().PostMsg(TMSG_EXECUTE_BUILT_IN, -1, -1, nullptr, "AudioBenchmark(60,quit)");
   else if (arg.length() != 0 && arg[0] != '-')
   {
     if (m_testmode)
@@ -63,6 +63,7 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <functional>
 
 using namespace XFILE;
 using namespace PLAYLIST;
@@ -70,6 +71,8 @@ using namespace MUSIC_INFO;
 using namespace PVR;
 using namespace EPG;
 
+std::atomic<uint64_t> CFileItem::m_nextGeneration(0);
+
 CFileItem::CFileItem(const CSong& song)
 {
   Initialize();
@@ -334,6 +337,7 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
   if (this == &item)
     return *this;
 
+  Touch();
   CGUIListItem::operator=(item);
   m_bLabelPreformated=item.m_bLabelPreformated;
   FreeMemory();
@@ -435,6 +439,7 @@ void CFileItem::Initialize()
   m_bCanQueue = true;
   m_specialSort = SortSpecialNone;
   m_doContentLookup = true;
+  Touch();
 }
 
 void CFileItem::Reset()
@@ -1321,8 +1326,14 @@ void CFileItem::SetLabel(const std::string &strLabel)
     m_bIsFolder = true;
     m_specialSort = SortSpecialOnTop;
     SetLabelPreformated(true);
+    Touch();
   }
+  // relabelling with the same label (ie. every format pass of a listing)
+  // leaves the cached sort keys valid
+  if (strLabel == GetLabel())
+    return;
   CGUIListItem::SetLabel(strLabel);
+  Touch();
 }
 
 void CFileItem::SetFileSizeLabel()
@@ -1621,7 +1632,7 @@ std::string CFileItem::GetOpticalMediaPath() const
  */
 void CFileItem::SetURL(const CURL& url)
 {
-  m_strPath = url.Get();
+  SetPath(url.Get());
 }
 
 const CURL CFileItem::GetURL() const
@@ -1847,6 +1858,8 @@ void CFileItemList::ClearItems()
   }
   m_items.clear();
   m_map.clear();
+  m_sortKeys.clear();
+  m_sortKeyItems.clear();
 }
 
 void CFileItemList::Add(const CFileItemPtr &pItem)
@@ -2082,6 +2095,23 @@ void CFileItemList::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute sortA
   m_sortDescription = sorting;
 }
 
+size_t CFileItemList::HashSortFields(const CFileItem& item)
+{
+  // the public members ToSortable() reads can be written without going
+  // through a setter, so they aren't covered by the item's generation
+  time_t dateTime = 0;
+  if (item.m_dateTime.IsValid())
+    item.m_dateTime.GetAsTime(dateTime);
+
+  size_t hash = std::hash<std::string>()(item.m_strTitle);
+  const uint64_t values[] = { (uint64_t)dateTime, (uint64_t)item.m_dwSize, (uint64_t)item.m_iDriveType,
+                              (uint64_t)item.m_lStartOffset, (uint64_t)item.m_lEndOffset,
+                              (uint64_t)item.m_iprogramCount, (uint64_t)item.m_bIsFolder };
+  for (size_t index = 0; index < sizeof(values) / sizeof(values[0]); index++)
+    hash = hash * 31 + std::hash<uint64_t>()(values[index]);
+  return hash;
+}
+
 void CFileItemList::Sort(SortDescription sortDescription)
 {
   if (sortDescription.sortBy == SortByFile ||
@@ -2102,29 +2132,75 @@ void CFileItemList::Sort(SortDescription sortDescription)
   if (m_sortIgnoreFolders)
     sortDescription.sortAttributes = (SortAttribute)((int)sortDescription.sortAttributes | SortAttributeIgnoreFolders);
 
-  const Fields fields = SortUtils::GetFieldsForSorting(sortDescription.sortBy);
-  SortItems sortItems((size_t)Size());
-  for (int index = 0; index < Size(); index++)
-  {
-    sortItems[index] = std::shared_ptr<SortItem>(new SortItem);
-    m_items[index]->ToSortable(*sortItems[index], fields);
-    (*sortItems[index])[FieldId] = index;
+  // the sort keys only depend on the sort method and on ignoring articles,
+  // reuse the ones of the last sort if it was done on the same items
+  // (ie. only the sort order changed). random needs new keys every time.
+  const SortAttribute keyAttributes = (SortAttribute)(sortDescription.sortAttributes & SortAttributeIgnoreArticle);
+  bool keysValid = m_sortKeys.sortBy == sortDescription.sortBy &&
+                   m_sortKeys.sortAttributes == keyAttributes &&
+                   m_sortKeys.sortBy != SortByRandom &&
+                   m_sortKeyItems.size() == m_items.size();
+  for (size_t index = 0; keysValid && index < m_items.size(); index++)
+  {
+    const SortKeyItem& keyItem = m_sortKeyItems[index];
+    const CFileItem* item = m_items[index].get();
+    keysValid = keyItem.item == item &&
+                keyItem.generation == item->GetGeneration() &&
+                keyItem.fields == HashSortFields(*item);
+  }
+
+  if (!keysValid)
+  {
+    m_sortKeys.clear();
+    m_sortKeys.sortBy = sortDescription.sortBy;
+    m_sortKeys.sortAttributes = keyAttributes;
+    m_sortKeys.labels.reserve(m_items.size());
+    m_sortKeys.special.reserve(m_items.size());
+    m_sortKeys.folder.reserve(m_items.size());
+
+    const Fields fields = SortUtils::GetFieldsForSorting(sortDescription.sortBy);
+    SortItem sortItem;
+    for (int index = 0; index < Size(); index++)
+    {
+      sortItem.clear();
+      m_items[index]->ToSortable(sortItem, fields);
+      sortItem[FieldId] = index;
+      SortUtils::AppendSortKey(m_sortKeys, sortItem);
+    }
   }
 
   // do the sorting
-  SortUtils::Sort(sortDescription, sortItems);
+  std::vector<size_t> order;
+  SortUtils::Sort(m_sortKeys, sortDescription.sortOrder, sortDescription.sortAttributes, order,
+                  sortDescription.limitEnd, sortDescription.limitStart);
 
-  // apply the new order to the existing CFileItems
+  // apply the new order to the existing CFileItems and
+  // keep the keys in the same order for the next time
   VECFILEITEMS sortedFileItems;
-  sortedFileItems.reserve(Size());
-  for (SortItems::const_iterator it = sortItems.begin(); it != sortItems.end(); ++it)
-  {
-    CFileItemPtr item = m_items[(int)(*it)->at(FieldId).asInteger()];
+  sortedFileItems.reserve(order.size());
+  SortKeys sortedKeys;
+  sortedKeys.sortBy = m_sortKeys.sortBy;
+  sortedKeys.sortAttributes = m_sortKeys.sortAttributes;
+  sortedKeys.labels.reserve(order.size());
+  sortedKeys.special.reserve(order.size());
+  sortedKeys.folder.reserve(order.size());
+  m_sortKeyItems.clear();
+  m_sortKeyItems.reserve(order.size());
+  for (std::vector<size_t>::const_iterator it = order.begin(); it != order.end(); ++it)
+  {
+    CFileItemPtr item = m_items[*it];
     // Set the sort label in the CFileItem
-    item->SetSortLabel((*it)->at(FieldSort).asWideString());
-
+    if (item->GetSortLabel() != m_sortKeys.labels[*it])
+      item->SetSortLabel(m_sortKeys.labels[*it]);
+
+    sortedKeys.labels.push_back(std::move(m_sortKeys.labels[*it]));
+    sortedKeys.special.push_back(m_sortKeys.special[*it]);
+    sortedKeys.folder.push_back(m_sortKeys.folder[*it]);
+    SortKeyItem keyItem = { item.get(), item->GetGeneration(), HashSortFields(*item) };
+    m_sortKeyItems.push_back(keyItem);
     sortedFileItems.push_back(item);
   }
+  m_sortKeys = std::move(sortedKeys);
 
   // replace the current list with the re-ordered one
   m_items.assign(sortedFileItems.begin(), sortedFileItems.end());
@@ -3231,6 +3307,9 @@ bool CFileItemList::UpdateItem(const CFileItem *item)
     if (pItem->IsSamePath(item))
     {
       pItem->UpdateInfo(*item);
+      // its sort key may be stale now
+      m_sortKeys.clear();
+      m_sortKeyItems.clear();
       return true;
     }
   }
@@ -3268,6 +3347,7 @@ void CFileItemList::SetReplaceListing(bool replace)
 
 void CFileItemList::ClearSortState()
 {
+  // the keys are checked against the items' generations on the next sort
   m_sortDescription.sortBy = SortByNone;
   m_sortDescription.sortOrder = SortOrderNone;
   m_sortDescription.sortAttributes = SortAttributeNone;
@@ -3278,6 +3358,8 @@ CVideoInfoTag* CFileItem::GetVideoInfoTag()
   if (!m_videoInfoTag)
     m_videoInfoTag = new CVideoInfoTag;
 
+  // the caller may change the tag through the returned pointer
+  Touch();
   return m_videoInfoTag;
 }
 
@@ -3286,6 +3368,7 @@ CPictureInfoTag* CFileItem::GetPictureInfoTag()
   if (!m_pictureInfoTag)
     m_pictureInfoTag = new CPictureInfoTag;
 
+  Touch();
   return m_pictureInfoTag;
 }
 
@@ -3294,6 +3377,7 @@ MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
   if (!m_musicInfoTag)
     m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
 
+  Touch();
   return m_musicInfoTag;
 }
 
@@ -24,7 +24,9 @@
  *
  */
 
+#include <atomic>
 #include <memory>
+#include <stdint.h>
 #include <utility>
 #include <vector>
 
@@ -125,7 +127,7 @@ public:
   void SetURL(const CURL& url);
   bool IsURL(const CURL& url) const;
   const std::string &GetPath() const { return m_strPath; };
-  void SetPath(const std::string &path) { m_strPath = path; };
+  void SetPath(const std::string &path) { if (path != m_strPath) { m_strPath = path; Touch(); } };
   bool IsPath(const std::string& path, bool ignoreURLOptions = false) const;
 
   /*! \brief reset class to it's default values as per construction.
@@ -252,7 +254,7 @@ public:
   void SetLabelPreformated(bool bYesNo) { m_bLabelPreformated=bYesNo; }
   bool SortsOnTop() const { return m_specialSort == SortSpecialOnTop; }
   bool SortsOnBottom() const { return m_specialSort == SortSpecialOnBottom; }
-  void SetSpecialSort(SortSpecial sort) { m_specialSort = sort; }
+  void SetSpecialSort(SortSpecial sort) { if (sort != m_specialSort) { m_specialSort = sort; Touch(); } }
 
   inline bool HasMusicInfoTag() const
   {
@@ -291,6 +293,7 @@ public:
   inline void SetEPGInfoTag(const EPG::CEpgInfoTagPtr& tag)
   {
     m_epgInfoTag = tag;
+    Touch();
   }
 
   inline bool HasPVRChannelInfoTag() const
@@ -526,7 +529,16 @@ public:
   void LoadEmbeddedCue();
   bool HasCueDocument() const;
   bool LoadTracksFromCueDocument(CFileItemList& scannedItems);
+
+  /*! \brief Changes whenever a setter changes the item or a non-const info tag accessor is called.
+   Setting a value the item already has does not change it.
+   Values are never reused, not even by an item created at the address of a deleted one.
+   Direct writes to the public members above do not change it.
+   */
+  uint64_t GetGeneration() const { return m_generation; }
 private:
+  void Touch() { m_generation = ++m_nextGeneration; }
+
   /*! \brief initialize all members of this class (not CGUIListItem members) to default values.
    Called from constructors, and from Reset()
    \sa Reset, CGUIListItem
@@ -556,6 +568,9 @@ private:
   std::string m_strServiceId;
   std::string m_strServiceFile;
   std::string m_strServiceExtras;
+
+  uint64_t m_generation;
+  static std::atomic<uint64_t> m_nextGeneration;
 };
 
 /*!
@@ -748,6 +763,18 @@ private:
   MAPFILEITEMS m_map;
   bool m_fastLookup;
   SortDescription m_sortDescription;
+  // the item a key of the last sort was built from and the state it was in
+  struct SortKeyItem
+  {
+    const CFileItem* item;
+    uint64_t generation;
+    size_t fields;
+  };
+  static size_t HashSortFields(const CFileItem& item);
+
+  // keys of the last sort, m_sortKeyItems are the items they belong to
+  SortKeys m_sortKeys;
+  std::vector<SortKeyItem> m_sortKeyItems;
   bool m_sortIgnoreFolders;
   CACHE_TYPE m_cacheToDisc;
   bool m_replaceListing;
@@ -455,3 +455,19 @@ void CAEFactory::DeviceChange()
   if (AE)
     AE->DeviceChange();
 }
+
+bool CAEFactory::GetProfile(AEProfile &profile)
+{
+  if (AE)
+    return AE->GetProfile(profile);
+
+  return false;
+}
+
+std::string CAEFactory::SetProfileTracing(bool enabled)
+{
+  if (AE)
+    return AE->SetProfileTracing(enabled);
+
+  return "";
+}
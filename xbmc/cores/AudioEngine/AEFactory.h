@@ -74,6 +74,9 @@ public:
   static void KeepConfiguration(unsigned int millis);
   static void DeviceChange();
 
+  static bool GetProfile(AEProfile &profile);
+  static std::string SetProfileTracing(bool enabled);
+
   static void RegisterAudioCallback(IAudioCallback* pCallback);
   static void UnregisterAudioCallback();
 
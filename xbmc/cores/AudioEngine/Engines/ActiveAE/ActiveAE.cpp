@@ -24,19 +24,26 @@ using namespace ActiveAE;
 #include "ActiveAESound.h"
 #include "ActiveAEStream.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 #include "cores/AudioEngine/Utils/AEChannelData.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
 #include "cores/AudioEngine/Encoders/AEEncoderFFmpeg.h"
 
+#include "filesystem/File.h"
 #include "settings/Settings.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 
 #define MAX_CACHE_LEVEL 0.4   // total cache time of stream in seconds
 #define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
 #define MAX_BUFFER_TIME 0.1   // max time of a buffer in seconds
 
+#define PROFILE_TRACE_FILE       "special://temp/aeprofile.csv"
+#define PROFILE_TRACE_MAX_EVENTS 500000
+
 void CEngineStats::Reset(unsigned int sampleRate, bool pcm)
 {
   CSingleLock lock(m_lock);
@@ -45,6 +52,7 @@ void CEngineStats::Reset(unsigned int sampleRate, bool pcm)
   m_bufferedSamples = 0;
   m_suspended = false;
   m_pcmOutput = pcm;
+  m_dataPending = false;
 }
 
 void CEngineStats::UpdateSinkDelay(const AEDelayStatus& status, int samples)
@@ -88,6 +96,8 @@ void CEngineStats::AddStream(unsigned int streamid)
   stream.m_resampleRatio = 1.0;
   stream.m_syncError = 0;
   stream.m_syncState = CAESyncInfo::AESyncState::SYNC_OFF;
+  memset(&stream.m_buffers, 0, sizeof(stream.m_buffers));
+  stream.m_buffers.id = streamid;
   m_streamStats.push_back(stream);
 }
 
@@ -134,6 +144,18 @@ void CEngineStats::UpdateStream(CActiveAEStream *stream)
       }
       str.m_bufferedTime = delay;
       stream->m_bufferedTime = 0;
+
+      str.m_buffers.inputTotal = 0;
+      str.m_buffers.inputUsed = 0;
+      if (stream->m_inputBuffers)
+      {
+        str.m_buffers.inputTotal = stream->m_inputBuffers->m_allSamples.size();
+        str.m_buffers.inputUsed = str.m_buffers.inputTotal - stream->m_inputBuffers->m_freeSamples.size();
+      }
+      str.m_buffers.processingTotal = 0;
+      str.m_buffers.processingUsed = 0;
+      if (stream->m_processingBuffers)
+        stream->m_processingBuffers->GetPoolLevels(str.m_buffers.processingTotal, str.m_buffers.processingUsed);
       break;
     }
   }
@@ -265,6 +287,122 @@ AEAudioFormat CEngineStats::GetCurrentSinkFormat()
   return m_sinkFormat;
 }
 
+static int64_t HostCounterToMicros(int64_t counter)
+{
+  static const int64_t frequency = CurrentHostFrequency();
+  return counter * 1000000 / frequency;
+}
+
+void CEngineStats::AddStageTime(AEProfile::Stage stage, int64_t start)
+{
+  int64_t elapsed = HostCounterToMicros(CurrentHostCounter() - start);
+
+  CSingleLock lock(m_lock);
+  AEProfile::Add(m_profile.stages[stage], elapsed);
+  if (m_profile.tracing)
+    Trace(AEProfile::GetStageName(stage), start, elapsed);
+}
+
+void CEngineStats::AddSinkWrite(int64_t start, int64_t duration)
+{
+  AddStageTime(AEProfile::STAGE_SINKWRITE, start);
+
+  CSingleLock lock(m_lock);
+  // a blocking sink accepts a write once the previous one has been
+  // played, so the gap between writes should match the audio written.
+  // gaps far beyond that are pauses or idle periods, not jitter
+  if (m_lastSinkWrite && m_lastSinkDuration > 0)
+  {
+    int64_t interval = HostCounterToMicros(start - m_lastSinkWrite);
+    if (interval < 10 * m_lastSinkDuration)
+    {
+      int64_t jitter = interval > m_lastSinkDuration ? interval - m_lastSinkDuration : m_lastSinkDuration - interval;
+      AEProfile::Add(m_profile.sinkJitter, jitter);
+      if (m_profile.tracing)
+        Trace("sinkjitter", start, jitter);
+    }
+  }
+  m_lastSinkWrite = start;
+  m_lastSinkDuration = duration;
+}
+
+void CEngineStats::SetDataPending(bool pending)
+{
+  CSingleLock lock(m_lock);
+  m_dataPending = pending;
+}
+
+void CEngineStats::AddUnderrun()
+{
+  CSingleLock lock(m_lock);
+  // the sink also times out when it is idle or a stream has ended,
+  // that is only an underrun if a playing stream still had samples
+  if (!m_dataPending)
+    return;
+
+  m_profile.underruns++;
+  m_lastSinkWrite = 0;
+  if (m_profile.tracing)
+    Trace("underrun", CurrentHostCounter(), 0);
+}
+
+void CEngineStats::GetProfile(AEProfile &profile)
+{
+  CSingleLock lock(m_lock);
+  profile = m_profile;
+  profile.streams.clear();
+  for (auto &str : m_streamStats)
+    profile.streams.push_back(str.m_buffers);
+}
+
+std::string CEngineStats::SetTracing(bool enabled)
+{
+  std::vector<std::string> events;
+  int64_t start;
+  {
+    CSingleLock lock(m_lock);
+    if (enabled == m_profile.tracing)
+      return "";
+
+    m_profile.tracing = enabled;
+    if (enabled)
+    {
+      m_traceStart = CurrentHostCounter();
+      m_traceEvents.clear();
+      CLog::Log(LOGNOTICE, "CEngineStats::%s - started tracing audio engine", __FUNCTION__);
+      return "";
+    }
+    events.swap(m_traceEvents);
+    start = m_traceStart;
+  }
+
+  std::string trace = "time,event,duration\n";
+  for (std::vector<std::string>::const_iterator it = events.begin(); it != events.end(); ++it)
+    trace += *it;
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(PROFILE_TRACE_FILE, true) ||
+      file.Write(trace.c_str(), trace.size()) != (ssize_t)trace.size())
+  {
+    CLog::Log(LOGERROR, "CEngineStats::%s - unable to write %s", __FUNCTION__, PROFILE_TRACE_FILE);
+    return "";
+  }
+  file.Close();
+
+  CLog::Log(LOGNOTICE, "CEngineStats::%s - wrote %u events traced over %u ms to %s", __FUNCTION__, (unsigned int)events.size(),
+            (unsigned int)(HostCounterToMicros(CurrentHostCounter() - start) / 1000), PROFILE_TRACE_FILE);
+  return PROFILE_TRACE_FILE;
+}
+
+void CEngineStats::Trace(const char *event, int64_t start, uint64_t value)
+{
+  // caller holds m_lock
+  if (m_traceEvents.size() >= PROFILE_TRACE_MAX_EVENTS)
+    return;
+  m_traceEvents.push_back(StringUtils::Format("%" PRId64 ",%s,%" PRIu64 "\n",
+                                              HostCounterToMicros(start - m_traceStart), event, value));
+}
+
 CActiveAE::CActiveAE() :
   CThread("ActiveAE"),
   m_controlPort("OutputControlPort", &m_inMsgEvent, &m_outMsgEvent),
@@ -287,6 +425,14 @@ CActiveAE::CActiveAE() :
   m_sinkHasVolume = false;
   m_stats.Reset(44100, true);
   m_streamIdGen = 0;
+  m_fixedSettings = false;
+}
+
+CActiveAE::CActiveAE(const AudioSettings &settings) :
+  CActiveAE()
+{
+  m_settings = settings;
+  m_fixedSettings = true;
 }
 
 CActiveAE::~CActiveAE()
@@ -1810,14 +1956,20 @@ void CActiveAE::UnconfigureSink()
 
 bool CActiveAE::RunStages()
 {
+  int64_t stagesStart = CurrentHostCounter();
   bool busy = false;
 
   // serve input streams
+  bool dataPending = false;
   std::list<CActiveAEStream*>::iterator it;
   for (it = m_streams.begin(); it != m_streams.end(); ++it)
   {
     if ((*it)->m_processingBuffers && !(*it)->m_paused)
-      busy = (*it)->m_processingBuffers->ProcessBuffers();
+    {
+      busy = (*it)->m_processingBuffers->ProcessBuffers(&m_stats);
+      if (!(*it)->m_processingBuffers->IsDrained())
+        dataPending = true;
+    }
 
     if ((*it)->m_streamIsBuffering &&
         (*it)->m_processingBuffers &&
@@ -1873,6 +2025,7 @@ bool CActiveAE::RunStages()
       }
     }
   }
+  m_stats.SetDataPending(dataPending);
 
   if (m_stats.GetWaterLevel() < MAX_WATER_LEVEL &&
      (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())))
@@ -1947,6 +2100,7 @@ bool CActiveAE::RunStages()
       }
 
       bool needClamp = false;
+      int64_t mixStart = CurrentHostCounter();
       for (it = m_streams.begin(); it != m_streams.end() && allStreamsReady; ++it)
       {
         if ((*it)->m_paused || !(*it)->m_processingBuffers)
@@ -2006,6 +2160,8 @@ bool CActiveAE::RunStages()
               nb_loops = out->pkt->nb_samples;
             }
 
+            // volume for stream, per frame when fading or limiting
+            float *gain = GetMixGains(nb_loops);
             for(int i=0; i<nb_loops; i++)
             {
               if ((*it)->m_fadingSamples > 0)
@@ -2020,25 +2176,14 @@ bool CActiveAE::RunStages()
                   (*it)->m_streamFading = false;
                 }
               }
+              gain[i] = (*it)->m_volume * (*it)->m_rgain;
+            }
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, i*nb_floats, out->pkt->planes > 1);
+            if(nb_loops > 1)
+              (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, nb_loops, out->pkt->planes > 1, gain);
 
-              for(int j=0; j<out->pkt->planes; j++)
-              {
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
-              }
-            }
+            for(int j=0; j<out->pkt->planes; j++)
+              CAEMixKernels::MulGain((float*)out->pkt->data[j], gain, nb_loops, nb_floats);
           }
           else
           {
@@ -2073,6 +2218,8 @@ bool CActiveAE::RunStages()
               nb_loops = out->pkt->nb_samples;
             }
 
+            // volume for stream, per frame when fading or limiting
+            float *gain = GetMixGains(nb_loops);
             for(int i=0; i<nb_loops; i++)
             {
               if ((*it)->m_fadingSamples > 0)
@@ -2087,35 +2234,18 @@ bool CActiveAE::RunStages()
                   (*it)->m_streamFading = false;
                 }
               }
+              gain[i] = (*it)->m_volume * (*it)->m_rgain;
+            }
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, i*nb_floats, mix->pkt->planes > 1);
+            if(nb_loops > 1)
+              (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, nb_loops, mix->pkt->planes > 1, gain);
 
-              for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
-              {
-                float *dst = (float*)out->pkt->data[j]+i*nb_floats;
-                float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
-              }
+            for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
+            {
+              float *dst = (float*)out->pkt->data[j];
+              float *src = (float*)mix->pkt->data[j];
+              if (CAEMixKernels::MulAddGain(dst, src, gain, nb_loops, nb_floats))
+                needClamp = true;
             }
             mix->Return();
           }
@@ -2129,9 +2259,11 @@ bool CActiveAE::RunStages()
         int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
         for (int i=0; i<out->pkt->planes; i++)
         {
-          CAEUtil::ClampArray((float*)out->pkt->data[i], nb_floats);
+          CAEMixKernels::SoftClamp((float*)out->pkt->data[i], nb_floats);
         }
       }
+      if (out)
+        m_stats.AddStageTime(AEProfile::STAGE_MIX, mixStart);
 
       // process output buffer, gui sounds, encode, viz
       if (out)
@@ -2199,8 +2331,10 @@ bool CActiveAE::RunStages()
           if (out->pkt->nb_samples)
           {
             buf = m_encoderBuffers->GetFreeBuffer();
+            int64_t encodeStart = CurrentHostCounter();
             buf->pkt->nb_samples = m_encoder->Encode(out->pkt->data[0], out->pkt->planes*out->pkt->linesize,
                                                      buf->pkt->data[0], buf->pkt->planes*buf->pkt->linesize);
+            m_stats.AddStageTime(AEProfile::STAGE_ENCODE, encodeStart);
 
             // set pts of last sample
             buf->pkt_start_offset = buf->pkt->nb_samples;
@@ -2257,6 +2391,10 @@ bool CActiveAE::RunStages()
     busy = true;
   }
 
+  // idle passes only poll, they would drown the ones doing work
+  if (busy)
+    m_stats.AddStageTime(AEProfile::STAGE_RUNSTAGES, stagesStart);
+
   return busy;
 }
 
@@ -2513,6 +2651,13 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
   }
 }
 
+float* CActiveAE::GetMixGains(int frames)
+{
+  if (m_mixGains.size() < (size_t)frames)
+    m_mixGains.resize(frames);
+  return m_mixGains.data();
+}
+
 void CActiveAE::Deamplify(CSoundPacket &dstSample)
 {
   if (m_volumeScaled < 1.0 || m_muted)
@@ -2541,6 +2686,9 @@ void CActiveAE::Deamplify(CSoundPacket &dstSample)
 
 void CActiveAE::LoadSettings()
 {
+  if (m_fixedSettings)
+    return;
+
   m_settings.device = CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT_AUDIODEVICE);
   m_settings.passthoughdevice = CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE);
 
@@ -2884,6 +3032,17 @@ AEAudioFormat CActiveAE::GetCurrentSinkFormat()
   return m_stats.GetCurrentSinkFormat();
 }
 
+bool CActiveAE::GetProfile(AEProfile &profile)
+{
+  m_stats.GetProfile(profile);
+  return true;
+}
+
+std::string CActiveAE::SetProfileTracing(bool enabled)
+{
+  return m_stats.SetTracing(enabled);
+}
+
 void CActiveAE::OnLostDevice()
 {
   if (!m_stats.UsingExternalDevice())
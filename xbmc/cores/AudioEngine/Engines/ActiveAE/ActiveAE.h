@@ -202,13 +202,21 @@ public:
   void SetSinkLatency(float time) { m_sinkLatency = time; }
   bool IsSuspended();
   AEAudioFormat GetCurrentSinkFormat();
+  void AddStageTime(AEProfile::Stage stage, int64_t start);
+  void AddSinkWrite(int64_t start, int64_t duration);
+  void SetDataPending(bool pending);
+  void AddUnderrun();
+  void GetProfile(AEProfile &profile);
+  std::string SetTracing(bool enabled);
 protected:
+  void Trace(const char *event, int64_t start, uint64_t value);
   float m_sinkCacheTotal;
   float m_sinkLatency;
   int m_bufferedSamples;
   unsigned int m_sinkSampleRate;
   AEDelayStatus m_sinkDelay;
   bool m_externalActive = false;
+  bool m_dataPending = false;
   bool m_suspended;
   AEAudioFormat m_sinkFormat;
   bool m_pcmOutput;
@@ -221,8 +229,16 @@ protected:
     double m_syncError;
     unsigned int m_errorTime;
     CAESyncInfo::AESyncState m_syncState;
+    AEProfile::StreamBuffers m_buffers;
   };
   std::vector<StreamStats> m_streamStats;
+
+  // profiling, times in host counter ticks unless noted
+  AEProfile m_profile;
+  int64_t m_lastSinkWrite = 0;
+  int64_t m_lastSinkDuration = 0; // microseconds
+  int64_t m_traceStart = 0;
+  std::vector<std::string> m_traceEvents;
 };
 
 class CActiveAE : public IAE, public IDispResource, private CThread
@@ -233,7 +249,10 @@ protected:
   friend class CActiveAEStream;
   friend class CSoundPacket;
   friend class CActiveAEBufferPoolResample;
+  friend class CActiveAEBenchmark;
   CActiveAE();
+  // an engine that keeps the given settings instead of following the GUI ones
+  explicit CActiveAE(const AudioSettings &settings);
   virtual ~CActiveAE();
   virtual bool  Initialize();
 
@@ -273,6 +292,8 @@ public:
   virtual void KeepConfiguration(unsigned int millis);
   virtual void DeviceChange();
   virtual AEAudioFormat GetCurrentSinkFormat();
+  virtual bool GetProfile(AEProfile &profile);
+  virtual std::string SetProfileTracing(bool enabled);
 
   virtual void RegisterAudioCallback(IAudioCallback* pCallback);
   virtual void UnregisterAudioCallback();
@@ -332,6 +353,7 @@ protected:
   bool ResampleSound(CActiveAESound *sound);
   void MixSounds(CSoundPacket &dstSample);
   void Deamplify(CSoundPacket &dstSample);
+  float* GetMixGains(int frames);
 
   bool CompareFormat(AEAudioFormat &lhs, AEAudioFormat &rhs);
 
@@ -392,6 +414,7 @@ protected:
   float m_volumeScaled; // multiplier to scale samples in order to achieve the volume specified in m_volume
   bool m_muted;
   bool m_sinkHasVolume;
+  std::vector<float> m_mixGains; // per frame stream gains used by RunStages
 
   // viz
   std::vector<IAudioCallback*> m_audioCallback;
@@ -401,5 +424,7 @@ protected:
   // polled via the interface
   float m_aeVolume;
   bool m_aeMuted;
+
+  bool m_fixedSettings;
 };
 };
@@ -0,0 +1,319 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ActiveAEBenchmark.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "ActiveAE.h"
+#include "ActiveAEStream.h"
+#include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/Utils/AEBitstreamPacker.h"
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
+#include "cores/AudioEngine/Utils/AEStreamData.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "filesystem/File.h"
+#include "messaging/ApplicationMessenger.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+#define BENCHMARK_REPORT_FILE "special://temp/aebenchmark.csv"
+#define BENCHMARK_DEVICE       "NULL:benchmark" // consumes packets at once, see CAESinkNULL
+#define BENCHMARK_INPUT_FRAMES 1024 // frames per AddData call
+#define BENCHMARK_STALL_TIME   5000 // ms without progress before a scenario fails
+
+using namespace ActiveAE;
+using namespace KODI::MESSAGING;
+
+const CActiveAEBenchmark::Scenario CActiveAEBenchmark::m_scenarios[] =
+{
+  // name                        streams  in rate  in layout          out rate ch  ratio  tempo  transcode passthrough                           frame size
+  { "pcm 48k 2.0",                     1,   48000, AE_CH_LAYOUT_2_0,   48000,  1,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 44.1k 2.0 to 48k",            1,   44100, AE_CH_LAYOUT_2_0,   48000,  1,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 48k 5.1 to 2.0",              1,   48000, AE_CH_LAYOUT_5_1,   48000,  1,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 96k 7.1 to 48k 5.1",          1,   96000, AE_CH_LAYOUT_7_1,   48000,  8,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 48k 2.0 sync ratio 1.001",    1,   48000, AE_CH_LAYOUT_2_0,   48000,  1,  1.001, 1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 48k 5.1 sync ratio 0.999",    1,   48000, AE_CH_LAYOUT_5_1,   48000,  8,  0.999, 1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 48k 2.0 tempo 1.1",           1,   48000, AE_CH_LAYOUT_2_0,   48000,  1,  1.0,   1.1,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "pcm 48k 5.1 tempo 0.9",           1,   48000, AE_CH_LAYOUT_5_1,   48000,  8,  1.0,   0.9,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "mix 4x pcm 44.1k 2.0 to 48k",     4,   44100, AE_CH_LAYOUT_2_0,   48000,  1,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "mix 2x pcm 48k 5.1",              2,   48000, AE_CH_LAYOUT_5_1,   48000,  8,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "transcode 48k 5.1 to ac3",        1,   48000, AE_CH_LAYOUT_5_1,   48000,  1,  1.0,   1.0,   true,     CAEStreamInfo::STREAM_TYPE_NULL,      0    },
+  { "passthrough ac3",                 1,   48000, AE_CH_LAYOUT_5_1,   48000,  1,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_AC3,       1792 },
+  { "passthrough dts",                 1,   48000, AE_CH_LAYOUT_5_1,   48000,  1,  1.0,   1.0,   false,    CAEStreamInfo::STREAM_TYPE_DTS_512,   2012 },
+};
+
+const unsigned int CActiveAEBenchmark::m_scenarioCount = sizeof(m_scenarios) / sizeof(m_scenarios[0]);
+
+CActiveAEBenchmark::CActiveAEBenchmark(unsigned int seconds, bool quit)
+  : m_seconds(seconds),
+    m_quit(quit)
+{
+}
+
+bool CActiveAEBenchmark::DoWork()
+{
+  std::vector<Result> results = Run(m_seconds);
+
+  std::string report = "scenario,streams,audio_s,wall_s,realtime_factor,runstages_s,runstages_per_stream";
+  for (unsigned int stage = 0; stage < AEProfile::STAGE_RUNSTAGES; stage++)
+    report += StringUtils::Format(",%s_s", AEProfile::GetStageName(stage));
+  report += "\n";
+
+  for (std::vector<Result>::const_iterator it = results.begin(); it != results.end(); ++it)
+  {
+    CLog::Log(LOGNOTICE, "CActiveAEBenchmark::%s - %-30s %u stream(s) %6.1fx realtime, %5.2f%% in RunStages per stream",
+              __FUNCTION__, it->name.c_str(), it->streams, it->realtimeFactor, it->stagesPerStream * 100);
+    report += StringUtils::Format("%s,%u,%.3f,%.3f,%.2f,%.3f,%.6f", it->name.c_str(), it->streams,
+                                  it->audioSeconds, it->wallSeconds, it->realtimeFactor, it->stagesSeconds, it->stagesPerStream);
+    for (unsigned int stage = 0; stage < AEProfile::STAGE_RUNSTAGES; stage++)
+      report += StringUtils::Format(",%.3f", it->stageSeconds[stage]);
+    report += "\n";
+  }
+
+  XFILE::CFile file;
+  bool written = file.OpenForWrite(BENCHMARK_REPORT_FILE, true) &&
+                 file.Write(report.c_str(), report.size()) == (ssize_t)report.size();
+  file.Close();
+  if (written)
+    CLog::Log(LOGNOTICE, "CActiveAEBenchmark::%s - wrote %s", __FUNCTION__, BENCHMARK_REPORT_FILE);
+  else
+    CLog::Log(LOGERROR, "CActiveAEBenchmark::%s - unable to write %s", __FUNCTION__, BENCHMARK_REPORT_FILE);
+
+  if (m_quit)
+    CApplicationMessenger::GetInstance().PostMsg(TMSG_QUIT);
+
+  return written && results.size() == m_scenarioCount;
+}
+
+std::vector<CActiveAEBenchmark::Result> CActiveAEBenchmark::Run(unsigned int seconds)
+{
+  std::vector<Result> results;
+
+  // sample buffers are allocated by the running engine
+  if (!CAEFactory::GetEngine())
+  {
+    CLog::Log(LOGERROR, "CActiveAEBenchmark::%s - audio engine is not running", __FUNCTION__);
+    return results;
+  }
+
+  CLog::Log(LOGNOTICE, "CActiveAEBenchmark::%s - %u seconds per scenario, %s mix kernels",
+            __FUNCTION__, seconds, CAEMixKernels::GetImplementation());
+
+  for (unsigned int i = 0; i < m_scenarioCount; i++)
+  {
+    Result result;
+    if (!RunScenario(m_scenarios[i], seconds, result))
+    {
+      CLog::Log(LOGERROR, "CActiveAEBenchmark::%s - %s failed", __FUNCTION__, m_scenarios[i].name);
+      continue;
+    }
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+CActiveAE *CActiveAEBenchmark::CreateEngine(const Scenario &scenario)
+{
+  AudioSettings settings;
+  settings.device = BENCHMARK_DEVICE;
+  settings.passthoughdevice = BENCHMARK_DEVICE;
+  settings.channels = scenario.channels;
+  settings.samplerate = scenario.outputRate;
+  // fixed mode pins the sink format, passthrough and transcoding need auto
+  settings.config = (scenario.transcode || scenario.passthrough != CAEStreamInfo::STREAM_TYPE_NULL) ?
+                    AE_CONFIG_AUTO : AE_CONFIG_FIXED;
+  settings.stereoupmix = false;
+  settings.normalizelevels = true;
+  settings.guisoundmode = AE_SOUND_OFF;
+  settings.passthrough = scenario.transcode;
+  settings.ac3passthrough = scenario.transcode;
+  settings.ac3transcode = scenario.transcode;
+  settings.eac3passthrough = false;
+  settings.dtspassthrough = false;
+  settings.truehdpassthrough = false;
+  settings.dtshdpassthrough = false;
+  settings.resampleQuality = AE_QUALITY_MID;
+  // a threshold of 0 always selects atempo, 1 always the resampler
+  settings.atempoThreshold = scenario.tempo != 1.0 ? 0.0 : 1.0;
+  settings.boostcenter = 0;
+
+  CActiveAE *engine = new CActiveAE(settings);
+  if (!engine->Initialize())
+  {
+    delete engine;
+    return NULL;
+  }
+  return engine;
+}
+
+bool CActiveAEBenchmark::RunScenario(const Scenario &scenario, unsigned int seconds, Result &result)
+{
+  CActiveAE *engine = CreateEngine(scenario);
+  if (!engine)
+    return false;
+
+  // below full volume so that the volume and limiter paths of RunStages run
+  engine->SetVolume(0.9f);
+
+  bool raw = scenario.passthrough != CAEStreamInfo::STREAM_TYPE_NULL;
+  AEAudioFormat format;
+  std::vector<uint8_t> payload;
+  double frameDuration; // seconds per AddData unit, a frame or a raw packet
+  if (raw)
+  {
+    CAEStreamInfo info;
+    info.m_type = scenario.passthrough;
+    info.m_sampleRate = scenario.inputRate;
+    info.m_channels = CAEChannelInfo(scenario.inputLayout).Count();
+    info.m_frameSize = scenario.frameSize;
+    info.m_dataIsLE = false;
+
+    // as the passthrough codec hands them over, see CDVDAudioCodecPassthrough
+    format.m_dataFormat = AE_FMT_RAW;
+    format.m_streamInfo = info;
+    format.m_sampleRate = CAEBitstreamPacker::GetOutputRate(info);
+    for (unsigned int c = 0; c < CAEBitstreamPacker::GetOutputChannelMap(info).Count(); c++)
+      format.m_channelLayout += AE_CH_RAW;
+    format.m_frameSize = 1;
+
+    // payload content does not matter to the packer
+    payload.resize(scenario.frameSize);
+    for (size_t i = 0; i < payload.size(); i++)
+      payload[i] = (uint8_t)(i * 31);
+    frameDuration = info.GetDuration() / 1000;
+  }
+  else
+  {
+    format.m_dataFormat = AE_FMT_FLOAT;
+    format.m_sampleRate = scenario.inputRate;
+    format.m_channelLayout = CAEChannelInfo(scenario.inputLayout);
+    format.m_frameSize = format.m_channelLayout.Count() * sizeof(float);
+
+    // one block of sine waves, 10 periods per block, a different pitch per channel
+    unsigned int channels = format.m_channelLayout.Count();
+    payload.resize(BENCHMARK_INPUT_FRAMES * format.m_frameSize);
+    float *samples = (float*)payload.data();
+    for (unsigned int i = 0; i < BENCHMARK_INPUT_FRAMES; i++)
+    {
+      for (unsigned int c = 0; c < channels; c++)
+        samples[i * channels + c] = 0.5f * sinf(2.0f * (float)M_PI * (10 + c) * i / BENCHMARK_INPUT_FRAMES);
+    }
+    frameDuration = 1.0 / scenario.inputRate;
+  }
+
+  unsigned int options = scenario.resampleRatio != 1.0 ? AESTREAM_FORCE_RESAMPLE : 0;
+  double ratio = scenario.tempo != 1.0 ? 1.0 / scenario.tempo : scenario.resampleRatio;
+
+  std::vector<CActiveAEStream*> streams;
+  bool ok = true;
+  for (unsigned int i = 0; i < scenario.streams && ok; i++)
+  {
+    CActiveAEStream *stream = static_cast<CActiveAEStream*>(engine->MakeStream(format, options));
+    if (stream)
+      streams.push_back(stream);
+    else
+      ok = false;
+  }
+
+  // feed the streams like a player would, as much as the engine takes
+  const uint8_t *data = payload.data();
+  uint64_t target = (uint64_t)(seconds / frameDuration);
+  std::vector<uint64_t> fed(streams.size(), 0);
+  int64_t start = CurrentHostCounter();
+  XbmcThreads::EndTime stall(BENCHMARK_STALL_TIME);
+  while (ok)
+  {
+    bool added = false;
+    bool finished = true;
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+      if (fed[i] >= target)
+        continue;
+      finished = false;
+
+      // only fill whole buffers, a partly filled one is not handed to the engine
+      unsigned int space = streams[i]->GetSpace();
+      if (raw)
+        space = std::min<uint64_t>(space, target - fed[i]);
+      else
+        space = std::min<uint64_t>(space / format.m_frameSize, target - fed[i]);
+      if (space == 0)
+        continue;
+
+      // the stream buffers exist once the engine hands out space, set the ratio then
+      if (fed[i] == 0 && ratio != 1.0)
+        engine->SetStreamResampleRatio(streams[i], ratio);
+
+      while (space > 0)
+      {
+        unsigned int frames = raw ? scenario.frameSize : std::min(space, (unsigned int)BENCHMARK_INPUT_FRAMES);
+        double pts = fed[i] * frameDuration * 1000;
+        if (streams[i]->AddData(&data, 0, frames, pts) != frames)
+          break;
+        unsigned int units = raw ? 1 : frames;
+        fed[i] += units;
+        space -= units;
+        added = true;
+      }
+    }
+
+    if (finished)
+      break;
+
+    if (added)
+      stall.Set(BENCHMARK_STALL_TIME);
+    else if (stall.IsTimePast())
+    {
+      CLog::Log(LOGERROR, "CActiveAEBenchmark::%s - %s stalled", __FUNCTION__, scenario.name);
+      ok = false;
+    }
+    else
+      Sleep(1);
+  }
+
+  // push out what is still buffered in the engine
+  for (std::vector<CActiveAEStream*>::iterator it = streams.begin(); it != streams.end() && ok; ++it)
+    (*it)->Drain(true);
+
+  result.name = scenario.name;
+  result.streams = scenario.streams;
+  result.audioSeconds = target * frameDuration;
+  result.wallSeconds = (double)(CurrentHostCounter() - start) / CurrentHostFrequency();
+  result.realtimeFactor = result.wallSeconds > 0 ? result.audioSeconds / result.wallSeconds : 0;
+
+  AEProfile profile;
+  engine->GetProfile(profile);
+  for (unsigned int stage = 0; stage < AEProfile::STAGE_MAX; stage++)
+    result.stageSeconds[stage] = profile.stages[stage].total / 1e6;
+  result.stagesSeconds = result.stageSeconds[AEProfile::STAGE_RUNSTAGES];
+  result.stagesPerStream = result.audioSeconds > 0 ? result.stagesSeconds / result.audioSeconds / scenario.streams : 0;
+
+  for (std::vector<CActiveAEStream*>::iterator it = streams.begin(); it != streams.end(); ++it)
+    engine->FreeStream(*it);
+  engine->Shutdown();
+  delete engine;
+
+  return ok && result.audioSeconds > 0;
+}
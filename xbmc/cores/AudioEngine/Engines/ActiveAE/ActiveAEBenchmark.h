@@ -0,0 +1,105 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "cores/AudioEngine/Utils/AEChannelData.h"
+#include "cores/AudioEngine/Utils/AEProfile.h"
+#include "cores/AudioEngine/Utils/AEStreamInfo.h"
+#include "utils/Job.h"
+
+namespace ActiveAE
+{
+
+class CActiveAE;
+
+/*!
+ \brief Headless benchmark of the audio pipeline.
+
+ Runs a private CActiveAE with fixed settings on a NULL sink that consumes
+ audio as fast as it is produced, and feeds it synthetic streams through
+ IAEStream like a player does. Every scenario goes through the whole engine:
+ stream resampling and atempo, mixing, volume and limiter, the encoder when
+ transcoding, IEC 61937 packing for passthrough and CActiveAESink. The time
+ spent in CActiveAE::RunStages and its stages comes from the engine profile.
+ The results are logged and written as CSV to special://temp/aebenchmark.csv
+ so build machines without a sound card can track the cost of these stages.
+ */
+class CActiveAEBenchmark : public CJob
+{
+public:
+  struct Result
+  {
+    std::string name;
+    unsigned int streams;
+    double audioSeconds;   // input audio fed to each stream
+    double wallSeconds;
+    double realtimeFactor; // audio seconds per wall second
+    double stagesSeconds;  // time spent in RunStages passes that did work
+    double stagesPerStream; // RunStages seconds per second of audio and stream
+    double stageSeconds[AEProfile::STAGE_MAX];
+  };
+
+  /*!
+   \param seconds audio to produce per scenario
+   \param quit quit the application when done, for --audiobenchmark
+   */
+  CActiveAEBenchmark(unsigned int seconds, bool quit);
+  virtual ~CActiveAEBenchmark() {}
+
+  virtual const char *GetType() const { return "audiobenchmark"; }
+  virtual LANE GetLane() const { return LANE_CPU; }
+  virtual bool DoWork();
+
+  /*!
+   \brief run every scenario on the calling thread
+   \return results in scenario order, failed scenarios are left out
+   */
+  static std::vector<Result> Run(unsigned int seconds);
+
+protected:
+  struct Scenario
+  {
+    const char *name;
+    unsigned int streams;
+    unsigned int inputRate;
+    AEStdChLayout inputLayout;
+    unsigned int outputRate;
+    int channels;           // audiooutput.channels, 1 = 2.0, 8 = 5.1
+    double resampleRatio;   // video sync resampling, 1.0 for none
+    double tempo;           // atempo, 1.0 for none
+    bool transcode;         // encode the mix to ac3
+    CAEStreamInfo::DataType passthrough;
+    unsigned int frameSize; // passthrough payload bytes per frame
+  };
+
+  static bool RunScenario(const Scenario &scenario, unsigned int seconds, Result &result);
+  static CActiveAE *CreateEngine(const Scenario &scenario);
+
+  static const Scenario m_scenarios[];
+  static const unsigned int m_scenarioCount;
+
+  unsigned int m_seconds;
+  bool m_quit;
+};
+
+}
@@ -30,6 +30,7 @@
 
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 
 #include <new> // for std::bad_alloc
 #include <algorithm>
@@ -524,6 +525,8 @@ void CActiveAESink::StateMachine(int signal, Protocol *port, Message *msg)
         switch (signal)
         {
         case CSinkControlProtocol::TIMEOUT:
+          // no samples arrived in time, only counted if the engine had some pending
+          m_stats->AddUnderrun();
           if (!m_extSilenceTimer.IsTimePast())
           {
             m_state = S_TOP_CONFIGURED_SILENCE;
@@ -1013,6 +1016,7 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
   }
 
   int framesOrPackets;
+  int64_t writeStart = CurrentHostCounter();
 
   while (frames > 0)
   {
@@ -1058,6 +1062,13 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
   if (m_requestedFormat.m_dataFormat == AE_FMT_RAW)
     m_stats->UpdateSinkDelay(status, samples->pool ? 1 : 0);
 
+  int64_t duration;
+  if (m_requestedFormat.m_dataFormat == AE_FMT_RAW)
+    duration = m_sinkFormat.m_streamInfo.GetDuration() * 1000;
+  else
+    duration = (int64_t)totalFrames * 1000000 / m_sinkFormat.m_sampleRate;
+  m_stats->AddSinkWrite(writeStart, duration);
+
   return status.delay * 1000;
 }
 
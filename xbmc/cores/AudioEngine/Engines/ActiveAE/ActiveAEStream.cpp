@@ -21,6 +21,7 @@
 #include "system.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
@@ -617,10 +618,11 @@ void CActiveAEStreamBuffers::SetExtraData(int profile, enum AVMatrixEncoding mat
   m_resampleBuffers->SetExtraData(profile, matrix_encoding, audio_service_type);
 }
 
-bool CActiveAEStreamBuffers::ProcessBuffers()
+bool CActiveAEStreamBuffers::ProcessBuffers(CEngineStats *stats)
 {
   bool busy = false;
   CSampleBuffer *buf;
+  int64_t start;
 
   while (!m_inputSamples.empty())
   {
@@ -630,7 +632,13 @@ bool CActiveAEStreamBuffers::ProcessBuffers()
     busy = true;
   }
 
-  busy |= m_resampleBuffers->ResampleBuffers();
+  start = CurrentHostCounter();
+  if (m_resampleBuffers->ResampleBuffers())
+  {
+    if (stats)
+      stats->AddStageTime(AEProfile::STAGE_RESAMPLE, start);
+    busy = true;
+  }
 
   while (!m_resampleBuffers->m_outputSamples.empty())
   {
@@ -640,7 +648,13 @@ bool CActiveAEStreamBuffers::ProcessBuffers()
     busy = true;
   }
 
-  busy |= m_atempoBuffers->ProcessBuffers();
+  start = CurrentHostCounter();
+  if (m_atempoBuffers->ProcessBuffers())
+  {
+    if (stats)
+      stats->AddStageTime(AEProfile::STAGE_ATEMPO, start);
+    busy = true;
+  }
 
   while (!m_atempoBuffers->m_outputSamples.empty())
   {
@@ -765,6 +779,20 @@ CActiveAEBufferPool* CActiveAEStreamBuffers::GetAtempoBuffers()
   return ret;
 }
 
+void CActiveAEStreamBuffers::GetPoolLevels(unsigned int &total, unsigned int &used)
+{
+  total = 0;
+  used = 0;
+  CActiveAEBufferPool *pools[] = { m_resampleBuffers, m_atempoBuffers };
+  for (CActiveAEBufferPool *pool : pools)
+  {
+    if (!pool)
+      continue;
+    total += pool->m_allSamples.size();
+    used += pool->m_allSamples.size() - pool->m_freeSamples.size();
+  }
+}
+
 bool CActiveAEStreamBuffers::HasWork()
 {
   if (!m_inputSamples.empty())
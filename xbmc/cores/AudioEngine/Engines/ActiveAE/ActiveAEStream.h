@@ -90,6 +90,8 @@ protected:
   XbmcThreads::EndTime m_timer;
 };
 
+class CEngineStats;
+
 class CActiveAEStreamBuffers
 {
 public:
@@ -97,7 +99,7 @@ public:
   virtual ~CActiveAEStreamBuffers();
   bool Create(unsigned int totaltime, bool remap, bool upmix, bool normalize = true);
   void SetExtraData(int profile, enum AVMatrixEncoding matrix_encoding, enum AVAudioServiceType audio_service_type);
-  bool ProcessBuffers();
+  bool ProcessBuffers(CEngineStats *stats = nullptr);
   void ConfigureResampler(bool normalizelevels, bool stereoupmix, AEQuality quality);
   bool HasInputLevel(int level);
   float GetDelay();
@@ -112,6 +114,7 @@ public:
   bool HasWork();
   CActiveAEBufferPool *GetResampleBuffers();
   CActiveAEBufferPool *GetAtempoBuffers();
+  void GetPoolLevels(unsigned int &total, unsigned int &used);
   
   AEAudioFormat m_inputFormat;
   std::deque<CSampleBuffer*> m_outputSamples;
@@ -27,6 +27,7 @@
 #include "system.h"
 
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
+#include "cores/AudioEngine/Utils/AEProfile.h"
 
 typedef std::pair<std::string, std::string> AEDevice;
 typedef std::vector<AEDevice> AEDeviceList;
@@ -271,5 +272,21 @@ public:
    * @return Returns true on success, else false.
    */
   virtual bool GetCurrentSinkFormat(AEAudioFormat &SinkFormat) { return false; }
+
+  /**
+   * Get per stage timings, buffer pool occupancy and underruns
+   *
+   * @param profile receives the statistics collected since the engine started
+   * @return Returns true on success, false if the engine does not profile.
+   */
+  virtual bool GetProfile(AEProfile &profile) { return false; }
+
+  /**
+   * Start or stop writing every stage timing to a CSV trace
+   *
+   * @param enabled true to start tracing
+   * @return path of the trace file written when tracing stopped, else empty.
+   */
+  virtual std::string SetProfileTracing(bool enabled) { return ""; }
 };
 
@@ -46,6 +46,7 @@ private:
   CEvent               m_wake;
   CEvent               m_inited;
   volatile bool        m_draining;
+  bool                 m_paced;            ///< false consumes packets as fast as they come
   AEAudioFormat        m_format;
   unsigned int         m_sink_frameSize;
   unsigned int         m_sinkbuffer_size;  ///< total size of the buffer
@@ -20,6 +20,7 @@
 
 #include "system.h"
 #include "AELimiter.h"
+#include "AEMixKernels.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/MathUtils.h"
 #include <algorithm>
@@ -52,6 +53,30 @@ float CAELimiter::Run(float* frame[AE_CH_MAX], int channels, int offset /*= 0*/,
     }
   }
 
+  return Step(highest);
+}
+
+void CAELimiter::Run(float* frame[AE_CH_MAX], int channels, int frames, bool planar, float *gain)
+{
+  if (m_peaks.size() < (size_t)frames)
+    m_peaks.resize(frames);
+
+  float *peaks = m_peaks.data();
+  std::fill(peaks, peaks + frames, 0.0f);
+  if (!planar)
+    CAEMixKernels::FramePeak(peaks, frame[0], frames, channels);
+  else
+  {
+    for(int i=0; i<channels; i++)
+      CAEMixKernels::FramePeak(peaks, frame[i], frames, 1);
+  }
+
+  for(int i=0; i<frames; i++)
+    gain[i] *= Step(peaks[i]);
+}
+
+float CAELimiter::Step(float highest)
+{
   float sample = highest * m_amplify;
   if (sample * m_attenuation > 1.0f)
   {
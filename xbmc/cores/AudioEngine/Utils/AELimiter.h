@@ -20,6 +20,7 @@
  */
 
 #include <algorithm>
+#include <vector>
 #include "AEAudioFormat.h"
 
 class CAELimiter
@@ -30,6 +31,9 @@ class CAELimiter
     float m_samplerate;
     int   m_holdcounter;
     float m_increase;
+    std::vector<float> m_peaks;
+
+    float Step(float highest);
 
   public:
     CAELimiter();
@@ -50,4 +54,9 @@ class CAELimiter
     }
 
     float Run(float* frame[AE_CH_MAX], int channels, int offset = 0, bool planar = false);
+    /*!
+     \brief Run the limiter over a block of frames.
+     Multiplies gain[i] by the factor Run() would return for frame i.
+     */
+    void Run(float* frame[AE_CH_MAX], int channels, int frames, bool planar, float *gain);
 };
@@ -0,0 +1,633 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEMixKernels.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AE_HAVE_AVX2
+#define AE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AE_HAVE_NEON
+#endif
+
+// the vector variants only handle the bulk of a buffer and leave the
+// remaining frames and unusual strides to the C reference below
+
+static void MulGainC(float *data, const float *gain, uint32_t frames, uint32_t stride)
+{
+  for (uint32_t i = 0; i < frames; i++, data += stride)
+  {
+    for (uint32_t c = 0; c < stride; c++)
+      data[c] *= gain[i];
+  }
+}
+
+static bool MulAddGainC(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride)
+{
+  bool exceeded = false;
+  for (uint32_t i = 0; i < frames; i++, dst += stride, src += stride)
+  {
+    for (uint32_t c = 0; c < stride; c++)
+    {
+      dst[c] += src[c] * gain[i];
+      if (fabsf(dst[c]) > 1.0f)
+        exceeded = true;
+    }
+  }
+  return exceeded;
+}
+
+static void FramePeakC(float *peak, const float *data, uint32_t frames, uint32_t stride)
+{
+  for (uint32_t i = 0; i < frames; i++, data += stride)
+  {
+    float highest = peak[i];
+    for (uint32_t c = 0; c < stride; c++)
+      highest = std::max(highest, fabsf(data[c]));
+    peak[i] = highest;
+  }
+}
+
+static void SoftClampC(float *data, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    float x = data[i];
+    if (x < -3.0f)
+      data[i] = -1.0f;
+    else if (x > 3.0f)
+      data[i] = 1.0f;
+    else
+    {
+      float y = x * x;
+      data[i] = x * (27.0f + y) / (27.0f + 9.0f * y);
+    }
+  }
+}
+
+#if defined(__SSE2__)
+static void MulGainSSE2(float *data, const float *gain, uint32_t frames, uint32_t stride)
+{
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 4 <= frames; i += 4)
+      _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(gain + i)));
+  }
+  else if (stride == 2)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      float *d = data + i * 2;
+      __m128 g = _mm_loadu_ps(gain + i);
+      _mm_storeu_ps(d,     _mm_mul_ps(_mm_loadu_ps(d),     _mm_unpacklo_ps(g, g)));
+      _mm_storeu_ps(d + 4, _mm_mul_ps(_mm_loadu_ps(d + 4), _mm_unpackhi_ps(g, g)));
+    }
+  }
+  else if (stride >= 4)
+  {
+    for (; i < frames; i++)
+    {
+      float *d = data + i * stride;
+      __m128 g = _mm_set1_ps(gain[i]);
+      uint32_t c = 0;
+      for (; c + 4 <= stride; c += 4)
+        _mm_storeu_ps(d + c, _mm_mul_ps(_mm_loadu_ps(d + c), g));
+      for (; c < stride; c++)
+        d[c] *= gain[i];
+    }
+  }
+  MulGainC(data + i * stride, gain + i, frames - i, stride);
+}
+
+static bool MulAddGainSSE2(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride)
+{
+  // max returns its second operand if one is NaN, so the running peak goes
+  // second and a NaN result is skipped like in the reference
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 peak = _mm_setzero_ps();
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      __m128 r = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(gain + i)));
+      _mm_storeu_ps(dst + i, r);
+      peak = _mm_max_ps(_mm_andnot_ps(sign, r), peak);
+    }
+  }
+  else if (stride == 2)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      float *d = dst + i * 2;
+      const float *s = src + i * 2;
+      __m128 g = _mm_loadu_ps(gain + i);
+      __m128 r0 = _mm_add_ps(_mm_loadu_ps(d),     _mm_mul_ps(_mm_loadu_ps(s),     _mm_unpacklo_ps(g, g)));
+      __m128 r1 = _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(_mm_loadu_ps(s + 4), _mm_unpackhi_ps(g, g)));
+      _mm_storeu_ps(d, r0);
+      _mm_storeu_ps(d + 4, r1);
+      peak = _mm_max_ps(_mm_andnot_ps(sign, r0), _mm_max_ps(_mm_andnot_ps(sign, r1), peak));
+    }
+  }
+  else if (stride >= 4)
+  {
+    for (; i < frames; i++)
+    {
+      float *d = dst + i * stride;
+      const float *s = src + i * stride;
+      __m128 g = _mm_set1_ps(gain[i]);
+      uint32_t c = 0;
+      for (; c + 4 <= stride; c += 4)
+      {
+        __m128 r = _mm_add_ps(_mm_loadu_ps(d + c), _mm_mul_ps(_mm_loadu_ps(s + c), g));
+        _mm_storeu_ps(d + c, r);
+        peak = _mm_max_ps(_mm_andnot_ps(sign, r), peak);
+      }
+      if (c < stride && MulAddGainC(d + c, s + c, gain + i, 1, stride - c))
+        peak = _mm_set1_ps(2.0f);
+    }
+  }
+  bool exceeded = _mm_movemask_ps(_mm_cmpgt_ps(peak, _mm_set1_ps(1.0f))) != 0;
+  if (MulAddGainC(dst + i * stride, src + i * stride, gain + i, frames - i, stride))
+    exceeded = true;
+  return exceeded;
+}
+
+static void FramePeakSSE2(float *peak, const float *data, uint32_t frames, uint32_t stride)
+{
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 4 <= frames; i += 4)
+      _mm_storeu_ps(peak + i, _mm_max_ps(_mm_andnot_ps(sign, _mm_loadu_ps(data + i)), _mm_loadu_ps(peak + i)));
+  }
+  FramePeakC(peak + i, data + i * stride, frames - i, stride);
+}
+
+static void SoftClampSSE2(float *data, uint32_t count)
+{
+  const __m128 lo  = _mm_set1_ps(-3.0f);
+  const __m128 hi  = _mm_set1_ps(3.0f);
+  const __m128 c27 = _mm_set1_ps(27.0f);
+  const __m128 c9  = _mm_set1_ps(9.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    // the rational function is exactly +-1 at +-3, so limiting the input
+    // matches the hard clamp of the reference. min/max return their second
+    // operand if one is NaN, the sample goes second so NaN passes through
+    // like it does in the reference
+    __m128 x = _mm_min_ps(hi, _mm_max_ps(lo, _mm_loadu_ps(data + i)));
+    __m128 y = _mm_mul_ps(x, x);
+    _mm_storeu_ps(data + i, _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(c27, y)), _mm_add_ps(c27, _mm_mul_ps(c9, y))));
+  }
+  SoftClampC(data + i, count - i);
+}
+#endif
+
+#if defined(AE_HAVE_AVX2)
+AE_TARGET_AVX2 static void MulGainAVX2(float *data, const float *gain, uint32_t frames, uint32_t stride)
+{
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 8 <= frames; i += 8)
+      _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(gain + i)));
+  }
+  else if (stride == 2)
+  {
+    for (; i + 8 <= frames; i += 8)
+    {
+      float *d = data + i * 2;
+      __m256 g = _mm256_loadu_ps(gain + i);
+      __m256 a = _mm256_unpacklo_ps(g, g);
+      __m256 b = _mm256_unpackhi_ps(g, g);
+      _mm256_storeu_ps(d,     _mm256_mul_ps(_mm256_loadu_ps(d),     _mm256_permute2f128_ps(a, b, 0x20)));
+      _mm256_storeu_ps(d + 8, _mm256_mul_ps(_mm256_loadu_ps(d + 8), _mm256_permute2f128_ps(a, b, 0x31)));
+    }
+  }
+  else if (stride >= 8)
+  {
+    for (; i < frames; i++)
+    {
+      float *d = data + i * stride;
+      __m256 g = _mm256_set1_ps(gain[i]);
+      uint32_t c = 0;
+      for (; c + 8 <= stride; c += 8)
+        _mm256_storeu_ps(d + c, _mm256_mul_ps(_mm256_loadu_ps(d + c), g));
+      for (; c < stride; c++)
+        d[c] *= gain[i];
+    }
+  }
+  MulGainC(data + i * stride, gain + i, frames - i, stride);
+}
+
+AE_TARGET_AVX2 static bool MulAddGainAVX2(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride)
+{
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 peak = _mm256_setzero_ps();
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 8 <= frames; i += 8)
+    {
+      __m256 r = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), _mm256_loadu_ps(gain + i)));
+      _mm256_storeu_ps(dst + i, r);
+      peak = _mm256_max_ps(_mm256_andnot_ps(sign, r), peak);
+    }
+  }
+  else if (stride == 2)
+  {
+    for (; i + 8 <= frames; i += 8)
+    {
+      float *d = dst + i * 2;
+      const float *s = src + i * 2;
+      __m256 g = _mm256_loadu_ps(gain + i);
+      __m256 a = _mm256_unpacklo_ps(g, g);
+      __m256 b = _mm256_unpackhi_ps(g, g);
+      __m256 r0 = _mm256_add_ps(_mm256_loadu_ps(d),     _mm256_mul_ps(_mm256_loadu_ps(s),     _mm256_permute2f128_ps(a, b, 0x20)));
+      __m256 r1 = _mm256_add_ps(_mm256_loadu_ps(d + 8), _mm256_mul_ps(_mm256_loadu_ps(s + 8), _mm256_permute2f128_ps(a, b, 0x31)));
+      _mm256_storeu_ps(d, r0);
+      _mm256_storeu_ps(d + 8, r1);
+      peak = _mm256_max_ps(_mm256_andnot_ps(sign, r0), _mm256_max_ps(_mm256_andnot_ps(sign, r1), peak));
+    }
+  }
+  else if (stride >= 8)
+  {
+    for (; i < frames; i++)
+    {
+      float *d = dst + i * stride;
+      const float *s = src + i * stride;
+      __m256 g = _mm256_set1_ps(gain[i]);
+      uint32_t c = 0;
+      for (; c + 8 <= stride; c += 8)
+      {
+        __m256 r = _mm256_add_ps(_mm256_loadu_ps(d + c), _mm256_mul_ps(_mm256_loadu_ps(s + c), g));
+        _mm256_storeu_ps(d + c, r);
+        peak = _mm256_max_ps(_mm256_andnot_ps(sign, r), peak);
+      }
+      if (c < stride && MulAddGainC(d + c, s + c, gain + i, 1, stride - c))
+        peak = _mm256_set1_ps(2.0f);
+    }
+  }
+  bool exceeded = _mm256_movemask_ps(_mm256_cmp_ps(peak, _mm256_set1_ps(1.0f), _CMP_GT_OQ)) != 0;
+  if (MulAddGainC(dst + i * stride, src + i * stride, gain + i, frames - i, stride))
+    exceeded = true;
+  return exceeded;
+}
+
+AE_TARGET_AVX2 static void FramePeakAVX2(float *peak, const float *data, uint32_t frames, uint32_t stride)
+{
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 8 <= frames; i += 8)
+      _mm256_storeu_ps(peak + i, _mm256_max_ps(_mm256_andnot_ps(sign, _mm256_loadu_ps(data + i)), _mm256_loadu_ps(peak + i)));
+  }
+  FramePeakC(peak + i, data + i * stride, frames - i, stride);
+}
+
+AE_TARGET_AVX2 static void SoftClampAVX2(float *data, uint32_t count)
+{
+  const __m256 lo  = _mm256_set1_ps(-3.0f);
+  const __m256 hi  = _mm256_set1_ps(3.0f);
+  const __m256 c27 = _mm256_set1_ps(27.0f);
+  const __m256 c9  = _mm256_set1_ps(9.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_loadu_ps(data + i)));
+    __m256 y = _mm256_mul_ps(x, x);
+    _mm256_storeu_ps(data + i, _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c27, y)), _mm256_add_ps(c27, _mm256_mul_ps(c9, y))));
+  }
+  SoftClampC(data + i, count - i);
+}
+#endif
+
+#if defined(AE_HAVE_NEON)
+static void MulGainNEON(float *data, const float *gain, uint32_t frames, uint32_t stride)
+{
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 4 <= frames; i += 4)
+      vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), vld1q_f32(gain + i)));
+  }
+  else if (stride == 2)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      float *d = data + i * 2;
+      float32x4_t g = vld1q_f32(gain + i);
+      float32x4x2_t z = vzipq_f32(g, g);
+      vst1q_f32(d,     vmulq_f32(vld1q_f32(d),     z.val[0]));
+      vst1q_f32(d + 4, vmulq_f32(vld1q_f32(d + 4), z.val[1]));
+    }
+  }
+  else if (stride >= 4)
+  {
+    for (; i < frames; i++)
+    {
+      float *d = data + i * stride;
+      float32x4_t g = vdupq_n_f32(gain[i]);
+      uint32_t c = 0;
+      for (; c + 4 <= stride; c += 4)
+        vst1q_f32(d + c, vmulq_f32(vld1q_f32(d + c), g));
+      for (; c < stride; c++)
+        d[c] *= gain[i];
+    }
+  }
+  MulGainC(data + i * stride, gain + i, frames - i, stride);
+}
+
+static bool MulAddGainNEON(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride)
+{
+  // multiply and add are kept separate, a fused multiply-add would round
+  // differently from the reference. vmax would propagate NaN, so the
+  // result of |r| > 1 is collected instead, which is false for NaN
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  uint32x4_t over = vdupq_n_u32(0);
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      float32x4_t r = vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), vld1q_f32(gain + i)));
+      vst1q_f32(dst + i, r);
+      over = vorrq_u32(over, vcagtq_f32(r, one));
+    }
+  }
+  else if (stride == 2)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      float *d = dst + i * 2;
+      const float *s = src + i * 2;
+      float32x4_t g = vld1q_f32(gain + i);
+      float32x4x2_t z = vzipq_f32(g, g);
+      float32x4_t r0 = vaddq_f32(vld1q_f32(d),     vmulq_f32(vld1q_f32(s),     z.val[0]));
+      float32x4_t r1 = vaddq_f32(vld1q_f32(d + 4), vmulq_f32(vld1q_f32(s + 4), z.val[1]));
+      vst1q_f32(d, r0);
+      vst1q_f32(d + 4, r1);
+      over = vorrq_u32(over, vorrq_u32(vcagtq_f32(r0, one), vcagtq_f32(r1, one)));
+    }
+  }
+  else if (stride >= 4)
+  {
+    for (; i < frames; i++)
+    {
+      float *d = dst + i * stride;
+      const float *s = src + i * stride;
+      float32x4_t g = vdupq_n_f32(gain[i]);
+      uint32_t c = 0;
+      for (; c + 4 <= stride; c += 4)
+      {
+        float32x4_t r = vaddq_f32(vld1q_f32(d + c), vmulq_f32(vld1q_f32(s + c), g));
+        vst1q_f32(d + c, r);
+        over = vorrq_u32(over, vcagtq_f32(r, one));
+      }
+      if (c < stride && MulAddGainC(d + c, s + c, gain + i, 1, stride - c))
+        over = vdupq_n_u32(~0u);
+    }
+  }
+  uint32x2_t m = vorr_u32(vget_low_u32(over), vget_high_u32(over));
+  bool exceeded = (vget_lane_u32(m, 0) | vget_lane_u32(m, 1)) != 0;
+  if (MulAddGainC(dst + i * stride, src + i * stride, gain + i, frames - i, stride))
+    exceeded = true;
+  return exceeded;
+}
+
+static void FramePeakNEON(float *peak, const float *data, uint32_t frames, uint32_t stride)
+{
+  uint32_t i = 0;
+  if (stride == 1)
+  {
+    for (; i + 4 <= frames; i += 4)
+    {
+      // select instead of vmax, which would propagate a NaN sample
+      float32x4_t p = vld1q_f32(peak + i);
+      float32x4_t a = vabsq_f32(vld1q_f32(data + i));
+      vst1q_f32(peak + i, vbslq_f32(vcgtq_f32(a, p), a, p));
+    }
+  }
+  FramePeakC(peak + i, data + i * stride, frames - i, stride);
+}
+
+static void SoftClampNEON(float *data, uint32_t count)
+{
+  uint32_t i = 0;
+#if defined(__aarch64__)
+  // armv7 neon has no exact division, the reciprocal estimate would not
+  // match the reference so it keeps using the C version
+  const float32x4_t lo  = vdupq_n_f32(-3.0f);
+  const float32x4_t hi  = vdupq_n_f32(3.0f);
+  const float32x4_t c27 = vdupq_n_f32(27.0f);
+  const float32x4_t c9  = vdupq_n_f32(9.0f);
+  for (; i + 4 <= count; i += 4)
+  {
+    // vmin/vmax propagate NaN, like the reference does
+    float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(data + i), lo), hi);
+    float32x4_t y = vmulq_f32(x, x);
+    vst1q_f32(data + i, vdivq_f32(vmulq_f32(x, vaddq_f32(c27, y)), vaddq_f32(c27, vmulq_f32(c9, y))));
+  }
+#endif
+  SoftClampC(data + i, count - i);
+}
+#endif
+
+typedef CAEMixKernels::KernelSet AEMixKernelSet;
+
+// samples are equal if their bits are, or if both are NaN
+static bool SameSamples(const float *a, const float *b, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (isnan(a[i]) && isnan(b[i]))
+      continue;
+    if (memcmp(&a[i], &b[i], sizeof(float)) != 0)
+      return false;
+  }
+  return true;
+}
+
+// runs a kernel set and the C reference on the same buffers, including
+// infinities, NaN, denormals and the clamp limits, and checks that the
+// results are bit identical
+static bool MatchesReference(const AEMixKernelSet &set)
+{
+  static const float special[] = { NAN, INFINITY, -INFINITY, -0.0f, 0.0f, 1.0f, -1.0f,
+                                   3.0f, -3.0f, 1e-40f, -1e-40f, 1e30f, -1e30f };
+  static const uint32_t strides[] = { 1, 2, 3, 4, 6, 8, 10 };
+  const uint32_t frames = 37; // leaves a remainder for every vector width
+  const size_t size = frames * 10;
+  const size_t specialCount = sizeof(special) / sizeof(special[0]);
+
+  std::vector<float> src(size), dst(size), gain(frames), peak(frames);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < size; i++)
+  {
+    seed = seed * 1664525 + 1013904223;
+    src[i] = ((int32_t)seed / 2147483648.0f) * 4.0f;
+    seed = seed * 1664525 + 1013904223;
+    dst[i] = ((int32_t)seed / 2147483648.0f) * 2.0f;
+    if (i % 7 == 3)
+      src[i] = special[(i / 7) % specialCount];
+  }
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    gain[i] = (float)i / frames * 1.5f;
+    peak[i] = (float)(i % 5) * 0.25f;
+  }
+  gain[5] = NAN;
+  gain[11] = INFINITY;
+  peak[3] = NAN;
+
+  for (size_t n = 0; n < sizeof(strides) / sizeof(strides[0]); n++)
+  {
+    const uint32_t stride = strides[n];
+    const size_t count = frames * stride;
+
+    std::vector<float> ref(src.begin(), src.begin() + count), out(ref);
+    MulGainC(ref.data(), gain.data(), frames, stride);
+    set.mulGain(out.data(), gain.data(), frames, stride);
+    if (!SameSamples(ref.data(), out.data(), count))
+      return false;
+
+    ref.assign(dst.begin(), dst.begin() + count);
+    out = ref;
+    bool refExceeded = MulAddGainC(ref.data(), src.data(), gain.data(), frames, stride);
+    bool outExceeded = set.mulAddGain(out.data(), src.data(), gain.data(), frames, stride);
+    if (refExceeded != outExceeded || !SameSamples(ref.data(), out.data(), count))
+      return false;
+
+    // a clipped sample followed by NaN in every lane must still be reported
+    std::vector<float> clipped(count, NAN), unity(frames, 1.0f);
+    clipped[0] = 2.0f;
+    ref.assign(count, 0.0f);
+    out = ref;
+    refExceeded = MulAddGainC(ref.data(), clipped.data(), unity.data(), frames, stride);
+    outExceeded = set.mulAddGain(out.data(), clipped.data(), unity.data(), frames, stride);
+    if (refExceeded != outExceeded)
+      return false;
+
+    std::vector<float> refPeak(peak), outPeak(peak);
+    FramePeakC(refPeak.data(), src.data(), frames, stride);
+    set.framePeak(outPeak.data(), src.data(), frames, stride);
+    if (!SameSamples(refPeak.data(), outPeak.data(), frames))
+      return false;
+
+    ref.assign(src.begin(), src.begin() + count);
+    out = ref;
+    SoftClampC(ref.data(), count);
+    set.softClamp(out.data(), count);
+    if (!SameSamples(ref.data(), out.data(), count))
+      return false;
+  }
+  return true;
+}
+
+std::vector<CAEMixKernels::KernelSet> CAEMixKernels::GetKernelSets()
+{
+  std::vector<KernelSet> sets;
+  sets.push_back({ MulGainC, MulAddGainC, FramePeakC, SoftClampC, "c" });
+  unsigned int features = g_cpuInfo.GetCPUFeatures();
+  (void)features;
+
+#if defined(__SSE2__)
+  if (features & CPU_FEATURE_SSE2)
+    sets.push_back({ MulGainSSE2, MulAddGainSSE2, FramePeakSSE2, SoftClampSSE2, "sse2" });
+#endif
+#if defined(AE_HAVE_AVX2)
+  if (features & CPU_FEATURE_AVX2)
+    sets.push_back({ MulGainAVX2, MulAddGainAVX2, FramePeakAVX2, SoftClampAVX2, "avx2" });
+#endif
+#if defined(AE_HAVE_NEON)
+#if !defined(__aarch64__)
+  if (features & CPU_FEATURE_NEON)
+#endif
+    sets.push_back({ MulGainNEON, MulAddGainNEON, FramePeakNEON, SoftClampNEON, "neon" });
+#endif
+  return sets;
+}
+
+static AEMixKernelSet SelectKernels()
+{
+  std::vector<AEMixKernelSet> sets = CAEMixKernels::GetKernelSets();
+  const AEMixKernelSet &reference = sets.front();
+  AEMixKernelSet set = sets.back();
+
+  if (set.mulGain != reference.mulGain && !MatchesReference(set))
+  {
+    CLog::Log(LOGERROR, "CAEMixKernels: %s kernels differ from the C reference, not using them", set.name);
+    set = reference;
+  }
+
+  CLog::Log(LOGNOTICE, "CAEMixKernels: using %s kernels", set.name);
+  return set;
+}
+
+static const AEMixKernelSet& Kernels()
+{
+  static const AEMixKernelSet kernels = SelectKernels();
+  return kernels;
+}
+
+void CAEMixKernels::MulGain(float *data, const float *gain, uint32_t frames, uint32_t stride)
+{
+  Kernels().mulGain(data, gain, frames, stride);
+}
+
+bool CAEMixKernels::MulAddGain(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride)
+{
+  return Kernels().mulAddGain(dst, src, gain, frames, stride);
+}
+
+void CAEMixKernels::FramePeak(float *peak, const float *data, uint32_t frames, uint32_t stride)
+{
+  Kernels().framePeak(peak, data, frames, stride);
+}
+
+void CAEMixKernels::SoftClamp(float *data, uint32_t count)
+{
+  Kernels().softClamp(data, count);
+}
+
+const char* CAEMixKernels::GetImplementation()
+{
+  return Kernels().name;
+}
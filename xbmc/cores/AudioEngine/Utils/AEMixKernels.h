@@ -0,0 +1,69 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+
+/*!
+ \brief Float kernels used by the ActiveAE mixing stage.
+
+ Gains are given per frame and apply to stride consecutive samples, so
+ interleaved buffers pass the channel count and planar buffers pass 1 for
+ each plane. An implementation (AVX2, SSE2, NEON or plain C) is picked
+ once at runtime from the CPU features. All of them produce the same
+ results as the C reference, NaN included: it passes through SoftClamp and
+ is skipped by the peak and range checks. The selected implementation is
+ compared bit for bit against the reference on a set of test buffers
+ before it is used, and the reference is used instead if they differ.
+ */
+class CAEMixKernels
+{
+public:
+  //! data[i * stride + c] *= gain[i]
+  static void MulGain(float *data, const float *gain, uint32_t frames, uint32_t stride);
+  //! dst[i * stride + c] += src[i * stride + c] * gain[i], returns true if a result exceeds [-1, 1]
+  static bool MulAddGain(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride);
+  //! peak[i] = max(peak[i], |data[i * stride + c]|)
+  static void FramePeak(float *peak, const float *data, uint32_t frames, uint32_t stride);
+  //! tanh-like soft clipper, see CAEUtil::SoftClamp
+  static void SoftClamp(float *data, uint32_t count);
+
+  //! name of the selected implementation
+  static const char* GetImplementation();
+
+  //! one implementation of the kernels above
+  struct KernelSet
+  {
+    void (*mulGain)(float *data, const float *gain, uint32_t frames, uint32_t stride);
+    bool (*mulAddGain)(float *dst, const float *src, const float *gain, uint32_t frames, uint32_t stride);
+    void (*framePeak)(float *peak, const float *data, uint32_t frames, uint32_t stride);
+    void (*softClamp)(float *data, uint32_t count);
+    const char *name;
+  };
+
+  /*!
+   \brief The implementations this build and CPU can run.
+
+   The C reference comes first and the one that is picked last. Meant for
+   tests and benchmarks, the mixing code goes through the functions above.
+   */
+  static std::vector<KernelSet> GetKernelSets();
+};
@@ -0,0 +1,65 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEProfile.h"
+
+#include <string.h>
+
+static const unsigned int HistogramBounds[AEProfile::HistogramBuckets] =
+  { 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 0 };
+
+static const char *StageNames[AEProfile::STAGE_MAX] =
+  { "resample", "atempo", "mix", "encode", "sinkwrite", "runstages" };
+
+void AEProfile::Reset()
+{
+  memset(stages, 0, sizeof(stages));
+  memset(&sinkJitter, 0, sizeof(sinkJitter));
+  underruns = 0;
+  streams.clear();
+  tracing = false;
+}
+
+void AEProfile::Add(Histogram &histogram, uint64_t value)
+{
+  histogram.count++;
+  histogram.total += value;
+  if (value > histogram.max)
+    histogram.max = value;
+
+  unsigned int bucket = 0;
+  while (bucket < HistogramBuckets - 1 && value > HistogramBounds[bucket])
+    bucket++;
+  histogram.buckets[bucket]++;
+}
+
+unsigned int AEProfile::GetHistogramBound(unsigned int bucket)
+{
+  if (bucket >= HistogramBuckets)
+    return 0;
+  return HistogramBounds[bucket];
+}
+
+const char* AEProfile::GetStageName(unsigned int stage)
+{
+  if (stage >= STAGE_MAX)
+    return "";
+  return StageNames[stage];
+}
@@ -0,0 +1,76 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Timing and buffer statistics of the audio engine, see IAE::GetProfile.
+ Times are in microseconds.
+ */
+struct AEProfile
+{
+  enum Stage
+  {
+    STAGE_RESAMPLE = 0,
+    STAGE_ATEMPO,
+    STAGE_MIX,
+    STAGE_ENCODE,
+    STAGE_SINKWRITE,
+    STAGE_RUNSTAGES,               // a whole pass of the engine over streams, mixing and sink buffers
+    STAGE_MAX
+  };
+
+  static const unsigned int HistogramBuckets = 12;
+
+  struct Histogram
+  {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+    uint64_t buckets[HistogramBuckets];
+  };
+
+  struct StreamBuffers
+  {
+    unsigned int id;
+    unsigned int inputTotal;       // buffers in the input pool of the stream
+    unsigned int inputUsed;
+    unsigned int processingTotal;  // buffers in the resample and atempo pools
+    unsigned int processingUsed;
+  };
+
+  Histogram stages[STAGE_MAX];
+  Histogram sinkJitter;            // deviation of the interval between sink writes from the duration written
+  uint64_t underruns;              // times the sink ran out of samples while playing
+  std::vector<StreamBuffers> streams;
+  bool tracing;
+
+  AEProfile() { Reset(); }
+  void Reset();
+
+  //! add a sample to a histogram
+  static void Add(Histogram &histogram, uint64_t value);
+  //! upper bound of a histogram bucket, 0 for the last unbounded one
+  static unsigned int GetHistogramBound(unsigned int bucket);
+  static const char* GetStageName(unsigned int stage);
+};
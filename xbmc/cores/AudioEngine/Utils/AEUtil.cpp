@@ -22,6 +22,7 @@
 #endif
 
 #include "AEUtil.h"
+#include "AEMixKernels.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 
@@ -369,83 +370,7 @@ inline float CAEUtil::SoftClamp(const float x)
 
 void CAEUtil::ClampArray(float *data, uint32_t count)
 {
-#if !defined(HAVE_SSE) || !defined(__SSE__)
-  for (uint32_t i = 0; i < count; ++i)
-    data[i] = SoftClamp(data[i]);
-
-#else
-  const __m128 c1 = _mm_set_ps1(27.0f);
-  const __m128 c2 = _mm_set_ps1(27.0f + 9.0f);
-
-  /* work around invalid alignment */
-  while (((uintptr_t)data & 0xF) && count > 0)
-  {
-    data[0] = SoftClamp(data[0]);
-    ++data;
-    --count;
-  }
-
-  uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i+=4, data+=4)
-  {
-    /* tanh approx clamp */
-    __m128 dt = _mm_load_ps(data);
-    __m128 tmp     = _mm_mul_ps(dt, dt);
-    *(__m128*)data = _mm_div_ps(
-      _mm_mul_ps(
-        dt,
-        _mm_add_ps(c1, tmp)
-      ),
-      _mm_add_ps(c2, tmp)
-    );
-  }
-
-  if (even != count)
-  {
-    uint32_t odd = count - even;
-    if (odd == 1)
-      data[0] = SoftClamp(data[0]);
-    else
-    {
-      __m128 dt;
-      __m128 tmp;
-      __m128 out;
-      if (odd == 2)
-      {
-        /* tanh approx clamp */
-        dt  = _mm_setr_ps(data[0], data[1], 0, 0);
-        tmp = _mm_mul_ps(dt, dt);
-        out = _mm_div_ps(
-          _mm_mul_ps(
-            dt,
-            _mm_add_ps(c1, tmp)
-          ),
-          _mm_add_ps(c2, tmp)
-        );
-
-        data[0] = ((float*)&out)[0];
-        data[1] = ((float*)&out)[1];
-      }
-      else
-      {
-        /* tanh approx clamp */
-        dt  = _mm_setr_ps(data[0], data[1], data[2], 0);
-        tmp = _mm_mul_ps(dt, dt);
-        out = _mm_div_ps(
-          _mm_mul_ps(
-            dt,
-            _mm_add_ps(c1, tmp)
-          ),
-          _mm_add_ps(c2, tmp)
-        );
-
-        data[0] = ((float*)&out)[0];
-        data[1] = ((float*)&out)[1];
-        data[2] = ((float*)&out)[2];
-      }
-    }
-  }
-#endif
+  CAEMixKernels::SoftClamp(data, count);
 }
 
 /*
@@ -0,0 +1,285 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+typedef CAEMixKernels::KernelSet KernelSet;
+
+// longer than two AVX2 vectors of every stride, so each kernel runs its
+// vector loop and then a remainder of every length
+const uint32_t MaxFrames = 67;
+const uint32_t MaxStride = 10;
+// one float in, so no buffer starts on a vector boundary
+const size_t Offset = 1;
+
+const float Special[] = { NAN, -NAN, INFINITY, -INFINITY, -0.0f, 0.0f,
+                          1e-40f, -1e-40f, 1.17549435e-38f, -1.4e-45f,
+                          1.0f, -1.0f, 3.0f, -3.0f, 1e30f, -1e30f };
+const size_t SpecialCount = sizeof(Special) / sizeof(Special[0]);
+
+class MixKernels
+{
+public:
+  MixKernels()
+  {
+    std::vector<KernelSet> sets = CAEMixKernels::GetKernelSets();
+    reference = sets.front();
+    vector.assign(sets.begin() + 1, sets.end());
+  }
+
+  KernelSet reference;
+  std::vector<KernelSet> vector;
+};
+
+// random samples in [-range, range) with every nth one taken from Special,
+// so specials land in every lane and in the remainders
+std::vector<float> Samples(size_t count, uint32_t seed, float range, size_t every)
+{
+  std::vector<float> samples(count + Offset);
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 1664525 + 1013904223;
+    samples[i + Offset] = ((int32_t)seed / 2147483648.0f) * range;
+    if (every && i % every == every - 1)
+      samples[i + Offset] = Special[(i / every + seed) % SpecialCount];
+  }
+  return samples;
+}
+
+// samples are the same if their bits are or if both are NaN
+::testing::AssertionResult SameSamples(const std::vector<float> &expected, const std::vector<float> &actual)
+{
+  if (expected.size() != actual.size())
+    return ::testing::AssertionFailure() << "size " << actual.size() << " != " << expected.size();
+
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    if (isnan(expected[i]) && isnan(actual[i]))
+      continue;
+    if (memcmp(&expected[i], &actual[i], sizeof(float)) != 0)
+      return ::testing::AssertionFailure() << "sample " << (int)i - (int)Offset << ": "
+                                           << actual[i] << " != " << expected[i];
+  }
+  return ::testing::AssertionSuccess();
+}
+}
+
+TEST(TestAEMixKernels, ReferenceSoftClamp)
+{
+  std::vector<float> data = { 0.0f, 1.0f, -1.0f, 3.0f, -3.0f, 5.0f, -5.0f, NAN };
+  KernelSet reference = MixKernels().reference;
+  reference.softClamp(data.data(), data.size());
+
+  EXPECT_EQ(0.0f, data[0]);
+  EXPECT_FLOAT_EQ(28.0f / 36.0f, data[1]);
+  EXPECT_FLOAT_EQ(-28.0f / 36.0f, data[2]);
+  EXPECT_FLOAT_EQ(1.0f, data[3]);
+  EXPECT_FLOAT_EQ(-1.0f, data[4]);
+  EXPECT_EQ(1.0f, data[5]);
+  EXPECT_EQ(-1.0f, data[6]);
+  EXPECT_TRUE(isnan(data[7]));
+}
+
+TEST(TestAEMixKernels, ReferenceMulAddGain)
+{
+  KernelSet reference = MixKernels().reference;
+  std::vector<float> dst = { 0.5f, -0.5f, 0.25f, 0.0f };
+  std::vector<float> src = { 0.25f, -0.25f, 1.0f, NAN };
+  std::vector<float> gain = { 2.0f, 1.0f };
+
+  EXPECT_FALSE(reference.mulAddGain(dst.data(), src.data(), gain.data(), 1, 2));
+  EXPECT_FLOAT_EQ(1.0f, dst[0]);
+  EXPECT_FLOAT_EQ(-1.0f, dst[1]);
+  EXPECT_TRUE(reference.mulAddGain(dst.data() + 2, src.data() + 2, gain.data() + 1, 1, 2));
+  EXPECT_FLOAT_EQ(1.25f, dst[2]);
+  EXPECT_TRUE(isnan(dst[3]));
+}
+
+TEST(TestAEMixKernels, MulGain)
+{
+  MixKernels kernels;
+  for (const KernelSet &set : kernels.vector)
+  {
+    SCOPED_TRACE(set.name);
+    for (uint32_t stride = 1; stride <= MaxStride; stride++)
+    {
+      for (uint32_t frames = 0; frames <= MaxFrames; frames++)
+      {
+        SCOPED_TRACE(::testing::Message() << "stride " << stride << " frames " << frames);
+        std::vector<float> gain = Samples(frames, frames, 2.0f, 5);
+        std::vector<float> expected = Samples(frames * stride, stride, 1.0f, 3);
+        std::vector<float> actual(expected);
+
+        kernels.reference.mulGain(expected.data() + Offset, gain.data() + Offset, frames, stride);
+        set.mulGain(actual.data() + Offset, gain.data() + Offset, frames, stride);
+        ASSERT_TRUE(SameSamples(expected, actual));
+      }
+    }
+  }
+}
+
+TEST(TestAEMixKernels, MulAddGain)
+{
+  MixKernels kernels;
+  for (const KernelSet &set : kernels.vector)
+  {
+    SCOPED_TRACE(set.name);
+    for (uint32_t stride = 1; stride <= MaxStride; stride++)
+    {
+      for (uint32_t frames = 0; frames <= MaxFrames; frames++)
+      {
+        SCOPED_TRACE(::testing::Message() << "stride " << stride << " frames " << frames);
+        // in range gains and samples, so only the specials can exceed [-1, 1]
+        std::vector<float> gain = Samples(frames, frames, 0.5f, 0);
+        std::vector<float> src = Samples(frames * stride, stride, 0.5f, frames % 2 ? 11 : 0);
+        std::vector<float> expected = Samples(frames * stride, stride + 1, 0.5f, 0);
+        std::vector<float> actual(expected);
+
+        bool expectedExceeded = kernels.reference.mulAddGain(expected.data() + Offset, src.data() + Offset,
+                                                             gain.data() + Offset, frames, stride);
+        bool actualExceeded = set.mulAddGain(actual.data() + Offset, src.data() + Offset,
+                                             gain.data() + Offset, frames, stride);
+        ASSERT_EQ(expectedExceeded, actualExceeded);
+        ASSERT_TRUE(SameSamples(expected, actual));
+      }
+    }
+  }
+}
+
+TEST(TestAEMixKernels, MulAddGainClipInTail)
+{
+  MixKernels kernels;
+  for (const KernelSet &set : kernels.vector)
+  {
+    SCOPED_TRACE(set.name);
+    for (uint32_t stride = 1; stride <= MaxStride; stride++)
+    {
+      for (uint32_t frames = 1; frames <= MaxFrames; frames++)
+      {
+        SCOPED_TRACE(::testing::Message() << "stride " << stride << " frames " << frames);
+        // the only sample that clips is the last one, then the first one
+        // followed by NaN everywhere else
+        std::vector<float> gain(frames + Offset, 1.0f);
+        std::vector<float> src(frames * stride + Offset, 0.0f);
+        std::vector<float> dst(src);
+        src.back() = 1.5f;
+        EXPECT_TRUE(set.mulAddGain(dst.data() + Offset, src.data() + Offset, gain.data() + Offset, frames, stride));
+
+        std::fill(src.begin(), src.end(), NAN);
+        std::fill(dst.begin(), dst.end(), 0.0f);
+        src[Offset] = -2.0f;
+        EXPECT_TRUE(set.mulAddGain(dst.data() + Offset, src.data() + Offset, gain.data() + Offset, frames, stride));
+      }
+    }
+  }
+}
+
+TEST(TestAEMixKernels, FramePeak)
+{
+  MixKernels kernels;
+  for (const KernelSet &set : kernels.vector)
+  {
+    SCOPED_TRACE(set.name);
+    for (uint32_t stride = 1; stride <= MaxStride; stride++)
+    {
+      for (uint32_t frames = 0; frames <= MaxFrames; frames++)
+      {
+        SCOPED_TRACE(::testing::Message() << "stride " << stride << " frames " << frames);
+        std::vector<float> data = Samples(frames * stride, stride, 1.5f, 4);
+        std::vector<float> expected = Samples(frames, frames, 1.0f, 7);
+        std::vector<float> actual(expected);
+
+        kernels.reference.framePeak(expected.data() + Offset, data.data() + Offset, frames, stride);
+        set.framePeak(actual.data() + Offset, data.data() + Offset, frames, stride);
+        ASSERT_TRUE(SameSamples(expected, actual));
+      }
+    }
+  }
+}
+
+TEST(TestAEMixKernels, SoftClamp)
+{
+  MixKernels kernels;
+  for (const KernelSet &set : kernels.vector)
+  {
+    SCOPED_TRACE(set.name);
+    for (uint32_t count = 0; count <= MaxFrames * 2; count++)
+    {
+      SCOPED_TRACE(::testing::Message() << "count " << count);
+      std::vector<float> expected = Samples(count, count, 4.0f, 3);
+      std::vector<float> actual(expected);
+
+      kernels.reference.softClamp(expected.data() + Offset, count);
+      set.softClamp(actual.data() + Offset, count);
+      ASSERT_TRUE(SameSamples(expected, actual));
+    }
+  }
+}
+
+TEST(TestAEMixKernels, Denormals)
+{
+  // gains and samples whose products and sums are denormal, or that are
+  // denormal to begin with
+  MixKernels kernels;
+  const uint32_t frames = MaxFrames;
+  const uint32_t stride = 3;
+  std::vector<float> gain(frames + Offset), src(frames * stride + Offset), dst(src);
+  for (uint32_t i = 0; i < frames; i++)
+    gain[i + Offset] = i % 2 ? 1e-20f : 1.0f;
+  for (uint32_t i = 0; i < frames * stride; i++)
+  {
+    src[i + Offset] = (i % 3 ? 1e-20f : 1e-39f) * (i % 4 ? 1.0f : -1.0f);
+    dst[i + Offset] = i % 5 ? -1e-40f : 1e-45f;
+  }
+
+  for (const KernelSet &set : kernels.vector)
+  {
+    SCOPED_TRACE(set.name);
+    std::vector<float> expected(src), actual(src);
+    kernels.reference.mulGain(expected.data() + Offset, gain.data() + Offset, frames, stride);
+    set.mulGain(actual.data() + Offset, gain.data() + Offset, frames, stride);
+    EXPECT_TRUE(SameSamples(expected, actual));
+
+    expected = dst;
+    actual = dst;
+    EXPECT_EQ(kernels.reference.mulAddGain(expected.data() + Offset, src.data() + Offset, gain.data() + Offset, frames, stride),
+              set.mulAddGain(actual.data() + Offset, src.data() + Offset, gain.data() + Offset, frames, stride));
+    EXPECT_TRUE(SameSamples(expected, actual));
+
+    std::vector<float> expectedPeak(frames + Offset, 0.0f), actualPeak(expectedPeak);
+    kernels.reference.framePeak(expectedPeak.data() + Offset, src.data() + Offset, frames, stride);
+    set.framePeak(actualPeak.data() + Offset, src.data() + Offset, frames, stride);
+    EXPECT_TRUE(SameSamples(expectedPeak, actualPeak));
+
+    expected = src;
+    actual = src;
+    kernels.reference.softClamp(expected.data() + Offset, frames * stride);
+    set.softClamp(actual.data() + Offset, frames * stride);
+    EXPECT_TRUE(SameSamples(expected, actual));
+  }
+}
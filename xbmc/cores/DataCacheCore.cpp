@@ -19,6 +19,7 @@
 */
 
 #include "cores/DataCacheCore.h"
+#include "threads/SingleLock.h"
 
 bool CDataCacheCore::HasAVInfoChanges()
 {
@@ -35,4 +36,16 @@ void CDataCacheCore::SignalVideoInfoChange()
 void CDataCacheCore::SignalAudioInfoChange()
 {
   m_hasAVInfoChanges = true;
-}
\ No newline at end of file
+}
+
+void CDataCacheCore::SetFileCacheInfo(const SFileCacheInfo &info)
+{
+  CSingleLock lock(m_fileCacheSection);
+  m_fileCacheInfo = info;
+}
+
+SFileCacheInfo CDataCacheCore::GetFileCacheInfo()
+{
+  CSingleLock lock(m_fileCacheSection);
+  return m_fileCacheInfo;
+}
@@ -20,6 +20,25 @@
 *
 */
 
+#include "threads/CriticalSection.h"
+
+#include <stdint.h>
+
+struct SFileCacheInfo
+{
+  SFileCacheInfo() : valid(false), forward(0), back(0), forwardSize(0), backSize(0), memory(0), spilled(0), streamRate(0), linkRate(0) {}
+
+  bool     valid;
+  int64_t  forward;     // bytes cached ahead of the read position
+  int64_t  back;        // bytes kept behind it
+  int64_t  forwardSize; // current forward window
+  int64_t  backSize;    // current backward window
+  int64_t  memory;      // bytes held in memory
+  int64_t  spilled;     // bytes held in the spill file
+  unsigned streamRate;  // bytes/s the player reads
+  unsigned linkRate;    // bytes/s the source delivers
+};
+
 class CDataCacheCore
 {
 public:
@@ -27,8 +46,14 @@ public:
   void SignalVideoInfoChange();
   void SignalAudioInfoChange();
 
+  void SetFileCacheInfo(const SFileCacheInfo &info);
+  SFileCacheInfo GetFileCacheInfo();
+
 protected:
   volatile bool m_hasAVInfoChanges;
+
+  CCriticalSection m_fileCacheSection;
+  SFileCacheInfo m_fileCacheInfo;
 };
 
 extern CDataCacheCore g_dataCacheCore;
\ No newline at end of file
@@ -37,8 +37,14 @@
 #include "OverlayRendererGUI.h"
 #if defined(HAS_GL) || defined(HAS_GLES)
 #include "OverlayRendererGL.h"
+#include "windowing/WindowingFactory.h"
 #endif
 
+#include <algorithm>
+
+// largest glyph atlas kept for libass subtitles, 4MB of alpha
+#define GLYPH_ATLAS_SIZE 2048
+
 using namespace OVERLAY;
 
 
@@ -89,12 +95,16 @@ long COverlayMainThread::Release()
 
 CRenderer::CRenderer()
 {
+  m_glyphAtlas   = NULL;
+  m_glyphTexture = NULL;
 }
 
 CRenderer::~CRenderer()
 {
   for(int i = 0; i < NUM_BUFFERS; i++)
     Release(m_buffers[i]);
+
+  ReleaseGlyphAtlas();
 }
 
 void CRenderer::AddOverlay(CDVDOverlay* o, double pts, int index)
@@ -154,6 +164,20 @@ void CRenderer::Flush()
     Release(m_buffers[i]);
 
   Release(m_cleanup);
+
+  ReleaseGlyphAtlas();
+}
+
+void CRenderer::ReleaseGlyphAtlas()
+{
+#if defined(HAS_GL) || defined(HAS_GLES)
+  if (m_glyphTexture)
+    m_glyphTexture->Release();
+#endif
+  m_glyphTexture = NULL;
+
+  delete m_glyphAtlas;
+  m_glyphAtlas = NULL;
 }
 
 void CRenderer::Release(int idx)
@@ -365,7 +389,28 @@ COverlay* CRenderer::Convert(CDVDOverlaySSA* o, double pts)
 
   COverlay *overlay = NULL;
 #if defined(HAS_GL) || defined(HAS_GLES)
-  overlay = new COverlayGlyphGL(images, targetWidth, targetHeight);
+  // glyphs that stay on screen keep their place in a persistent atlas,
+  // so a new frame only copies and uploads the glyphs that are new
+  SQuads quads;
+  if (!m_glyphAtlas)
+    m_glyphAtlas = new CGlyphAtlas(std::min(GLYPH_ATLAS_SIZE, (int)g_Windowing.GetMaxTextureSize()));
+
+  if (m_glyphAtlas->Add(images, quads))
+  {
+    if (!m_glyphTexture || m_glyphTexture->m_generation != m_glyphAtlas->GetGeneration())
+    {
+      // the atlas was repacked, overlays still showing keep the old texture
+      if (m_glyphTexture)
+        m_glyphTexture->Release();
+      m_glyphTexture = new COverlayGlyphAtlasGL(*m_glyphAtlas);
+    }
+    else
+      m_glyphTexture->Update(*m_glyphAtlas);
+
+    overlay = new COverlayGlyphGL(quads, m_glyphTexture, targetWidth, targetHeight);
+  }
+  else
+    overlay = new COverlayGlyphGL(images, targetWidth, targetHeight);
 #endif
   // scale to video dimensions
   if (overlay)
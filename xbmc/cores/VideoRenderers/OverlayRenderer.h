@@ -34,6 +34,9 @@ class CDVDOverlaySSA;
 
 namespace OVERLAY {
 
+  class CGlyphAtlas;
+  class COverlayGlyphAtlasGL;
+
   struct SRenderState
   {
     float x;
@@ -127,10 +130,14 @@ namespace OVERLAY {
 
     void      Release(COverlayV& list);
     void      Release(SElementV& list);
+    void      ReleaseGlyphAtlas();
 
     CCriticalSection m_section;
     SElementV        m_buffers[NUM_BUFFERS];
 
     COverlayV        m_cleanup;
+
+    CGlyphAtlas*          m_glyphAtlas;
+    COverlayGlyphAtlasGL* m_glyphTexture;
   };
 }
@@ -313,9 +313,59 @@ COverlayTextureGL::COverlayTextureGL(CDVDOverlaySpu* o)
   m_pma    = !!USE_PREMULTIPLIED_ALPHA;
 }
 
+COverlayGlyphAtlasGL::COverlayGlyphAtlasGL(CGlyphAtlas& atlas)
+{
+  m_generation = atlas.GetGeneration();
+
+  // the whole atlas goes up now, forget what changed before
+  int first, last;
+  atlas.GetDirtyRows(first, last);
+
+  glGenTextures(1, &m_texture);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, m_texture);
+
+  LoadTexture(GL_TEXTURE_2D
+            , atlas.GetSize()
+            , atlas.GetSize()
+            , atlas.GetSize()
+            , &m_u, &m_v
+            , true
+            , atlas.GetData());
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+}
+
+COverlayGlyphAtlasGL::~COverlayGlyphAtlasGL()
+{
+  glDeleteTextures(1, &m_texture);
+}
+
+void COverlayGlyphAtlasGL::Update(CGlyphAtlas& atlas)
+{
+  int first, last;
+  if (!atlas.GetDirtyRows(first, last))
+    return;
+
+  // whole rows, so no row length is needed on GLES2
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, m_texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  glTexSubImage2D(GL_TEXTURE_2D, 0
+                , 0, first, atlas.GetSize(), last - first + 1
+                , GL_ALPHA, GL_UNSIGNED_BYTE
+                , atlas.GetData() + first * atlas.GetSize());
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+}
+
 COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
 {
   m_vertex = NULL;
+  m_count  = 0;
   m_width  = 1.0;
   m_height = 1.0;
   m_align  = ALIGN_VIDEO;
@@ -323,6 +373,7 @@ COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
   m_x      = 0.0f;
   m_y      = 0.0f;
   m_texture = 0;
+  m_atlas  = NULL;
 
   SQuads quads;
   if(!convert_quad(images, quads))
@@ -340,7 +391,33 @@ COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
             , true
             , quads.data);
 
+  LoadVertices(quads, width, height);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+}
+
+COverlayGlyphGL::COverlayGlyphGL(SQuads& quads, COverlayGlyphAtlasGL* atlas, int width, int height)
+{
+  m_vertex = NULL;
+  m_count  = 0;
+  m_width  = 1.0;
+  m_height = 1.0;
+  m_align  = ALIGN_VIDEO;
+  m_pos    = POSITION_RELATIVE;
+  m_x      = 0.0f;
+  m_y      = 0.0f;
+
+  m_atlas   = (COverlayGlyphAtlasGL*)atlas->Acquire();
+  m_texture = m_atlas->m_texture;
+  m_u       = m_atlas->m_u;
+  m_v       = m_atlas->m_v;
+
+  LoadVertices(quads, width, height);
+}
 
+void COverlayGlyphGL::LoadVertices(SQuads& quads, int width, int height)
+{
   float scale_u = m_u / quads.size_x;
   float scale_v = m_v / quads.size_y;
 
@@ -413,14 +490,14 @@ COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
     vs += 1;
     vt += 4;
   }
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
 }
 
 COverlayGlyphGL::~COverlayGlyphGL()
 {
-  glDeleteTextures(1, &m_texture);
+  if (m_atlas)
+    m_atlas->Release();
+  else
+    glDeleteTextures(1, &m_texture);
   free(m_vertex);
 }
 
@@ -33,6 +33,9 @@ typedef struct ass_image ASS_Image;
 
 namespace OVERLAY {
 
+  class CGlyphAtlas;
+  struct SQuads;
+
   class COverlayTextureGL
       : public COverlayMainThread
   {
@@ -49,11 +52,31 @@ namespace OVERLAY {
     bool   m_pma; /*< is alpha in texture premultipled in the values */
   };
 
+  /*! \brief texture of one generation of a CGlyphAtlas, shared by the glyph overlays
+      using it. released like an overlay so the texture is deleted on the main thread */
+  class COverlayGlyphAtlasGL
+     : public COverlayMainThread
+  {
+  public:
+   COverlayGlyphAtlasGL(CGlyphAtlas& atlas);
+   virtual ~COverlayGlyphAtlasGL();
+
+   void Render(SRenderState& state) {}
+   /*! \brief upload the rows of the atlas that changed since the last call */
+   void Update(CGlyphAtlas& atlas);
+
+   unsigned int m_generation;
+   GLuint m_texture;
+   float  m_u;
+   float  m_v;
+  };
+
   class COverlayGlyphGL
      : public COverlayMainThread
   {
   public:
    COverlayGlyphGL(ASS_Image* images, int width, int height);
+   COverlayGlyphGL(SQuads& quads, COverlayGlyphAtlasGL* atlas, int width, int height);
 
    virtual ~COverlayGlyphGL();
 
@@ -72,6 +95,11 @@ namespace OVERLAY {
    GLuint m_texture;
    float  m_u;
    float  m_v;
+
+   COverlayGlyphAtlasGL* m_atlas; /*< owner of m_texture if set */
+
+  private:
+   void LoadVertices(SQuads& quads, int width, int height);
   };
 
 }
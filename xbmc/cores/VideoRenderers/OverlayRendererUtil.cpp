@@ -27,6 +27,8 @@
 #include "guilib/GraphicContext.h"
 #include "settings/Settings.h"
 
+#include <algorithm>
+
 #define PIXEL_ASHIFT 24
 #define PIXEL_RSHIFT 16
 #define PIXEL_GSHIFT 8
@@ -305,6 +307,188 @@ bool convert_quad(ASS_Image* images, SQuads& quads)
   return true;
 }
 
+static inline bool is_visible(ASS_Image* img)
+{
+  // fully transparent or width or height is 0 -> not displayed
+  return (img->color & 0xff) != 0xff && img->w != 0 && img->h != 0;
+}
+
+static uint64_t hash_bitmap(ASS_Image* img)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for(int i=0; i<img->h; i++)
+  {
+    const unsigned char* row = img->bitmap + img->stride * i;
+    int x = 0;
+    for(; x + 8 <= img->w; x += 8)
+    {
+      uint64_t word;
+      memcpy(&word, row + x, sizeof(word));
+      hash  = (hash ^ word) * 0x100000001b3ULL;
+      hash ^= hash >> 32;
+    }
+    for(; x < img->w; x++)
+      hash = (hash ^ row[x]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+CGlyphAtlas::CGlyphAtlas(int size)
+{
+  m_size       = size;
+  m_data       = (uint8_t*)calloc(m_size * m_size, 1);
+  m_generation = 0;
+  m_dirtyFirst = 0;
+  m_dirtyLast  = m_size - 1;
+}
+
+CGlyphAtlas::~CGlyphAtlas()
+{
+  free(m_data);
+}
+
+void CGlyphAtlas::Clear()
+{
+  memset(m_data, 0, m_size * m_size);
+  m_slots.clear();
+  m_shelves.clear();
+  m_generation++;
+  m_dirtyFirst = 0;
+  m_dirtyLast  = m_size - 1;
+}
+
+bool CGlyphAtlas::Place(ASS_Image* img, const SKey& key, SSlot& slot)
+{
+  // keep one empty pixel to the right and below so linear filtering
+  // does not bleed neighbours in, like convert_quad
+  int w = img->w + 1;
+  int h = img->h + 1;
+  if (w > m_size || h > m_size)
+    return false;
+
+  // tightest shelf that is at most a third taller than the glyph
+  SShelf* shelf = NULL;
+  for(std::vector<SShelf>::iterator it = m_shelves.begin(); it != m_shelves.end(); ++it)
+  {
+    if (it->height < h || it->height > h + h / 3 + 2 || it->x + w > m_size)
+      continue;
+    if (!shelf || it->height < shelf->height)
+      shelf = &*it;
+  }
+
+  if (!shelf)
+  {
+    int y = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+    if (y + h > m_size)
+      return false;
+    SShelf add = { y, h, 0 };
+    m_shelves.push_back(add);
+    shelf = &m_shelves.back();
+  }
+
+  slot.u = shelf->x;
+  slot.v = shelf->y;
+  shelf->x += w;
+
+  for(int i=0; i<img->h; i++)
+    memcpy(m_data      + m_size * (slot.v + i) + slot.u
+         , img->bitmap + img->stride * i
+         , img->w);
+
+  if (m_dirtyFirst > m_dirtyLast)
+  {
+    m_dirtyFirst = slot.v;
+    m_dirtyLast  = slot.v + img->h - 1;
+  }
+  else
+  {
+    m_dirtyFirst = std::min(m_dirtyFirst, slot.v);
+    m_dirtyLast  = std::max(m_dirtyLast, slot.v + img->h - 1);
+  }
+
+  m_slots[key] = slot;
+  return true;
+}
+
+bool CGlyphAtlas::Add(ASS_Image* images, SQuads& quads)
+{
+  ASS_Image* img;
+
+  quads.count = 0;
+  for(img = images; img; img = img->next)
+  {
+    if (is_visible(img))
+      quads.count++;
+  }
+
+  if (quads.count == 0)
+    return false;
+
+  quads.quad   = (SQuad*)calloc(quads.count, sizeof(SQuad));
+  quads.size_x = m_size;
+  quads.size_y = m_size;
+
+  // a second pass starts from an empty atlas with only this frame
+  for(int pass = 0; pass < 2; pass++)
+  {
+    SQuad* v = quads.quad;
+    bool fits = true;
+
+    for(img = images; img; img = img->next)
+    {
+      if (!is_visible(img))
+        continue;
+
+      SKey key = { hash_bitmap(img), img->w, img->h };
+      SSlot slot;
+      std::map<SKey, SSlot>::const_iterator it = m_slots.find(key);
+      if (it != m_slots.end())
+        slot = it->second;
+      else if (!Place(img, key, slot))
+      {
+        fits = false;
+        break;
+      }
+
+      unsigned int color = img->color;
+      v->a = 255 - (color & 0xff);
+      v->r = (color >> 24) & 0xff;
+      v->g = (color >> 16) & 0xff;
+      v->b = (color >> 8 ) & 0xff;
+
+      v->u = slot.u;
+      v->v = slot.v;
+
+      v->x = img->dst_x;
+      v->y = img->dst_y;
+
+      v->w = img->w;
+      v->h = img->h;
+
+      v++;
+    }
+
+    if (fits)
+      return true;
+
+    Clear();
+  }
+
+  return false;
+}
+
+bool CGlyphAtlas::GetDirtyRows(int& first, int& last)
+{
+  if (m_dirtyFirst > m_dirtyLast)
+    return false;
+
+  first = m_dirtyFirst;
+  last  = m_dirtyLast;
+  m_dirtyFirst = m_size;
+  m_dirtyLast  = -1;
+  return true;
+}
+
 int GetStereoscopicDepth()
 {
   int depth = 0;
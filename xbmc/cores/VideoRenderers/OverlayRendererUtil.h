@@ -21,6 +21,9 @@
 #pragma once
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
 
 class CDVDOverlayImage;
 class CDVDOverlaySpu;
@@ -59,6 +62,71 @@ namespace OVERLAY {
     SQuad*   quad;
   };
 
+  /*!
+   \brief Persistent alpha atlas of libass glyph bitmaps
+
+   Bitmaps are keyed on their size and content, so glyphs that stay on
+   screen from one frame to the next are packed once and keep their place.
+   New glyphs go on shelves of similar height and only the rows they touch
+   are marked dirty. When the atlas is full it is cleared and the frame
+   is packed again, which bumps the generation so users know to reload
+   the whole texture.
+   */
+  class CGlyphAtlas
+  {
+  public:
+    CGlyphAtlas(int size);
+   ~CGlyphAtlas();
+
+    /*!
+     \brief place the visible images of a frame, quads get atlas coordinates
+     \return false if nothing is visible or the frame does not fit
+     */
+    bool      Add(ASS_Image* images, SQuads& quads);
+    int       GetSize() const { return m_size; }
+    uint8_t*  GetData() const { return m_data; }
+    unsigned int GetGeneration() const { return m_generation; }
+    /*!
+     \brief rows written since the last call
+     \return false if nothing changed
+     */
+    bool      GetDirtyRows(int& first, int& last);
+
+  private:
+    struct SKey
+    {
+      uint64_t hash;
+      int      w, h;
+      bool operator<(const SKey& rhs) const
+      {
+        if (hash != rhs.hash) return hash < rhs.hash;
+        if (w != rhs.w)       return w < rhs.w;
+        return h < rhs.h;
+      }
+    };
+    struct SSlot
+    {
+      int u, v;
+    };
+    struct SShelf
+    {
+      int y;
+      int height;
+      int x;
+    };
+
+    void      Clear();
+    bool      Place(ASS_Image* img, const SKey& key, SSlot& slot);
+
+    int                    m_size;
+    uint8_t*               m_data;
+    unsigned int           m_generation;
+    int                    m_dirtyFirst;
+    int                    m_dirtyLast;
+    std::map<SKey, SSlot>  m_slots;
+    std::vector<SShelf>    m_shelves;
+  };
+
   uint32_t* convert_rgba(CDVDOverlayImage* o, bool mergealpha);
   uint32_t* convert_rgba(CDVDOverlaySpu*   o, bool mergealpha
                        , int& min_x, int& max_x
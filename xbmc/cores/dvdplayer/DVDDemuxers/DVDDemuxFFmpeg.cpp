@@ -625,6 +625,11 @@ void CDVDDemuxFFmpeg::Dispose()
   m_pFormatContext = NULL;
   m_speed = DVD_PLAYSPEED_NORMAL;
 
+  CDVDDemuxUtils::PacketStatistics stats;
+  CDVDDemuxUtils::GetPacketStatistics(stats);
+  CLog::Log(LOGDEBUG, "CDVDDemuxFFmpeg::Dispose - packets referenced: %" PRIu64 " (%" PRIu64 " bytes), copied: %" PRIu64 " (%" PRIu64 " bytes), pool hits: %" PRIu64 ", misses: %" PRIu64,
+    stats.packetsReferenced, stats.bytesReferenced, stats.packetsCopied, stats.bytesCopied, stats.poolHits, stats.poolMisses);
+
   DisposeStreams();
 
   m_pInput = NULL;
@@ -845,7 +850,7 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
           {
             if(m_pkt.pkt.stream_index == (int)m_pFormatContext->programs[m_program]->stream_index[i])
             {
-              pPacket = CDVDDemuxUtils::AllocateDemuxPacket(m_pkt.pkt.size);
+              pPacket = CDVDDemuxUtils::AllocateDemuxPacket(&m_pkt.pkt);
               break;
             }
           }
@@ -854,7 +859,7 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
             bReturnEmpty = true;
         }
         else
-          pPacket = CDVDDemuxUtils::AllocateDemuxPacket(m_pkt.pkt.size);
+          pPacket = CDVDDemuxUtils::AllocateDemuxPacket(&m_pkt.pkt);
       }
       else
         bReturnEmpty = true;
@@ -917,13 +922,6 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
               *dst++ = *src++;
             }
           }
-          else
-          {
-            // copy contents into our own packet
-            pPacket->iSize = m_pkt.pkt.size;
-            // maybe we can avoid a memcpy here by detecting where pkt.destruct is pointing too?
-            memcpy(pPacket->pData, m_pkt.pkt.data, pPacket->iSize);
-          }
         }
 
 
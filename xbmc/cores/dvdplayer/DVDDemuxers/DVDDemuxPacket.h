@@ -23,6 +23,8 @@
 #define DMX_SPECIALID_STREAMINFO    -10
 #define DMX_SPECIALID_STREAMCHANGE  -11
 
+struct AVBufferRef;
+
  typedef struct DemuxPacket
 {
   unsigned char* pData;   // data
@@ -34,4 +36,7 @@
   double dts; // dts in DVD_TIME_BASE
   double duration; // duration in DVD_TIME_BASE if available
   int interlaced;  // is packet interlaced
+
+  AVBufferRef* pBuffer; // if set, pData points into this shared buffer instead of an owned allocation
+  int iAllocSize;       // capacity of an owned pData allocation, excluding padding
 } DemuxPacket;
@@ -23,20 +23,165 @@
 #endif
 #include "DVDDemuxUtils.h"
 #include "DVDClock.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 
+#include <vector>
+
 extern "C" {
 #include "libavcodec/avcodec.h"
 }
 
+// payload buffers are pooled in power of two size classes between
+// 2^POOL_MIN_SHIFT and 2^POOL_MAX_SHIFT bytes, larger ones are not kept
+#define POOL_MIN_SHIFT    8
+#define POOL_MAX_SHIFT   22
+#define POOL_CLASSES     (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define POOL_MAX_BUFFERS 16
+#define POOL_MAX_HEADERS 256
+
+namespace
+{
+  class CDemuxPacketPool
+  {
+  public:
+    CDemuxPacketPool()
+    {
+      memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    ~CDemuxPacketPool()
+    {
+      for (std::vector<DemuxPacket*>::iterator it = m_headers.begin(); it != m_headers.end(); ++it)
+        delete *it;
+      for (int i = 0; i < POOL_CLASSES; i++)
+      {
+        for (std::vector<uint8_t*>::iterator it = m_buffers[i].begin(); it != m_buffers[i].end(); ++it)
+          _aligned_free(*it);
+      }
+    }
+
+    DemuxPacket* GetHeader()
+    {
+      {
+        CSingleLock lock(m_section);
+        if (!m_headers.empty())
+        {
+          DemuxPacket* pPacket = m_headers.back();
+          m_headers.pop_back();
+          return pPacket;
+        }
+      }
+      return new DemuxPacket;
+    }
+
+    void ReleaseHeader(DemuxPacket* pPacket)
+    {
+      {
+        CSingleLock lock(m_section);
+        if (m_headers.size() < POOL_MAX_HEADERS)
+        {
+          m_headers.push_back(pPacket);
+          return;
+        }
+      }
+      delete pPacket;
+    }
+
+    // returns a buffer of at least size bytes plus padding, size is
+    // updated to the usable capacity of the buffer
+    uint8_t* GetBuffer(int& size)
+    {
+      int cls = GetClass(size);
+      if (cls < 0)
+      {
+        CSingleLock lock(m_section);
+        m_stats.poolMisses++;
+        lock.Leave();
+        return (uint8_t*)_aligned_malloc(size + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+      }
+
+      size = 1 << (cls + POOL_MIN_SHIFT);
+      {
+        CSingleLock lock(m_section);
+        if (!m_buffers[cls].empty())
+        {
+          uint8_t* buffer = m_buffers[cls].back();
+          m_buffers[cls].pop_back();
+          m_stats.poolHits++;
+          return buffer;
+        }
+        m_stats.poolMisses++;
+      }
+      return (uint8_t*)_aligned_malloc(size + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+    }
+
+    void ReleaseBuffer(uint8_t* buffer, int size)
+    {
+      int cls = GetClass(size);
+      if (cls >= 0 && size == 1 << (cls + POOL_MIN_SHIFT))
+      {
+        CSingleLock lock(m_section);
+        if (m_buffers[cls].size() < POOL_MAX_BUFFERS)
+        {
+          m_buffers[cls].push_back(buffer);
+          return;
+        }
+      }
+      _aligned_free(buffer);
+    }
+
+    void AddCopied(int size)
+    {
+      CSingleLock lock(m_section);
+      m_stats.bytesCopied += size;
+      m_stats.packetsCopied++;
+    }
+
+    void AddReferenced(int size)
+    {
+      CSingleLock lock(m_section);
+      m_stats.bytesReferenced += size;
+      m_stats.packetsReferenced++;
+    }
+
+    void GetStatistics(CDVDDemuxUtils::PacketStatistics& stats)
+    {
+      CSingleLock lock(m_section);
+      stats = m_stats;
+    }
+
+  private:
+    static int GetClass(int size)
+    {
+      int shift = POOL_MIN_SHIFT;
+      while (shift <= POOL_MAX_SHIFT && (1 << shift) < size)
+        shift++;
+      if (shift > POOL_MAX_SHIFT)
+        return -1;
+      return shift - POOL_MIN_SHIFT;
+    }
+
+    CCriticalSection m_section;
+    std::vector<DemuxPacket*> m_headers;
+    std::vector<uint8_t*> m_buffers[POOL_CLASSES];
+    CDVDDemuxUtils::PacketStatistics m_stats;
+  };
+
+  CDemuxPacketPool g_packetPool;
+}
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData)
-        _aligned_free(pPacket->pData);
-      SAFE_DELETE(pPacket);
+      if (pPacket->pBuffer)
+        av_buffer_unref(&pPacket->pBuffer);
+      else if (pPacket->pData)
+        g_packetPool.ReleaseBuffer(pPacket->pData, pPacket->iAllocSize);
+      g_packetPool.ReleaseHeader(pPacket);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -46,7 +191,7 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
+  DemuxPacket* pPacket = g_packetPool.GetHeader();
   if (!pPacket)
     return NULL;
 
@@ -65,7 +210,8 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
         * Note, if the first 23 bits of the additional bytes are not 0 then damaged
         * MPEG bitstreams could cause overread and segfault
         */
-      pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+      pPacket->iAllocSize = iDataSize;
+      pPacket->pData = g_packetPool.GetBuffer(pPacket->iAllocSize);
       if (!pPacket->pData)
       {
         FreeDemuxPacket(pPacket);
@@ -89,3 +235,41 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
   }
   return pPacket;
 }
+
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket* pkt)
+{
+  // share the payload when it lives inside a reference counted buffer
+  // that also holds the input padding decoders are allowed to read
+  if (pkt->data && pkt->size > 0 && pkt->buf &&
+      pkt->data >= pkt->buf->data &&
+      pkt->data + pkt->size + FF_INPUT_BUFFER_PADDING_SIZE <= pkt->buf->data + pkt->buf->size)
+  {
+    DemuxPacket* pPacket = AllocateDemuxPacket(0);
+    if (!pPacket)
+      return NULL;
+
+    pPacket->pBuffer = av_buffer_ref(pkt->buf);
+    if (pPacket->pBuffer)
+    {
+      pPacket->pData = pkt->data;
+      pPacket->iSize = pkt->size;
+      g_packetPool.AddReferenced(pkt->size);
+      return pPacket;
+    }
+    FreeDemuxPacket(pPacket);
+  }
+
+  DemuxPacket* pPacket = AllocateDemuxPacket(pkt->data ? pkt->size : 0);
+  if (pPacket && pPacket->pData)
+  {
+    memcpy(pPacket->pData, pkt->data, pkt->size);
+    pPacket->iSize = pkt->size;
+    g_packetPool.AddCopied(pkt->size);
+  }
+  return pPacket;
+}
+
+void CDVDDemuxUtils::GetPacketStatistics(PacketStatistics& stats)
+{
+  g_packetPool.GetStatistics(stats);
+}
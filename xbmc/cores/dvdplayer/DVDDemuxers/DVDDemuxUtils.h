@@ -20,12 +20,30 @@
  *
  */
 
+#include <stdint.h>
 #include "DVDDemuxPacket.h"
 
+struct AVPacket;
+
 class CDVDDemuxUtils
 {
 public:
+  struct PacketStatistics
+  {
+    uint64_t bytesCopied;        // payload bytes memcpy'd out of demuxer packets
+    uint64_t bytesReferenced;    // payload bytes shared with the demuxer through a buffer reference
+    uint64_t packetsCopied;
+    uint64_t packetsReferenced;
+    uint64_t poolHits;           // allocations served from the packet pool
+    uint64_t poolMisses;
+  };
+
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+  /*! \brief Allocate a packet carrying the payload of an ffmpeg packet.
+   The payload is referenced when the packet is reference counted and
+   padded, otherwise it is copied into a pooled buffer. */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket* pkt);
+  static void GetPacketStatistics(PacketStatistics& stats);
 };
 
@@ -21,16 +21,46 @@
 #include "DVDInputStreamFile.h"
 #include "filesystem/File.h"
 #include "filesystem/IFile.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 #include "utils/URIUtils.h"
 
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+// the file is mapped in windows so large files also work with a 32 bit
+// address space. both sizes are multiples of any page size in use
+#define MAP_WINDOW_SIZE    (64 * 1024 * 1024)
+#define MAP_READAHEAD_MIN  ( 4 * 1024 * 1024)
+#define MAP_READAHEAD_MAX  (32 * 1024 * 1024)
+
 using namespace XFILE;
 
 CDVDInputStreamFile::CDVDInputStreamFile(const CFileItem& fileitem) : CDVDInputStream(DVDSTREAM_TYPE_FILE, fileitem)
 {
   m_pFile = NULL;
   m_eof = true;
+
+  m_mapFd = -1;
+  m_mapData = NULL;
+  m_mapOffset = 0;
+  m_mapLength = 0;
+  m_mapFileSize = 0;
+  m_mapPosition = 0;
+  m_mapAdvised = 0;
+  m_mapReadAhead = MAP_READAHEAD_MIN;
+
+  m_readBytes = 0;
+  m_readTime = 0;
 }
 
 CDVDInputStreamFile::~CDVDInputStreamFile()
@@ -40,7 +70,7 @@ CDVDInputStreamFile::~CDVDInputStreamFile()
 
 bool CDVDInputStreamFile::IsEOF()
 {
-  return !m_pFile || m_eof;
+  return (!m_pFile && m_mapFd < 0) || m_eof;
 }
 
 bool CDVDInputStreamFile::Open()
@@ -98,6 +128,18 @@ bool CDVDInputStreamFile::Open()
   if (m_forceNoCache)
     flags |= READ_NO_CACHE;
 
+  m_readBytes = 0;
+  m_readTime = 0;
+
+  // uncached local audio/video can skip CFile and read straight from the page cache
+  if (g_advancedSettings.m_videoMemoryMapLocalFiles && !(flags & READ_CACHED) &&
+      !m_item.IsSubtitle() && OpenMapped(m_item.GetPath()))
+  {
+    SAFE_DELETE(m_pFile);
+    m_eof = false;
+    return true;
+  }
+
   // open file in binary mode
   if (!m_pFile->Open(m_item.GetPath(), flags))
   {
@@ -115,6 +157,17 @@ bool CDVDInputStreamFile::Open()
 // close file and reset everyting
 void CDVDInputStreamFile::Close()
 {
+  if (m_readBytes > 0)
+  {
+    double seconds = (double)m_readTime / CurrentHostFrequency();
+    CLog::Log(LOGDEBUG, "CDVDInputStreamFile::Close - read %" PRId64" bytes in %.3f s (%.1f MB/s) through %s",
+      m_readBytes, seconds, seconds > 0.0 ? m_readBytes / seconds / (1024 * 1024) : 0.0, m_mapFd >= 0 ? "mmap" : "CFile");
+    m_readBytes = 0;
+    m_readTime = 0;
+  }
+
+  CloseMapped();
+
   if (m_pFile)
   {
     m_pFile->Close();
@@ -127,9 +180,50 @@ void CDVDInputStreamFile::Close()
 
 int CDVDInputStreamFile::Read(uint8_t* buf, int buf_size)
 {
+  if (m_mapFd >= 0)
+  {
+    int64_t start = CurrentHostCounter();
+    int total = 0;
+
+    // the file may have grown since it was opened, or since the last read
+    // that got to its end, if it is still being written to
+    if (m_mapPosition + buf_size > m_mapFileSize)
+      UpdateMappedSize();
+
+    while (total < buf_size && m_mapPosition < m_mapFileSize)
+    {
+      if (!MapWindow(m_mapPosition))
+        return total > 0 ? total : -1;
+
+      int64_t offset = m_mapPosition - m_mapOffset;
+      int size = (int)std::min((int64_t)(buf_size - total), m_mapLength - offset);
+      memcpy(buf + total, m_mapData + offset, size);
+      total += size;
+      m_mapPosition += size;
+    }
+
+    if (total == 0)
+    {
+      m_eof = true;
+      return 0;
+    }
+
+    AdviseReadAhead();
+    m_stats.AddSampleBytes(total);
+    m_readBytes += total;
+    m_readTime += CurrentHostCounter() - start;
+    return total;
+  }
+
   if(!m_pFile) return -1;
 
+  int64_t start = CurrentHostCounter();
   ssize_t ret = m_pFile->Read(buf, buf_size);
+  if (ret > 0)
+  {
+    m_readBytes += ret;
+    m_readTime += CurrentHostCounter() - start;
+  }
 
   if (ret < 0)
     return -1; // player will retry read in case of error until playback is stopped
@@ -143,6 +237,35 @@ int CDVDInputStreamFile::Read(uint8_t* buf, int buf_size)
 
 int64_t CDVDInputStreamFile::Seek(int64_t offset, int whence)
 {
+  if (m_mapFd >= 0)
+  {
+    int64_t position;
+    if (whence == SEEK_POSSIBLE)
+      return 1;
+    else if (whence == SEEK_SET)
+      position = offset;
+    else if (whence == SEEK_CUR)
+      position = m_mapPosition + offset;
+    else if (whence == SEEK_END)
+    {
+      UpdateMappedSize();
+      position = m_mapFileSize + offset;
+    }
+    else
+      return -1;
+
+    if (position < 0)
+      return -1;
+
+    // read-ahead starts over unless this skips forward into what is already requested
+    if (position < m_mapPosition || position > m_mapAdvised)
+      m_mapAdvised = position;
+
+    m_mapPosition = position;
+    m_eof = false;
+    return m_mapPosition;
+  }
+
   if(!m_pFile) return -1;
 
   if(whence == SEEK_POSSIBLE)
@@ -158,6 +281,8 @@ int64_t CDVDInputStreamFile::Seek(int64_t offset, int whence)
 
 int64_t CDVDInputStreamFile::GetLength()
 {
+  if (m_mapFd >= 0)
+    return m_mapFileSize;
   if (m_pFile)
     return m_pFile->GetLength();
   return 0;
@@ -192,9 +317,152 @@ int CDVDInputStreamFile::GetBlockSize()
 
 void CDVDInputStreamFile::SetReadRate(unsigned rate)
 {
+  if (m_mapFd >= 0)
+  {
+    // keep about ten seconds of the stream requested ahead of the demuxer
+    m_mapReadAhead = std::max((int64_t)MAP_READAHEAD_MIN, std::min((int64_t)MAP_READAHEAD_MAX, (int64_t)rate * 10));
+    CLog::Log(LOGDEBUG, "CDVDInputStreamFile::SetReadRate - set mmap read-ahead to %" PRId64" bytes", m_mapReadAhead);
+    return;
+  }
+
+  // only the player sets a read rate, so this is the cache it shows the state of
+  bool publish = true;
+  if (m_pFile)
+    m_pFile->IoControl(IOCTRL_CACHE_PUBLISH, &publish);
+
   // Increase requested rate by 10%:
   unsigned maxrate = (unsigned) (1.1 * rate);
 
-  if(m_pFile->IoControl(IOCTRL_CACHE_SETRATE, &maxrate) >= 0)
+  if(m_pFile && m_pFile->IoControl(IOCTRL_CACHE_SETRATE, &maxrate) >= 0)
     CLog::Log(LOGDEBUG, "CDVDInputStreamFile::SetReadRate - set cache throttle rate to %u bytes per second", maxrate);
 }
+
+bool CDVDInputStreamFile::OpenMapped(const std::string &path)
+{
+#if defined(TARGET_POSIX)
+  std::string file = CSpecialProtocol::TranslatePath(path);
+  if (!CURL(file).GetProtocol().empty())
+    return false;
+
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  m_mapFd = fd;
+  m_mapFileSize = st.st_size;
+  m_mapPosition = 0;
+  m_mapAdvised = 0;
+  m_mapReadAhead = MAP_READAHEAD_MIN;
+
+  if (!MapWindow(0))
+  {
+    CloseMapped();
+    return false;
+  }
+
+  m_stats.Start();
+  CLog::Log(LOGDEBUG, "CDVDInputStreamFile::OpenMapped - mapped %s (%" PRId64" bytes)", file.c_str(), m_mapFileSize);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CDVDInputStreamFile::CloseMapped()
+{
+#if defined(TARGET_POSIX)
+  if (m_mapData)
+    munmap(m_mapData, m_mapLength);
+  if (m_mapFd >= 0)
+    close(m_mapFd);
+#endif
+  m_mapData = NULL;
+  m_mapFd = -1;
+  m_mapOffset = 0;
+  m_mapLength = 0;
+  m_mapFileSize = 0;
+  m_mapPosition = 0;
+  m_mapAdvised = 0;
+}
+
+bool CDVDInputStreamFile::MapWindow(int64_t offset)
+{
+#if defined(TARGET_POSIX)
+  if (m_mapData && offset >= m_mapOffset && offset < m_mapOffset + m_mapLength)
+    return true;
+
+  if (m_mapData)
+    munmap(m_mapData, m_mapLength);
+
+  m_mapOffset = offset - offset % MAP_WINDOW_SIZE;
+  m_mapLength = std::min((int64_t)MAP_WINDOW_SIZE, m_mapFileSize - m_mapOffset);
+
+  void *data = mmap(NULL, m_mapLength, PROT_READ, MAP_SHARED, m_mapFd, m_mapOffset);
+  if (data == MAP_FAILED)
+  {
+    CLog::Log(LOGERROR, "CDVDInputStreamFile::MapWindow - failed to map %" PRId64" bytes at %" PRId64", errno %d", m_mapLength, m_mapOffset, errno);
+    m_mapData = NULL;
+    m_mapLength = 0;
+    return false;
+  }
+
+  m_mapData = (uint8_t*)data;
+  madvise(m_mapData, m_mapLength, MADV_SEQUENTIAL);
+  if (m_mapAdvised < m_mapOffset)
+    m_mapAdvised = m_mapOffset;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CDVDInputStreamFile::UpdateMappedSize()
+{
+#if defined(TARGET_POSIX)
+  struct stat st;
+  if (fstat(m_mapFd, &st) != 0 || st.st_size == m_mapFileSize)
+    return;
+
+  CLog::Log(LOGDEBUG, "CDVDInputStreamFile::UpdateMappedSize - size changed from %" PRId64" to %" PRId64" bytes", m_mapFileSize, (int64_t)st.st_size);
+
+  // a window cut short by the old size can be longer now, and one that
+  // reaches past the new size would fault. MapWindow maps it again
+  if (m_mapData && (m_mapLength < MAP_WINDOW_SIZE || m_mapOffset + m_mapLength > st.st_size))
+  {
+    munmap(m_mapData, m_mapLength);
+    m_mapData = NULL;
+    m_mapLength = 0;
+  }
+  m_mapFileSize = st.st_size;
+#endif
+}
+
+void CDVDInputStreamFile::AdviseReadAhead()
+{
+#if defined(TARGET_POSIX)
+  if (!m_mapData)
+    return;
+
+  // hint again once half of the previous request has been consumed
+  if (m_mapAdvised - m_mapPosition >= m_mapReadAhead / 2)
+    return;
+
+  int64_t end = std::min(m_mapPosition + m_mapReadAhead, m_mapOffset + m_mapLength);
+  int64_t start = std::max(m_mapAdvised, m_mapPosition);
+  if (start >= end)
+    return;
+
+  static const int64_t pagesize = sysconf(_SC_PAGESIZE);
+  start -= (start - m_mapOffset) % pagesize;
+
+  madvise(m_mapData + (start - m_mapOffset), end - start, MADV_WILLNEED);
+  m_mapAdvised = end;
+#endif
+}
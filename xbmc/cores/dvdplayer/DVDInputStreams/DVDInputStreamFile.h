@@ -40,6 +40,26 @@ public:
   virtual bool GetCacheStatus(XFILE::SCacheStatus *status);
 
 protected:
+  // local files can be read from a memory mapped window instead of CFile,
+  // with the kernel read-ahead hinted from the demuxer's read position
+  bool OpenMapped(const std::string &path);
+  void CloseMapped();
+  bool MapWindow(int64_t offset);
+  void UpdateMappedSize();
+  void AdviseReadAhead();
+
   XFILE::CFile* m_pFile;
   bool m_eof;
+
+  int      m_mapFd;
+  uint8_t* m_mapData;     // current window
+  int64_t  m_mapOffset;   // file offset of the window
+  int64_t  m_mapLength;
+  int64_t  m_mapFileSize;
+  int64_t  m_mapPosition;
+  int64_t  m_mapAdvised;  // read-ahead has been requested up to this offset
+  int64_t  m_mapReadAhead;
+
+  int64_t  m_readBytes;   // per open, logged on close to compare both paths
+  int64_t  m_readTime;
 };
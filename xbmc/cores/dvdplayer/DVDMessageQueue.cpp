@@ -25,11 +25,80 @@
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
+#define RING_INITIAL_SIZE 256
+
+CDVDMessageRing::CDVDMessageRing()
+  : m_slots(RING_INITIAL_SIZE, NULL)
+  , m_mask(RING_INITIAL_SIZE - 1)
+  , m_tail(0)
+  , m_count(0)
+{
+}
+
+CDVDMessageRing::~CDVDMessageRing()
+{
+  remove(CDVDMsg::NONE);
+}
+
+void CDVDMessageRing::push_front(CDVDMsg* msg)
+{
+  if (m_count == m_slots.size())
+    grow();
+  m_slots[(m_tail + m_count) & m_mask] = msg;
+  m_count++;
+}
+
+void CDVDMessageRing::push_back(CDVDMsg* msg)
+{
+  if (m_count == m_slots.size())
+    grow();
+  m_tail = (m_tail - 1) & m_mask;
+  m_slots[m_tail] = msg;
+  m_count++;
+}
+
+CDVDMsg* CDVDMessageRing::pop_back()
+{
+  CDVDMsg* msg = m_slots[m_tail];
+  m_slots[m_tail] = NULL;
+  m_tail = (m_tail + 1) & m_mask;
+  m_count--;
+  return msg;
+}
+
+void CDVDMessageRing::remove(CDVDMsg::Message type)
+{
+  // compact the kept messages towards the oldest end, preserving order
+  size_t kept = 0;
+  for (size_t i = 0; i < m_count; i++)
+  {
+    CDVDMsg*& slot = m_slots[(m_tail + i) & m_mask];
+    CDVDMsg* msg = slot;
+    slot = NULL;
+    if (type == CDVDMsg::NONE || msg->IsType(type))
+      msg->Release();
+    else
+      m_slots[(m_tail + kept++) & m_mask] = msg;
+  }
+  m_count = kept;
+}
+
+void CDVDMessageRing::grow()
+{
+  std::vector<CDVDMsg*> slots(m_slots.size() * 2, NULL);
+  for (size_t i = 0; i < m_count; i++)
+    slots[i] = at(i);
+  m_slots.swap(slots);
+  m_mask = m_slots.size() - 1;
+  m_tail = 0;
+}
+
 CDVDMessageQueue::CDVDMessageQueue(const std::string &owner) : m_hEvent(true), m_owner(owner)
 {
   m_iDataSize     = 0;
   m_bAbortRequest = false;
   m_bInitialized = false;
+  m_iWaiting = 0;
 
   m_TimeBack = DVD_NOPTS_VALUE;
   m_TimeFront = DVD_NOPTS_VALUE;
@@ -56,9 +125,7 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
   CSingleLock lock(m_section);
 
-  m_messages.remove_if([type](const DVDMessageListItem &item){
-    return type == CDVDMsg::NONE || item.message->IsType(type);
-  });
+  m_messages.remove(type);
 
   m_prioMessages.remove_if([type](const DVDMessageListItem &item){
     return type == CDVDMsg::NONE || item.message->IsType(type);
@@ -131,9 +198,9 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
     }
 
     if (front)
-      m_messages.emplace_front(pMsg, priority);
+      m_messages.push_front(pMsg->Acquire());
     else
-      m_messages.emplace_back(pMsg, priority);
+      m_messages.push_back(pMsg->Acquire());
   }
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
@@ -154,8 +221,10 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
 
   pMsg->Release();
 
-  // inform waiter for new packet
-  m_hEvent.Set();
+  // inform waiter for new packet, the event is only touched when
+  // a reader is actually blocked in Get
+  if (m_iWaiting)
+    m_hEvent.Set();
 
   return MSGQ_OK;
 }
@@ -176,16 +245,22 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    std::list<DVDMessageListItem> &msgs = (priority > 0 || !m_prioMessages.empty()) ? m_prioMessages : m_messages;
-
-    if (!msgs.empty() && msgs.back().priority >= priority)
+    if (priority > 0 || !m_prioMessages.empty())
     {
-      DVDMessageListItem& item(msgs.back());
-      priority = item.priority;
-
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
+      if (!m_prioMessages.empty() && m_prioMessages.back().priority >= priority)
       {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
+        DVDMessageListItem& item(m_prioMessages.back());
+        priority = item.priority;
+        *pMsg = item.message->Acquire();
+        m_prioMessages.pop_back();
+      }
+    }
+    else if (!m_messages.empty())
+    {
+      CDVDMsg* msg = m_messages.pop_back();
+      if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
+      {
+        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
         if (packet)
         {
           m_iDataSize -= packet->iSize;
@@ -195,10 +270,12 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
             m_TimeBack = packet->pts;
         }
       }
+      // the ring's reference is handed over to the caller
+      *pMsg = msg;
+    }
 
-      *pMsg = item.message->Acquire();
-      msgs.pop_back();
-
+    if (*pMsg)
+    {
       ret = MSGQ_OK;
       break;
     }
@@ -209,14 +286,17 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     }
     else
     {
+      m_iWaiting++;
       m_hEvent.Reset();
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
 
       lock.Enter();
+      m_iWaiting--;
+      if (!signaled)
+        return MSGQ_TIMEOUT;
     }
   }
 
@@ -234,9 +314,9 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
     return 0;
 
   unsigned count = 0;
-  for (const auto &item : m_messages)
+  for (size_t i = 0; i < m_messages.size(); i++)
   {
-    if(item.message->IsType(type))
+    if(m_messages.at(i)->IsType(type))
       count++;
   }
   for (const auto &item : m_prioMessages)
@@ -23,6 +23,7 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include <vector>
 #include <algorithm>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
@@ -52,6 +53,46 @@ struct DVDMessageListItem
   int priority;
 };
 
+/*!
+ \brief Growable circular buffer holding the non prioritised messages.
+ Like the list it replaces, front is the newest and back the oldest entry.
+ Slots are reused, so steady state queueing does not allocate.
+ */
+class CDVDMessageRing
+{
+public:
+  CDVDMessageRing();
+  ~CDVDMessageRing();
+
+  bool empty() const { return m_count == 0; }
+  size_t size() const { return m_count; }
+
+  // ownership of the message reference moves into the ring
+  void push_front(CDVDMsg* msg);
+  void push_back(CDVDMsg* msg);
+
+  CDVDMsg* back() const { return m_slots[m_tail]; }
+  // releases ownership of the oldest message to the caller
+  CDVDMsg* pop_back();
+
+  // i = 0 is the oldest entry
+  CDVDMsg* at(size_t i) const { return m_slots[(m_tail + i) & m_mask]; }
+
+  // release and remove the messages of a type, CDVDMsg::NONE removes all
+  void remove(CDVDMsg::Message type);
+
+private:
+  CDVDMessageRing(const CDVDMessageRing&) = delete;
+  CDVDMessageRing& operator=(const CDVDMessageRing&) = delete;
+
+  void grow();
+
+  std::vector<CDVDMsg*> m_slots;
+  size_t m_mask;
+  size_t m_tail;  // index of the oldest entry
+  size_t m_count;
+};
+
 enum MsgQueueReturnCode
 {
   MSGQ_OK = 1,
@@ -113,6 +154,7 @@ private:
 
   bool m_bAbortRequest;
   bool m_bInitialized;
+  int m_iWaiting;
 
   int m_iDataSize;
   double m_TimeFront;
@@ -122,6 +164,6 @@ private:
   int m_iMaxDataSize;
   std::string m_owner;
 
-  std::list<DVDMessageListItem> m_messages;
+  CDVDMessageRing m_messages;
   std::list<DVDMessageListItem> m_prioMessages;
 };
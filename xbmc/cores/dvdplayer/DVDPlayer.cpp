@@ -3144,6 +3144,15 @@ void CDVDPlayer::GetGeneralInfo(std::string& strGeneralInfo)
                                     , m_State.cache_level * 100);
       if(m_playSpeed == 0 || m_caching == CACHESTATE_WAITFILL)
         strBuf += StringUtils::Format(" %d sec", DVD_TIME_TO_SEC(m_State.cache_delay));
+
+      SFileCacheInfo info = g_dataCacheCore.GetFileCacheInfo();
+      if (info.valid)
+        strBuf += StringUtils::Format(" win:%s/%s mem:%s disk:%s link:%s/s"
+                                      , StringUtils::SizeToString(info.forwardSize).c_str()
+                                      , StringUtils::SizeToString(info.backSize).c_str()
+                                      , StringUtils::SizeToString(info.memory).c_str()
+                                      , StringUtils::SizeToString(info.spilled).c_str()
+                                      , StringUtils::SizeToString(info.linkRate).c_str());
     }
 
     strGeneralInfo = StringUtils::Format("C(a/v:% 6.3f%s, ad:% 6.3f, %s)"
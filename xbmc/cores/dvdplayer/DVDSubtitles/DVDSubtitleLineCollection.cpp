@@ -20,14 +20,16 @@
 
 #include "DVDSubtitleLineCollection.h"
 
+#include <algorithm>
 
-CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
+static bool CompareStartTime(const CDVDOverlay* lhs, const CDVDOverlay* rhs)
 {
-  m_pHead = NULL;
-  m_pCurrent = NULL;
-  m_pTail = NULL;
+  return lhs->iPTSStartTime < rhs->iPTSStartTime;
+}
 
-  m_iSize = 0;
+CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
+{
+  m_current = 0;
 }
 
 CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
@@ -37,85 +39,69 @@ CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 
 void CDVDSubtitleLineCollection::Add(CDVDOverlay* pOverlay)
 {
-  ListElement* pElement = new ListElement;
-  pElement->pOverlay = pOverlay;
-  pElement->pNext = NULL;
-
-  if (!m_pHead)
-  {
-    m_pHead = m_pTail = pElement;
-    m_pCurrent = m_pHead;
-  }
-  else
-  {
-    m_pTail->pNext = pElement;
-    m_pTail = pElement;
-  }
-
-  m_iSize++;
+  m_overlays.push_back(pOverlay);
+  // the index is rebuilt on the next Get
+  m_maxStopTime.clear();
 }
 
 void CDVDSubtitleLineCollection::Sort()
 {
-  if (!m_pHead || !m_pHead->pNext)
-    return;
-  
-  for (ListElement* p1 = m_pHead; p1->pNext != NULL; p1 = p1->pNext)
+  std::stable_sort(m_overlays.begin(), m_overlays.end(), CompareStartTime);
+  m_maxStopTime.clear();
+}
+
+void CDVDSubtitleLineCollection::Index()
+{
+  m_maxStopTime.resize(m_overlays.size());
+
+  double maxStopTime = 0.0;
+  for (size_t i = 0; i < m_overlays.size(); i++)
   {
-    for (ListElement* p2 = p1->pNext; p2 != NULL; p2 = p2->pNext)
-    {
-      if (p1->pOverlay->iPTSStartTime > p2->pOverlay->iPTSStartTime)
-      {
-        CDVDOverlay* temp = p1->pOverlay;
-        p1->pOverlay = p2->pOverlay;
-        p2->pOverlay = temp;
-      }
-    }
+    if (i == 0 || m_overlays[i]->iPTSStopTime > maxStopTime)
+      maxStopTime = m_overlays[i]->iPTSStopTime;
+    m_maxStopTime[i] = maxStopTime;
   }
 }
 
 CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
 {
-  CDVDOverlay* pOverlay = NULL;
+  if (m_maxStopTime.size() != m_overlays.size())
+    Index();
 
-  if (m_pCurrent)
+  if (m_current >= m_overlays.size())
+    return NULL;
+
+  // every overlay before the first one whose running max stop time reaches
+  // iPts has stopped, and that one has not. if the cursor is behind it, jump
+  if (m_overlays[m_current]->iPTSStopTime < iPts)
   {
-    while (m_pCurrent && m_pCurrent->pOverlay->iPTSStopTime < iPts)
-    {
-      m_pCurrent = m_pCurrent->pNext;
-    }
-
-    if (m_pCurrent)
-    {
-      pOverlay = m_pCurrent->pOverlay;
-
-      // advance to the next overlay
-      m_pCurrent = m_pCurrent->pNext;
-    }
+    size_t first = std::lower_bound(m_maxStopTime.begin(), m_maxStopTime.end(), iPts) - m_maxStopTime.begin();
+    if (first > m_current)
+      m_current = first;
+
+    // overlapping overlays with an earlier stop may still follow the cursor
+    while (m_current < m_overlays.size() && m_overlays[m_current]->iPTSStopTime < iPts)
+      m_current++;
+
+    if (m_current >= m_overlays.size())
+      return NULL;
   }
-  return pOverlay;
+
+  // advance to the next overlay
+  return m_overlays[m_current++];
 }
 
 void CDVDSubtitleLineCollection::Reset()
 {
-  m_pCurrent = m_pHead;
+  m_current = 0;
 }
 
 void CDVDSubtitleLineCollection::Clear()
 {
-  ListElement* pElement = NULL;
-
-  while (m_pHead)
-  {
-    pElement = m_pHead;
-    m_pHead = pElement->pNext;
-
-    pElement->pOverlay->Release();
-    delete pElement;
-  }
+  for (std::vector<CDVDOverlay*>::iterator it = m_overlays.begin(); it != m_overlays.end(); ++it)
+    (*it)->Release();
 
-  m_pTail    = NULL;
-  m_pHead    = NULL;
-  m_pCurrent = NULL;
-  m_iSize    = 0;
+  m_overlays.clear();
+  m_maxStopTime.clear();
+  m_current = 0;
 }
@@ -22,22 +22,23 @@
 
 #include "../DVDCodecs/Overlay/DVDOverlay.h"
 
-typedef struct stListElement
-{
-  CDVDOverlay* pOverlay;
-  struct stListElement* pNext;
+#include <vector>
 
-} ListElement;
+/*!
+ \brief Overlays of a subtitle file ordered by start time
 
+ Get walks forward from a cursor. Besides the overlays, the collection keeps
+ the running maximum of their stop times, which never decreases, so the first
+ overlay still showing at a pts is found by binary search. Seeking in either
+ direction, or restarting after Reset, costs O(log n) instead of a walk from
+ the start of the file.
+ */
 class CDVDSubtitleLineCollection
 {
 public:
   CDVDSubtitleLineCollection();
   virtual ~CDVDSubtitleLineCollection();
 
-  //void Lock()   { EnterCriticalSection(&m_critSection); }
-  //void Unlock() { LeaveCriticalSection(&m_critSection); }
-
   void Add(CDVDOverlay* pSubtitle);
   void Sort();
 
@@ -45,16 +46,13 @@ public:
 
   void Reset();
 
-  void Remove();
   void Clear();
-  int GetSize() { return m_iSize; }
+  int GetSize() { return (int)m_overlays.size(); }
 
 private:
-  ListElement* m_pHead;
-  ListElement* m_pCurrent;
-  ListElement* m_pTail;
+  void Index();
 
-  int m_iSize;
-  //CRITICAL_SECTION m_critSection;
+  std::vector<CDVDOverlay*> m_overlays;
+  std::vector<double>       m_maxStopTime; // max iPTSStopTime of m_overlays[0..i]
+  size_t                    m_current;
 };
-
@@ -23,6 +23,7 @@
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
@@ -37,6 +38,7 @@
 using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
+#define BULK_SAVEPOINT "bulkingest"
 
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
@@ -103,6 +105,12 @@ CDatabase::CDatabase(void)
   m_sqlite = true;
   m_bMultiWrite = false;
   m_multipleExecute = false;
+  m_bulkIngest = false;
+  m_bulkDepth = 0;
+  m_bulkPending = 0;
+  m_bulkSize = 0;
+  m_bulkMillis = 0;
+  m_bulkStart = 0;
 }
 
 CDatabase::~CDatabase(void)
@@ -253,6 +261,23 @@ bool CDatabase::ResultQuery(const std::string &strQuery)
   return bReturn;
 }
 
+std::unique_ptr<dbiplus::Cursor> CDatabase::PrepareCursor(const std::string &strQuery)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return nullptr;
+
+    return std::unique_ptr<dbiplus::Cursor>(m_pDB->prepareCursor(strQuery));
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to prepare query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return nullptr;
+}
+
 bool CDatabase::QueueInsertQuery(const std::string &strQuery)
 {
   if (strQuery.empty())
@@ -611,9 +636,16 @@ void CDatabase::Close()
 
   m_openCount = 0;
   m_multipleExecute = false;
+  m_lookupCache.clear();
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
+  if (m_bulkIngest)
+  {
+    m_bulkIngest = false;
+    m_pDB->set_commit_writes(false);
+    m_pDB->commit_transaction();
+  }
   m_pDB->disconnect();
   m_pDB.reset();
   m_pDS.reset();
@@ -666,7 +698,16 @@ void CDatabase::BeginTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->start_transaction();
+    {
+      if (m_bulkIngest)
+      {
+        m_pDB->start_savepoint(BULK_SAVEPOINT);
+        m_bulkDepth++;
+        m_pDB->set_commit_writes(false);
+      }
+      else
+        m_pDB->start_transaction();
+    }
   }
   catch (...)
   {
@@ -679,7 +720,25 @@ bool CDatabase::CommitTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->commit_transaction();
+    {
+      if (m_bulkIngest)
+      {
+        if (m_bulkDepth > 0)
+        {
+          m_pDB->release_savepoint(BULK_SAVEPOINT);
+          m_bulkDepth--;
+        }
+        if (m_bulkDepth == 0)
+        {
+          m_pDB->set_commit_writes(true);
+          m_bulkPending++;
+          if (m_bulkPending >= m_bulkSize || XbmcThreads::SystemClockMillis() - m_bulkStart >= m_bulkMillis)
+            FlushBulkIngest();
+        }
+      }
+      else
+        m_pDB->commit_transaction();
+    }
   }
   catch (...)
   {
@@ -694,7 +753,22 @@ void CDatabase::RollbackTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->rollback_transaction();
+    {
+      if (m_bulkIngest)
+      {
+        // ids inserted since the savepoint are gone again
+        m_lookupCache.clear();
+        if (m_bulkDepth > 0)
+        {
+          m_pDB->rollback_savepoint(BULK_SAVEPOINT);
+          m_bulkDepth--;
+        }
+        if (m_bulkDepth == 0)
+          m_pDB->set_commit_writes(true);
+      }
+      else
+        m_pDB->rollback_transaction();
+    }
   }
   catch (...)
   {
@@ -708,6 +782,86 @@ bool CDatabase::InTransaction()
   return m_pDB->in_transaction();
 }
 
+bool CDatabase::BeginBulkIngest(unsigned int batchSize /* = 64 */, unsigned int batchMillis /* = 2000 */)
+{
+  if (NULL == m_pDB.get()) return false;
+  if (m_bulkIngest) return true;
+
+  try
+  {
+    m_pDB->start_transaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    return false;
+  }
+  m_bulkIngest = true;
+  m_bulkDepth = 0;
+  m_bulkPending = 0;
+  // writes outside of BeginTransaction() aren't part of the ingest, they are
+  // committed right away instead of holding the write lock until the next flush
+  m_pDB->set_commit_writes(true);
+  m_bulkSize = batchSize > 0 ? batchSize : 1;
+  m_bulkMillis = batchMillis;
+  m_bulkStart = XbmcThreads::SystemClockMillis();
+  m_lookupCache.clear();
+  return true;
+}
+
+bool CDatabase::EndBulkIngest()
+{
+  if (!m_bulkIngest)
+    return true;
+
+  if (m_bulkDepth > 0)
+    CLog::Log(LOGWARNING, "%s - %u transaction(s) still open, committing them", __FUNCTION__, m_bulkDepth);
+
+  m_bulkIngest = false;
+  m_bulkDepth = 0;
+  m_lookupCache.clear();
+  if (NULL != m_pDB.get())
+    m_pDB->set_commit_writes(false);
+
+  // commit through the child class so it sees the batch as one transaction
+  return CommitTransaction();
+}
+
+void CDatabase::FlushBulkIngest()
+{
+  if (!m_bulkIngest || m_bulkDepth > 0 || NULL == m_pDB.get())
+    return;
+
+  try
+  {
+    m_pDB->commit_transaction();
+    m_pDB->start_transaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  m_bulkPending = 0;
+  m_bulkStart = XbmcThreads::SystemClockMillis();
+}
+
+int CDatabase::GetCachedLookupId(const std::string &strTable, const std::string &strValue) const
+{
+  if (!m_bulkIngest)
+    return -1;
+
+  std::map<std::string, int>::const_iterator it = m_lookupCache.find(strTable + '\n' + strValue);
+  if (it == m_lookupCache.end())
+    return -1;
+  return it->second;
+}
+
+void CDatabase::CacheLookupId(const std::string &strTable, const std::string &strValue, int id)
+{
+  if (m_bulkIngest && id >= 0)
+    m_lookupCache[strTable + '\n' + strValue] = id;
+}
+
 bool CDatabase::CreateDatabase()
 {
   BeginTransaction();
@@ -23,8 +23,10 @@
 namespace dbiplus {
   class Database;
   class Dataset;
+  class Cursor;
 }
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -71,6 +73,37 @@ public:
   void RollbackTransaction();
   bool InTransaction();
 
+  /*!
+   * @brief Group the writes of a library scan into larger transactions.
+   * @remarks While active, BeginTransaction()/CommitTransaction()/RollbackTransaction() work on
+   *          savepoints inside a batch transaction. The batch is committed once batchSize
+   *          top level transactions have been committed or it has been open for batchMillis,
+   *          whichever comes first, and lookup ids cached by the child class are kept
+   *          until the bulk ingest ends or anything is rolled back. Writes made outside of
+   *          BeginTransaction() are not part of the batch, each of them commits it.
+   * @param batchSize The number of top level transactions to commit together.
+   * @param batchMillis The time after which a batch is committed regardless of its size.
+   * @return True if the bulk ingest was started, false if the database isn't open.
+   * @sa EndBulkIngest, FlushBulkIngest
+   */
+  bool BeginBulkIngest(unsigned int batchSize = 64, unsigned int batchMillis = 2000);
+
+  /*!
+   * @brief Commit the current batch and go back to one transaction per BeginTransaction().
+   * @return True if the batch was committed, false otherwise.
+   * @sa BeginBulkIngest
+   */
+  bool EndBulkIngest();
+
+  /*!
+   * @brief Commit the current batch early, e.g. before waiting on a scraper,
+   *        so other connections aren't locked out meanwhile.
+   * @remarks Does nothing outside a bulk ingest or inside an open transaction.
+   */
+  void FlushBulkIngest();
+
+  bool InBulkIngest() const { return m_bulkIngest; }
+
   std::string PrepareSQL(std::string strStmt, ...) const;
 
   /*!
@@ -118,6 +151,16 @@ public:
    */
   bool ResultQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Prepare a select query to read its rows one at a time.
+   * @remarks Values are bound to '?' placeholders on the returned cursor instead of
+   *          being formatted into the query. On SQLite the prepared statement is cached
+   *          and reused for the same query text. Release the cursor before Close().
+   * @param strQuery The query to prepare.
+   * @return The cursor, empty on failure.
+   */
+  std::unique_ptr<dbiplus::Cursor> PrepareCursor(const std::string &strQuery);
+
   /*!
    * @brief Start a multiple execution queue. Any ExecuteQuery() function
    *        following this call will be queued rather than executed until
@@ -206,6 +249,16 @@ protected:
 
   bool BuildSQL(const std::string &strQuery, const Filter &filter, std::string &strSQL);
 
+  /*!
+   * @brief Look up an id remembered for a value of a lookup table during a bulk ingest.
+   * @param strTable The lookup table, e.g. "genre".
+   * @param strValue The value exactly as it was passed to CacheLookupId().
+   * @return The id, or -1 if it isn't cached or no bulk ingest is running.
+   * @sa CacheLookupId, BeginBulkIngest
+   */
+  int GetCachedLookupId(const std::string &strTable, const std::string &strValue) const;
+  void CacheLookupId(const std::string &strTable, const std::string &strValue, int id);
+
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
 
   std::unique_ptr<dbiplus::Database> m_pDB;
@@ -222,4 +275,12 @@ private:
 
   bool m_multipleExecute;
   std::vector<std::string> m_multipleQueries;
+
+  bool m_bulkIngest;
+  unsigned int m_bulkDepth;       ///< savepoints currently open in the batch
+  unsigned int m_bulkPending;     ///< top level transactions in the batch
+  unsigned int m_bulkSize;
+  unsigned int m_bulkMillis;
+  unsigned int m_bulkStart;       ///< when the batch was started
+  std::map<std::string, int> m_lookupCache;
 };
@@ -49,6 +49,7 @@ Database::Database():
 {
   active = false;	// No connection yet
   compression = false;
+  commit_writes = false;
 }
 
 Database::~Database() {
@@ -72,6 +73,13 @@ int Database::connectFull(const char *newHost, const char *newPort, const char *
   return connect(true);
 }
 
+void Database::write_done() {
+  if (commit_writes && in_transaction()) {
+    commit_transaction();
+    start_transaction();
+  }
+}
+
 std::string Database::prepare(const char *format, ...)
 {
   va_list args;
@@ -82,6 +90,11 @@ std::string Database::prepare(const char *format, ...)
   return result;
 }
 
+Cursor *Database::prepareCursor(const std::string &sql)
+{
+  return new DatasetCursor(this, sql);
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset():
@@ -558,6 +571,127 @@ for (unsigned int i=0; i < fields_object->size(); i++)
 
 
 
+//************* DatasetCursor implementation ***************
+
+DatasetCursor::DatasetCursor(Database *newDb, const std::string &sql):
+  db(newDb),
+  ds(NULL),
+  sql(sql),
+  started(false)
+{
+}
+
+DatasetCursor::~DatasetCursor() {
+  delete ds;
+}
+
+void DatasetCursor::set_param(int index, const std::string &value) {
+  if (index < 1)
+    throw DbErrors("Cursor parameter %d out of range", index);
+  if ((size_t)index > params.size())
+    params.resize(index, "NULL");
+  params[index - 1] = value;
+}
+
+void DatasetCursor::bind(int index, int value) {
+  set_param(index, std::to_string(value));
+}
+
+void DatasetCursor::bind(int index, int64_t value) {
+  set_param(index, std::to_string(value));
+}
+
+void DatasetCursor::bind(int index, double value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.17g", value);
+  set_param(index, buf);
+}
+
+void DatasetCursor::bind(int index, const std::string &value) {
+  set_param(index, db->prepare("'%s'", value.c_str()));
+}
+
+void DatasetCursor::bind_null(int index) {
+  set_param(index, "NULL");
+}
+
+bool DatasetCursor::step() {
+  if (started) {
+    if (ds->eof())
+      return false;
+    ds->next();
+    return !ds->eof();
+  }
+
+  // substitute the placeholders, skipping quoted literals
+  std::string query;
+  query.reserve(sql.size());
+  size_t param = 0;
+  char quote = 0;
+  for (size_t i = 0; i < sql.size(); i++) {
+    const char c = sql[i];
+    if (quote) {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '\'' || c == '"' || c == '`')
+      quote = c;
+    else if (c == '?') {
+      query += param < params.size() ? params[param] : "NULL";
+      param++;
+      continue;
+    }
+    query += c;
+  }
+
+  if (!ds)
+    ds = db->CreateDataset();
+  started = true;
+  if (!ds->query(query))
+    return false;
+  return !ds->eof();
+}
+
+void DatasetCursor::reset() {
+  if (ds)
+    ds->close();
+  started = false;
+}
+
+int DatasetCursor::column_count() {
+  return ds ? ds->field_count() : 0;
+}
+
+const char *DatasetCursor::column_name(int n) {
+  return ds ? ds->fieldName(n) : NULL;
+}
+
+bool DatasetCursor::column_isNull(int n) {
+  return ds->fv(n).get_isNull();
+}
+
+int DatasetCursor::column_int(int n) {
+  return ds->fv(n).get_asInt();
+}
+
+int64_t DatasetCursor::column_int64(int n) {
+  return ds->fv(n).get_asInt64();
+}
+
+double DatasetCursor::column_double(int n) {
+  return ds->fv(n).get_asDouble();
+}
+
+const char *DatasetCursor::column_text(int n) {
+  const field_value value = ds->fv(n);
+  if (value.get_isNull())
+    return NULL;
+  text = value.get_asString();
+  return text.c_str();
+}
+
+
+
 //************* DbErrors implementation ***************
 
 DbErrors::DbErrors():
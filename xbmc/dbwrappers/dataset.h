@@ -34,11 +34,13 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #include "qry_dat.h"
 #include <stdarg.h>
 
 namespace dbiplus {
 class Dataset;		// forward declaration of class Dataset
+class Cursor;		// forward declaration of class Cursor
 
 
 #define S_NO_CONNECTION "No active connection";
@@ -66,6 +68,7 @@ class Database  {
 protected:
   bool active;
   bool compression;
+  bool commit_writes;
   std::string error, // Error description
     host, port, db, login, passwd, //Login info
     sequence_table, //Sequence table for nextid
@@ -142,12 +145,30 @@ public:
 
   virtual bool exists(void) { return false; }
 
+/* returns a forward-only cursor for a select query with '?' parameters,
+   the caller owns it and has to delete it before disconnecting.
+   the default runs the query through a Dataset once the parameters are bound */
+  virtual Cursor *prepareCursor(const std::string &sql);
+
 /* virtual methods for transaction */
 
   virtual void start_transaction() {};
   virtual void commit_transaction() {};
   virtual void rollback_transaction() {};
 
+/* savepoints nest inside an open transaction, release keeps the changes
+   made since the savepoint, rollback discards them and releases it */
+  virtual void start_savepoint(const std::string &name) {};
+  virtual void release_savepoint(const std::string &name) {};
+  virtual void rollback_savepoint(const std::string &name) {};
+
+/* while set, a write done by exec() inside an open transaction commits that
+   transaction and starts a new one. set by the owner of a long running
+   transaction for the times it has no savepoint of its own open, so writes
+   made outside of one aren't kept waiting for the next commit */
+  void set_commit_writes(bool v) { commit_writes = v; }
+  void write_done();
+
 /* virtual methods for formatting */
 
   /*! \brief Prepare a SQL statement for execution or querying using C printf nomenclature.
@@ -490,6 +511,85 @@ public:
 
 
 
+/******************* Class Cursor definition **********************
+
+   forward-only read of the rows of a select query, columns are
+   read from the current row only, the result set is never
+   materialized (where the backend allows it).
+   parameters are '?' placeholders, numbered starting with 1.
+
+******************************************************************/
+class Cursor  {
+public:
+  virtual ~Cursor() {}
+
+/* bind parameters, before the first step() or after reset() */
+  virtual void bind(int index, int value) = 0;
+  virtual void bind(int index, int64_t value) = 0;
+  virtual void bind(int index, double value) = 0;
+  virtual void bind(int index, const std::string &value) = 0;
+  virtual void bind_null(int index) = 0;
+
+/* executes the query on the first call and moves to the next row,
+   returns false once there are no more rows */
+  virtual bool step() = 0;
+/* rewinds the query to run it again, bound parameters are kept */
+  virtual void reset() = 0;
+
+/* column access on the current row, columns start with 0 */
+  virtual int column_count() = 0;
+  virtual const char *column_name(int n) = 0;
+  virtual bool column_isNull(int n) = 0;
+  virtual int column_int(int n) = 0;
+  virtual int64_t column_int64(int n) = 0;
+  virtual double column_double(int n) = 0;
+/* text is valid until the next step() or column_text() call */
+  virtual const char *column_text(int n) = 0;
+  std::string column_string(int n) { const char *text = column_text(n); return text ? text : ""; }
+};
+
+
+/******************* Class DatasetCursor definition ****************
+
+   fallback Cursor for backends without prepared statements, the
+   parameters are formatted into the query which runs as a Dataset
+
+******************************************************************/
+class DatasetCursor : public Cursor  {
+public:
+  DatasetCursor(Database *newDb, const std::string &sql);
+  virtual ~DatasetCursor();
+
+  virtual void bind(int index, int value);
+  virtual void bind(int index, int64_t value);
+  virtual void bind(int index, double value);
+  virtual void bind(int index, const std::string &value);
+  virtual void bind_null(int index);
+
+  virtual bool step();
+  virtual void reset();
+
+  virtual int column_count();
+  virtual const char *column_name(int n);
+  virtual bool column_isNull(int n);
+  virtual int column_int(int n);
+  virtual int64_t column_int64(int n);
+  virtual double column_double(int n);
+  virtual const char *column_text(int n);
+
+private:
+  void set_param(int index, const std::string &value);
+
+  Database *db;
+  Dataset *ds;
+  std::string sql;
+  std::vector<std::string> params;	// formatted sql literals
+  bool started;
+  std::string text;
+};
+
+
+
 /******************** Class DbErrors definition *********************
 
 			   error handling
@@ -533,6 +533,38 @@ void MysqlDatabase::rollback_transaction() {
   }
 }
 
+void MysqlDatabase::start_savepoint(const std::string &name) {
+  if (active)
+  {
+    std::string sql = "SAVEPOINT " + name;
+    query_with_reconnect(sql.c_str());
+    if (g_advancedSettings.CanLogComponent(LOGDATABASE))
+      CLog::Log(LOGDEBUG,"Mysql savepoint %s", name.c_str());
+  }
+}
+
+void MysqlDatabase::release_savepoint(const std::string &name) {
+  if (active)
+  {
+    std::string sql = "RELEASE SAVEPOINT " + name;
+    query_with_reconnect(sql.c_str());
+    if (g_advancedSettings.CanLogComponent(LOGDATABASE))
+      CLog::Log(LOGDEBUG,"Mysql release savepoint %s", name.c_str());
+  }
+}
+
+void MysqlDatabase::rollback_savepoint(const std::string &name) {
+  if (active)
+  {
+    std::string sql = "ROLLBACK TO SAVEPOINT " + name;
+    query_with_reconnect(sql.c_str());
+    sql = "RELEASE SAVEPOINT " + name;
+    query_with_reconnect(sql.c_str());
+    if (g_advancedSettings.CanLogComponent(LOGDATABASE))
+      CLog::Log(LOGDEBUG,"Mysql rollback to savepoint %s", name.c_str());
+  }
+}
+
 bool MysqlDatabase::exists(void) {
   bool ret = false;
 
@@ -1549,6 +1581,7 @@ int MysqlDataset::exec(const std::string &sql) {
   }
   else
   {
+    db->write_done();
     // TODO: collect results and store in exec_res
     return res;
   }
@@ -80,6 +80,10 @@ public:
   virtual void commit_transaction();
   virtual void rollback_transaction();
 
+  virtual void start_savepoint(const std::string &name);
+  virtual void release_savepoint(const std::string &name);
+  virtual void rollback_savepoint(const std::string &name);
+
 /* virtual methods for formatting */
   virtual std::string vprepare(const char *format, va_list args);
 
@@ -75,6 +75,9 @@ int callback(void* res_ptr,int ncol, char** reslt,char** cols)
   return 0;  
 }
 
+// prepared statements kept per connection
+#define SQLITE_STMT_CACHE_MAX 64
+
 static int busy_callback(void*, int busyCount)
 {
   Sleep(100);
@@ -261,10 +264,62 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  // statements have to be finalized or the connection stays open
+  clear_stmt_cache();
   sqlite3_close(conn);
   active = false;
 }
 
+Cursor *SqliteDatabase::prepareCursor(const std::string &sql) {
+  return new SqliteCursor(this, sql);
+}
+
+sqlite3_stmt *SqliteDatabase::acquire_stmt(const std::string &sql) {
+  if (!active) throw DbErrors("No Database Connection");
+
+  std::map<std::string, stmt_lru_list::iterator>::iterator it = stmt_cache.find(sql);
+  if (it != stmt_cache.end()) {
+    // in use now, a nested cursor on the same sql gets its own
+    sqlite3_stmt *stmt = it->second->second;
+    stmt_lru.erase(it->second);
+    stmt_cache.erase(it);
+    return stmt;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK) {
+    sqlite3_finalize(stmt);
+    throw DbErrors(getErrorMsg());
+  }
+  return stmt;
+}
+
+void SqliteDatabase::release_stmt(const std::string &sql, sqlite3_stmt *stmt) {
+  if (!stmt) return;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  if (!active || stmt_cache.find(sql) != stmt_cache.end()) {
+    sqlite3_finalize(stmt);
+    return;
+  }
+  if (stmt_cache.size() >= SQLITE_STMT_CACHE_MAX) {
+    // evict the statement released longest ago
+    sqlite3_finalize(stmt_lru.back().second);
+    stmt_cache.erase(stmt_lru.back().first);
+    stmt_lru.pop_back();
+  }
+  stmt_lru.push_front(std::make_pair(sql, stmt));
+  stmt_cache[sql] = stmt_lru.begin();
+}
+
+void SqliteDatabase::clear_stmt_cache() {
+  for (stmt_lru_list::iterator it = stmt_lru.begin(); it != stmt_lru.end(); ++it)
+    sqlite3_finalize(it->second);
+  stmt_lru.clear();
+  stmt_cache.clear();
+}
+
 int SqliteDatabase::create() {
   return connect(true);
 }
@@ -415,6 +470,29 @@ void SqliteDatabase::rollback_transaction() {
   }  
 }
 
+void SqliteDatabase::start_savepoint(const std::string &name) {
+  if (active) {
+    std::string sql = "savepoint " + name;
+    sqlite3_exec(conn,sql.c_str(),NULL,NULL,NULL);
+  }
+}
+
+void SqliteDatabase::release_savepoint(const std::string &name) {
+  if (active) {
+    std::string sql = "release savepoint " + name;
+    sqlite3_exec(conn,sql.c_str(),NULL,NULL,NULL);
+  }
+}
+
+void SqliteDatabase::rollback_savepoint(const std::string &name) {
+  if (active) {
+    std::string sql = "rollback to savepoint " + name;
+    sqlite3_exec(conn,sql.c_str(),NULL,NULL,NULL);
+    sql = "release savepoint " + name;
+    sqlite3_exec(conn,sql.c_str(),NULL,NULL,NULL);
+  }
+}
+
 
 // methods for formatting
 // ---------------------------------------------
@@ -623,8 +701,10 @@ int SqliteDataset::exec(const std::string &sql) {
       qry = qry.substr(0, pos);
   }
 
-  if((res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str())) == SQLITE_OK)
+  if((res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str())) == SQLITE_OK) {
+    db->write_done();
     return res;
+  }
   else
     {
       throw DbErrors(db->getErrorMsg());
@@ -812,4 +892,95 @@ long SqliteDataset::nextid(const char *seq_name) {
 void SqliteDataset::interrupt() {
   sqlite3_interrupt(handle());
 }
+
+
+
+//************* SqliteCursor implementation ***************
+
+SqliteCursor::SqliteCursor(SqliteDatabase *newDb, const std::string &sql):
+  db(newDb),
+  sql(sql),
+  stmt(NULL),
+  done(false)
+{
+  stmt = db->acquire_stmt(sql);
+}
+
+SqliteCursor::~SqliteCursor() {
+  db->release_stmt(sql, stmt);
+}
+
+void SqliteCursor::check_bind(int err) {
+  if (db->setErr(err, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+}
+
+void SqliteCursor::bind(int index, int value) {
+  check_bind(sqlite3_bind_int(stmt, index, value));
+}
+
+void SqliteCursor::bind(int index, int64_t value) {
+  check_bind(sqlite3_bind_int64(stmt, index, value));
+}
+
+void SqliteCursor::bind(int index, double value) {
+  check_bind(sqlite3_bind_double(stmt, index, value));
+}
+
+void SqliteCursor::bind(int index, const std::string &value) {
+  check_bind(sqlite3_bind_text(stmt, index, value.c_str(), value.size(), SQLITE_TRANSIENT));
+}
+
+void SqliteCursor::bind_null(int index) {
+  check_bind(sqlite3_bind_null(stmt, index));
+}
+
+bool SqliteCursor::step() {
+  if (done)
+    return false;
+
+  int err = sqlite3_step(stmt);
+  if (err == SQLITE_ROW)
+    return true;
+
+  done = true;
+  if (err != SQLITE_DONE) {
+    db->setErr(err, sql.c_str());
+    throw DbErrors(db->getErrorMsg());
+  }
+  return false;
+}
+
+void SqliteCursor::reset() {
+  sqlite3_reset(stmt);
+  done = false;
+}
+
+int SqliteCursor::column_count() {
+  return sqlite3_column_count(stmt);
+}
+
+const char *SqliteCursor::column_name(int n) {
+  return sqlite3_column_name(stmt, n);
+}
+
+bool SqliteCursor::column_isNull(int n) {
+  return sqlite3_column_type(stmt, n) == SQLITE_NULL;
+}
+
+int SqliteCursor::column_int(int n) {
+  return sqlite3_column_int(stmt, n);
+}
+
+int64_t SqliteCursor::column_int64(int n) {
+  return sqlite3_column_int64(stmt, n);
+}
+
+double SqliteCursor::column_double(int n) {
+  return sqlite3_column_double(stmt, n);
+}
+
+const char *SqliteCursor::column_text(int n) {
+  return (const char *)sqlite3_column_text(stmt, n);
+}
 }//namespace
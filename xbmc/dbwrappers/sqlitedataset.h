@@ -30,6 +30,8 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <list>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -45,6 +47,12 @@ protected:
   sqlite3 *conn = nullptr;
   bool _in_transaction;
   int last_err;
+/* prepared statements not in use by a cursor, most recently released first,
+   and the same entries keyed by sql text */
+  typedef std::list<std::pair<std::string, sqlite3_stmt*> > stmt_lru_list;
+  stmt_lru_list stmt_lru;
+  std::map<std::string, stmt_lru_list::iterator> stmt_cache;
+  void clear_stmt_cache();
 
 public:
 /* default constructor */
@@ -77,6 +85,11 @@ public:
   virtual int drop();
 /* check if database exists (ie has tables/views defined) */
   virtual bool exists();
+/* returns a cursor on a cached prepared statement */
+  virtual Cursor *prepareCursor(const std::string &sql);
+/* take a prepared statement out of the cache (or prepare it) and hand it back when done */
+  sqlite3_stmt *acquire_stmt(const std::string &sql);
+  void release_stmt(const std::string &sql, sqlite3_stmt *stmt);
 
 /* \brief copy database */
   virtual int copy(const char *backup_name);
@@ -92,6 +105,10 @@ public:
   virtual void commit_transaction();
   virtual void rollback_transaction();
 
+  virtual void start_savepoint(const std::string &name);
+  virtual void release_savepoint(const std::string &name);
+  virtual void rollback_savepoint(const std::string &name);
+
 /* virtual methods for formatting */
   virtual std::string vprepare(const char *format, va_list args);
 
@@ -173,5 +190,43 @@ or insert() operations default = false) */
 
   virtual bool dropIndex(const char *table, const char *index);
 };
+
+
+/***************** Class SqliteCursor definition ********************
+
+       class 'SqliteCursor' steps through a prepared statement
+
+******************************************************************/
+
+class SqliteCursor : public Cursor {
+public:
+  SqliteCursor(SqliteDatabase *newDb, const std::string &sql);
+  virtual ~SqliteCursor();
+
+  virtual void bind(int index, int value);
+  virtual void bind(int index, int64_t value);
+  virtual void bind(int index, double value);
+  virtual void bind(int index, const std::string &value);
+  virtual void bind_null(int index);
+
+  virtual bool step();
+  virtual void reset();
+
+  virtual int column_count();
+  virtual const char *column_name(int n);
+  virtual bool column_isNull(int n);
+  virtual int column_int(int n);
+  virtual int64_t column_int64(int n);
+  virtual double column_double(int n);
+  virtual const char *column_text(int n);
+
+private:
+  void check_bind(int err);
+
+  SqliteDatabase *db;
+  std::string sql;
+  sqlite3_stmt *stmt;
+  bool done;
+};
 } //namespace
 #endif
@@ -20,11 +20,13 @@
 
 #include "Epg.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "addons/include/xbmc_epg_types.h"
 #include "EpgContainer.h"
 #include "EpgDatabase.h"
+#include "EpgSearchIndex.h"
 #include "guilib/LocalizeStrings.h"
 #include "pvr/addons/PVRClients.h"
 #include "pvr/PVRManager.h"
@@ -86,12 +88,13 @@ CEpg &CEpg::operator =(const CEpg &right)
   m_iEpgID            = right.m_iEpgID;
   m_strName           = right.m_strName;
   m_strScraperName    = right.m_strScraperName;
-  m_nowActiveStart    = right.m_nowActiveStart;
+  std::atomic_store(&m_nowActiveTag, std::atomic_load(&right.m_nowActiveTag));
   m_lastScanTime      = right.m_lastScanTime;
   m_pvrChannel        = right.m_pvrChannel;
 
   for (std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); ++it)
     m_tags.insert(make_pair(it->first, it->second));
+  InvalidateTagIndex();
 
   return *this;
 }
@@ -150,6 +153,8 @@ void CEpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  std::atomic_store(&m_nowActiveTag, CEpgInfoTagPtr());
+  InvalidateTagIndex();
 }
 
 void CEpg::Cleanup(void)
@@ -166,11 +171,12 @@ void CEpg::Cleanup(const CDateTime &Time)
   {
     if (it->second->EndAsUTC() < Time)
     {
-      if (m_nowActiveStart == it->first)
-        m_nowActiveStart.SetValid(false);
+      if (std::atomic_load(&m_nowActiveTag) == it->second)
+        std::atomic_store(&m_nowActiveTag, CEpgInfoTagPtr());
 
       it->second->ClearTimer();
       it = m_tags.erase(it);
+      InvalidateTagIndex();
     }
     else
     {
@@ -181,34 +187,41 @@ void CEpg::Cleanup(const CDateTime &Time)
 
 CEpgInfoTagPtr CEpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
 {
-  CSingleLock lock(m_critSection);
-  if (m_nowActiveStart.IsValid())
-  {
-    std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(m_nowActiveStart);
-    if (it != m_tags.end() && it->second->IsActive())
-      return it->second;
-  }
+  CEpgInfoTagPtr nowTag(std::atomic_load(&m_nowActiveTag));
+  if (nowTag && nowTag->IsActive())
+    return nowTag;
 
   if (bUpdateIfNeeded)
   {
-    CEpgInfoTagPtr lastActiveTag;
+    TagIndexPtr index(GetTagIndex());
+    if (index->tags.empty())
+      return CEpgInfoTagPtr();
+
+    /* all tags of this table belong to the same channel, so they share the current playing time */
+    time_t now;
+    index->tags.front()->GetCurrentPlayingTime().GetAsTime(now);
 
-    /* one of the first items will always match if the list is sorted */
-    for (std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    nowTag = FindTagAround(*index, now, true);
+    if (nowTag)
     {
-      if (it->second->IsActive())
-      {
-        m_nowActiveStart = it->first;
-        return it->second;
-      }
-      else if (it->second->WasActive())
-        lastActiveTag = it->second;
+      std::atomic_store(&m_nowActiveTag, nowTag);
+      return nowTag;
     }
 
     /* there might be a gap between the last and next event. return the last if found and it ended not more than 5 minutes ago */
-    if (lastActiveTag &&
-        lastActiveTag->EndAsUTC() + CDateTimeSpan(0, 0, 5, 0) >= CDateTime::GetUTCDateTime())
-      return lastActiveTag;
+    std::vector<TagTimes>::const_iterator it = std::upper_bound(index->times.begin(), index->times.end(), now,
+        [](time_t value, const TagTimes &times) { return value < times.start; });
+    while (it != index->times.begin())
+    {
+      --it;
+      if (it->end < now)
+      {
+        CEpgInfoTagPtr lastActiveTag(index->tags[it - index->times.begin()]);
+        if (lastActiveTag->EndAsUTC() + CDateTimeSpan(0, 0, 5, 0) >= CDateTime::GetUTCDateTime())
+          return lastActiveTag;
+        break;
+      }
+    }
   }
 
   return CEpgInfoTagPtr();
@@ -217,21 +230,29 @@ CEpgInfoTagPtr CEpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
 CEpgInfoTagPtr CEpg::GetTagNext() const
 {
   CEpgInfoTagPtr nowTag(GetTagNow());
+  TagIndexPtr index(GetTagIndex());
+  if (index->tags.empty())
+    return CEpgInfoTagPtr();
+
   if (nowTag)
   {
-    CSingleLock lock(m_critSection);
-    std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(nowTag->StartAsUTC());
-    if (it != m_tags.end() && ++it != m_tags.end())
-      return it->second;
+    time_t start;
+    nowTag->StartAsUTC().GetAsTime(start);
+    std::vector<TagTimes>::const_iterator it = std::lower_bound(index->times.begin(), index->times.end(), start,
+        [](const TagTimes &times, time_t value) { return times.start < value; });
+    size_t i = it - index->times.begin();
+    if (i < index->tags.size() && index->tags[i] == nowTag && i + 1 < index->tags.size())
+      return index->tags[i + 1];
   }
-  else if (Size() > 0)
+  else
   {
     /* return the first event that is in the future */
-    for (std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
-    {
-      if (it->second->IsUpcoming())
-        return it->second;
-    }
+    time_t now;
+    index->tags.front()->GetCurrentPlayingTime().GetAsTime(now);
+    std::vector<TagTimes>::const_iterator it = std::upper_bound(index->times.begin(), index->times.end(), now,
+        [](time_t value, const TagTimes &times) { return value < times.start; });
+    if (it != index->times.end())
+      return index->tags[it - index->times.begin()];
   }
 
   return CEpgInfoTagPtr();
@@ -266,11 +287,18 @@ CEpgInfoTagPtr CEpg::GetTag(const CDateTime &StartTime) const
 
 CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime) const
 {
-  CSingleLock lock(m_critSection);
-  for (std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  TagIndexPtr index(GetTagIndex());
+  time_t begin, end;
+  beginTime.GetAsTime(begin);
+  endTime.GetAsTime(end);
+
+  /* tags starting after endTime can't end before it */
+  std::vector<TagTimes>::const_iterator it = std::lower_bound(index->times.begin(), index->times.end(), begin,
+      [](const TagTimes &times, time_t value) { return times.start < value; });
+  for (; it != index->times.end() && it->start <= end; ++it)
   {
-    if (it->second->StartAsUTC() >= beginTime && it->second->EndAsUTC() <= endTime)
-      return it->second;
+    if (it->end <= end)
+      return index->tags[it - index->times.begin()];
   }
 
   return CEpgInfoTagPtr();
@@ -278,14 +306,63 @@ CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &
 
 CEpgInfoTagPtr CEpg::GetTagAround(const CDateTime &time) const
 {
+  time_t around;
+  time.GetAsTime(around);
+
+  return FindTagAround(*GetTagIndex(), around, false);
+}
+
+CEpgInfoTagPtr CEpg::FindTagAround(const TagIndex &index, time_t time, bool bIncludeStart)
+{
+  /* maxEnd doesn't decrease, so skip all tags that ended before the given time in one step */
+  std::vector<TagTimes>::const_iterator it = std::upper_bound(index.times.begin(), index.times.end(), time,
+      [](time_t value, const TagTimes &times) { return value < times.maxEnd; });
+  for (; it != index.times.end() && (it->start < time || (bIncludeStart && it->start == time)); ++it)
+  {
+    if (it->end > time)
+      return index.tags[it - index.times.begin()];
+  }
+
+  return CEpgInfoTagPtr();
+}
+
+CEpg::TagIndexPtr CEpg::GetTagIndex(void) const
+{
+  TagIndexPtr index(std::atomic_load(&m_tagIndex));
+  if (index)
+    return index;
+
   CSingleLock lock(m_critSection);
+  index = m_tagIndex;
+  if (index)
+    return index;
+
+  std::shared_ptr<TagIndex> newIndex(new TagIndex);
+  newIndex->times.reserve(m_tags.size());
+  newIndex->tags.reserve(m_tags.size());
+
+  time_t maxEnd = 0;
   for (std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
   {
-    if ((it->second->StartAsUTC() < time) && (it->second->EndAsUTC() > time))
-      return it->second;
+    TagTimes times;
+    it->second->StartAsUTC().GetAsTime(times.start);
+    it->second->EndAsUTC().GetAsTime(times.end);
+    maxEnd = std::max(maxEnd, times.end);
+    times.maxEnd = maxEnd;
+
+    newIndex->times.push_back(times);
+    newIndex->tags.push_back(it->second);
   }
 
-  return CEpgInfoTagPtr();
+  index = newIndex;
+  std::atomic_store(&m_tagIndex, index);
+  return index;
+}
+
+void CEpg::InvalidateTagIndex(void)
+{
+  std::atomic_store(&m_tagIndex, TagIndexPtr());
+  m_searchIndex.reset();
 }
 
 void CEpg::AddEntry(const CEpgInfoTag &tag)
@@ -307,6 +384,7 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
     newTag->SetPVRChannel(m_pvrChannel);
     newTag->SetEpg(this);
   }
+  InvalidateTagIndex();
 }
 
 bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false */, bool bSort /* = true */)
@@ -331,6 +409,7 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
   infoTag->Update(tag, bNewTag);
   infoTag->SetEpg(this);
   infoTag->SetPVRChannel(m_pvrChannel);
+  InvalidateTagIndex();
 
   if (bUpdateDatabase)
     m_changedTags.insert(make_pair(infoTag->UniqueBroadcastID(), infoTag));
@@ -501,15 +580,64 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
 
   CSingleLock lock(m_critSection);
 
-  for (std::map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  TagIndexPtr index(GetTagIndex());
+  if (!m_searchIndex)
+    m_searchIndex.reset(new CEpgSearchIndex(index->tags));
+
+  /* only check the tags in the time window of the filter */
+  unsigned int iFirst(0), iLast(index->tags.size());
+  GetTimeRange(*index, filter, iFirst, iLast);
+
+  /* and of those only the ones containing the words of the search term and having its genre */
+  std::vector<unsigned int> candidates;
+  if (m_searchIndex->GetCandidates(filter, candidates))
+  {
+    std::vector<unsigned int>::const_iterator it = std::lower_bound(candidates.begin(), candidates.end(), iFirst);
+    for (; it != candidates.end() && *it < iLast; ++it)
+    {
+      if (filter.FilterEntry(*index->tags[*it]))
+        results.Add(CFileItemPtr(new CFileItem(index->tags[*it])));
+    }
+
+    return results.Size() - iInitialSize;
+  }
+
+  for (unsigned int iTag = iFirst; iTag < iLast; iTag++)
   {
-    if (filter.FilterEntry(*it->second))
-      results.Add(CFileItemPtr(new CFileItem(it->second)));
+    if (filter.FilterEntry(*index->tags[iTag]))
+      results.Add(CFileItemPtr(new CFileItem(index->tags[iTag])));
   }
 
   return results.Size() - iInitialSize;
 }
 
+void CEpg::GetTimeRange(const TagIndex &index, const EpgSearchFilter &filter, unsigned int &iFirst, unsigned int &iLast)
+{
+  /* the filter compares local times, allow a day of slack for converting its bounds to UTC */
+  static const time_t slack = 24 * 60 * 60;
+
+  /* matching tags start at or after the start of the window */
+  if (filter.m_startDateTime.IsValid())
+  {
+    time_t start;
+    filter.m_startDateTime.GetAsUTCDateTime().GetAsTime(start);
+    iFirst = std::lower_bound(index.times.begin(), index.times.end(), start - slack,
+        [](const TagTimes &times, time_t value) { return times.start < value; }) - index.times.begin();
+  }
+
+  /* and end at or before its end, which they can't if they start after it */
+  if (filter.m_endDateTime.IsValid())
+  {
+    time_t end;
+    filter.m_endDateTime.GetAsUTCDateTime().GetAsTime(end);
+    iLast = std::upper_bound(index.times.begin(), index.times.end(), end + slack,
+        [](time_t value, const TagTimes &times) { return value < times.start; }) - index.times.begin();
+  }
+
+  if (iLast < iFirst)
+    iLast = iFirst;
+}
+
 bool CEpg::Persist(void)
 {
   if (CSettings::GetInstance().GetBool(CSettings::SETTING_EPG_IGNOREDBFORCLIENT) || !NeedsSave())
@@ -601,8 +729,8 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
       if (bUpdateDb)
         m_deletedTags.insert(make_pair(currentTag->UniqueBroadcastID(), currentTag));
 
-      if (m_nowActiveStart == it->first)
-        m_nowActiveStart.SetValid(false);
+      if (std::atomic_load(&m_nowActiveTag) == it->second)
+        std::atomic_store(&m_nowActiveTag, CEpgInfoTagPtr());
 
       it->second->ClearTimer();
       m_tags.erase(it++);
@@ -621,6 +749,8 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
     }
   }
 
+  InvalidateTagIndex();
+
   return bReturn;
 }
 
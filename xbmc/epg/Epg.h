@@ -28,6 +28,7 @@
 #include "EpgSearchFilter.h"
 
 #include <memory>
+#include <vector>
 
 namespace PVR
 {
@@ -38,6 +39,7 @@ namespace PVR
 namespace EPG
 {
   class CEpg;
+  class CEpgSearchIndex;
   typedef std::shared_ptr<CEpg> CEpgPtr;
   typedef std::map<unsigned int, CEpgPtr> EPGMAP;
 
@@ -349,6 +351,55 @@ namespace EPG
 
     bool IsRemovableTag(const EPG::CEpgInfoTag &tag) const;
 
+    /*!
+     * @brief Start and end time of a tag in the time index.
+     */
+    struct TagTimes
+    {
+      time_t start;
+      time_t end;
+      time_t maxEnd; /*!< the latest end time of this tag and all tags starting before it */
+    };
+
+    /*!
+     * @brief Immutable copy of m_tags sorted by start time, used for lookups by time without holding the lock.
+     */
+    struct TagIndex
+    {
+      std::vector<TagTimes>       times;
+      std::vector<CEpgInfoTagPtr> tags;
+    };
+    typedef std::shared_ptr<const TagIndex> TagIndexPtr;
+
+    /*!
+     * @brief Get the time index of this table, building it if the tags changed since it was last built.
+     * @return The time index.
+     */
+    TagIndexPtr GetTagIndex(void) const;
+
+    /*!
+     * @brief Drop the time index after m_tags or the times of a tag changed. Must be called with m_critSection held.
+     */
+    void InvalidateTagIndex(void);
+
+    /*!
+     * @brief Find the first tag in the index that is running at the given time.
+     * @param index The time index to search.
+     * @param time The time in UTC.
+     * @param bIncludeStart True to also match a tag starting exactly at the given time.
+     * @return The found tag or NULL if it wasn't found.
+     */
+    static CEpgInfoTagPtr FindTagAround(const TagIndex &index, time_t time, bool bIncludeStart);
+
+    /*!
+     * @brief Narrow the positions in the index to the tags that can lie in the time window of a filter.
+     * @param index The time index to search.
+     * @param filter The filter to get the time window from.
+     * @param iFirst Set to the position of the first tag in the window, if the filter has a start time.
+     * @param iLast Set to the position after the last tag in the window, if the filter has an end time.
+     */
+    static void GetTimeRange(const TagIndex &index, const EpgSearchFilter &filter, unsigned int &iFirst, unsigned int &iLast);
+
     std::map<CDateTime, CEpgInfoTagPtr> m_tags;
     std::map<int, CEpgInfoTagPtr>       m_changedTags;
     std::map<int, CEpgInfoTagPtr>       m_deletedTags;
@@ -359,7 +410,9 @@ namespace EPG
     int                                 m_iEpgID;          /*!< the database ID of this table */
     std::string                         m_strName;         /*!< the name of this table */
     std::string                         m_strScraperName;  /*!< the name of the scraper to use */
-    mutable CDateTime                   m_nowActiveStart;  /*!< the start time of the tag that is currently active */
+    mutable CEpgInfoTagPtr              m_nowActiveTag;    /*!< the tag that is currently active. only accessed with std::atomic_load/store */
+    mutable TagIndexPtr                 m_tagIndex;        /*!< time index of m_tags or NULL if it has to be rebuilt. only accessed with std::atomic_load/store */
+    mutable std::shared_ptr<CEpgSearchIndex> m_searchIndex; /*!< word and genre index over the tags of m_tagIndex or NULL if it has to be rebuilt */
 
     CDateTime                           m_lastScanTime;    /*!< the last time the EPG has been updated */
 
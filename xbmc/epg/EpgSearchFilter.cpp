@@ -94,7 +94,7 @@ bool EpgSearchFilter::MatchSearchTerm(const CEpgInfoTag &tag) const
 
   if (!m_strSearchTerm.empty())
   {
-    CTextSearch search(m_strSearchTerm, m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+    const CTextSearch &search = GetTextSearch();
     bReturn = search.Search(tag.Title()) ||
         search.Search(tag.PlotOutline());
   }
@@ -102,6 +102,18 @@ bool EpgSearchFilter::MatchSearchTerm(const CEpgInfoTag &tag) const
   return bReturn;
 }
 
+const CTextSearch &EpgSearchFilter::GetTextSearch() const
+{
+  if (!m_textSearch || m_strTextSearchTerm != m_strSearchTerm || m_bTextSearchCaseSensitive != m_bIsCaseSensitive)
+  {
+    m_textSearch.reset(new CTextSearch(m_strSearchTerm, m_bIsCaseSensitive, SEARCH_DEFAULT_OR));
+    m_strTextSearchTerm = m_strSearchTerm;
+    m_bTextSearchCaseSensitive = m_bIsCaseSensitive;
+  }
+
+  return *m_textSearch;
+}
+
 bool EpgSearchFilter::MatchBroadcastId(const CEpgInfoTag &tag) const
 {
   if (m_iUniqueBroadcastId != 0)
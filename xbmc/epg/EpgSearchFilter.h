@@ -21,7 +21,11 @@
 
 #include "XBDateTime.h"
 
+#include <memory>
+#include <string>
+
 class CFileItemList;
+class CTextSearch;
 
 namespace EPG
 {
@@ -59,6 +63,12 @@ namespace EPG
 
     static int RemoveDuplicates(CFileItemList &results);
 
+    /*!
+     * @brief Get m_strSearchTerm parsed for the current case sensitivity. It is only parsed again after either changed.
+     * @return The parsed search term.
+     */
+    const CTextSearch &GetTextSearch() const;
+
     std::string   m_strSearchTerm;            /*!< The term to search for */
     bool          m_bIsCaseSensitive;         /*!< Do a case sensitive search */
     bool          m_bSearchInDescription;     /*!< Search for strSearchTerm in the description too */
@@ -79,5 +89,10 @@ namespace EPG
     bool          m_bIgnorePresentTimers;     /*!< True to ignore currently present timers (future recordings), false if not */
     bool          m_bIgnorePresentRecordings; /*!< True to ignore currently active recordings, false if not */
     unsigned int  m_iUniqueBroadcastId;       /*!< The broadcastid to search for */
+
+  private:
+    mutable std::shared_ptr<CTextSearch> m_textSearch;   /*!< The parsed search term, see GetTextSearch() */
+    mutable std::string   m_strTextSearchTerm;          /*!< The search term m_textSearch was parsed from */
+    mutable bool          m_bTextSearchCaseSensitive;   /*!< The case sensitivity m_textSearch was parsed with */
   };
 }
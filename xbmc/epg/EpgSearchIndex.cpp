@@ -0,0 +1,279 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgSearchIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "addons/include/xbmc_pvr_types.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include "EpgSearchFilter.h"
+
+using namespace EPG;
+
+// longest substring of a word that is looked up directly in m_grams
+static const size_t MAX_GRAM = 3;
+
+// bytes >= 0x80 are kept in words so multi byte UTF-8 characters are never split
+static bool IsWordChar(char c)
+{
+  return (unsigned char)c >= 0x80 || isalnum((unsigned char)c);
+}
+
+// split lower case text into maximal runs of word characters
+static void SplitWords(const std::string &strText, std::vector<std::string> &words)
+{
+  size_t iStart = 0;
+  while (iStart < strText.size())
+  {
+    while (iStart < strText.size() && !IsWordChar(strText[iStart]))
+      iStart++;
+
+    size_t iEnd = iStart;
+    while (iEnd < strText.size() && IsWordChar(strText[iEnd]))
+      iEnd++;
+
+    if (iEnd > iStart)
+      words.push_back(strText.substr(iStart, iEnd - iStart));
+    iStart = iEnd;
+  }
+}
+
+CEpgSearchIndex::CEpgSearchIndex(const std::vector<CEpgInfoTagPtr> &tags)
+{
+  for (unsigned int iTag = 0; iTag < tags.size(); iTag++)
+  {
+    AddText(tags[iTag]->Title(), iTag);
+    AddText(tags[iTag]->PlotOutline(), iTag);
+
+    int iGenreType = tags[iTag]->GenreType();
+    m_genres[iGenreType].push_back(iTag);
+    if (iGenreType > EPG_EVENT_CONTENTMASK_USERDEFINED || iGenreType < EPG_EVENT_CONTENTMASK_MOVIEDRAMA)
+      m_unknownGenres.push_back(iTag);
+  }
+}
+
+void CEpgSearchIndex::AddText(const std::string &strText, unsigned int iTag)
+{
+  std::string strLower(strText);
+  StringUtils::ToLower(strLower);
+
+  std::vector<std::string> words;
+  SplitWords(strLower, words);
+  for (std::vector<std::string>::const_iterator it = words.begin(); it != words.end(); ++it)
+  {
+    std::pair<std::map<std::string, unsigned int>::iterator, bool> word = m_wordIds.insert(std::make_pair(*it, (unsigned int)m_words.size()));
+    if (word.second)
+    {
+      m_words.push_back(Postings());
+      m_vocabulary.push_back(*it);
+      AddGrams(*it, word.first->second);
+    }
+
+    // tags are added in order, so a tag is already listed if it is the last one
+    Postings &postings = m_words[word.first->second];
+    if (postings.empty() || postings.back() != iTag)
+      postings.push_back(iTag);
+  }
+}
+
+void CEpgSearchIndex::AddGrams(const std::string &strWord, unsigned int iWord)
+{
+  for (size_t iLength = 1; iLength <= MAX_GRAM && iLength <= strWord.size(); iLength++)
+  {
+    for (size_t iPos = 0; iPos + iLength <= strWord.size(); iPos++)
+    {
+      // words are added in order, so a word is already listed if it is the last one
+      Postings &postings = m_grams[strWord.substr(iPos, iLength)];
+      if (postings.empty() || postings.back() != iWord)
+        postings.push_back(iWord);
+    }
+  }
+}
+
+bool CEpgSearchIndex::GetCandidates(const EpgSearchFilter &filter, std::vector<unsigned int> &candidates) const
+{
+  bool bNarrowed(false);
+
+  if (!filter.m_strSearchTerm.empty())
+    bNarrowed = GetSearchCandidates(filter.GetTextSearch(), candidates);
+
+  Postings genreCandidates;
+  if (GetGenreCandidates(filter, genreCandidates))
+  {
+    if (bNarrowed)
+    {
+      Postings intersection;
+      std::set_intersection(candidates.begin(), candidates.end(), genreCandidates.begin(), genreCandidates.end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+    else
+    {
+      candidates.swap(genreCandidates);
+      bNarrowed = true;
+    }
+  }
+
+  return bNarrowed;
+}
+
+bool CEpgSearchIndex::GetGenreCandidates(const EpgSearchFilter &filter, Postings &candidates) const
+{
+  if (filter.m_iGenreType == EPG_SEARCH_UNSET)
+    return false;
+
+  std::map<int, Postings>::const_iterator it = m_genres.find(filter.m_iGenreType);
+  if (it != m_genres.end())
+    candidates = it->second;
+
+  if (filter.m_bIncludeUnknownGenres)
+  {
+    Postings merged;
+    std::set_union(candidates.begin(), candidates.end(), m_unknownGenres.begin(), m_unknownGenres.end(), std::back_inserter(merged));
+    candidates.swap(merged);
+  }
+
+  return true;
+}
+
+bool CEpgSearchIndex::GetSearchCandidates(const CTextSearch &search, Postings &candidates) const
+{
+  /* NOT terms only ever remove tags, so they are left to the search itself */
+  const std::vector<std::string> &andTerms = search.GetAndTerms();
+  const std::vector<std::string> &orTerms = search.GetOrTerms();
+  bool bNarrowed(false);
+
+  /* a tag has to contain at least one of the OR terms */
+  if (!orTerms.empty())
+  {
+    Postings orCandidates;
+    for (std::vector<std::string>::const_iterator it = orTerms.begin(); it != orTerms.end(); ++it)
+    {
+      Postings termCandidates;
+      if (!GetTermCandidates(*it, termCandidates))
+        return false; // this term can't be narrowed down, so neither can the union
+
+      Postings merged;
+      std::set_union(orCandidates.begin(), orCandidates.end(), termCandidates.begin(), termCandidates.end(), std::back_inserter(merged));
+      orCandidates.swap(merged);
+    }
+    candidates.swap(orCandidates);
+    bNarrowed = true;
+  }
+
+  /* and all of the AND terms */
+  for (std::vector<std::string>::const_iterator it = andTerms.begin(); it != andTerms.end(); ++it)
+  {
+    Postings termCandidates;
+    if (!GetTermCandidates(*it, termCandidates))
+      continue;
+
+    if (bNarrowed)
+    {
+      Postings intersection;
+      std::set_intersection(candidates.begin(), candidates.end(), termCandidates.begin(), termCandidates.end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+    else
+    {
+      candidates.swap(termCandidates);
+      bNarrowed = true;
+    }
+  }
+
+  return bNarrowed;
+}
+
+bool CEpgSearchIndex::GetTermCandidates(const std::string &strTerm, Postings &candidates) const
+{
+  /* case sensitive terms are matched case insensitive here, which only adds candidates */
+  std::string strLower(strTerm);
+  StringUtils::ToLower(strLower);
+
+  /* every word of a term that occurs in a text lies within one word of that text */
+  std::vector<std::string> words;
+  SplitWords(strLower, words);
+  if (words.empty())
+    return false;
+
+  for (std::vector<std::string>::const_iterator it = words.begin(); it != words.end(); ++it)
+  {
+    Postings wordCandidates;
+    GetWordCandidates(*it, wordCandidates);
+
+    if (it == words.begin())
+    {
+      candidates.swap(wordCandidates);
+    }
+    else
+    {
+      Postings intersection;
+      std::set_intersection(candidates.begin(), candidates.end(), wordCandidates.begin(), wordCandidates.end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+
+    if (candidates.empty())
+      break;
+  }
+
+  return true;
+}
+
+void CEpgSearchIndex::GetWordCandidates(const std::string &strWord, Postings &candidates) const
+{
+  /* the search matches substrings, so every indexed word containing this one counts */
+  Postings words;
+  if (strWord.size() <= MAX_GRAM)
+  {
+    /* short words are substrings of exactly the words listed for them */
+    std::unordered_map<std::string, Postings>::const_iterator it = m_grams.find(strWord);
+    if (it != m_grams.end())
+      words = it->second;
+  }
+  else
+  {
+    /* longer words can only be contained in the words listed for each of their substrings,
+       so only the words of the rarest one have to be checked */
+    const Postings *rarest = NULL;
+    for (size_t iPos = 0; iPos + MAX_GRAM <= strWord.size(); iPos++)
+    {
+      std::unordered_map<std::string, Postings>::const_iterator it = m_grams.find(strWord.substr(iPos, MAX_GRAM));
+      if (it == m_grams.end())
+        return;
+      if (!rarest || it->second.size() < rarest->size())
+        rarest = &it->second;
+    }
+
+    for (Postings::const_iterator it = rarest->begin(); it != rarest->end(); ++it)
+    {
+      if (m_vocabulary[*it].find(strWord) != std::string::npos)
+        words.push_back(*it);
+    }
+  }
+
+  for (Postings::const_iterator it = words.begin(); it != words.end(); ++it)
+    candidates.insert(candidates.end(), m_words[*it].begin(), m_words[*it].end());
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
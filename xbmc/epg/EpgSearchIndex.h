@@ -0,0 +1,74 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "EpgInfoTag.h"
+
+class CTextSearch;
+
+namespace EPG
+{
+  struct EpgSearchFilter;
+
+  /** Inverted word and genre index over the tags of one EPG table */
+
+  class CEpgSearchIndex
+  {
+  public:
+    /*!
+     * @brief Build the index.
+     * @param tags The tags to index. Candidates are returned as positions in this vector.
+     */
+    CEpgSearchIndex(const std::vector<CEpgInfoTagPtr> &tags);
+
+    /*!
+     * @brief Get the tags that might match the search term and genre of a filter.
+     *
+     * A tag that matches the filter is always a candidate, but candidates still have to be
+     * checked with the filter itself.
+     * @param filter The filter to get the candidates for.
+     * @param candidates The positions of the candidates, in ascending order.
+     * @return False if the filter can't be narrowed down by the index and all tags have to be checked.
+     */
+    bool GetCandidates(const EpgSearchFilter &filter, std::vector<unsigned int> &candidates) const;
+
+  private:
+    typedef std::vector<unsigned int> Postings;
+
+    void AddText(const std::string &strText, unsigned int iTag);
+    void AddGrams(const std::string &strWord, unsigned int iWord);
+    bool GetSearchCandidates(const CTextSearch &search, Postings &candidates) const;
+    bool GetGenreCandidates(const EpgSearchFilter &filter, Postings &candidates) const;
+    bool GetTermCandidates(const std::string &strTerm, Postings &candidates) const;
+    void GetWordCandidates(const std::string &strWord, Postings &candidates) const;
+
+    std::map<std::string, unsigned int> m_wordIds; /*!< lower case word -> position in m_words */
+    std::vector<Postings> m_words;                 /*!< positions of the tags containing each word */
+    std::vector<std::string> m_vocabulary;         /*!< the words, in the order of m_words */
+    std::unordered_map<std::string, Postings> m_grams; /*!< substrings of up to three bytes -> positions of the words containing them */
+    std::map<int, Postings> m_genres;              /*!< genre type -> positions of the tags with that genre */
+    Postings m_unknownGenres;                      /*!< positions of the tags with a genre type outside of the known range */
+  };
+}
@@ -18,6 +18,7 @@
  *
  */
 
+#include <algorithm>
 #include <assert.h>
 #include <tinyxml.h>
 
@@ -48,6 +49,20 @@ using namespace EPG;
 #define BLOCKJUMP    4 // how many blocks are jumped with each analogue scroll action
 #define BLOCK_SCROLL_OFFSET 60 / MINSPERBLOCK // how many blocks are jumped if we are at left/right edge of grid
 
+// index of the first block starting at or after the given offset (in seconds) from the grid start
+static int BlockCeil(time_t offset)
+{
+  const time_t blockSecs = MINSPERBLOCK * 60;
+  if (offset <= 0)
+    return -(int)(-offset / blockSecs);
+  return (int)((offset + blockSecs - 1) / blockSecs);
+}
+
+static bool CompareStartBlock(int block, const GridItemsPtr &item)
+{
+  return block < item.startBlock;
+}
+
 CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID, int controlID, float posX, float posY, float width,
                                            float height, int scrollTime, int preloadItems, int timeBlocks, int rulerUnit,
                                            const CTextureInfo& progressIndicatorTexture)
@@ -429,26 +444,27 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
     int block = blockOffset;
     float posA2 = posA;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
+    const GridItemsPtr *first = GetGridItem(channel, block);
+    if (first && first->startBlock < blockOffset)
     {
       /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (startBlock >= 0 && m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
+      block = first->startBlock;
       int missingSection = blockOffset - block;
       posA2 -= missingSection * m_blockSize;
     }
 
+    CGUIListItemPtr focusedChannelItem;
+    if (channel == m_channelOffset + m_channelCursor)
+      focusedChannelItem = GetBlockItem(channel, m_blockOffset + m_blockCursor);
+
     while (posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
-      if (!item || !item.get()->IsFileItem())
+      GridItemsPtr *gridItem = GetGridItem(channel, block);
+      if (!gridItem || !gridItem->item || !gridItem->item->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      CGUIListItemPtr item = gridItem->item;
+      bool focused = focusedChannelItem && item == focusedChannelItem;
 
       // calculate the size to truncate if item is out of grid view
       float truncateSize = 0;
@@ -461,14 +477,14 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
       {
         CSingleLock lock(m_critSection);
         // truncate item's width
-        m_gridIndex[channel][block].width = m_gridIndex[channel][block].originWidth - truncateSize;
+        gridItem->width = gridItem->originWidth - truncateSize;
       }
 
-      ProcessItem(posA2, posB, item.get(), m_lastChannel, focused, m_programmeLayout, m_focusedProgrammeLayout, currentTime, dirtyregions, m_gridIndex[channel][block].width);
+      ProcessItem(posA2, posB, item.get(), m_lastChannel, focused, m_programmeLayout, m_focusedProgrammeLayout, currentTime, dirtyregions, gridItem->width);
 
       // increment our X position
-      posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-      block += MathUtils::round_int(m_gridIndex[channel][block].originWidth / m_blockSize);
+      posA2 += gridItem->width; // assumes focused & unfocused layouts have equal length
+      block = gridItem->endBlock + 1;
     }
 
     // increment our Y position
@@ -515,26 +531,27 @@ void CGUIEPGGridContainer::RenderProgrammeGrid()
     int block = blockOffset;
     float posA2 = posA;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
+    const GridItemsPtr *first = GetGridItem(channel, block);
+    if (first && first->startBlock < blockOffset)
     {
       /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (startBlock >= 0 && m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
+      block = first->startBlock;
       int missingSection = blockOffset - block;
       posA2 -= missingSection * m_blockSize;
     }
 
+    CGUIListItemPtr focusedChannelItem;
+    if (channel == m_channelOffset + m_channelCursor)
+      focusedChannelItem = GetBlockItem(channel, m_blockOffset + m_blockCursor);
+
     while (posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
-      if (!item || !item.get()->IsFileItem())
+      GridItemsPtr *gridItem = GetGridItem(channel, block);
+      if (!gridItem || !gridItem->item || !gridItem->item->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      CGUIListItemPtr item = gridItem->item;
+      bool focused = focusedChannelItem && item == focusedChannelItem;
 
       // reset to grid start position if first item is out of grid view
       if (posA2 < posA)
@@ -553,8 +570,8 @@ void CGUIEPGGridContainer::RenderProgrammeGrid()
       }
 
       // increment our X position
-      posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-      block += MathUtils::round_int(m_gridIndex[channel][block].originWidth / m_blockSize);
+      posA2 += gridItem->width; // assumes focused & unfocused layouts have equal length
+      block = gridItem->endBlock + 1;
     }
 
     // increment our Y position
@@ -888,12 +905,7 @@ void CGUIEPGGridContainer::UpdateItems(CFileItemList *items)
     m_epgItemsPtr.push_back(itemsPointer);
   }
 
-  m_gridIndex.reserve(m_channelItems.size());
-  for (unsigned int i = 0; i < m_channelItems.size(); i++)
-  {
-    std::vector<GridItemsPtr> blocks(MAXBLOCKS);
-    m_gridIndex.push_back(blocks);
-  }
+  m_gridIndex.resize(m_channelItems.size());
 
   FreeItemsMemory();
   UpdateLayout();
@@ -926,89 +938,50 @@ void CGUIEPGGridContainer::UpdateItems(CFileItemList *items)
   if (m_blocks >= MAXBLOCKS)
     m_blocks = MAXBLOCKS;
 
-  CDateTimeSpan blockDuration;
-  blockDuration.SetDateTimeSpan(0, 0, MINSPERBLOCK, 0);
+  time_t gridStart;
+  m_gridStart.GetAsTime(gridStart);
 
   long tick(XbmcThreads::SystemClockMillis());
 
   for (unsigned int row = 0; row < m_epgItemsPtr.size(); ++row)
   {
-    CDateTime gridCursor      = m_gridStart; //reset cursor for new channel
     unsigned long progIdx     = m_epgItemsPtr[row].start;
     unsigned long lastIdx     = m_epgItemsPtr[row].stop;
     const CEpgInfoTagPtr info = m_programmeItems[progIdx]->GetEPGInfoTag();
     int iEpgId                = info ? info->EpgID() : -1;
+    int nextBlock             = 0; // first block not yet covered by a programme or gap
 
-    /** FOR EACH BLOCK **********************************************************************/
+    /** FOR EACH PROGRAMME ******************************************************************/
 
-    for (int block = 0; block < m_blocks; block++)
+    for (; progIdx <= lastIdx && nextBlock < m_blocks; progIdx++)
     {
-      while (progIdx <= lastIdx)
-      {
-        CFileItemPtr item = m_programmeItems[progIdx];
-        const CEpgInfoTagPtr tag(item->GetEPGInfoTag());
-        if (!tag)
-        {
-          progIdx++;
-          continue;
-        }
-
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
+      CFileItemPtr item = m_programmeItems[progIdx];
+      const CEpgInfoTagPtr tag(item->GetEPGInfoTag());
+      if (!tag)
+        continue;
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[row][block].item = item;
-          break;
-        }
-        
-        progIdx++;
-      }
+      if (tag->EpgID() != iEpgId || m_gridEnd <= tag->StartAsUTC())
+        break;
 
-      gridCursor += blockDuration;
+      // a programme covers every block whose start time lies within [start, end)
+      time_t start, end;
+      tag->StartAsUTC().GetAsTime(start);
+      tag->EndAsUTC().GetAsTime(end);
+      int startBlock = std::max(nextBlock, BlockCeil(start - gridStart));
+      int endBlock   = std::min(m_blocks, BlockCeil(end - gridStart)) - 1;
+      if (startBlock > endBlock)
+        continue; // shorter than a block or already covered by the previous programme
+
+      if (startBlock > nextBlock)
+        AppendGridItem(row, CreateGapItem(row), nextBlock, startBlock - 1);
+
+      item->SetProperty("GenreType", tag->GenreType());
+      AppendGridItem(row, item, startBlock, endBlock);
+      nextBlock = endBlock + 1;
     }
 
-    /** FOR EACH BLOCK **********************************************************************/
-    int itemSize = 1; // size of the programme in blocks
-    int savedBlock = 0;
-
-    for (int block = 0; block < m_blocks; block++)
-    {
-      CFileItemPtr item = m_gridIndex[row][block].item;
-
-      if ((item != m_gridIndex[row][block+1].item) || (!item && block == m_blocks - 1))
-      {
-        if (!item)
-        {
-          CEpgInfoTagPtr gapTag(CEpgInfoTag::CreateDefaultTag());
-          gapTag->SetPVRChannel(m_channelItems[row]->GetPVRChannelInfoTag());
-          CFileItemPtr gapItem(new CFileItem(gapTag));
-          for (int i = block ; i > block - itemSize; i--)
-          {
-            m_gridIndex[row][i].item = gapItem;
-          }
-        }
-        else
-        {
-          const CEpgInfoTagPtr tag(item->GetEPGInfoTag());
-          if (tag)
-            m_gridIndex[row][savedBlock].item->SetProperty("GenreType", tag->GenreType());
-        }
-
-        m_gridIndex[row][savedBlock].originWidth = itemSize*m_blockSize;
-        m_gridIndex[row][savedBlock].originHeight = m_channelHeight;
-
-        m_gridIndex[row][savedBlock].width = m_gridIndex[row][savedBlock].originWidth;
-        m_gridIndex[row][savedBlock].height = m_gridIndex[row][savedBlock].originHeight;
-
-        itemSize = 1;
-        savedBlock = block+1;
-      }
-      else
-      {
-        itemSize++;
-      }
-    }
+    if (nextBlock < m_blocks)
+      AppendGridItem(row, CreateGapItem(row), nextBlock, m_blocks - 1);
   }
 
   /******************************************* END ******************************************/
@@ -1153,7 +1126,7 @@ void CGUIEPGGridContainer::OnLeft()
   if (!m_gridIndex.empty() && m_item)
   {
     if (m_channelCursor + m_channelOffset >= 0 && m_blockOffset >= 0 &&
-        m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blockOffset].item)
+        m_item->item != GetBlockItem(m_channelCursor + m_channelOffset, m_blockOffset))
     {
       // this is not first item on page
       m_item = GetPrevItem(m_channelCursor);
@@ -1178,7 +1151,7 @@ void CGUIEPGGridContainer::OnRight()
 {
   if (!m_gridIndex.empty() && m_item)
   {
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blocksPerPage + m_blockOffset - 1].item)
+    if (m_item->item != GetBlockItem(m_channelCursor + m_channelOffset, m_blocksPerPage + m_blockOffset - 1))
     {
       // this is not last item on page
       m_item = GetNextItem(m_channelCursor);
@@ -1301,7 +1274,7 @@ bool CGUIEPGGridContainer::SelectItemFromPoint(const CPoint &point, bool justGri
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return false;
   // bail if block isn't occupied
-  if (!m_gridIndex[channelIndex][blockIndex].item)
+  if (!GetBlockItem(channelIndex, blockIndex))
     return false;
 
   SetChannel(channel);
@@ -1489,7 +1462,7 @@ int CGUIEPGGridContainer::GetSelectedItem() const
       m_blockCursor + m_blockOffset >= m_blocks)
     return -1;
 
-  CGUIListItemPtr currentItem = m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item;
+  CGUIListItemPtr currentItem = GetBlockItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset);
   if (!currentItem)
     return -1;
 
@@ -1514,7 +1487,7 @@ CFileItemPtr CGUIEPGGridContainer::GetSelectedChannelItem() const
       !m_epgItemsPtr.empty() &&
       m_channelCursor + m_channelOffset < m_channels &&
       m_blockCursor + m_blockOffset < m_blocks)
-    item = m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item;
+    item = GetBlockItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset);
 
   return item;
 }
@@ -1528,7 +1501,7 @@ CEpgInfoTagPtr CGUIEPGGridContainer::GetSelectedEpgInfoTag() const
       m_channelCursor + m_channelOffset < m_channels &&
       m_blockCursor + m_blockOffset < m_blocks)
   {
-    CFileItemPtr currentItem(m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item);
+    CFileItemPtr currentItem(GetBlockItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset));
     if (currentItem)
       tag = currentItem->GetEPGInfoTag();
   }
@@ -1538,14 +1511,18 @@ CEpgInfoTagPtr CGUIEPGGridContainer::GetSelectedEpgInfoTag() const
 
 int CGUIEPGGridContainer::GetBlock(const CEpgInfoTagPtr &tag, int channel) const
 {
-  for (int block = 0; block < m_blocks; ++block)
+  int channelIndex = channel + m_channelOffset;
+  if (channelIndex < 0 || channelIndex >= (int)m_gridIndex.size())
+    return -1;
+
+  const std::vector<GridItemsPtr> &items = m_gridIndex[channelIndex];
+  for (std::vector<GridItemsPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
   {
-    CFileItemPtr item = m_gridIndex[channel + m_channelOffset][block].item;
-    if (item)
+    if (it->item)
     {
-      CEpgInfoTagPtr currentTag(item->GetEPGInfoTag());
+      CEpgInfoTagPtr currentTag(it->item->GetEPGInfoTag());
       if (currentTag == tag)
-        return (block - m_blockOffset >= 0) ? block - m_blockOffset : 0;
+        return (it->startBlock - m_blockOffset >= 0) ? it->startBlock - m_blockOffset : 0;
     }
   }
 
@@ -1557,14 +1534,14 @@ int CGUIEPGGridContainer::GetChannel(const CEpgInfoTagPtr &tag) const
   if (tag->HasPVRChannel())
   {
     int channelId = tag->ChannelTag()->ChannelID();
-    for (int row = 0; row < m_channels; ++row)
+    for (int row = 0; row < m_channels && row < (int)m_gridIndex.size(); ++row)
     {
-      for (int block = 0; block < m_blocks; ++block)
+      const std::vector<GridItemsPtr> &items = m_gridIndex[row];
+      for (std::vector<GridItemsPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
       {
-        CFileItemPtr item = m_gridIndex[row][block].item;
-        if (item)
+        if (it->item)
         {
-          CEpgInfoTagPtr currentTag(item->GetEPGInfoTag());
+          CEpgInfoTagPtr currentTag(it->item->GetEPGInfoTag());
           if (currentTag->HasPVRChannel()) // Take care. Gap tags have no channel.
           {
             if (currentTag->ChannelTag()->ChannelID() == channelId)
@@ -1655,9 +1632,9 @@ GridItemsPtr *CGUIEPGGridContainer::GetClosestItem(const int &channel)
   }
 
   if (right <= SHORTGAP && right <= left && m_blockCursor + right < m_blocksPerPage)
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + right + m_blockOffset];
+    return GetGridItem(channel + m_channelOffset, m_blockCursor + right + m_blockOffset);
 
-  return &m_gridIndex[channel + m_channelOffset][m_blockCursor - left  + m_blockOffset];
+  return GetGridItem(channel + m_channelOffset, m_blockCursor - left + m_blockOffset);
 }
 
 int CGUIEPGGridContainer::GetItemSize(GridItemsPtr *item)
@@ -1679,12 +1656,17 @@ int CGUIEPGGridContainer::GetBlock(const CGUIListItemPtr &item, const int &chann
 int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, const int &channel)
 {
   int channelIndex = channel + m_channelOffset;
-  int block = 0;
+  if (channelIndex < 0 || channelIndex >= (int)m_gridIndex.size())
+    return m_blocks;
 
-  while (m_gridIndex[channelIndex][block].item != item && block < m_blocks)
-    block++;
+  const std::vector<GridItemsPtr> &items = m_gridIndex[channelIndex];
+  for (std::vector<GridItemsPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
+  {
+    if (it->item == item)
+      return it->startBlock;
+  }
 
-  return block;
+  return m_blocks;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
@@ -1694,12 +1676,13 @@ GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  int i = m_blockCursor;
-
-  while (i < m_blocksPerPage && m_gridIndex[channelIndex][i + m_blockOffset].item == m_gridIndex[channelIndex][blockIndex].item)
-    i++;
+  GridItemsPtr *current = GetGridItem(channelIndex, blockIndex);
+  if (!current)
+    return NULL;
 
-  return &m_gridIndex[channelIndex][i + m_blockOffset];
+  // the item following the current one, or the one at the page edge if the current one runs past it
+  GridItemsPtr *next = GetGridItem(channelIndex, std::min(current->endBlock + 1, m_blocksPerPage + m_blockOffset));
+  return next ? next : current;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
@@ -1709,12 +1692,12 @@ GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  int i = m_blockCursor;
-
-  while (i > 0 && m_gridIndex[channelIndex][i + m_blockOffset].item == m_gridIndex[channelIndex][blockIndex].item)
-    i--;
+  GridItemsPtr *current = GetGridItem(channelIndex, blockIndex);
+  if (!current)
+    return NULL;
 
-  return &m_gridIndex[channelIndex][i + m_blockOffset];
+  // the item preceding the current one, or the current one if it starts before the page
+  return GetGridItem(channelIndex, std::max(current->startBlock - 1, m_blockOffset));
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
@@ -1724,7 +1707,56 @@ GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  return &m_gridIndex[channelIndex][blockIndex];
+  return GetGridItem(channelIndex, blockIndex);
+}
+
+GridItemsPtr *CGUIEPGGridContainer::GetGridItem(int channel, int block)
+{
+  return const_cast<GridItemsPtr *>(static_cast<const CGUIEPGGridContainer *>(this)->GetGridItem(channel, block));
+}
+
+const GridItemsPtr *CGUIEPGGridContainer::GetGridItem(int channel, int block) const
+{
+  if (channel < 0 || channel >= (int)m_gridIndex.size() || block < 0 || block >= m_blocks)
+    return NULL;
+
+  // items are sorted by start block and don't overlap, so the candidate is the last one starting at or before block
+  const std::vector<GridItemsPtr> &items = m_gridIndex[channel];
+  std::vector<GridItemsPtr>::const_iterator it = std::upper_bound(items.begin(), items.end(), block, CompareStartBlock);
+  if (it == items.begin())
+    return NULL;
+
+  --it;
+  if (block > it->endBlock)
+    return NULL;
+
+  return &(*it);
+}
+
+CFileItemPtr CGUIEPGGridContainer::GetBlockItem(int channel, int block) const
+{
+  const GridItemsPtr *gridItem = GetGridItem(channel, block);
+  return gridItem ? gridItem->item : CFileItemPtr();
+}
+
+void CGUIEPGGridContainer::AppendGridItem(int channel, const CFileItemPtr &item, int startBlock, int endBlock)
+{
+  GridItemsPtr gridItem;
+  gridItem.item         = item;
+  gridItem.originWidth  = (endBlock - startBlock + 1) * m_blockSize;
+  gridItem.originHeight = m_channelHeight;
+  gridItem.width        = gridItem.originWidth;
+  gridItem.height       = gridItem.originHeight;
+  gridItem.startBlock   = startBlock;
+  gridItem.endBlock     = endBlock;
+  m_gridIndex[channel].push_back(gridItem);
+}
+
+CFileItemPtr CGUIEPGGridContainer::CreateGapItem(int channel) const
+{
+  CEpgInfoTagPtr gapTag(CEpgInfoTag::CreateDefaultTag());
+  gapTag->SetPVRChannel(m_channelItems[channel]->GetPVRChannelInfoTag());
+  return CFileItemPtr(new CFileItem(gapTag));
 }
 
 void CGUIEPGGridContainer::SetFocus(bool focus)
@@ -1890,10 +1922,10 @@ void CGUIEPGGridContainer::ClearGridIndex(void)
 {
   for (unsigned int i = 0; i < m_gridIndex.size(); i++)
   {
-    for (int block = 0; block < m_blocks; block++)
+    for (unsigned int j = 0; j < m_gridIndex[i].size(); j++)
     {
-      if (m_gridIndex[i][block].item)
-        m_gridIndex[i][block].item.get()->ClearProperties();
+      if (m_gridIndex[i][j].item)
+        m_gridIndex[i][j].item.get()->ClearProperties();
     }
     m_gridIndex[i].clear();
   }
@@ -1927,13 +1959,12 @@ void CGUIEPGGridContainer::GoToEnd()
   int blocksEnd = 0;   // the end block of the last epg element for the selected channel
   int blocksStart = 0; // the start block of the last epg element for the selected channel
   int blockOffset = 0; // the block offset to scroll to
-  for (int blockIndex = m_blocks; blockIndex >= 0 && (!blocksEnd || !blocksStart); blockIndex--)
+  int channelIndex = m_channelCursor + m_channelOffset;
+  if (channelIndex >= 0 && channelIndex < (int)m_gridIndex.size() && !m_gridIndex[channelIndex].empty())
   {
-    if (!blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item != NULL)
-      blocksEnd = blockIndex;
-    if (blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blocksEnd].item != 
-                     m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item)
-      blocksStart = blockIndex + 1;
+    const GridItemsPtr &last = m_gridIndex[channelIndex].back();
+    blocksEnd   = last.endBlock;
+    blocksStart = last.startBlock;
   }
   if (blocksEnd - blocksStart > m_blocksPerPage)
     blockOffset = blocksStart;
@@ -1964,7 +1995,7 @@ void CGUIEPGGridContainer::GoToNow()
       if (offset + blockIndex >= m_blocks)
         break;
 
-      const CFileItemPtr item = m_gridIndex[m_channelCursor + m_channelOffset][offset + blockIndex].item;
+      const CFileItemPtr item = GetBlockItem(m_channelCursor + m_channelOffset, offset + blockIndex);
       if (item)
       {
         const CEpgInfoTagPtr tag = item->GetEPGInfoTag();
@@ -2147,40 +2178,36 @@ void CGUIEPGGridContainer::FreeProgrammeMemory(int channel, int keepStart, int k
 {
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
+    // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
+    // but each index entry holds a whole item, so items partially visible at keepStart/keepEnd are skipped
     if (keepStart > 0 && keepStart < m_blocks)
     {
-      // if item exist and block is not part of visible item
-      CGUIListItemPtr last = m_gridIndex[channel][keepStart].item;
-      for (int i = keepStart - 1 ; i > 0 ; i--)
+      const GridItemsPtr *keep = GetGridItem(channel, keepStart);
+      if (keep)
       {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
+        CSingleLock lock(m_critSection);
+        const std::vector<GridItemsPtr> &items = m_gridIndex[channel];
+        size_t keepIndex = keep - &items[0];
+        for (size_t i = 0; i < keepIndex; ++i)
         {
-          CSingleLock lock(m_critSection);
-
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that ocupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
+          if (items[i].item)
+            items[i].item->FreeMemory();
         }
       }
     }
 
     if (keepEnd > 0 && keepEnd < m_blocks)
     {
-      CGUIListItemPtr last = m_gridIndex[channel][keepEnd].item;
-      for (int i = keepEnd + 1 ; i < m_blocks ; i++)
+      const GridItemsPtr *keep = GetGridItem(channel, keepEnd);
+      if (keep)
       {
-        // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
+        CSingleLock lock(m_critSection);
+        const std::vector<GridItemsPtr> &items = m_gridIndex[channel];
+        size_t keepIndex = keep - &items[0];
+        for (size_t i = keepIndex + 1; i < items.size(); ++i)
         {
-          CSingleLock lock(m_critSection);
-
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that ocupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
+          if (items[i].item)
+            items[i].item->FreeMemory();
         }
       }
     }
@@ -37,6 +37,8 @@ namespace EPG
     float originHeight;
     float width;
     float height;
+    int startBlock; //! first block covered by the item
+    int endBlock;   //! last block covered by the item
   };
 
   class CGUIEPGGridContainer : public IGUIContainer
@@ -108,7 +110,12 @@ namespace EPG
     void UpdateLayout();
     void Reset();
     void ClearGridIndex(void);
+    void AppendGridItem(int channel, const CFileItemPtr &item, int startBlock, int endBlock);
+    CFileItemPtr CreateGapItem(int channel) const;
 
+    GridItemsPtr *GetGridItem(int channel, int block);
+    const GridItemsPtr *GetGridItem(int channel, int block) const;
+    CFileItemPtr GetBlockItem(int channel, int block) const;
     GridItemsPtr *GetItem(const int &channel);
     GridItemsPtr *GetNextItem(const int &channel);
     GridItemsPtr *GetPrevItem(const int &channel);
@@ -214,7 +221,7 @@ namespace EPG
 
     CGUITexture m_guiProgressIndicatorTexture;
 
-    std::vector<std::vector<GridItemsPtr> > m_gridIndex;
+    std::vector<std::vector<GridItemsPtr> > m_gridIndex; //! per channel, one entry per programme or gap, sorted by start block
     GridItemsPtr *m_item;
     CGUIListItem *m_lastItem;
     CGUIListItem *m_lastChannel;
@@ -0,0 +1,497 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AdaptiveCache.h"
+#include "IFile.h"
+#include "SpecialProtocol.h"
+#include "URL.h"
+#include "Util.h"
+#include "cores/DataCacheCore.h"
+#include "posix/PosixFile.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <new>
+#include <string.h>
+
+#define CacheLocalFile CPosixFile
+
+#define ADAPTIVE_BLOCK_SIZE     (512 * 1024)
+#define ADAPTIVE_FRONT_MIN      (4 * 1024 * 1024)
+#define ADAPTIVE_BACK_MIN       (1 * 1024 * 1024)
+#define ADAPTIVE_BACK_SECONDS   10
+#define ADAPTIVE_PUBLISH_MSEC   1000
+
+using namespace XFILE;
+
+CAdaptiveCache::CAdaptiveCache(size_t memory, size_t limit)
+ : CCacheStrategy()
+ , m_beg(0)
+ , m_end(0)
+ , m_cur(0)
+ , m_memory(memory)
+ , m_limit(std::max(memory, limit))
+ , m_memoryUsed(0)
+ , m_spillUsed(0)
+ , m_front(memory - memory / 4)
+ , m_back(memory / 4)
+ , m_streamRate(0)
+ , m_linkRate(0)
+ , m_spill(false)
+ , m_publish(false)
+ , m_published(false)
+ , m_publishTime(0)
+ , m_spillRead(NULL)
+ , m_spillWrite(NULL)
+ , m_spillFailed(false)
+ , m_spillEnd(0)
+{
+}
+
+CAdaptiveCache::~CAdaptiveCache()
+{
+  Close();
+}
+
+int CAdaptiveCache::Open()
+{
+  CSingleLock lock(m_sync);
+  Clear();
+  m_beg = 0;
+  m_end = 0;
+  m_cur = 0;
+  m_spillFailed = false;
+  return CACHE_RC_OK;
+}
+
+void CAdaptiveCache::Close()
+{
+  CSingleLock lock(m_sync);
+  Clear();
+  CloseSpill();
+
+  if (m_published)
+  {
+    g_dataCacheCore.SetFileCacheInfo(SFileCacheInfo());
+    m_published = false;
+  }
+}
+
+size_t CAdaptiveCache::GetMaxWriteSize(const size_t& iRequestSize)
+{
+  CSingleLock lock(m_sync);
+  DropBlocks();
+
+  int64_t front = m_end - m_cur;
+  if (front >= m_front)
+    return 0;
+
+  return std::min(std::min(iRequestSize, (size_t)(m_front - front)), Capacity());
+}
+
+int CAdaptiveCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+  DropBlocks();
+
+  // limit by the forward window
+  int64_t front = m_end - m_cur;
+  if (front >= m_front)
+    return 0;
+  if ((int64_t)len > m_front - front)
+    len = (size_t)(m_front - front);
+
+  size_t written = 0;
+  while (written < len)
+  {
+    size_t offset = (size_t)(m_end - m_beg);
+    size_t index  = offset / ADAPTIVE_BLOCK_SIZE;
+    size_t inner  = offset % ADAPTIVE_BLOCK_SIZE;
+
+    if (index == m_blocks.size() && !AddBlock())
+      break;
+
+    size_t size = std::min(len - written, (size_t)ADAPTIVE_BLOCK_SIZE - inner);
+    Block &block = m_blocks[index];
+    if (block.data)
+      memcpy(block.data + inner, buf + written, size);
+    else if (m_spillWrite->Seek(block.spill + inner, SEEK_SET) != block.spill + (int64_t)inner ||
+             m_spillWrite->Write(buf + written, size) != (ssize_t)size)
+    {
+      CLog::Log(LOGERROR, "CAdaptiveCache::%s - failed to write to spill file", __FUNCTION__);
+      if (written == 0)
+        return CACHE_RC_ERROR;
+      break;
+    }
+
+    m_end += size;
+    written += size;
+  }
+
+  if (written > 0)
+    m_written.Set();
+
+  return (int)written;
+}
+
+int CAdaptiveCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  int64_t front = m_end - m_cur;
+  if (front == 0)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  size_t offset = (size_t)(m_cur - m_beg);
+  size_t index  = offset / ADAPTIVE_BLOCK_SIZE;
+  size_t inner  = offset % ADAPTIVE_BLOCK_SIZE;
+
+  // only read up till the end of the block
+  len = std::min(std::min(len, (size_t)front), (size_t)ADAPTIVE_BLOCK_SIZE - inner);
+  if (len == 0)
+    return 0;
+
+  Block &block = m_blocks[index];
+  if (block.data)
+    memcpy(buf, block.data + inner, len);
+  else if (m_spillRead->Seek(block.spill + inner, SEEK_SET) != block.spill + (int64_t)inner ||
+           m_spillRead->Read(buf, len) != (ssize_t)len)
+  {
+    CLog::Log(LOGERROR, "CAdaptiveCache::%s - failed to read from spill file", __FUNCTION__);
+    return CACHE_RC_ERROR;
+  }
+
+  m_cur += len;
+  DropBlocks();
+
+  m_space.Set();
+
+  return (int)len;
+}
+
+int64_t CAdaptiveCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = m_end - m_cur;
+
+  if(millis == 0 || IsEndOfInput())
+    return avail;
+
+  if((int64_t)minimum > m_front)
+    minimum = (unsigned int)m_front;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast() )
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = m_end - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CAdaptiveCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we have, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000)
+  {
+    // everything cached becomes back data, which frees the forward window
+    m_cur = m_end;
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  if(pos >= m_beg && pos <= m_end)
+  {
+    m_cur = pos;
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+bool CAdaptiveCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+  if (!clearAnyway && IsCachedPosition(pos))
+  {
+    m_cur = pos;
+    return false;
+  }
+
+  Clear();
+  m_end = pos;
+  m_beg = pos;
+  m_cur = pos;
+
+  return true;
+}
+
+int64_t CAdaptiveCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  if (IsCachedPosition(iFilePosition))
+    return m_end;
+  return iFilePosition;
+}
+
+int64_t CAdaptiveCache::CachedDataEndPos()
+{
+  return m_end;
+}
+
+bool CAdaptiveCache::IsCachedPosition(int64_t iFilePosition)
+{
+  return iFilePosition >= m_beg && iFilePosition <= m_end;
+}
+
+CCacheStrategy *CAdaptiveCache::CreateNew()
+{
+  return new CAdaptiveCache(m_memory, m_limit);
+}
+
+void CAdaptiveCache::SetPublish(bool publish)
+{
+  CSingleLock lock(m_sync);
+  m_publish = publish;
+  if (!m_publish && m_published)
+  {
+    g_dataCacheCore.SetFileCacheInfo(SFileCacheInfo());
+    m_published = false;
+  }
+}
+
+void CAdaptiveCache::SetRates(unsigned streamRate, unsigned linkRate)
+{
+  CSingleLock lock(m_sync);
+  m_streamRate = streamRate;
+  m_linkRate = linkRate;
+
+  if (m_streamRate > 0)
+  {
+    int64_t stream = m_streamRate;
+
+    // the less headroom the link has over the stream, the longer it takes to
+    // refill after a stall, so the deeper the forward window has to be.
+    // a link with headroom refills memory long before it drains, only one
+    // that is measured to barely keep up gets to spill to disk
+    int seconds;
+    if (m_linkRate >= 4 * stream)
+      seconds = 20;
+    else if (m_linkRate >= 2 * stream)
+      seconds = 40;
+    else
+      seconds = 90;
+    m_spill = m_linkRate > 0 && m_linkRate < 2 * stream;
+
+    int64_t limit = m_spill ? m_limit : m_memory;
+    m_back  = std::max((int64_t)ADAPTIVE_BACK_MIN, std::min(stream * ADAPTIVE_BACK_SECONDS, limit / 4));
+    m_back  = std::min(m_back, limit / 4);
+    m_front = std::max((int64_t)ADAPTIVE_FRONT_MIN, stream * seconds);
+    m_front = std::min(m_front, limit - m_back);
+
+    DropBlocks();
+  }
+
+  unsigned now = XbmcThreads::SystemClockMillis();
+  if (m_publish && (!m_published || now - m_publishTime >= ADAPTIVE_PUBLISH_MSEC))
+  {
+    Publish();
+    m_publishTime = now;
+    m_published = true;
+  }
+}
+
+int64_t CAdaptiveCache::GetForwardSize()
+{
+  CSingleLock lock(m_sync);
+  return m_front;
+}
+
+bool CAdaptiveCache::AddBlock()
+{
+  Block block;
+  block.data = NULL;
+  block.spill = 0;
+
+  if (m_memoryUsed + ADAPTIVE_BLOCK_SIZE <= m_memory)
+  {
+    block.data = new (std::nothrow) uint8_t[ADAPTIVE_BLOCK_SIZE];
+    if (block.data)
+    {
+      m_memoryUsed += ADAPTIVE_BLOCK_SIZE;
+      m_blocks.push_back(block);
+      return true;
+    }
+    CLog::Log(LOGWARNING, "CAdaptiveCache::%s - out of memory", __FUNCTION__);
+  }
+
+  if (!m_spill || m_memoryUsed + m_spillUsed + ADAPTIVE_BLOCK_SIZE > m_limit)
+    return false;
+
+  if (!m_spillWrite && !OpenSpill())
+    return false;
+
+  if (!m_spillFree.empty())
+  {
+    block.spill = m_spillFree.back();
+    m_spillFree.pop_back();
+  }
+  else
+  {
+    block.spill = m_spillEnd;
+    m_spillEnd += ADAPTIVE_BLOCK_SIZE;
+  }
+
+  m_spillUsed += ADAPTIVE_BLOCK_SIZE;
+  m_blocks.push_back(block);
+  return true;
+}
+
+void CAdaptiveCache::DropBlocks()
+{
+  bool dropped = false;
+
+  // release blocks that fell entirely out of the backward window
+  while (!m_blocks.empty() && m_cur - (m_beg + ADAPTIVE_BLOCK_SIZE) >= m_back)
+  {
+    Block &block = m_blocks.front();
+    if (block.data)
+    {
+      delete[] block.data;
+      m_memoryUsed -= ADAPTIVE_BLOCK_SIZE;
+    }
+    else
+    {
+      m_spillFree.push_back(block.spill);
+      m_spillUsed -= ADAPTIVE_BLOCK_SIZE;
+    }
+
+    m_blocks.pop_front();
+    m_beg += ADAPTIVE_BLOCK_SIZE;
+    dropped = true;
+  }
+
+  if (dropped)
+    m_space.Set();
+}
+
+void CAdaptiveCache::Clear()
+{
+  for (std::deque<Block>::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+    delete[] it->data;
+
+  m_blocks.clear();
+  m_memoryUsed = 0;
+  m_spillUsed = 0;
+  m_spillEnd = 0;
+  m_spillFree.clear();
+}
+
+size_t CAdaptiveCache::Capacity()
+{
+  // room left in the last block plus the blocks that may still be added
+  size_t capacity = m_blocks.size() * ADAPTIVE_BLOCK_SIZE - (size_t)(m_end - m_beg);
+  size_t used = m_memoryUsed + m_spillUsed;
+
+  if (m_spillFailed || !m_spill)
+  {
+    if (m_memory > m_memoryUsed)
+      capacity += (m_memory - m_memoryUsed) / ADAPTIVE_BLOCK_SIZE * ADAPTIVE_BLOCK_SIZE;
+  }
+  else if (m_limit > used)
+    capacity += (m_limit - used) / ADAPTIVE_BLOCK_SIZE * ADAPTIVE_BLOCK_SIZE;
+
+  return capacity;
+}
+
+bool CAdaptiveCache::OpenSpill()
+{
+  if (m_spillFailed)
+    return false;
+
+  m_spillName = CSpecialProtocol::TranslatePath(CUtil::GetNextFilename("special://temp/filecache%03d.cache", 999));
+  if (m_spillName.empty())
+  {
+    CLog::Log(LOGERROR, "CAdaptiveCache::%s - unable to generate a new filename", __FUNCTION__);
+    m_spillFailed = true;
+    return false;
+  }
+
+  CURL fileURL(m_spillName);
+  m_spillWrite = new CacheLocalFile();
+  m_spillRead = new CacheLocalFile();
+
+  if (!m_spillWrite->OpenForWrite(fileURL, false) || !m_spillRead->Open(fileURL))
+  {
+    CLog::Log(LOGERROR, "CAdaptiveCache::%s - failed to open spill file \"%s\"", __FUNCTION__, m_spillName.c_str());
+    CloseSpill();
+    m_spillFailed = true;
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "CAdaptiveCache::%s - spilling to \"%s\"", __FUNCTION__, m_spillName.c_str());
+  return true;
+}
+
+void CAdaptiveCache::CloseSpill()
+{
+  if (m_spillWrite)
+  {
+    m_spillWrite->Close();
+    m_spillRead->Close();
+
+    if (!m_spillName.empty() && !m_spillRead->Delete(CURL(m_spillName)))
+      CLog::Log(LOGWARNING, "CAdaptiveCache::%s - failed to delete spill file \"%s\"", __FUNCTION__, m_spillName.c_str());
+  }
+
+  delete m_spillWrite;
+  delete m_spillRead;
+  m_spillWrite = NULL;
+  m_spillRead = NULL;
+  m_spillName.clear();
+}
+
+void CAdaptiveCache::Publish()
+{
+  SFileCacheInfo info;
+  info.valid       = true;
+  info.forward     = m_end - m_cur;
+  info.back        = m_cur - m_beg;
+  info.forwardSize = m_front;
+  info.backSize    = m_back;
+  info.memory      = m_memoryUsed;
+  info.spilled     = m_spillUsed;
+  info.streamRate  = m_streamRate;
+  info.linkRate    = m_linkRate;
+  g_dataCacheCore.SetFileCacheInfo(info);
+}
@@ -0,0 +1,116 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <deque>
+#include <vector>
+
+namespace XFILE {
+
+/*!
+ \brief Cache strategy whose windows follow the stream
+
+ Data is kept in fixed size blocks that are allocated while the forward
+ window fills and released once they fall out of the backward window, so a
+ low bitrate stream only holds what it needs. Both windows are sized from
+ the rate the player reads at and the rate the source delivers, see
+ SetRates. When the link barely keeps up with the stream, blocks that do not
+ fit the memory budget go to a temporary spill file, up to the total limit.
+ */
+class CAdaptiveCache : public CCacheStrategy
+{
+public:
+  /*!
+   \param memory bytes that may be held in memory
+   \param limit total bytes that may be cached, the part above memory is spilled to disk
+   */
+  CAdaptiveCache(size_t memory, size_t limit);
+  virtual ~CAdaptiveCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual size_t GetMaxWriteSize(const size_t& iRequestSize);
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual bool Reset(int64_t pos, bool clearAnyway=true);
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+  virtual void SetRates(unsigned streamRate, unsigned linkRate);
+  virtual int64_t GetForwardSize();
+  virtual void SetPublish(bool publish);
+
+protected:
+  struct Block
+  {
+    uint8_t *data;  // NULL when the block lives in the spill file
+    int64_t  spill; // offset in the spill file
+  };
+
+  bool AddBlock();
+  void DropBlocks();
+  void Clear();
+  size_t Capacity();
+  bool OpenSpill();
+  void CloseSpill();
+  void Publish();
+
+  int64_t            m_beg;         /**< index in file of the first byte of the first block */
+  int64_t            m_end;         /**< index in file of end of valid data */
+  int64_t            m_cur;         /**< current reading index in file */
+  std::deque<Block>  m_blocks;
+
+  size_t             m_memory;      /**< memory budget */
+  size_t             m_limit;       /**< memory plus spill budget */
+  size_t             m_memoryUsed;
+  size_t             m_spillUsed;
+  int64_t            m_front;       /**< forward window */
+  int64_t            m_back;        /**< backward window */
+  unsigned           m_streamRate;
+  unsigned           m_linkRate;
+  bool               m_spill;       /**< the link is too slow for memory alone, blocks may go to disk */
+  bool               m_publish;     /**< this is the cache of the file being played */
+  bool               m_published;   /**< stats were handed to g_dataCacheCore */
+  unsigned           m_publishTime;
+
+  std::string        m_spillName;
+  IFile             *m_spillRead;
+  IFile             *m_spillWrite;
+  bool               m_spillFailed;
+  int64_t            m_spillEnd;
+  std::vector<int64_t> m_spillFree;
+
+  CCriticalSection   m_sync;
+  CEvent             m_written;
+};
+
+} // namespace XFILE
@@ -279,6 +279,7 @@ CDoubleCache::CDoubleCache(CCacheStrategy *impl)
   assert(NULL != impl);
   m_pCache = impl;
   m_pCacheOld = NULL;
+  m_publish = false;
 }
 
 CDoubleCache::~CDoubleCache()
@@ -353,6 +354,7 @@ bool CDoubleCache::Reset(int64_t iSourcePosition, bool clearAnyway)
       delete pCacheNew;
       return m_pCache->Reset(iSourcePosition, clearAnyway);
     }
+    pCacheNew->SetPublish(m_publish);
     bool bRes = pCacheNew->Reset(iSourcePosition, clearAnyway);
     m_pCacheOld = m_pCache;
     m_pCache = pCacheNew;
@@ -403,3 +405,20 @@ CCacheStrategy *CDoubleCache::CreateNew()
   return new CDoubleCache(m_pCache->CreateNew());
 }
 
+void CDoubleCache::SetRates(unsigned streamRate, unsigned linkRate)
+{
+  m_pCache->SetRates(streamRate, linkRate);
+}
+
+int64_t CDoubleCache::GetForwardSize()
+{
+  return m_pCache->GetForwardSize();
+}
+
+void CDoubleCache::SetPublish(bool publish)
+{
+  m_publish = publish;
+  m_pCache->SetPublish(publish);
+  if (m_pCacheOld)
+    m_pCacheOld->SetPublish(publish);
+}
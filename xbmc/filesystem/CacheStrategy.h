@@ -69,6 +69,25 @@ public:
 
   virtual CCacheStrategy *CreateNew() = 0;
 
+  /*!
+   \brief Inform the strategy about the rate the stream is read at and the rate the source delivers
+   \param streamRate bytes per second requested by the reader, 0 if unknown
+   \param linkRate bytes per second measured from the source, 0 if unknown
+   */
+  virtual void SetRates(unsigned streamRate, unsigned linkRate) {}
+
+  /*!
+   \brief Size of the forward window, for strategies that size it themselves
+   \return the window in bytes, or 0 when it is fixed by the caller
+   */
+  virtual int64_t GetForwardSize() { return 0; }
+
+  /*!
+   \brief Allow the strategy to publish its state to g_dataCacheCore
+   Only the cache of the file being played should, any other cache would overwrite its state.
+   */
+  virtual void SetPublish(bool publish) {}
+
   CEvent m_space;
 protected:
   bool  m_bEndOfInput;
@@ -136,9 +155,14 @@ public:
 
   virtual CCacheStrategy *CreateNew();
 
+  virtual void SetRates(unsigned streamRate, unsigned linkRate);
+  virtual int64_t GetForwardSize();
+  virtual void SetPublish(bool publish);
+
 protected:
   CCacheStrategy *m_pCache;
   CCacheStrategy *m_pCacheOld;
+  bool m_publish;
 };
 
 }
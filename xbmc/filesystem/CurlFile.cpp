@@ -27,6 +27,7 @@
 #include "File.h"
 #include "threads/SystemClock.h"
 
+#include <algorithm>
 #include <vector>
 #include <climits>
 #include <cassert>
@@ -52,6 +53,11 @@ using namespace XCURL;
 #define XMIN(a,b) ((a)<(b)?(a):(b))
 #define FITS_INT(a) (((a) <= INT_MAX) && ((a) >= INT_MIN))
 
+// segmented transfers, see CCurlFile::OpenSegmented
+#define SEGMENT_SIZE       (4 * 1024 * 1024)
+#define SEGMENT_MIN_FILE   (64 * 1024 * 1024)
+#define SEGMENT_PERIOD     2000 // ms between adjustments of the segment count
+
 curl_proxytype proxyType2CUrlProxyType[] = {
   CURLPROXY_HTTP,
   CURLPROXY_SOCKS4,
@@ -107,6 +113,17 @@ extern "C" size_t write_callback(char *buffer,
   return state->WriteCallback(buffer, size, nitems);
 }
 
+extern "C" size_t segment_write_callback(char *buffer,
+               size_t size,
+               size_t nitems,
+               void *userp)
+{
+  if(userp == NULL) return 0;
+
+  CCurlFile::CSegment *segment = (CCurlFile::CSegment *)userp;
+  return segment->WriteCallback(buffer, size, nitems);
+}
+
 extern "C" size_t read_callback(char *buffer,
                size_t size,
                size_t nitems,
@@ -405,6 +422,39 @@ void CCurlFile::CReadState::Disconnect()
   m_curlAliasList = NULL;
 }
 
+CCurlFile::CSegment::CSegment(CCurlFile* file, int64_t start, int64_t end)
+{
+  m_file = file;
+  m_start = start;
+  m_end = end;
+  m_done = false;
+  m_verified = false;
+  m_retries = 0;
+  m_data.reserve((size_t)(end - start));
+}
+
+size_t CCurlFile::CSegment::WriteCallback(char *buffer, size_t size, size_t nitems)
+{
+  size_t amount = size * nitems;
+
+  // a server that ignores the range would hand us the file from the start
+  if (!m_verified)
+  {
+    long response = 0;
+    g_curlInterface.easy_getinfo(m_state.m_easyHandle, CURLINFO_RESPONSE_CODE, &response);
+    if (response != 206)
+      return 0;
+    m_verified = true;
+  }
+
+  if (m_data.size() + amount > (size_t)(m_end - m_start))
+    return 0;
+
+  m_data.insert(m_data.end(), buffer, buffer + amount);
+  m_file->m_segmentBytes += amount;
+  return amount;
+}
+
 
 CCurlFile::~CCurlFile()
 {
@@ -448,7 +498,15 @@ CCurlFile::CCurlFile()
   m_acceptCharset = "UTF-8,*;q=0.8"; /* prefer UTF-8 if available */
   m_readbuffer = (char*)malloc(512 * 1024);
   m_readbuffersize = 512 * 1024;
-
+  m_segmented = false;
+  m_segmentMulti = NULL;
+  m_segmentCount = 0;
+  m_segmentPos = 0;
+  m_segmentNext = 0;
+  m_segmentBytes = 0;
+  m_segmentStamp = 0;
+  m_segmentLast = 0;
+  m_segmentRate = 0;
 }
 
 //Has to be called before Open()
@@ -462,6 +520,7 @@ void CCurlFile::Close()
   if (m_opened && m_forWrite && !m_inError)
       Write(NULL, 0);
 
+  CloseSegmented();
   m_state->Disconnect();
   delete m_oldState;
   m_oldState = NULL;
@@ -1126,6 +1185,9 @@ bool CCurlFile::Open(const CURL& url)
     m_url = efurl;
   }
 
+  if (g_advancedSettings.m_httpSegments > 1)
+    OpenSegmented();
+
   return true;
 }
 
@@ -1296,7 +1358,7 @@ bool CCurlFile::Exists(const CURL& url)
 
 int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  int64_t nextPos = m_state->m_filePos;
+  int64_t nextPos = m_segmented ? m_segmentPos : m_state->m_filePos;
   
   if(!m_seekable)
     return -1;
@@ -1322,6 +1384,9 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   // We can't seek beyond EOF
   if (m_state->m_fileSize && nextPos > m_state->m_fileSize) return -1;
 
+  if (m_segmented)
+    return SeekSegmented(nextPos) ? nextPos : -1;
+
   if(m_state->Seek(nextPos))
     return nextPos;
 
@@ -1400,9 +1465,18 @@ int64_t CCurlFile::GetLength()
 int64_t CCurlFile::GetPosition()
 {
   if (!m_opened) return 0;
+  if (m_segmented) return m_segmentPos;
   return m_state->m_filePos;
 }
 
+ssize_t CCurlFile::Read(void* lpBuf, size_t uiBufSize)
+{
+  if (m_segmented)
+    return ReadSegmented(lpBuf, uiBufSize);
+
+  return m_state->Read(lpBuf, uiBufSize);
+}
+
 int CCurlFile::Stat(const CURL& url, struct __stat64* buffer)
 {
   // if file is already running, get info from it
@@ -1767,6 +1841,298 @@ void CCurlFile::CReadState::SetReadBuffer(const void* lpBuf, int64_t uiBufSize)
   m_filePos = 0;
 }
 
+/*
+ * Segmented transfers fetch ahead of the reader over several range requests
+ * at once, which helps on links where one tcp stream can't reach the bitrate
+ * because of latency. Segments are requested in file order and handed out in
+ * that order, so the reader sees a plain sequential stream. The number of
+ * segments in flight follows the throughput measured while the reader waits.
+ */
+bool CCurlFile::OpenSegmented()
+{
+  CURL url(m_url);
+  if (!url.IsProtocol("http") && !url.IsProtocol("https"))
+    return false;
+
+  // only plain GETs of large files the server serves partial content for
+  if (!m_seekable || !m_multisession || m_httpresponse != 206 ||
+      m_state->m_fileSize < SEGMENT_MIN_FILE || !m_contentencoding.empty() ||
+      m_postdataset || m_putdataset || !m_customrequest.empty())
+    return false;
+
+  m_segmentMulti = g_curlInterface.multi_init();
+  if (!m_segmentMulti)
+    return false;
+
+  // the single connection is replaced, keep what it told us about the file
+  int64_t fileSize = m_state->m_fileSize;
+  m_segmentPos = m_state->m_filePos;
+  m_state->Disconnect();
+  m_state->m_fileSize = fileSize;
+
+  m_segmentNext = m_segmentPos;
+  m_segmentCount = 2;
+  m_segmentBytes = 0;
+  m_segmentStamp = XbmcThreads::SystemClockMillis();
+  m_segmentLast = m_segmentStamp;
+  m_segmentRate = 0;
+  m_segmented = true;
+
+  CLog::Log(LOGDEBUG, "CCurlFile::OpenSegmented - using up to %d segments for %s", g_advancedSettings.m_httpSegments, CURL::GetRedacted(m_url).c_str());
+  return true;
+}
+
+void CCurlFile::CloseSegmented()
+{
+  if (!m_segmented)
+    return;
+
+  for (std::deque<CSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+    ReleaseSegment(*it);
+  m_segments.clear();
+
+  g_curlInterface.multi_cleanup(m_segmentMulti);
+  m_segmentMulti = NULL;
+  m_segmented = false;
+
+  CLog::Log(LOGDEBUG, "CCurlFile::CloseSegmented - ended with %d segments at %" PRId64" bytes/s", m_segmentCount, m_segmentRate);
+}
+
+ssize_t CCurlFile::ReadSegmented(void* lpBuf, size_t uiBufSize)
+{
+  int64_t fileSize = m_state->m_fileSize;
+  if (m_segmentPos >= fileSize)
+    return 0;
+
+  while (true)
+  {
+    // keep the wanted number of segments requested ahead of the reader
+    while ((int)m_segments.size() < m_segmentCount && m_segmentNext < fileSize)
+    {
+      CSegment* segment = new CSegment(this, m_segmentNext, std::min(m_segmentNext + SEGMENT_SIZE, fileSize));
+      if (!StartSegment(segment))
+      {
+        // go on with the segments we have, it is requested again once one of them is done
+        ReleaseSegment(segment);
+        m_segmentCount = std::max((int)m_segments.size(), 1);
+        if (m_segments.empty())
+        {
+          CLog::Log(LOGERROR, "CCurlFile::ReadSegmented - unable to request %s at %" PRId64, CURL::GetRedacted(m_url).c_str(), m_segmentNext);
+          return -1;
+        }
+        break;
+      }
+      m_segments.push_back(segment);
+      m_segmentNext = segment->m_end;
+    }
+
+    // service the transfers on every read, the segments behind the front one only fill
+    // up while we do. this only waits if there is nothing to read yet.
+    if (!PerformSegments())
+      return -1;
+
+    CSegment* segment = m_segments.front();
+    int64_t avail = segment->m_start + (int64_t)segment->m_data.size() - m_segmentPos;
+    if (avail > 0)
+    {
+      size_t want = (size_t)std::min((int64_t)uiBufSize, avail);
+      memcpy(lpBuf, &segment->m_data[(size_t)(m_segmentPos - segment->m_start)], want);
+      m_segmentPos += want;
+
+      if (m_segmentPos >= segment->m_end)
+      {
+        ReleaseSegment(segment);
+        m_segments.pop_front();
+      }
+      return want;
+    }
+  }
+}
+
+bool CCurlFile::SeekSegmented(int64_t pos)
+{
+  // drop what lies before the new position, everything if it is behind us
+  while (!m_segments.empty() && (m_segments.front()->m_end <= pos || m_segments.front()->m_start > pos))
+  {
+    ReleaseSegment(m_segments.front());
+    m_segments.pop_front();
+  }
+
+  if (m_segments.empty())
+    m_segmentNext = pos;
+
+  m_segmentPos = pos;
+  return true;
+}
+
+bool CCurlFile::StartSegment(CSegment* segment)
+{
+  CURL_HANDLE* h = segment->m_state.m_easyHandle;
+  if (!h)
+  {
+    CURL url(m_url);
+    g_curlInterface.easy_aquire(url.GetProtocol().c_str(), url.GetHostName().c_str(), &segment->m_state.m_easyHandle, NULL);
+    h = segment->m_state.m_easyHandle;
+    if (!h)
+      return false;
+
+    SetCommonOptions(&segment->m_state);
+    SetRequestHeaders(&segment->m_state);
+
+    g_curlInterface.easy_setopt(h, CURLOPT_URL, m_url.c_str());
+    g_curlInterface.easy_setopt(h, CURLOPT_WRITEDATA, segment);
+    g_curlInterface.easy_setopt(h, CURLOPT_WRITEFUNCTION, segment_write_callback);
+
+    // cancelling the file cancels all of its segments
+    g_curlInterface.easy_setopt(h, CURLOPT_XFERINFOFUNCTION, transfer_canceled_callback);
+    g_curlInterface.easy_setopt(h, CURLOPT_XFERINFODATA, m_state);
+    g_curlInterface.easy_setopt(h, CURLOPT_NOPROGRESS, 0);
+
+    // the following segments go to the same server, keep the connections
+    g_curlInterface.easy_setopt(h, CURLOPT_FORBID_REUSE, long(0));
+  }
+
+  // a retry resumes after what already arrived
+  segment->m_verified = false;
+  segment->m_range = StringUtils::Format("%" PRId64"-%" PRId64, segment->m_start + (int64_t)segment->m_data.size(), segment->m_end - 1);
+  g_curlInterface.easy_setopt(h, CURLOPT_RANGE, segment->m_range.c_str());
+
+  return g_curlInterface.multi_add_handle(m_segmentMulti, h) == CURLM_OK;
+}
+
+void CCurlFile::ReleaseSegment(CSegment* segment)
+{
+  if (segment->m_state.m_easyHandle)
+    g_curlInterface.multi_remove_handle(m_segmentMulti, segment->m_state.m_easyHandle);
+
+  delete segment;
+}
+
+bool CCurlFile::PerformSegments()
+{
+  if (m_state->m_cancelled)
+    return false;
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+
+  // a reader that stopped asking isn't limited by the link, don't measure that
+  if (now - m_segmentLast > 1000)
+  {
+    m_segmentBytes = 0;
+    m_segmentStamp = now;
+  }
+  m_segmentLast = now;
+
+  int running = 0;
+  CURLMcode result = g_curlInterface.multi_perform(m_segmentMulti, &running);
+  if (result != CURLM_OK && result != CURLM_CALL_MULTI_PERFORM)
+  {
+    CLog::Log(LOGERROR, "CCurlFile::PerformSegments - Multi perform failed with code %d, aborting", result);
+    return false;
+  }
+
+  int msgs;
+  CURLMsg* msg;
+  while ((msg = g_curlInterface.multi_info_read(m_segmentMulti, &msgs)))
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    CSegment* segment = NULL;
+    for (std::deque<CSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+    {
+      if ((*it)->m_state.m_easyHandle == msg->easy_handle)
+        segment = *it;
+    }
+    if (!segment)
+      continue;
+
+    g_curlInterface.multi_remove_handle(m_segmentMulti, segment->m_state.m_easyHandle);
+
+    if (msg->data.result == CURLE_OK && segment->m_data.size() == (size_t)(segment->m_end - segment->m_start))
+    {
+      segment->m_done = true;
+      continue;
+    }
+
+    if (msg->data.result == CURLE_WRITE_ERROR && !segment->m_verified)
+    {
+      CLog::Log(LOGERROR, "CCurlFile::PerformSegments - server ignored the range request");
+      return false;
+    }
+
+    if (++segment->m_retries > CSettings::GetInstance().GetInt(CSettings::SETTING_NETWORK_CURLRETRIES))
+    {
+      CLog::Log(LOGERROR, "CCurlFile::PerformSegments - Failed: %s(%d)", g_curlInterface.easy_strerror(msg->data.result), msg->data.result);
+      return false;
+    }
+
+    CLog::Log(LOGNOTICE, "CCurlFile::PerformSegments - Reconnect segment at %" PRId64", (re)try %i", segment->m_start, segment->m_retries);
+    if (!StartSegment(segment))
+    {
+      // nothing would ever complete it, drop it and those after it so the next read requests them anew
+      CLog::Log(LOGERROR, "CCurlFile::PerformSegments - unable to reconnect segment at %" PRId64, segment->m_start);
+      std::deque<CSegment*>::iterator it = std::find(m_segments.begin(), m_segments.end(), segment);
+      m_segmentNext = segment->m_start;
+      for (std::deque<CSegment*>::iterator i = it; i != m_segments.end(); ++i)
+        ReleaseSegment(*i);
+      m_segments.erase(it, m_segments.end());
+      return false;
+    }
+  }
+
+  // adjust the segments in flight, more while that still raises the throughput
+  if (now - m_segmentStamp >= SEGMENT_PERIOD)
+  {
+    int64_t rate = m_segmentBytes * 1000 / (now - m_segmentStamp);
+    if (rate >= m_segmentRate - m_segmentRate / 10)
+    {
+      if (m_segmentCount < g_advancedSettings.m_httpSegments)
+        m_segmentCount++;
+    }
+    else if (m_segmentCount > 2)
+      m_segmentCount--;
+
+    m_segmentRate = rate;
+    m_segmentBytes = 0;
+    m_segmentStamp = now;
+  }
+
+  // only wait when there is nothing to read yet
+  CSegment* front = m_segments.front();
+  if (front->m_start + (int64_t)front->m_data.size() > m_segmentPos || result == CURLM_CALL_MULTI_PERFORM)
+    return true;
+
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+  int maxfd = -1;
+  FD_ZERO(&fdread);
+  FD_ZERO(&fdwrite);
+  FD_ZERO(&fdexcep);
+
+  g_curlInterface.multi_fdset(m_segmentMulti, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+  long timeout = 0;
+  if (CURLM_OK != g_curlInterface.multi_timeout(m_segmentMulti, &timeout) || timeout == -1 || timeout > 200)
+    timeout = 200;
+
+  int rc;
+  do
+  {
+    struct timeval wait = { 0, (maxfd == -1 ? 100 : timeout) * 1000 };
+    rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &wait);
+  } while (rc == SOCKET_ERROR && errno == EINTR);
+
+  if (rc == SOCKET_ERROR)
+  {
+    CLog::Log(LOGERROR, "CCurlFile::PerformSegments - Failed with socket error:%s", strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
 void CCurlFile::ClearRequestHeaders()
 {
   m_requestheaders.clear();
@@ -21,8 +21,10 @@
 
 #include "IFile.h"
 #include "utils/RingBuffer.h"
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 #include "utils/HttpHeader.h"
 
 namespace XCURL
@@ -57,7 +59,7 @@ namespace XFILE
       virtual int  Stat(const CURL& url, struct __stat64* buffer);
       virtual void Close();
       virtual bool ReadString(char *szLine, int iLineLength)     { return m_state->ReadString(szLine, iLineLength); }
-      virtual ssize_t Read(void* lpBuf, size_t uiBufSize)        { return m_state->Read(lpBuf, uiBufSize); }
+      virtual ssize_t Read(void* lpBuf, size_t uiBufSize);
       virtual ssize_t Write(const void* lpBuf, size_t uiBufSize);
       virtual std::string GetMimeType()                          { return m_state->m_httpheader.GetMimeType(); }
       virtual std::string GetContent()                           { return m_state->m_httpheader.GetValue("content-type"); }
@@ -155,6 +157,24 @@ namespace XFILE
           void         Disconnect();
       };
 
+      /* one range request of a segmented transfer */
+      class CSegment
+      {
+      public:
+          CSegment(CCurlFile* file, int64_t start, int64_t end);
+          CCurlFile*        m_file;
+          CReadState        m_state;    // owns the easy handle and header lists
+          int64_t           m_start;
+          int64_t           m_end;      // exclusive
+          std::vector<char> m_data;
+          std::string       m_range;
+          bool              m_done;
+          bool              m_verified; // the server answered this request with partial content
+          int               m_retries;
+
+          size_t WriteCallback(char *buffer, size_t size, size_t nitems);
+      };
+
     protected:
       void ParseAndCorrectUrl(CURL &url);
       void SetCommonOptions(CReadState* state);
@@ -162,6 +182,14 @@ namespace XFILE
       void SetCorrectHeaders(CReadState* state);
       bool Service(const std::string& strURL, std::string& strHTML);
 
+      bool    OpenSegmented();
+      void    CloseSegmented();
+      ssize_t ReadSegmented(void* lpBuf, size_t uiBufSize);
+      bool    SeekSegmented(int64_t pos);
+      bool    StartSegment(CSegment* segment);
+      void    ReleaseSegment(CSegment* segment);
+      bool    PerformSegments();
+
     protected:
       CReadState*     m_state;
       CReadState*     m_oldState;
@@ -212,5 +240,17 @@ namespace XFILE
 
       long            m_httpresponse;
       bool            m_silent;
+
+      /* segmented transfer, read ahead over parallel range requests */
+      bool                   m_segmented;
+      std::deque<CSegment*>  m_segments;
+      XCURL::CURLM*          m_segmentMulti;
+      int                    m_segmentCount;  // segments in flight
+      int64_t                m_segmentPos;    // read position
+      int64_t                m_segmentNext;   // start of the next segment to request
+      int64_t                m_segmentBytes;  // received in the current measurement period
+      unsigned int           m_segmentStamp;  // start of the current measurement period
+      unsigned int           m_segmentLast;   // last time the transfers were serviced
+      int64_t                m_segmentRate;   // bytes/s of the previous period
   };
 }
@@ -24,18 +24,25 @@
 #include "File.h"
 #include "URL.h"
 
+#include "AdaptiveCache.h"
 #include "CircularCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 #include "settings/Settings.h"
 
 #include <cassert>
+#include <climits>
 #include <algorithm>
 #include <memory>
 
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (128*1024)
+// the adaptive cache may hold this many times the memory buffer size, spilling to disk
+#define ADAPTIVE_CACHE_SPILL_FACTOR 4
+// bytes read before the link rate is trusted
+#define READ_RATE_MIN_SAMPLE (1024*1024)
 
 class CWriteRate
 {
@@ -82,6 +89,44 @@ private:
   int64_t  m_size;
 };
 
+// throughput of the source counted only while a read is in progress, so
+// the time the writer spends waiting for room in the cache does not
+// drag it down to the playback rate
+class CReadRate
+{
+public:
+  CReadRate()
+  {
+    m_size = 0;
+    m_time = 0;
+  }
+
+  void Add(int64_t size, int64_t ticks)
+  {
+    m_size += size;
+    m_time += ticks;
+
+    // forget older samples so a changing link shows up within seconds
+    if (m_time > 4 * CurrentHostFrequency())
+    {
+      m_size /= 2;
+      m_time /= 2;
+    }
+  }
+
+  unsigned Rate()
+  {
+    // too little data says more about buffering than about the link
+    if (m_size < READ_RATE_MIN_SAMPLE || m_time <= 0)
+      return 0;
+
+    return (unsigned)std::min((double)m_size * CurrentHostFrequency() / m_time, (double)UINT_MAX);
+  }
+
+private:
+  int64_t m_size;
+  int64_t m_time;
+};
 
 CFileCache::CFileCache(const unsigned int flags)
   : CThread("FileCache")
@@ -200,7 +245,13 @@ bool CFileCache::Open(const CURL& url)
         front /= 2;
         back /= 2;
       }
-      m_pCache = new CCircularCache(front, back);
+      if (m_flags & READ_AUDIO_VIDEO)
+      {
+        // windows follow the stream and link rates, overflow goes to disk
+        m_pCache = new CAdaptiveCache(front + back, (front + back) * ADAPTIVE_CACHE_SPILL_FACTOR);
+      }
+      else
+        m_pCache = new CCircularCache(front, back);
       m_forwardCacheSize = front;
     }
 
@@ -249,6 +300,7 @@ void CFileCache::Process()
 
   CWriteRate limiter;
   CWriteRate average;
+  CReadRate link;
   bool cacheReachEOF = false;
 
   while (!m_bStop)
@@ -256,6 +308,8 @@ void CFileCache::Process()
     // Update filesize
     m_fileSize = m_source.GetLength();
 
+    m_pCache->SetRates(m_writeRate, link.Rate());
+
     // check for seek events
     if (m_seekEvent.WaitMSec(0))
     {
@@ -323,7 +377,12 @@ void CFileCache::Process()
 
     ssize_t iRead = 0;
     if (!cacheReachEOF)
+    {
+      int64_t start = CurrentHostCounter();
       iRead = m_source.Read(buffer.get(), maxWrite);
+      if (iRead > 0)
+        link.Add(iRead, CurrentHostCounter() - start);
+    }
     if (iRead == 0)
     {
       // Check for actual EOF and retry as long as we still have data in our cache
@@ -585,8 +644,11 @@ int CFileCache::IoControl(EIoControl request, void* param)
   if (request == IOCTRL_CACHE_STATUS)
   {
     SCacheStatus* status = (SCacheStatus*)param;
+    int64_t forwardCacheSize = m_pCache->GetForwardSize();
+    if (forwardCacheSize <= 0)
+      forwardCacheSize = m_forwardCacheSize;
     status->forward = m_pCache->WaitForData(0, 0);
-    status->level   = (m_forwardCacheSize == 0) ? 0.0 : (float) status->forward / m_forwardCacheSize;
+    status->level   = (forwardCacheSize == 0) ? 0.0 : (float) status->forward / forwardCacheSize;
     status->maxrate = m_writeRate;
     status->currate = m_writeRateActual;
     return 0;
@@ -598,6 +660,12 @@ int CFileCache::IoControl(EIoControl request, void* param)
     return 0;
   }
 
+  if (request == IOCTRL_CACHE_PUBLISH)
+  {
+    m_pCache->SetPublish(*(bool*)param);
+    return 0;
+  }
+
   if (request == IOCTRL_SEEK_POSSIBLE)
     return m_seekPossible;
 
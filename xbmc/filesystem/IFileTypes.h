@@ -70,6 +70,7 @@ typedef enum {
   IOCTRL_CACHE_SETRATE = 4,  /**< unsigned int with speed limit for caching in bytes per second */
   IOCTRL_SET_CACHE     = 8,  /**< CFileCache */
   IOCTRL_SET_RETRY     = 16, /**< Enable/disable retry within the protocol handler (if supported) */
+  IOCTRL_CACHE_PUBLISH = 32, /**< bool, publish the cache state to g_dataCacheCore (only for the file being played) */
 } EIoControl;
 
 enum CURLOPTIONTYPE
@@ -21,6 +21,7 @@
 #include "ApplicationBuiltins.h"
 
 #include "Application.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBenchmark.h"
 #include "filesystem/RarManager.h"
 #include "filesystem/ZipManager.h"
 #include "messaging/ApplicationMessenger.h"
@@ -29,6 +30,7 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/FileOperationJob.h"
+#include "utils/JobManager.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
@@ -38,6 +40,23 @@
 
 using namespace KODI::MESSAGING;
 
+/*! \brief Benchmark the audio pipeline into the NULL sink.
+ *  \param params The parameters.
+ *  \details params[0] = Seconds of audio per scenario (optional, default 60).
+ *           params[1] = "quit" to quit when done (optional).
+ */
+static int AudioBenchmark(const std::vector<std::string>& params)
+{
+  int seconds = params.empty() ? 0 : atoi(params[0].c_str());
+  if (seconds <= 0)
+    seconds = 60;
+  bool quit = params.size() > 1 && StringUtils::EqualsNoCase(params[1], "quit");
+
+  CJobManager::GetInstance().AddJob(new ActiveAE::CActiveAEBenchmark(seconds, quit), NULL);
+
+  return 0;
+}
+
 /*! \brief Extract an archive.
  *  \param params The parameters
  *  \details params[0] = The archive URL.
@@ -158,6 +177,7 @@ static int WakeOnLAN(const std::vector<std::string>& params)
 CBuiltins::CommandMap CApplicationBuiltins::GetOperations() const
 {
   return {
+           {"audiobenchmark", {"Benchmark the audio pipeline into the NULL sink", 0, AudioBenchmark}},
            {"extract", {"Extracts the specified archive", 1, Extract}},
            {"mute", {"Mute the player", 0, Mute}},
            {"notifyall", {"Notify all connected clients", 2, NotifyAll}},
@@ -237,6 +237,10 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
 // XBMC operations
   { "XBMC.GetInfoLabels",                           CXBMCOperations::GetInfoLabels },
   { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans },
+  { "XBMC.GetJobStatistics",                        CXBMCOperations::GetJobStatistics },
+  { "XBMC.SetJobTracing",                           CXBMCOperations::SetJobTracing },
+  { "XBMC.GetAudioStatistics",                      CXBMCOperations::GetAudioStatistics },
+  { "XBMC.SetAudioTracing",                         CXBMCOperations::SetAudioTracing },
   
   // Cloud operations
   { "Cloud.GetCloudPrelogin",                       CCloudOperations::GetDropboxPrelogin },
@@ -19,7 +19,9 @@
  */
 
 #include "XBMCOperations.h"
+#include "cores/AudioEngine/AEFactory.h"
 #include "messaging/ApplicationMessenger.h"
+#include "utils/JobManager.h"
 #include "utils/Variant.h"
 #include "powermanagement/PowerManager.h"
 
@@ -95,3 +97,127 @@ JSONRPC_STATUS CXBMCOperations::GetInfoBooleans(const std::string &method, ITran
 
   return OK;
 }
+
+JSONRPC_STATUS CXBMCOperations::GetJobStatistics(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  static const char *lanes[] = { "io", "cpu" };
+  static const char *priorities[] = { "lowpausable", "low", "normal", "high" };
+
+  CJobManager::Statistics stats;
+  CJobManager::GetInstance().GetStatistics(stats);
+
+  result["lanes"] = CVariant(CVariant::VariantTypeObject);
+  for (unsigned int lane = CJob::LANE_IO; lane <= CJob::LANE_CPU; ++lane)
+  {
+    const CJobManager::LaneStatistics &laneStats = stats.lanes[lane];
+    CVariant &item = result["lanes"][lanes[lane]];
+    item["budget"] = laneStats.budget;
+    item["workers"] = laneStats.workers;
+    item["busy"] = laneStats.busy;
+    item["queued"] = laneStats.queued;
+  }
+
+  result["priorities"] = CVariant(CVariant::VariantTypeObject);
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
+    const CJobManager::PriorityStatistics &priorityStats = stats.priorities[priority];
+    CVariant &item = result["priorities"][priorities[priority]];
+    item["jobs"] = priorityStats.jobs;
+    item["averagewait"] = priorityStats.jobs ? priorityStats.waitTotal / priorityStats.jobs : 0;
+    item["maxwait"] = priorityStats.waitMax;
+    item["averagerun"] = priorityStats.jobs ? priorityStats.runTotal / priorityStats.jobs : 0;
+    item["maxrun"] = priorityStats.runMax;
+  }
+
+  std::map<std::string, CJobManager::TypeStatistics> types;
+  CJobManager::GetInstance().GetTypeStatistics(types);
+
+  result["types"] = CVariant(CVariant::VariantTypeObject);
+  for (std::map<std::string, CJobManager::TypeStatistics>::const_iterator it = types.begin(); it != types.end(); ++it)
+  {
+    CVariant &item = result["types"][it->first];
+    item["queued"] = it->second.queued;
+    item["running"] = it->second.running;
+    item["completed"] = it->second.completed;
+    item["cancelled"] = it->second.cancelled;
+    item["waithistogram"] = CVariant(CVariant::VariantTypeArray);
+    item["runhistogram"] = CVariant(CVariant::VariantTypeArray);
+    for (unsigned int i = 0; i < CJobManager::HistogramBuckets; ++i)
+    {
+      item["waithistogram"].push_back(it->second.waitHistogram[i]);
+      item["runhistogram"].push_back(it->second.runHistogram[i]);
+    }
+  }
+
+  result["histogrambounds"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int i = 0; i < CJobManager::HistogramBuckets; ++i)
+    result["histogrambounds"].push_back(CJobManager::GetHistogramBound(i));
+
+  result["tracing"] = CJobManager::GetInstance().IsTracing();
+
+  return OK;
+}
+
+JSONRPC_STATUS CXBMCOperations::SetJobTracing(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  result["file"] = CJobManager::GetInstance().SetTracing(parameterObject["enabled"].asBoolean());
+  result["tracing"] = CJobManager::GetInstance().IsTracing();
+
+  return OK;
+}
+
+static CVariant HistogramToVariant(const AEProfile::Histogram &histogram)
+{
+  CVariant item(CVariant::VariantTypeObject);
+  item["count"] = histogram.count;
+  item["average"] = histogram.count ? histogram.total / histogram.count : 0;
+  item["max"] = histogram.max;
+  item["histogram"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int i = 0; i < AEProfile::HistogramBuckets; ++i)
+    item["histogram"].push_back(histogram.buckets[i]);
+  return item;
+}
+
+JSONRPC_STATUS CXBMCOperations::GetAudioStatistics(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  AEProfile profile;
+  if (!CAEFactory::GetProfile(profile))
+    return FailedToExecute;
+
+  result["stages"] = CVariant(CVariant::VariantTypeObject);
+  for (unsigned int stage = 0; stage < AEProfile::STAGE_MAX; ++stage)
+    result["stages"][AEProfile::GetStageName(stage)] = HistogramToVariant(profile.stages[stage]);
+
+  result["sinkjitter"] = HistogramToVariant(profile.sinkJitter);
+  result["underruns"] = profile.underruns;
+
+  result["streams"] = CVariant(CVariant::VariantTypeArray);
+  for (std::vector<AEProfile::StreamBuffers>::const_iterator it = profile.streams.begin(); it != profile.streams.end(); ++it)
+  {
+    CVariant item(CVariant::VariantTypeObject);
+    item["id"] = it->id;
+    item["inputtotal"] = it->inputTotal;
+    item["inputused"] = it->inputUsed;
+    item["processingtotal"] = it->processingTotal;
+    item["processingused"] = it->processingUsed;
+    result["streams"].push_back(item);
+  }
+
+  result["histogrambounds"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int i = 0; i < AEProfile::HistogramBuckets; ++i)
+    result["histogrambounds"].push_back(AEProfile::GetHistogramBound(i));
+
+  result["tracing"] = profile.tracing;
+
+  return OK;
+}
+
+JSONRPC_STATUS CXBMCOperations::SetAudioTracing(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  result["file"] = CAEFactory::SetProfileTracing(parameterObject["enabled"].asBoolean());
+
+  AEProfile profile;
+  result["tracing"] = CAEFactory::GetProfile(profile) && profile.tracing;
+
+  return OK;
+}
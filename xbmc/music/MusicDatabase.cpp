@@ -679,23 +679,33 @@ int CMusicDatabase::AddSong(const int idAlbum,
     URIUtils::Split(strPathAndFileName, strPath, strFileName);
     int idPath = AddPath(strPath);
 
+    // called for every song while scanning, keep it on prepared statements
+    std::unique_ptr<dbiplus::Cursor> cursor;
     if (!strMusicBrainzTrackID.empty())
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum = %i AND strMusicBrainzTrackID = '%s'",
-                          idAlbum,
-                          strMusicBrainzTrackID.c_str());
+    {
+      cursor = PrepareCursor("SELECT idSong FROM song WHERE idAlbum = ? AND strMusicBrainzTrackID = ?");
+      if (!cursor)
+        return -1;
+      cursor->bind(1, idAlbum);
+      cursor->bind(2, strMusicBrainzTrackID);
+    }
     else
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum=%i AND strFileName='%s' AND strTitle='%s' AND iTrack=%i AND strMusicBrainzTrackID IS NULL",
-                          idAlbum,
-                          strFileName.c_str(),
-                          strTitle.c_str(),
-                          iTrack);
+    {
+      cursor = PrepareCursor("SELECT idSong FROM song WHERE idAlbum=? AND strFileName=? AND strTitle=? AND iTrack=? AND strMusicBrainzTrackID IS NULL");
+      if (!cursor)
+        return -1;
+      cursor->bind(1, idAlbum);
+      cursor->bind(2, strFileName);
+      cursor->bind(3, strTitle);
+      cursor->bind(4, iTrack);
+    }
 
-    if (!m_pDS->query(strSQL))
-      return -1;
+    if (cursor->step())
+      idSong = cursor->column_int(0);
+    cursor.reset();
 
-    if (m_pDS->num_rows() == 0)
+    if (idSong < 0)
     {
-      m_pDS->close();
       strSQL=PrepareSQL("INSERT INTO song ("
                                           "idSong,idAlbum,idPath,strArtists,strGenres,"
                                           "strTitle,iTrack,iDuration,iYear,strFileName,"
@@ -726,8 +736,6 @@ int CMusicDatabase::AddSong(const int idAlbum,
     }
     else
     {
-      idSong = m_pDS->fv("idSong").get_asInt();
-      m_pDS->close();
       UpdateSong( idSong, strTitle, strMusicBrainzTrackID, strPathAndFileName, strComment, strMood, strThumb, 
                   artistString, genres, iTrack, iDuration, iYear, iTimesPlayed, iStartOffset, iEndOffset, 
                   dtLastPlayed, rating, userrating, votes);
@@ -1205,6 +1213,12 @@ int CMusicDatabase::AddArtist(const std::string& strArtist, const std::string& s
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
+    // artists are only removed by a cleanup, so during a scan the same tags give the same artist
+    const std::string cacheKey = strMusicBrainzArtistID.empty() ? strArtist : strMusicBrainzArtistID + '\n' + strArtist;
+    int idCached = GetCachedLookupId("artist", cacheKey);
+    if (idCached >= 0)
+      return idCached;
+
     // 1) MusicBrainz
     if (!strMusicBrainzArtistID.empty())
     {
@@ -1223,6 +1237,7 @@ int CMusicDatabase::AddArtist(const std::string& strArtist, const std::string& s
           m_pDS->exec(strSQL);
           m_pDS->close();
         }
+        CacheLookupId("artist", cacheKey, idArtist);
         return idArtist;
       }
       m_pDS->close();
@@ -1242,6 +1257,7 @@ int CMusicDatabase::AddArtist(const std::string& strArtist, const std::string& s
                             strMusicBrainzArtistID.c_str(),
                             idArtist);
         m_pDS->exec(strSQL);
+        CacheLookupId("artist", cacheKey, idArtist);
         return idArtist;
       }
 
@@ -1259,6 +1275,7 @@ int CMusicDatabase::AddArtist(const std::string& strArtist, const std::string& s
       {
         int idArtist = (int)m_pDS->fv("idArtist").get_asInt();
         m_pDS->close();
+        CacheLookupId("artist", cacheKey, idArtist);
         return idArtist;
       }
       m_pDS->close();
@@ -1275,6 +1292,7 @@ int CMusicDatabase::AddArtist(const std::string& strArtist, const std::string& s
 
     m_pDS->exec(strSQL);
     int idArtist = (int)m_pDS->lastinsertid();
+    CacheLookupId("artist", cacheKey, idArtist);
     return idArtist;
   }
   catch (...)
@@ -1436,11 +1454,15 @@ int CMusicDatabase::AddRole(const std::string &strRole)
   {
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
-    strSQL = PrepareSQL("SELECT idRole FROM role WHERE strRole LIKE '%s'", strRole.c_str());
-    m_pDS->query(strSQL);
-    if (m_pDS->num_rows() > 0)
-      idRole = m_pDS->fv("idRole").get_asInt();
-    m_pDS->close();
+    // called for every artist credit while scanning
+    strSQL = "SELECT idRole FROM role WHERE strRole LIKE ?";
+    std::unique_ptr<dbiplus::Cursor> cursor = PrepareCursor(strSQL);
+    if (!cursor)
+      return -1;
+    cursor->bind(1, strRole);
+    if (cursor->step())
+      idRole = cursor->column_int(0);
+    cursor.reset();
 
     if (idRole < 0)
     {
@@ -5621,7 +5643,9 @@ bool CMusicDatabase::CommitTransaction()
 {
   if (CDatabase::CommitTransaction())
   { // number of items in the db has likely changed, so reset the infomanager cache
-    g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, GetSongsCount() > 0);
+    // (a bulk ingest does this once it has ended)
+    if (!InBulkIngest())
+      g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, GetSongsCount() > 0);
     return true;
   }
   return false;
@@ -130,6 +130,9 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      // write the albums in batches rather than one transaction each
+      m_musicDatabase.BeginBulkIngest();
+
       bool commit = true;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
       {
@@ -151,6 +154,7 @@ void CMusicInfoScanner::Process()
           break;
         }
       }
+      m_musicDatabase.EndBulkIngest();
 
       if (commit)
       {
@@ -246,6 +250,7 @@ void CMusicInfoScanner::Process()
   {
     CLog::Log(LOGERROR, "MusicInfoScanner: Exception while scanning.");
   }
+  m_musicDatabase.EndBulkIngest();
   m_musicDatabase.Close();
   CLog::Log(LOGDEBUG, "%s - Finished scan", __FUNCTION__);
   
@@ -1045,6 +1050,9 @@ INFO_RET CMusicInfoScanner::DownloadAlbumInfo(const CAlbum& album, const ADDON::
     m_handle->SetText(album.GetAlbumArtistString() + " - " + album.strAlbum);
   }
 
+  // don't keep the database locked while waiting on the scraper
+  m_musicDatabase.FlushBulkIngest();
+
   // clear our scraper cache
   info->ClearCache();
 
@@ -1266,6 +1274,9 @@ INFO_RET CMusicInfoScanner::DownloadArtistInfo(const CArtist& artist, const ADDO
     m_handle->SetText(artist.strArtist);
   }
 
+  // don't keep the database locked while waiting on the scraper
+  m_musicDatabase.FlushBulkIngest();
+
   // clear our scraper cache
   info->ClearCache();
 
@@ -31,6 +31,7 @@
 #include <utility>
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
@@ -47,8 +48,16 @@
 #include "utils/Variant.h"
 #include "XBDateTime.h"
 
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #define MAX_POST_BUFFER_SIZE 2048
 
+#define MIN_DOWNLOAD_BLOCK_SIZE 4096
+#define MAX_DOWNLOAD_BLOCK_SIZE 262144
+
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 
@@ -749,6 +758,35 @@ int CWebServer::CreateRedirect(struct MHD_Connection *connection, const std::str
   return MHD_YES;
 }
 
+static size_t GetDownloadBlockSize(uint64_t length)
+{
+  // small files fit into a single block, everything else is read in large
+  // blocks to keep the number of reads and socket writes per request low
+  return static_cast<size_t>(std::min<uint64_t>(std::max<uint64_t>(length, MIN_DOWNLOAD_BLOCK_SIZE), MAX_DOWNLOAD_BLOCK_SIZE));
+}
+
+#if defined(TARGET_POSIX) && MHD_VERSION >= 0x00094400
+static struct MHD_Response* CreateFileDescriptorResponse(const std::string &filePath, uint64_t offset, uint64_t length)
+{
+  // only plain local files can be handed to libmicrohttpd which then sends
+  // them with sendfile() without copying the data through our buffers
+  std::string localPath = CSpecialProtocol::TranslatePath(filePath);
+  if (length == 0 || !CURL(localPath).GetProtocol().empty())
+    return NULL;
+
+  int fd = open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+
+  // the response takes ownership of the file descriptor
+  struct MHD_Response *response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+  if (response == NULL)
+    close(fd);
+
+  return response;
+}
+#endif
+
 int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct MHD_Response *&response)
 {
   if (handler == NULL)
@@ -851,17 +889,27 @@ int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct
     context->ranges.GetFirstPosition(context->writePosition);
 
     // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
+    response = NULL;
+#if defined(TARGET_POSIX) && MHD_VERSION >= 0x00094400
+    // a single range doesn't need any multipart boundaries so it can be sent straight from the file
+    if (context->rangeCountTotal == 1)
+      response = CreateFileDescriptorResponse(filePath, context->writePosition, totalLength);
+#endif
+
     if (response == NULL)
     {
-      CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      response = MHD_create_response_from_callback(totalLength, GetDownloadBlockSize(totalLength),
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == NULL)
+      {
+        CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -1127,23 +1175,51 @@ static void logFromMHD(void* unused, const char* fmt, va_list ap)
 
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
-  unsigned int timeout = 60 * 60 * 24;
-
 #if MHD_VERSION >= 0x00040500
   MHD_set_panic_func(&panicHandlerForMHD, NULL);
 #endif
 
-  return MHD_start_daemon(flags |
 #if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          // use main thread for each connection, can only handle one request at a
-                          // time [unless you set the thread pool size]
-                          MHD_USE_SELECT_INTERNALLY
+  // use main thread for each connection, can only handle one request at a
+  // time [unless you set the thread pool size]
+  unsigned int threadMode = MHD_USE_SELECT_INTERNALLY;
+  unsigned int threadPoolSize = 4;
 #else
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
+  // one thread per connection
+  // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+  // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+  unsigned int threadMode = MHD_USE_THREAD_PER_CONNECTION;
+  unsigned int threadPoolSize = 0;
+
+  // a fixed pool of threads polling all connections instead of a thread per connection
+  if (g_advancedSettings.m_webserverThreadPool > 0)
+  {
+    threadMode = MHD_USE_SELECT_INTERNALLY;
+    threadPoolSize = g_advancedSettings.m_webserverThreadPool;
+  }
 #endif
+
+  struct MHD_Daemon *daemon = NULL;
+#if (defined(TARGET_LINUX) || defined(TARGET_ANDROID)) && MHD_VERSION >= 0x00092100
+  // prefer epoll, libmicrohttpd may have been built without it though
+  if (threadPoolSize > 0)
+  {
+    daemon = StartMHD(flags | threadMode | MHD_USE_EPOLL_LINUX_ONLY, threadPoolSize, port);
+    if (daemon == NULL)
+      CLog::Log(LOGDEBUG, "CWebServer::%s - epoll is not available, falling back to select", __FUNCTION__);
+  }
+#endif
+  if (daemon == NULL)
+    daemon = StartMHD(flags | threadMode, threadPoolSize, port);
+
+  return daemon;
+}
+
+struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, unsigned int threadPoolSize, int port)
+{
+  unsigned int timeout = 60 * 60 * 24;
+
+  return MHD_start_daemon(flags
 #if (MHD_VERSION >= 0x00040001)
                           | MHD_USE_DEBUG /* Print MHD error messages to log */
 #endif 
@@ -1154,8 +1230,8 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           &CWebServer::AnswerToConnection,
                           this,
 
-#if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          MHD_OPTION_THREAD_POOL_SIZE, 4,
+#if (MHD_VERSION >= 0x00040002)
+                          MHD_OPTION_THREAD_POOL_SIZE, threadPoolSize,
 #endif
                           MHD_OPTION_CONNECTION_LIMIT, 512,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
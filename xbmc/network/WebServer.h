@@ -62,6 +62,7 @@ public:
 
 private:
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
+  struct MHD_Daemon* StartMHD(unsigned int flags, unsigned int threadPoolSize, int port);
   static int AskForAuthentication (struct MHD_Connection *connection);
   static bool IsAuthenticated (CWebServer *server, struct MHD_Connection *connection);
 
@@ -83,6 +83,7 @@ class CThumbnailWriter : public CJob
     CThumbnailWriter(unsigned char* buffer, int width, int height, int stride, const std::string& thumbFile);
     ~CThumbnailWriter();
     bool DoWork();
+    LANE GetLane() const { return LANE_CPU; }
 
   private:
     unsigned char* m_buffer;
@@ -37,7 +37,6 @@
 #include "utils/URIUtils.h"
 #include "filesystem/File.h"
 #include "filesystem/CurlFile.h"
-#include "filesystem/ZipFile.h"
 #include "settings/Settings.h"
 #include "settings/MediaSettings.h"
 #include "utils/JobManager.h"
@@ -492,9 +491,7 @@ bool CEmbyUtils::GetEmbyInProgressShows(CFileItemList &items, const std::string
   url2.SetOption("Limit", StringUtils::Format("%i",limit));
   url2.SetOption("Recursive", "true");
   url2.SetOption("Fields", StandardFields);
-  CVariant result = GetEmbyCVariant(url2.Get());
-
-  bool rtn = ParseEmbyVideos(items, url2, result, MediaTypeEpisode);
+  bool rtn = ParseEmbyVideosStream(items, url2, MediaTypeEpisode);
   return rtn;
 }
 
@@ -529,9 +526,7 @@ bool CEmbyUtils::GetEmbyInProgressMovies(CFileItemList &items, const std::string
   url2.SetOption("GroupItems", "False");
   url2.SetOption("Fields", MoviesFields);
   url2.SetOption("Recursive", "true");
-  CVariant result = GetEmbyCVariant(url2.Get());
-
-  bool rtn = ParseEmbyVideos(items, url2, result, MediaTypeMovie);
+  bool rtn = ParseEmbyVideosStream(items, url2, MediaTypeMovie);
   return rtn;
 }
 
@@ -755,9 +750,7 @@ bool CEmbyUtils::GetEmbyEpisodes(CFileItemList &items, const std::string url)
   
   url2.SetOption("IncludeItemTypes", EmbyTypeEpisode);
   url2.SetOption("Fields", StandardFields);
-  const CVariant variant = GetEmbyCVariant(url2.Get());
-  
-  bool rtn = ParseEmbyVideos(items, url2, variant, MediaTypeEpisode);
+  bool rtn = ParseEmbyVideosStream(items, url2, MediaTypeEpisode);
   return rtn;
 }
 
@@ -983,46 +976,35 @@ bool CEmbyUtils::ParseEmbyVideos(CFileItemList &items, CURL url, const CVariant
     return false;
   }
 
+  return ParseEmbyVideoItems(items, url, variant["Items"], type);
+}
+
+bool CEmbyUtils::ParseEmbyVideos(CFileItemList &items, CURL url, const CEmbyViewItems &variantItems, std::string type)
+{
+  return ParseEmbyVideoItems(items, url, variantItems, type);
+}
+
+template<class TItems>
+bool CEmbyUtils::ParseEmbyVideoItems(CFileItemList &items, const CURL &url, const TItems &variantItems, const std::string &type)
+{
+  // variantItems is a fetched "Items" array or a view cache snapshot,
+  // the snapshot thaws one item at a time for the loop body.
 #if defined(EMBY_DEBUG_TIMING)
   unsigned int currentTime = XbmcThreads::SystemClockMillis();
 #endif
   bool rtn = false;
-  const auto& variantItems = variant["Items"];
-  for (auto variantItemIt = variantItems.begin_array(); variantItemIt != variantItems.end_array(); ++variantItemIt)
+  for (unsigned int k = 0; k < variantItems.size(); ++k)
   {
-    if (*variantItemIt == CVariant::VariantTypeNull)
+    const CVariant &variantItem = variantItems[k];
+    if (variantItem.isNull())
       continue;
 
-    const auto objectItem = *variantItemIt;
     rtn = true;
-
-    // ignore raw blueray rips, these are designed to be
-    // direct played (ie via mounted filesystem)
-    // and we do not do that yet.
-    if (objectItem["VideoType"].asString() == "BluRay")
-      continue;
-    if (objectItem["VideoType"].asString() == "Dvd")
-      continue;
-    if (objectItem["IsFolder"].asBoolean())
-      continue;
-
-    std::string videoType = type;
-    if (videoType.empty())
-    {
-      videoType = objectItem["Type"].asString();
-      StringUtils::ToLower(videoType);
-    }
-    CFileItemPtr item = ToVideoFileItemPtr(url, objectItem, videoType);
-    items.Add(item);
+    CFileItemPtr item = ParseEmbyVideo(url, variantItem, type);
+    if (item)
+      items.Add(item);
   }
-  // this is needed to display movies/episodes properly ... dont ask
-  // good thing it didnt take 2 days to figure it out
-  items.SetLabel(variantItems[0]["SeasonName"].asString());
-  items.SetProperty("library.filter", "true");
-  if (type == MediaTypeTvShow)
-    SetEmbyItemProperties(items, "episodes");
-  else
-    SetEmbyItemProperties(items, "movies");
+  SetEmbyVideosProperties(items, variantItems[0]["SeasonName"].asString(), type);
 
 #if defined(EMBY_DEBUG_TIMING)
   int delta = XbmcThreads::SystemClockMillis() - currentTime;
@@ -1035,6 +1017,50 @@ bool CEmbyUtils::ParseEmbyVideos(CFileItemList &items, CURL url, const CVariant
   return rtn;
 }
 
+bool CEmbyUtils::ParseEmbyVideosStream(CFileItemList &items, const CURL &url, std::string type)
+{
+  // same as GetEmbyCVariant + ParseEmbyVideos but items are turned into
+  // CFileItems as they are parsed, the full CVariant tree is never built.
+  XFILE::CCurlFile emby;
+  if (!OpenEmbyResponse(url.Get(), emby))
+    return false;
+
+#if defined(EMBY_DEBUG_TIMING)
+  unsigned int currentTime = XbmcThreads::SystemClockMillis();
+#endif
+  bool rtn = false;
+  int itemCount = 0;
+  std::string seasonName;
+  CVariant resultObject;
+  const std::vector<std::string> itemsPath = { "Items" };
+  bool parsed = CJSONVariantParser::Parse(EmbyResponseReader(emby), itemsPath, [&](CVariant &objectItem)
+  {
+    if (itemCount++ == 0)
+      seasonName = objectItem["SeasonName"].asString();
+    if (objectItem == CVariant::VariantTypeNull)
+      return true;
+
+    rtn = true;
+    CFileItemPtr item = ParseEmbyVideo(url, objectItem, type);
+    if (item)
+      items.Add(item);
+    return true;
+  }, resultObject);
+
+  if (!parsed || !resultObject.isObject() || !resultObject.isMember("Items"))
+  {
+    CLog::Log(LOGERROR, "CEmbyUtils::ParseEmbyVideosStream invalid response from %s", url.GetRedacted().c_str());
+    return false;
+  }
+  SetEmbyVideosProperties(items, seasonName, type);
+
+#if defined(EMBY_DEBUG_TIMING)
+  CLog::Log(LOGDEBUG, "CEmbyUtils::ParseEmbyVideosStream %d(msec) for %d items",
+    XbmcThreads::SystemClockMillis() - currentTime, itemCount);
+#endif
+  return rtn;
+}
+
 bool CEmbyUtils::ParseEmbySeries(CFileItemList &items, const CURL &url, const CVariant &variant)
 {
   if (variant.isNull() || !variant.isObject() || !variant.isMember("Items"))
@@ -1043,102 +1069,109 @@ bool CEmbyUtils::ParseEmbySeries(CFileItemList &items, const CURL &url, const CV
     return false;
   }
 
+  return ParseEmbySeriesItems(items, url, variant["Items"]);
+}
+
+bool CEmbyUtils::ParseEmbySeries(CFileItemList &items, const CURL &url, const CEmbyViewItems &variantItems)
+{
+  return ParseEmbySeriesItems(items, url, variantItems);
+}
+
+template<class TItems>
+bool CEmbyUtils::ParseEmbySeriesItems(CFileItemList &items, const CURL &url, const TItems &variantItems)
+{
   bool rtn = false;
   std::string imagePath;
 
-  if (!variant.isNull() || variant.isObject() || variant.isMember("Items"))
+  for (unsigned int k = 0; k < variantItems.size(); ++k)
   {
-    const auto& variantItems = variant["Items"];
-    for (auto variantItemIt = variantItems.begin_array(); variantItemIt != variantItems.end_array(); ++variantItemIt)
-    {
-      if (*variantItemIt == CVariant::VariantTypeNull)
-        continue;
+    const CVariant &item = variantItems[k];
+    if (item.isNull())
+      continue;
 
-      const auto item = *variantItemIt;
-      rtn = true;
+    rtn = true;
 
-      // local vars for common fields
-      std::string itemId = item["Id"].asString();
-      std::string seriesId = item["SeriesId"].asString();
-      // clear url options
-      CURL curl(url);
-      curl.SetOption("ParentId", itemId);
-
-      CFileItemPtr newItem(new CFileItem());
-      // set m_bIsFolder to true to indicate we are series list
-      newItem->m_bIsFolder = true;
-
-      std::string title = item["Name"].asString();
-      newItem->SetLabel(title);
-
-      CDateTime premiereDate;
-      premiereDate.SetFromW3CDateTime(item["PremiereDate"].asString());
-      newItem->m_dateTime = premiereDate;
-
-      newItem->SetPath("emby://tvshows/shows/" + Base64URL::Encode(curl.Get()));
-      newItem->SetMediaServiceId(itemId);
-      newItem->SetMediaServiceFile(item["Path"].asString());
-
-      curl.SetFileName("Items/" + itemId + "/Images/Primary");
-      imagePath = curl.Get();
-      newItem->SetArt("thumb", imagePath);
-      newItem->SetIconImage(imagePath);
-
-      curl.SetFileName("Items/" + itemId + "/Images/Banner");
-      imagePath = curl.Get();
-      newItem->SetArt("banner", imagePath);
-
-      curl.SetFileName("Items/" + itemId + "/Images/Backdrop");
-      imagePath = curl.Get();
-      newItem->SetArt("fanart", imagePath);
-
-      newItem->GetVideoInfoTag()->m_playCount = static_cast<int>(item["UserData"]["PlayCount"].asInteger());
-      newItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, newItem->GetVideoInfoTag()->m_playCount > 0);
-
-      newItem->GetVideoInfoTag()->m_strTitle = title;
-      newItem->GetVideoInfoTag()->m_strStatus = item["Status"].asString();
-
-      newItem->GetVideoInfoTag()->m_type = MediaTypeTvShow;
-      newItem->GetVideoInfoTag()->m_strFileNameAndPath = newItem->GetPath();
-      newItem->GetVideoInfoTag()->SetSortTitle(title);
-      newItem->GetVideoInfoTag()->SetOriginalTitle(title);
-      //newItem->GetVideoInfoTag()->SetSortTitle(item["SortName"].asString());
-      //newItem->GetVideoInfoTag()->SetOriginalTitle(item["OriginalTitle"].asString());
-      newItem->SetProperty("EmbySeriesID", seriesId);
-      newItem->GetVideoInfoTag()->SetPlot(item["Overview"].asString());
-      newItem->GetVideoInfoTag()->SetPlotOutline(item["ShortOverview"].asString());
-      newItem->GetVideoInfoTag()->m_firstAired = premiereDate;
-      newItem->GetVideoInfoTag()->SetPremiered(premiereDate);
-      newItem->GetVideoInfoTag()->m_dateAdded.SetFromW3CDateTime(item["DateCreated"].asString());
-      newItem->GetVideoInfoTag()->SetYear(static_cast<int>(item["ProductionYear"].asInteger()));
-      newItem->GetVideoInfoTag()->SetRating(item["CommunityRating"].asFloat(), static_cast<int>(item["VoteCount"].asInteger()), "", true);
-      newItem->GetVideoInfoTag()->m_strMPAARating = item["OfficialRating"].asString();
-
-      int totalEpisodes = item["RecursiveItemCount"].asInteger() - item["ChildCount"].asInteger();
-      int unWatchedEpisodes = static_cast<int>(item["UserData"]["UnplayedItemCount"].asInteger());
-      int watchedEpisodes = totalEpisodes - unWatchedEpisodes;
-      int iSeasons        = static_cast<int>(item["ChildCount"].asInteger());
-
-      newItem->GetVideoInfoTag()->m_iSeason = iSeasons;
-      newItem->GetVideoInfoTag()->m_iEpisode = totalEpisodes;
-      newItem->GetVideoInfoTag()->m_playCount = (int)watchedEpisodes >= newItem->GetVideoInfoTag()->m_iEpisode;
-
-      newItem->SetProperty("totalseasons", iSeasons);
-      newItem->SetProperty("totalepisodes", newItem->GetVideoInfoTag()->m_iEpisode);
-      newItem->SetProperty("numepisodes",   newItem->GetVideoInfoTag()->m_iEpisode);
-      newItem->SetProperty("watchedepisodes", watchedEpisodes);
-      newItem->SetProperty("unwatchedepisodes", unWatchedEpisodes);
-
-      GetVideoDetails(*newItem, item);
-      SetEmbyItemProperties(*newItem, "tvshows");
-      items.Add(newItem);
-    }
-    // this is needed to display movies/episodes properly ... dont ask
-    // good thing it didnt take 2 days to figure it out
-    items.SetProperty("library.filter", "true");
-    items.SetCacheToDisc(CFileItemList::CACHE_NEVER);
-    SetEmbyItemProperties(items, "tvshows");
+    // local vars for common fields
+    std::string itemId = item["Id"].asString();
+    std::string seriesId = item["SeriesId"].asString();
+    // clear url options
+    CURL curl(url);
+    curl.SetOption("ParentId", itemId);
+
+    CFileItemPtr newItem(new CFileItem());
+    // set m_bIsFolder to true to indicate we are series list
+    newItem->m_bIsFolder = true;
+
+    std::string title = item["Name"].asString();
+    newItem->SetLabel(title);
+
+    CDateTime premiereDate;
+    premiereDate.SetFromW3CDateTime(item["PremiereDate"].asString());
+    newItem->m_dateTime = premiereDate;
+
+    newItem->SetPath("emby://tvshows/shows/" + Base64URL::Encode(curl.Get()));
+    newItem->SetMediaServiceId(itemId);
+    newItem->SetMediaServiceFile(item["Path"].asString());
+
+    curl.SetFileName("Items/" + itemId + "/Images/Primary");
+    imagePath = curl.Get();
+    newItem->SetArt("thumb", imagePath);
+    newItem->SetIconImage(imagePath);
+
+    curl.SetFileName("Items/" + itemId + "/Images/Banner");
+    imagePath = curl.Get();
+    newItem->SetArt("banner", imagePath);
+
+    curl.SetFileName("Items/" + itemId + "/Images/Backdrop");
+    imagePath = curl.Get();
+    newItem->SetArt("fanart", imagePath);
+
+    newItem->GetVideoInfoTag()->m_playCount = static_cast<int>(item["UserData"]["PlayCount"].asInteger());
+    newItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, newItem->GetVideoInfoTag()->m_playCount > 0);
+
+    newItem->GetVideoInfoTag()->m_strTitle = title;
+    newItem->GetVideoInfoTag()->m_strStatus = item["Status"].asString();
+
+    newItem->GetVideoInfoTag()->m_type = MediaTypeTvShow;
+    newItem->GetVideoInfoTag()->m_strFileNameAndPath = newItem->GetPath();
+    newItem->GetVideoInfoTag()->SetSortTitle(title);
+    newItem->GetVideoInfoTag()->SetOriginalTitle(title);
+    //newItem->GetVideoInfoTag()->SetSortTitle(item["SortName"].asString());
+    //newItem->GetVideoInfoTag()->SetOriginalTitle(item["OriginalTitle"].asString());
+    newItem->SetProperty("EmbySeriesID", seriesId);
+    newItem->GetVideoInfoTag()->SetPlot(item["Overview"].asString());
+    newItem->GetVideoInfoTag()->SetPlotOutline(item["ShortOverview"].asString());
+    newItem->GetVideoInfoTag()->m_firstAired = premiereDate;
+    newItem->GetVideoInfoTag()->SetPremiered(premiereDate);
+    newItem->GetVideoInfoTag()->m_dateAdded.SetFromW3CDateTime(item["DateCreated"].asString());
+    newItem->GetVideoInfoTag()->SetYear(static_cast<int>(item["ProductionYear"].asInteger()));
+    newItem->GetVideoInfoTag()->SetRating(item["CommunityRating"].asFloat(), static_cast<int>(item["VoteCount"].asInteger()), "", true);
+    newItem->GetVideoInfoTag()->m_strMPAARating = item["OfficialRating"].asString();
+
+    int totalEpisodes = item["RecursiveItemCount"].asInteger() - item["ChildCount"].asInteger();
+    int unWatchedEpisodes = static_cast<int>(item["UserData"]["UnplayedItemCount"].asInteger());
+    int watchedEpisodes = totalEpisodes - unWatchedEpisodes;
+    int iSeasons        = static_cast<int>(item["ChildCount"].asInteger());
+
+    newItem->GetVideoInfoTag()->m_iSeason = iSeasons;
+    newItem->GetVideoInfoTag()->m_iEpisode = totalEpisodes;
+    newItem->GetVideoInfoTag()->m_playCount = (int)watchedEpisodes >= newItem->GetVideoInfoTag()->m_iEpisode;
+
+    newItem->SetProperty("totalseasons", iSeasons);
+    newItem->SetProperty("totalepisodes", newItem->GetVideoInfoTag()->m_iEpisode);
+    newItem->SetProperty("numepisodes",   newItem->GetVideoInfoTag()->m_iEpisode);
+    newItem->SetProperty("watchedepisodes", watchedEpisodes);
+    newItem->SetProperty("unwatchedepisodes", unWatchedEpisodes);
+
+    GetVideoDetails(*newItem, item);
+    SetEmbyItemProperties(*newItem, "tvshows");
+    items.Add(newItem);
   }
+  // this is needed to display movies/episodes properly ... dont ask
+  // good thing it didnt take 2 days to figure it out
+  items.SetProperty("library.filter", "true");
+  items.SetCacheToDisc(CFileItemList::CACHE_NEVER);
+  SetEmbyItemProperties(items, "tvshows");
   return rtn;
 }
 
@@ -1430,19 +1463,29 @@ bool CEmbyUtils::ParseEmbyArtists(CFileItemList &items, const CURL &url, const C
     return false;
   }
 
+  return ParseEmbyArtistItems(items, url, variant["Items"]);
+}
+
+bool CEmbyUtils::ParseEmbyArtists(CFileItemList &items, const CURL &url, const CEmbyViewItems &variantItems)
+{
+  return ParseEmbyArtistItems(items, url, variantItems);
+}
+
+template<class TItems>
+bool CEmbyUtils::ParseEmbyArtistItems(CFileItemList &items, const CURL &url, const TItems &variantItems)
+{
   // clear base url options
   CURL curl(url);
   curl.SetOptions("");
   std::string imagePath;
 
   bool rtn = false;
-  const auto& variantItems = variant["Items"];
-  for (auto variantItemIt = variantItems.begin_array(); variantItemIt != variantItems.end_array(); ++variantItemIt)
+  for (unsigned int k = 0; k < variantItems.size(); ++k)
   {
-    if (*variantItemIt == CVariant::VariantTypeNull)
+    const CVariant &item = variantItems[k];
+    if (item.isNull())
       continue;
 
-    const auto item = *variantItemIt;
     rtn = true;
 
     // local vars for common fields
@@ -1500,15 +1543,25 @@ bool CEmbyUtils::ParseEmbyMoviesFilter(CFileItemList &items, CURL url, const CVa
     return false;
   }
 
+  return ParseEmbyMoviesFilterItems(items, url, variant["Items"], filter);
+}
+
+bool CEmbyUtils::ParseEmbyMoviesFilter(CFileItemList &items, CURL url, const CEmbyViewItems &variantItems, const std::string &filter)
+{
+  return ParseEmbyMoviesFilterItems(items, url, variantItems, filter);
+}
+
+template<class TItems>
+bool CEmbyUtils::ParseEmbyMoviesFilterItems(CFileItemList &items, const CURL &url, const TItems &variantItems, const std::string &filter)
+{
   bool rtn = false;
   CURL curl(url);
-  const auto& variantItems = variant["Items"];
-  for (auto variantItemIt = variantItems.begin_array(); variantItemIt != variantItems.end_array(); ++variantItemIt)
+  for (unsigned int k = 0; k < variantItems.size(); ++k)
   {
-    if (*variantItemIt == CVariant::VariantTypeNull)
+    const CVariant &item = variantItems[k];
+    if (item.isNull())
       continue;
 
-    const auto item = *variantItemIt;
     rtn = true;
 
     // local vars for common fields
@@ -1546,15 +1599,25 @@ bool CEmbyUtils::ParseEmbyTVShowsFilter(CFileItemList &items, const CURL url, co
     return false;
   }
 
+  return ParseEmbyTVShowsFilterItems(items, url, variant["Items"], filter);
+}
+
+bool CEmbyUtils::ParseEmbyTVShowsFilter(CFileItemList &items, const CURL url, const CEmbyViewItems &variantItems, const std::string &filter)
+{
+  return ParseEmbyTVShowsFilterItems(items, url, variantItems, filter);
+}
+
+template<class TItems>
+bool CEmbyUtils::ParseEmbyTVShowsFilterItems(CFileItemList &items, const CURL &url, const TItems &variantItems, const std::string &filter)
+{
   bool rtn = false;
   CURL curl1(url);
-  const auto& variantItems = variant["Items"];
-  for (auto variantItemIt = variantItems.begin_array(); variantItemIt != variantItems.end_array(); ++variantItemIt)
+  for (unsigned int k = 0; k < variantItems.size(); ++k)
   {
-    if (*variantItemIt == CVariant::VariantTypeNull)
+    const CVariant &item = variantItems[k];
+    if (item.isNull())
       continue;
 
-    const auto item = *variantItemIt;
     rtn = true;
 
     // local vars for common fields
@@ -1584,47 +1647,18 @@ bool CEmbyUtils::ParseEmbyTVShowsFilter(CFileItemList &items, const CURL url, co
 
 CVariant CEmbyUtils::GetEmbyCVariant(std::string url, std::string filter)
 {
-#if defined(EMBY_DEBUG_TIMING)
-  unsigned int currentTime = XbmcThreads::SystemClockMillis();
-#endif
-  
   XFILE::CCurlFile emby;
-  emby.SetRequestHeader("Cache-Control", "no-cache");
-  emby.SetRequestHeader("Content-Type", "application/json");
-  emby.SetRequestHeader("Accept-Encoding", "gzip");
-  
-  CURL curl(url);
-  // this is key to get back gzip encoded content
-  curl.SetProtocolOption("seekable", "0");
-  // we always want json back
-  curl.SetProtocolOptions(curl.GetProtocolOptions() + "&format=json");
-  std::string response;
-  if (emby.Get(curl.Get(), response))
+  if (OpenEmbyResponse(url, emby))
   {
 #if defined(EMBY_DEBUG_TIMING)
-    CLog::Log(LOGDEBUG, "CEmbyUtils::GetEmbyCVariant %d(msec) for %lu bytes",
-              XbmcThreads::SystemClockMillis() - currentTime, response.size());
-#endif
-    if (emby.GetContentEncoding() == "gzip")
-    {
-      std::string buffer;
-      if (XFILE::CZipFile::DecompressGzip(response, buffer))
-        response = std::move(buffer);
-      else
-        return CVariant(CVariant::VariantTypeNull);
-    }
-#if defined(EMBY_DEBUG_VERBOSE)
-    CLog::Log(LOGDEBUG, "CEmbyUtils::GetEmbyCVariant %s", curl.Get().c_str());
-    CLog::Log(LOGDEBUG, "CEmbyUtils::GetEmbyCVariant %s", response.c_str());
-#endif
-#if defined(EMBY_DEBUG_TIMING)
-    currentTime = XbmcThreads::SystemClockMillis();
+    unsigned int currentTime = XbmcThreads::SystemClockMillis();
 #endif
+    // parse while the response downloads, the body is never held as a string
     CVariant resultObject;
-    if (CJSONVariantParser::Parse(response, resultObject))
+    if (CJSONVariantParser::Parse(EmbyResponseReader(emby), resultObject))
     {
 #if defined(EMBY_DEBUG_TIMING)
-      CLog::Log(LOGDEBUG, "CEmbyUtils::GetEmbyCVariant parsed in %d(msec)",
+      CLog::Log(LOGDEBUG, "CEmbyUtils::GetEmbyCVariant fetched and parsed in %d(msec)",
                 XbmcThreads::SystemClockMillis() - currentTime);
 #endif
       // recently added does not return proper object, we make one up later
@@ -1635,7 +1669,67 @@ CVariant CEmbyUtils::GetEmbyCVariant(std::string url, std::string filter)
   return CVariant(CVariant::VariantTypeNull);
 }
 
+bool CEmbyUtils::OpenEmbyResponse(std::string url, XFILE::CCurlFile &emby)
+{
+  emby.SetRequestHeader("Cache-Control", "no-cache");
+  emby.SetRequestHeader("Content-Type", "application/json");
+  // curl asks for gzip and inflates it as it arrives
+  emby.SetContentEncoding("gzip");
+
+  CURL curl(url);
+  // this is key to get back gzip encoded content
+  curl.SetProtocolOption("seekable", "0");
+  // we always want json back
+  curl.SetProtocolOptions(curl.GetProtocolOptions() + "&format=json");
+#if defined(EMBY_DEBUG_VERBOSE)
+  CLog::Log(LOGDEBUG, "CEmbyUtils::OpenEmbyResponse %s", curl.Get().c_str());
+#endif
+  return emby.Open(curl);
+}
+
+CJSONVariantParser::ReadCallback CEmbyUtils::EmbyResponseReader(XFILE::CCurlFile &emby)
+{
+  return [&emby](char *buffer, size_t size) -> size_t
+  {
+    ssize_t read = emby.Read(buffer, size);
+    return read > 0 ? read : 0;
+  };
+}
+
 #pragma mark - Emby private
+CFileItemPtr CEmbyUtils::ParseEmbyVideo(const CURL &url, const CVariant &objectItem, const std::string &type)
+{
+  // ignore raw blueray rips, these are designed to be
+  // direct played (ie via mounted filesystem)
+  // and we do not do that yet.
+  if (objectItem["VideoType"].asString() == "BluRay")
+    return nullptr;
+  if (objectItem["VideoType"].asString() == "Dvd")
+    return nullptr;
+  if (objectItem["IsFolder"].asBoolean())
+    return nullptr;
+
+  std::string videoType = type;
+  if (videoType.empty())
+  {
+    videoType = objectItem["Type"].asString();
+    StringUtils::ToLower(videoType);
+  }
+  return ToVideoFileItemPtr(url, objectItem, videoType);
+}
+
+void CEmbyUtils::SetEmbyVideosProperties(CFileItemList &items, const std::string &seasonName, const std::string &type)
+{
+  // this is needed to display movies/episodes properly ... dont ask
+  // good thing it didnt take 2 days to figure it out
+  items.SetLabel(seasonName);
+  items.SetProperty("library.filter", "true");
+  if (type == MediaTypeTvShow)
+    SetEmbyItemProperties(items, "episodes");
+  else
+    SetEmbyItemProperties(items, "movies");
+}
+
 CFileItemPtr CEmbyUtils::ToVideoFileItemPtr(CURL url, const CVariant &variant, std::string type)
 {
   // clear base url options
@@ -22,6 +22,7 @@
 #include <string>
 #include "FileItem.h"
 #include "services/ServicesManager.h"
+#include "utils/JSONVariantParser.h"
 
 //#define EMBY_DEBUG_VERBOSE
 //#define EMBY_DEBUG_TIMING
@@ -32,6 +33,7 @@ namespace XFILE
 }
 class CEmbyClient;
 typedef std::shared_ptr<CEmbyClient> CEmbyClientPtr;
+class CEmbyViewItems;
 
 
 static const std::string EmbyApiKeyHeader = "X-MediaBrowser-Token";
@@ -104,17 +106,33 @@ public:
 
   #pragma mark - Emby parsers
   static bool ParseEmbyVideos(CFileItemList &items, const CURL url, const CVariant &object, std::string type);
+  static bool ParseEmbyVideos(CFileItemList &items, const CURL url, const CEmbyViewItems &variantItems, std::string type);
+  static bool ParseEmbyVideosStream(CFileItemList &items, const CURL &url, std::string type);
   static bool ParseEmbySeries(CFileItemList &items, const CURL &url, const CVariant &variant);
+  static bool ParseEmbySeries(CFileItemList &items, const CURL &url, const CEmbyViewItems &variantItems);
   static bool ParseEmbySeasons(CFileItemList &items, const CURL &url, const CVariant &series, const CVariant &variant);
   static bool ParseEmbyAudio(CFileItemList &items, const CURL &url, const CVariant &variant);
   static bool ParseEmbyAlbum(CFileItemList &items, const CURL &url, const CVariant &variant);
   static bool ParseEmbyArtists(CFileItemList &items, const CURL &url, const CVariant &variant);
+  static bool ParseEmbyArtists(CFileItemList &items, const CURL &url, const CEmbyViewItems &variantItems);
   static bool ParseEmbyMoviesFilter(CFileItemList &items, const CURL url, const CVariant &object, const std::string &filter);
+  static bool ParseEmbyMoviesFilter(CFileItemList &items, const CURL url, const CEmbyViewItems &variantItems, const std::string &filter);
   static bool ParseEmbyTVShowsFilter(CFileItemList &items, const CURL url, const CVariant &object, const std::string &filter);
+  static bool ParseEmbyTVShowsFilter(CFileItemList &items, const CURL url, const CEmbyViewItems &variantItems, const std::string &filter);
   static CVariant GetEmbyCVariant(std::string url, std::string filter = "");
 
 private:
   #pragma mark - Emby private
+  static bool OpenEmbyResponse(std::string url, XFILE::CCurlFile &emby);
+  static CJSONVariantParser::ReadCallback EmbyResponseReader(XFILE::CCurlFile &emby);
+  // TItems is a CVariant "Items" array or a CEmbyViewItems snapshot
+  template<class TItems> static bool ParseEmbyVideoItems(CFileItemList &items, const CURL &url, const TItems &variantItems, const std::string &type);
+  template<class TItems> static bool ParseEmbySeriesItems(CFileItemList &items, const CURL &url, const TItems &variantItems);
+  template<class TItems> static bool ParseEmbyArtistItems(CFileItemList &items, const CURL &url, const TItems &variantItems);
+  template<class TItems> static bool ParseEmbyMoviesFilterItems(CFileItemList &items, const CURL &url, const TItems &variantItems, const std::string &filter);
+  template<class TItems> static bool ParseEmbyTVShowsFilterItems(CFileItemList &items, const CURL &url, const TItems &variantItems, const std::string &filter);
+  static CFileItemPtr ParseEmbyVideo(const CURL &url, const CVariant &objectItem, const std::string &type);
+  static void SetEmbyVideosProperties(CFileItemList &items, const std::string &seasonName, const std::string &type);
   static CFileItemPtr ToVideoFileItemPtr(CURL url, const CVariant &variant, std::string type);
   static void GetVideoDetails(CFileItem &item, const CVariant &variant);
   static void GetMusicDetails(CFileItem &item, const CVariant &variant);
@@ -24,8 +24,35 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 
+// refreeze once this many items have been changed and they
+// make up more than a quarter of the view.
+#define EMBY_VIEWCACHE_COMPACT_MIN 256
+
+
+CVariant CEmbyViewItems::operator[](unsigned int position) const
+{
+  if (position >= m_itemCount)
+    return CVariant(CVariant::VariantTypeNull);
+
+  if (m_changes)
+  {
+    const auto change = m_changes->find(position);
+    if (change != m_changes->end())
+      return *change->second;
+  }
+
+  // without frozen items every position is an appended one
+  const CFrozenVariant::CRef items = m_items->Root()["Items"];
+  if (!items.isArray())
+    return CVariant(CVariant::VariantTypeNull);
+  return items[position].ToVariant();
+}
 
 CEmbyViewCache::CEmbyViewCache()
+: m_items(std::make_shared<CFrozenVariant>())
+, m_changes(std::make_shared<EmbyViewChanges>())
+, m_itemCount(0)
+, m_tombstones(0)
 {
 }
 
@@ -35,8 +62,14 @@ CEmbyViewCache::~CEmbyViewCache()
 
 void CEmbyViewCache::Init(const EmbyViewContent &content)
 {
+  CFrozenVariantPtr items = std::make_shared<CFrozenVariant>(content.items);
+  std::unordered_map<std::string, size_t> index;
+  size_t count = BuildIndex(*items, index);
+
   CSingleLock lock(m_cacheLock);
   m_cache = content;
+  m_cache.items = CVariant(CVariant::VariantTypeNull);
+  SetFrozen(items, index, count);
 }
 
 const std::string CEmbyViewCache::GetId() const
@@ -53,82 +86,94 @@ const std::string CEmbyViewCache::GetName() const
 
 void CEmbyViewCache::SetItems(CVariant &variant)
 {
+  // freeze and index the new payload outside the lock, the fetched
+  // variant is no longer needed after that.
+  CFrozenVariantPtr items = std::make_shared<CFrozenVariant>(variant);
+  variant = CVariant(CVariant::VariantTypeNull);
+  std::unordered_map<std::string, size_t> index;
+  size_t count = BuildIndex(*items, index);
+
   CSingleLock lock(m_cacheLock);
-  m_cache.items = std::move(variant);
+  SetFrozen(items, index, count);
 }
 
-CVariant& CEmbyViewCache::GetItems()
+CEmbyViewItems CEmbyViewCache::GetItems()
 {
   CSingleLock lock(m_cacheLock);
-  return m_cache.items;
+  CEmbyViewItems items;
+  items.m_items = m_items;
+  items.m_changes = m_changes;
+  items.m_itemCount = m_itemCount;
+  return items;
 }
 
 bool CEmbyViewCache::ItemsValid()
 {
   CSingleLock lock(m_cacheLock);
-  if (m_cache.items.isNull())
-    return false;
+  // a view fetched empty becomes valid once items are appended to it
+  if (m_changes->empty())
+  {
+    const CFrozenVariant::CRef items = m_items->Root();
+    if (items.isNull())
+      return false;
 
-  if (!m_cache.items.isObject())
-    return false;
+    if (!items.isObject())
+      return false;
 
-  if (!m_cache.items.isMember("Items"))
-    return false;
+    if (!items.isMember("Items"))
+      return false;
 
-  if (!m_cache.items["Items"].isArray())
-    return false;
+    if (!items["Items"].isArray())
+      return false;
+  }
 
-  return m_cache.items["Items"].size() > 0;
+  return m_itemCount > m_tombstones;
 }
 
 bool CEmbyViewCache::AppendItem(const CVariant &variant)
 {
-  bool exists = false;
-  CSingleLock lock(m_cacheLock);
-  const auto& variantItems = m_cache.items["Items"];
-  for (auto variantItemIt = variantItems.begin_array(); variantItemIt != variantItems.end_array(); ++variantItemIt)
-  {
-    if (variant["Id"] == (*variantItemIt)["Id"].asString())
-    {
-      exists = true;
-      break;
-    }
-  }
-  if (!exists)
   {
-    m_cache.items["Items"].push_back(variant);
-    return true;
-  }
+    CSingleLock lock(m_cacheLock);
+    const std::string itemId = variant["Id"].asString();
+    if (m_itemIndex.find(itemId) != m_itemIndex.end())
+      return false;
 
-  return false;
+    Changes()[m_itemCount] = std::make_shared<CVariant>(variant);
+    m_itemIndex[itemId] = m_itemCount++;
+  }
+  CompactIfNeeded();
+  return true;
 }
 
 bool CEmbyViewCache::UpdateItem(const CVariant &variant)
 {
-  CSingleLock lock(m_cacheLock);
-  for (size_t k = 0; k < m_cache.items["Items"].size(); ++k)
   {
-    if (variant["Id"] == m_cache.items["Items"][k]["Id"].asString())
-    {
-      m_cache.items["Items"][k] = variant;
-      return true;
-    }
+    CSingleLock lock(m_cacheLock);
+    CVariant *item = FindItem(variant["Id"].asString());
+    if (!item)
+      return false;
+
+    *item = variant;
   }
-  return false;
+  CompactIfNeeded();
+  return true;
 }
 
 bool CEmbyViewCache::RemoveItem(const std::string &itemId)
 {
-  CSingleLock lock(m_cacheLock);
-  for (size_t k = 0; k < m_cache.items["Items"].size(); ++k)
   {
-    if (itemId == m_cache.items["Items"][k]["Id"].asString())
-    {
-      m_cache.items["Items"].erase(k);
-      return true;
-    }
+    CSingleLock lock(m_cacheLock);
+    CVariant *item = FindItem(itemId);
+    if (!item)
+      return false;
+
+    // tombstone it, the frozen items cannot be erased
+    *item = CVariant(CVariant::VariantTypeNull);
+    m_itemIndex.erase(itemId);
+    m_tombstones++;
   }
-  return false;
+  CompactIfNeeded();
+  return true;
 }
 
 const EmbyViewInfo CEmbyViewCache::GetInfo() const
@@ -144,34 +189,143 @@ const EmbyViewInfo CEmbyViewCache::GetInfo() const
 
 bool CEmbyViewCache::SetWatched(const std::string id, int playcount, double resumetime)
 {
-  CSingleLock lock(m_cacheLock);
-  for (size_t k = 0; k < m_cache.items["Items"].size(); ++k)
   {
-    if (id == m_cache.items["Items"][k]["Id"].asString())
-    {
-      // do it the long way or the value will not get updated
-      m_cache.items["Items"][k]["UserData"]["Played"] = true;
-      m_cache.items["Items"][k]["UserData"]["PlayCount"] = playcount;
-      m_cache.items["Items"][k]["UserData"]["PlaybackPositionTicks"] = CEmbyUtils::SecondsToTicks(resumetime);
-      return true;
-    }
+    CSingleLock lock(m_cacheLock);
+    CVariant *item = FindItem(id);
+    if (!item)
+      return false;
+
+    // do it the long way or the value will not get updated
+    (*item)["UserData"]["Played"] = true;
+    (*item)["UserData"]["PlayCount"] = playcount;
+    (*item)["UserData"]["PlaybackPositionTicks"] = CEmbyUtils::SecondsToTicks(resumetime);
   }
-  return false;
+  CompactIfNeeded();
+  return true;
 }
 
 bool CEmbyViewCache::SetUnWatched(const std::string id)
 {
+  {
+    CSingleLock lock(m_cacheLock);
+    CVariant *item = FindItem(id);
+    if (!item)
+      return false;
+
+    // do it the long way or the value will not get updated
+    (*item)["UserData"]["Played"] = false;
+    (*item)["UserData"]["PlayCount"] = 0;
+    (*item)["UserData"]["PlaybackPositionTicks"] = 0;
+  }
+  CompactIfNeeded();
+  return true;
+}
+
+size_t CEmbyViewCache::BuildIndex(const CFrozenVariant &frozen, std::unordered_map<std::string, size_t> &index)
+{
+  const CFrozenVariant::CRef items = frozen.Root();
+  if (!items.isObject() || !items["Items"].isArray())
+    return 0;
+
+  const CFrozenVariant::CRef variantItems = items["Items"];
+  size_t count = variantItems.size();
+  index.reserve(count);
+  for (unsigned int k = 0; k < count; ++k)
+  {
+    // first one wins, same as the old linear search
+    index.emplace(variantItems[k]["Id"].asString(), k);
+  }
+  return count;
+}
+
+void CEmbyViewCache::SetFrozen(const CFrozenVariantPtr &items, std::unordered_map<std::string, size_t> &index, size_t count)
+{
+  // caller must hold m_cacheLock, snapshots keep the old changes
+  m_items = items;
+  m_changes = std::make_shared<EmbyViewChanges>();
+  m_itemIndex.swap(index);
+  m_itemCount = count;
+  m_tombstones = 0;
+}
+
+void CEmbyViewCache::CompactIfNeeded()
+{
+  // refreeze from a snapshot so neither readers nor writers wait on the
+  // copy. it is dropped if the view changed in the meantime, the next
+  // change tries again.
+  CEmbyViewItems snapshot;
+  {
+    CSingleLock lock(m_cacheLock);
+    if (m_changes->size() < EMBY_VIEWCACHE_COMPACT_MIN ||
+        m_changes->size() * 4 <= m_itemCount)
+      return;
+    snapshot = GetItems();
+  }
+
+  CVariant payload(Thaw(snapshot));
+  CFrozenVariantPtr items = std::make_shared<CFrozenVariant>(payload);
+  payload = CVariant(CVariant::VariantTypeNull);
+  std::unordered_map<std::string, size_t> index;
+  size_t count = BuildIndex(*items, index);
+
   CSingleLock lock(m_cacheLock);
-  for (size_t k = 0; k < m_cache.items["Items"].size(); ++k)
+  if (m_items != snapshot.m_items || m_changes != snapshot.m_changes)
+    return;
+  SetFrozen(items, index, count);
+}
+
+CVariant CEmbyViewCache::Thaw(const CEmbyViewItems &snapshot)
+{
+  // rebuilds the mutable payload from the frozen
+  // items with the changes applied on top.
+  const CFrozenVariant::CRef frozen = snapshot.m_items->Root();
+  const bool hasItems = frozen.isObject() && frozen["Items"].isArray();
+  if (!hasItems && snapshot.m_changes->empty())
+    return frozen.ToVariant();
+
+  CVariant items(CVariant::VariantTypeObject);
+  if (frozen.isObject())
   {
-    if (id == m_cache.items["Items"][k]["Id"].asString())
+    for (unsigned int k = 0; k < frozen.size(); ++k)
     {
-      // do it the long way or the value will not get updated
-      m_cache.items["Items"][k]["UserData"]["Played"] = false;
-      m_cache.items["Items"][k]["UserData"]["PlayCount"] = 0;
-      m_cache.items["Items"][k]["UserData"]["PlaybackPositionTicks"] = 0;
-      return true;
+      if (frozen.key(k) != "Items")
+        items[frozen.key(k)] = frozen.value(k).ToVariant();
     }
   }
-  return false;
+
+  CVariant &variantItems = items["Items"];
+  variantItems = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int k = 0; k < snapshot.size(); ++k)
+  {
+    CVariant item = snapshot[k];
+    if (!item.isNull())
+      variantItems.push_back(std::move(item));
+  }
+  return items;
+}
+
+EmbyViewChanges& CEmbyViewCache::Changes()
+{
+  // caller must hold m_cacheLock, snapshots only ever see the
+  // changes they were taken with.
+  if (m_changes.use_count() > 1)
+    m_changes = std::make_shared<EmbyViewChanges>(*m_changes);
+  return *m_changes;
+}
+
+CVariant* CEmbyViewCache::FindItem(const std::string &itemId)
+{
+  // caller must hold m_cacheLock, the item is thawed into
+  // m_changes on first use so it can be modified.
+  const auto it = m_itemIndex.find(itemId);
+  if (it == m_itemIndex.end())
+    return nullptr;
+
+  EmbyViewChanges &changes = Changes();
+  std::shared_ptr<CVariant> &item = changes[it->second];
+  if (!item)
+    item = std::make_shared<CVariant>(m_items->Root()["Items"][it->second].ToVariant());
+  else if (item.use_count() > 1)
+    item = std::make_shared<CVariant>(*item);
+  return item.get();
 }
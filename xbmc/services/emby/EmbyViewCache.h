@@ -19,9 +19,12 @@
  *
  */
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "utils/FrozenVariant.h"
 #include "utils/Variant.h"
 #include "threads/CriticalSection.h"
 
@@ -45,6 +48,33 @@ typedef struct EmbyViewContent
   CVariant items;
 } EmbyViewContent;
 
+// items changed since the payload was frozen, keyed by array position.
+// an item is never modified once a CEmbyViewItems shares it.
+typedef std::unordered_map<size_t, std::shared_ptr<CVariant>> EmbyViewChanges;
+
+/*!
+ \brief The items of a view as they were when CEmbyViewCache::GetItems was
+ called. It shares the frozen payload and the changed items with the cache,
+ so taking one costs a few reference counts and it never changes afterwards.
+ operator[] thaws a single item into a variant the caller owns, a removed
+ item comes back null.
+ */
+class CEmbyViewItems
+{
+public:
+  CEmbyViewItems() : m_itemCount(0) { }
+
+  unsigned int size() const { return m_itemCount; }
+  CVariant operator[](unsigned int position) const;
+
+private:
+  friend class CEmbyViewCache;
+
+  CFrozenVariantPtr m_items;
+  std::shared_ptr<const EmbyViewChanges> m_changes;
+  unsigned int m_itemCount;
+};
+
 class CEmbyViewCache
 {
 public:
@@ -55,7 +85,9 @@ public:
   const std::string GetId() const;
   const std::string GetName() const;
   void  SetItems(CVariant &variant);
-  CVariant &GetItems();
+  // returns a consistent snapshot of the view items without copying
+  // them, later updates do not show up in it.
+  CEmbyViewItems GetItems();
   bool  ItemsValid();
   bool  AppendItem(const CVariant &variant);
   bool  UpdateItem(const CVariant &variant);
@@ -67,6 +99,23 @@ public:
   const EmbyViewInfo GetInfo() const;
 
 private:
+  static size_t BuildIndex(const CFrozenVariant &frozen, std::unordered_map<std::string, size_t> &index);
+  void  SetFrozen(const CFrozenVariantPtr &items, std::unordered_map<std::string, size_t> &index, size_t count);
+  void  CompactIfNeeded();
+  static CVariant Thaw(const CEmbyViewItems &snapshot);
+  EmbyViewChanges &Changes();
+  CVariant *FindItem(const std::string &itemId);
+
   EmbyViewContent m_cache;
   CCriticalSection m_cacheLock;
+  // the payload is kept frozen, (*m_items)["Items"] holds the items as
+  // fetched. changes since then live in m_changes, keyed by array position,
+  // positions past the frozen items are appended ones and a null entry is
+  // a removed item. m_itemIndex maps Id -> array position. m_changes and
+  // its items are copied before a change when a snapshot still shares them.
+  CFrozenVariantPtr m_items;
+  std::shared_ptr<EmbyViewChanges> m_changes;
+  std::unordered_map<std::string, size_t> m_itemIndex;
+  size_t m_itemCount;
+  size_t m_tombstones;
 };
@@ -25,10 +25,12 @@
 #include "PlexClient.h"
 #include "PlexUtils.h"
 #include "PlexClientSync.h"
+#include "PlexSectionCache.h"
 
 #include "Application.h"
 #include "URL.h"
 #include "filesystem/CurlFile.h"
+#include "filesystem/Directory.h"
 #include "filesystem/StackDirectory.h"
 #include "network/Network.h"
 #include "settings/Settings.h"
@@ -243,6 +245,58 @@ const std::string CPlexClient::FormatContentTitle(const std::string contentTitle
   return title;
 }
 
+const std::string CPlexClient::GetSectionUpdatedAt(const std::string &section) const
+{
+  {
+    CSingleLock lock(m_criticalMovies);
+    for (const auto &content : m_movieSectionsContents)
+    {
+      if (content.section == section)
+        return content.updatedAt;
+    }
+  }
+  {
+    CSingleLock lock(m_criticalTVShow);
+    for (const auto &content : m_showSectionsContents)
+    {
+      if (content.section == section)
+        return content.updatedAt;
+    }
+  }
+  return "";
+}
+
+CPlexSectionCachePtr CPlexClient::GetSectionCache(const std::string &section, const std::string &nodeName)
+{
+  CSingleLock lock(m_criticalSectionCache);
+  const auto it = m_sectionCache.find(section);
+  if (it != m_sectionCache.end())
+    return it->second;
+
+  // first use since startup, pick up the on-disk snapshot if there is one
+  std::string cachePath = "special://temp/plex/";
+  if (!XFILE::CDirectory::Exists(cachePath))
+    XFILE::CDirectory::Create(cachePath);
+  std::string sectionName = section;
+  StringUtils::Replace(sectionName, "/", "_");
+  std::string cacheFile = cachePath + m_uuid + "-" + sectionName + ".json";
+
+  CPlexSectionCachePtr cache = CPlexSectionCachePtr(new CPlexSectionCache(cacheFile, nodeName));
+  cache->Load();
+  m_sectionCache[section] = cache;
+  return cache;
+}
+
+void CPlexClient::SetSectionItemWatched(const std::string &ratingKey, bool watched)
+{
+  CSingleLock lock(m_criticalSectionCache);
+  for (auto &cache : m_sectionCache)
+  {
+    if (cache.second->SetWatched(ratingKey, watched))
+      break;
+  }
+}
+
 bool CPlexClient::IsSameClientHostName(const CURL& url)
 {
   CURL real_url(url);
@@ -20,6 +20,7 @@
  */
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -81,6 +82,8 @@ class CFileItem;
 typedef std::shared_ptr<CFileItem> CFileItemPtr;
 typedef std::vector<PlexSectionsContent> PlexSectionsContentVector;
 class CPlexClientSync;
+class CPlexSectionCache;
+typedef std::shared_ptr<CPlexSectionCache> CPlexSectionCachePtr;
 
 
 class CPlexClient
@@ -119,6 +122,10 @@ public:
   const PlexSectionsContentVector GetPlaylistContent() const;
   const PlexSectionsContentVector GetHomeContent() const;
   const std::string FormatContentTitle(const std::string contentTitle) const;
+  const std::string GetSectionUpdatedAt(const std::string &section) const;
+
+  CPlexSectionCachePtr GetSectionCache(const std::string &section, const std::string &nodeName);
+  void  SetSectionItemWatched(const std::string &ratingKey, bool watched);
 
   std::string GetHost();
   int         GetPort();
@@ -157,4 +164,6 @@ private:
   std::vector<PlexSectionsContent> m_photoSectionsContents;
   std::vector<PlexSectionsContent> m_playlistSectionsContents;
   std::vector<PlexSectionsContent> m_homeSectionsContents;
+  CCriticalSection  m_criticalSectionCache;
+  std::map<std::string, CPlexSectionCachePtr> m_sectionCache;
 };
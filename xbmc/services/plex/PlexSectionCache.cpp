@@ -0,0 +1,282 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PlexSectionCache.h"
+
+#include "XBDateTime.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/auto_buffer.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/log.h"
+
+// bump if the on-disk layout changes, old snapshots are then ignored.
+#define PLEX_SECTIONCACHE_VERSION 1
+// delta sync cannot see deletes or remote watched state changes
+// that do not touch updatedAt, force a full crawl once a day.
+#define PLEX_SECTIONCACHE_MAXAGE  (24 * 60 * 60)
+
+static int64_t nowAsTime()
+{
+  time_t now;
+  CDateTime::GetUTCDateTime().GetAsTime(now);
+  return now;
+}
+
+static const CVariant makeVariantArrayIfSingleItem(const CVariant &variant)
+{
+  // xml2json gives us an object for a single child, an array for more.
+  if (variant.isArray())
+    return variant;
+
+  CVariant array(CVariant::VariantTypeArray);
+  if (variant.isObject())
+    array.push_back(variant);
+  return array;
+}
+
+CPlexSectionCache::CPlexSectionCache(const std::string &cacheFile, const std::string &nodeName)
+: m_cacheFile(cacheFile)
+, m_nodeName(nodeName)
+, m_updatedAt(0)
+, m_addedAt(0)
+, m_lastFullSync(0)
+, m_dirty(false)
+, m_items(std::make_shared<CVariant>())
+{
+}
+
+CPlexSectionCache::~CPlexSectionCache()
+{
+}
+
+bool CPlexSectionCache::Load()
+{
+  XUTILS::auto_buffer buffer;
+  XFILE::CFile file;
+  if (file.LoadFile(m_cacheFile, buffer) <= 0)
+    return false;
+
+  CVariant snapshot;
+  if (!CJSONVariantParser::Parse(std::string(buffer.get(), buffer.size()), snapshot) ||
+      !snapshot.isObject() ||
+      snapshot["version"].asInteger() != PLEX_SECTIONCACHE_VERSION ||
+      !snapshot["MediaContainer"].isObject())
+  {
+    CLog::Log(LOGDEBUG, "CPlexSectionCache::Load ignoring invalid snapshot %s", m_cacheFile.c_str());
+    return false;
+  }
+
+  std::shared_ptr<CVariant> items = std::make_shared<CVariant>(std::move(snapshot["MediaContainer"]));
+  CSingleLock lock(m_cacheLock);
+  m_items = items;
+  m_sectionUpdatedAt = snapshot["sectionUpdatedAt"].asString();
+  m_lastFullSync = snapshot["lastFullSync"].asInteger();
+  m_dirty = false;
+  BuildIndex();
+  CLog::Log(LOGDEBUG, "CPlexSectionCache::Load %d items from %s",
+    (int)m_itemIndex.size(), m_cacheFile.c_str());
+  return true;
+}
+
+bool CPlexSectionCache::Save()
+{
+  std::shared_ptr<const CVariant> items;
+  CVariant snapshot(CVariant::VariantTypeObject);
+  {
+    CSingleLock lock(m_cacheLock);
+    if (!m_dirty)
+      return true;
+    items = m_items;
+    snapshot["version"] = PLEX_SECTIONCACHE_VERSION;
+    snapshot["sectionUpdatedAt"] = m_sectionUpdatedAt;
+    snapshot["lastFullSync"] = m_lastFullSync;
+    m_dirty = false;
+  }
+
+  // serialize outside the lock, the snapshot is never modified
+  snapshot["MediaContainer"] = *items;
+  std::string json;
+  if (!CJSONVariantWriter::Write(snapshot, json, true))
+    return false;
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(m_cacheFile, true) ||
+      file.Write(json.c_str(), json.size()) != (ssize_t)json.size())
+  {
+    CLog::Log(LOGERROR, "CPlexSectionCache::Save failed to write %s", m_cacheFile.c_str());
+    file.Close();
+    XFILE::CFile::Delete(m_cacheFile);
+    return false;
+  }
+  file.Close();
+  return true;
+}
+
+bool CPlexSectionCache::ItemsValid()
+{
+  CSingleLock lock(m_cacheLock);
+  return m_items->isObject() && (*m_items)[m_nodeName].isArray();
+}
+
+bool CPlexSectionCache::NeedFullSync()
+{
+  CSingleLock lock(m_cacheLock);
+  return nowAsTime() - m_lastFullSync > PLEX_SECTIONCACHE_MAXAGE;
+}
+
+void CPlexSectionCache::SetItems(CVariant &mediaContainer, const std::string &sectionUpdatedAt)
+{
+  std::shared_ptr<CVariant> items = std::make_shared<CVariant>(std::move(mediaContainer));
+  (*items)[m_nodeName] = makeVariantArrayIfSingleItem((*items)[m_nodeName]);
+
+  CSingleLock lock(m_cacheLock);
+  m_items = items;
+  m_sectionUpdatedAt = sectionUpdatedAt;
+  m_lastFullSync = nowAsTime();
+  m_dirty = true;
+  BuildIndex();
+}
+
+int CPlexSectionCache::MergeItems(const CVariant &mediaContainer, const std::string &sectionUpdatedAt)
+{
+  const CVariant delta = makeVariantArrayIfSingleItem(mediaContainer[m_nodeName]);
+
+  int merged = 0;
+  CSingleLock lock(m_cacheLock);
+  CVariant &items = MutableItems()[m_nodeName];
+  for (auto variantIt = delta.begin_array(); variantIt != delta.end_array(); ++variantIt)
+  {
+    const std::string ratingKey = (*variantIt)["ratingKey"].asString();
+    if (ratingKey.empty())
+      continue;
+
+    const auto it = m_itemIndex.find(ratingKey);
+    if (it != m_itemIndex.end())
+    {
+      items[it->second] = *variantIt;
+    }
+    else
+    {
+      items.push_back(*variantIt);
+      m_itemIndex[ratingKey] = items.size() - 1;
+    }
+    UpdateWatermarks(*variantIt);
+    merged++;
+  }
+  m_sectionUpdatedAt = sectionUpdatedAt;
+  m_dirty = true;
+  return merged;
+}
+
+std::shared_ptr<const CVariant> CPlexSectionCache::GetItems()
+{
+  CSingleLock lock(m_cacheLock);
+  return m_items;
+}
+
+size_t CPlexSectionCache::GetSize()
+{
+  CSingleLock lock(m_cacheLock);
+  return m_itemIndex.size();
+}
+
+const std::string CPlexSectionCache::GetSectionUpdatedAt() const
+{
+  CSingleLock lock(m_cacheLock);
+  return m_sectionUpdatedAt;
+}
+
+int64_t CPlexSectionCache::GetUpdatedAtWatermark() const
+{
+  CSingleLock lock(m_cacheLock);
+  return m_updatedAt;
+}
+
+int64_t CPlexSectionCache::GetAddedAtWatermark() const
+{
+  CSingleLock lock(m_cacheLock);
+  return m_addedAt;
+}
+
+bool CPlexSectionCache::SetWatched(const std::string &ratingKey, bool watched)
+{
+  CSingleLock lock(m_cacheLock);
+  const auto it = m_itemIndex.find(ratingKey);
+  if (it == m_itemIndex.end())
+    return false;
+
+  // mirror what the server does on (un)scrobble so ParsePlexVideos
+  // sees the same state it would get from a fresh listing.
+  CVariant &item = MutableItems()[m_nodeName][it->second];
+  if (watched)
+  {
+    item["viewCount"] = item["viewCount"].asInteger() + 1;
+    item["lastViewedAt"] = nowAsTime();
+  }
+  else
+  {
+    item.erase("viewCount");
+    item.erase("lastViewedAt");
+  }
+  item.erase("viewOffset");
+  m_dirty = true;
+  return true;
+}
+
+void CPlexSectionCache::BuildIndex()
+{
+  // caller must hold m_cacheLock
+  m_itemIndex.clear();
+  m_updatedAt = 0;
+  m_addedAt = 0;
+  if (!m_items->isObject() || !(*m_items)[m_nodeName].isArray())
+    return;
+
+  const CVariant &items = (*m_items)[m_nodeName];
+  m_itemIndex.reserve(items.size());
+  size_t k = 0;
+  for (auto variantIt = items.begin_array(); variantIt != items.end_array(); ++variantIt, ++k)
+  {
+    m_itemIndex.emplace((*variantIt)["ratingKey"].asString(), k);
+    UpdateWatermarks(*variantIt);
+  }
+}
+
+void CPlexSectionCache::UpdateWatermarks(const CVariant &item)
+{
+  // caller must hold m_cacheLock
+  int64_t updatedAt = item["updatedAt"].asInteger();
+  if (updatedAt > m_updatedAt)
+    m_updatedAt = updatedAt;
+  int64_t addedAt = item["addedAt"].asInteger();
+  if (addedAt > m_addedAt)
+    m_addedAt = addedAt;
+}
+
+CVariant& CPlexSectionCache::MutableItems()
+{
+  // caller must hold m_cacheLock, copy-on-write if a GetItems
+  // snapshot is still out there.
+  if (m_items.use_count() > 1)
+    m_items = std::make_shared<CVariant>(*m_items);
+  return *m_items;
+}
@@ -0,0 +1,73 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "utils/Variant.h"
+#include "threads/CriticalSection.h"
+
+// Caches the "all" listing (MediaContainer) of one Plex library section.
+// Items are indexed by ratingKey so a delta response (items with
+// updatedAt >= watermark) can be patched in place, the whole thing is
+// persisted to disk so a restart does not need a full crawl.
+class CPlexSectionCache
+{
+public:
+  CPlexSectionCache(const std::string &cacheFile, const std::string &nodeName);
+ ~CPlexSectionCache();
+
+  bool  Load();
+  bool  Save();
+
+  bool  ItemsValid();
+  bool  NeedFullSync();
+  void  SetItems(CVariant &mediaContainer, const std::string &sectionUpdatedAt);
+  int   MergeItems(const CVariant &mediaContainer, const std::string &sectionUpdatedAt);
+  // returns a consistent snapshot of the MediaContainer, never modified.
+  std::shared_ptr<const CVariant> GetItems();
+  size_t GetSize();
+
+  const std::string GetSectionUpdatedAt() const;
+  int64_t GetUpdatedAtWatermark() const;
+  int64_t GetAddedAtWatermark() const;
+
+  bool  SetWatched(const std::string &ratingKey, bool watched);
+
+private:
+  void  BuildIndex();
+  void  UpdateWatermarks(const CVariant &item);
+  CVariant &MutableItems();
+
+  std::string m_cacheFile;
+  std::string m_nodeName;
+  std::string m_sectionUpdatedAt;
+  int64_t     m_updatedAt;
+  int64_t     m_addedAt;
+  int64_t     m_lastFullSync;
+  bool        m_dirty;
+  std::shared_ptr<CVariant> m_items;
+  std::unordered_map<std::string, size_t> m_itemIndex;
+  CCriticalSection m_cacheLock;
+};
+
+typedef std::shared_ptr<CPlexSectionCache> CPlexSectionCachePtr;
@@ -20,6 +20,7 @@
 
 #include "PlexUtils.h"
 #include "PlexServices.h"
+#include "PlexSectionCache.h"
 #include "Application.h"
 #include "ContextMenuManager.h"
 #include "Util.h"
@@ -39,8 +40,8 @@
 #include "settings/Settings.h"
 #include "settings/MediaSettings.h"
 
-#include "contrib/xml2json/xml2json.hpp"
 #include "utils/JSONVariantParser.h"
+#include "utils/XMLVariantParser.h"
 
 #include "video/VideoInfoTag.h"
 #include "video/windows/GUIWindowVideoBase.h"
@@ -230,6 +231,11 @@ void CPlexUtils::SetWatched(CFileItem &item)
 
   std::string filename = StringUtils::Format(":/scrobble?identifier=com.plexapp.plugins.library&key=%s", id.c_str());
   ReportToServer(url, filename);
+
+  // keep the cached section listing in step with the server
+  CPlexClientPtr client = CPlexServices::GetInstance().FindClient(url);
+  if (client)
+    client->SetSectionItemWatched(id, true);
 }
 
 void CPlexUtils::SetUnWatched(CFileItem &item)
@@ -249,6 +255,11 @@ void CPlexUtils::SetUnWatched(CFileItem &item)
 
   std::string filename = StringUtils::Format(":/unscrobble?identifier=com.plexapp.plugins.library&key=%s", id.c_str());
   ReportToServer(url, filename);
+
+  // keep the cached section listing in step with the server
+  CPlexClientPtr client = CPlexServices::GetInstance().FindClient(url);
+  if (client)
+    client->SetSectionItemWatched(id, false);
 }
 
 void CPlexUtils::ReportProgress(CFileItem &item, double currentSeconds)
@@ -1164,9 +1175,12 @@ bool CPlexUtils::GetPlexMovies(CFileItemList &items, std::string url, std::strin
 {
   bool rtn = false;
   CURL curl(url);
-  CVariant variant = GetPlexCVariant(url);
-  if (!variant.isNull() && variant.isObject() && variant.isMember("MediaContainer"))
-    rtn = ParsePlexVideos(items, curl, variant["MediaContainer"]["Video"], MediaTypeMovie, false);
+  std::shared_ptr<const CVariant> mediaContainer = GetPlexSectionItems(url, "Video");
+  if (mediaContainer)
+    return ParsePlexVideos(items, curl, (*mediaContainer)["Video"], MediaTypeMovie, false);
+
+  CVariant variant;
+  rtn = ParsePlexVideosStream(items, curl, MediaTypeMovie, false, variant, -1);
 
   return rtn;
 }
@@ -1175,19 +1189,82 @@ bool CPlexUtils::GetPlexMovies(CFileItemList &items, std::string url, std::strin
 bool CPlexUtils::GetPlexTvshows(CFileItemList &items, std::string url)
 {
   bool rtn = false;
+  CURL curl(url);
+  std::string token = curl.GetProtocolOption("X-Plex-Token");
+  curl.SetProtocolOptions("");
+  curl.SetProtocolOption("X-Plex-Token",token);
+
+  std::shared_ptr<const CVariant> mediaContainer = GetPlexSectionItems(url, "Directory");
+  if (mediaContainer)
+    return ParsePlexSeries(items, curl, (*mediaContainer)["Directory"]);
+
   CVariant variant = GetPlexCVariant(url);
   if (!variant.isNull() && variant.isObject() && variant.isMember("MediaContainer"))
-  {
-    CURL curl(url);
-    std::string token = curl.GetProtocolOption("X-Plex-Token");
-    curl.SetProtocolOptions("");
-    curl.SetProtocolOption("X-Plex-Token",token);
     rtn = ParsePlexSeries(items, curl, variant["MediaContainer"]["Directory"]);
-  }
 
   return rtn;
 }
 
+std::shared_ptr<const CVariant> CPlexUtils::GetPlexSectionItems(const std::string &url, const std::string &nodeName)
+{
+  // only plain "library/sections/<key>/all" listings are cached,
+  // anything with a filter or paging goes straight to the server.
+  CURL curl(url);
+  std::string section = curl.GetFileName();
+  if (!StringUtils::EndsWith(section, "/all") || !curl.GetOptions().empty() ||
+      curl.HasProtocolOption("X-Plex-Container-Start"))
+    return nullptr;
+  section.erase(section.size() - 4);
+  removeLeadingSlash(section);
+
+  CPlexClientPtr client = CPlexServices::GetInstance().FindClient(url);
+  if (!client)
+    return nullptr;
+
+  const std::string sectionUpdatedAt = client->GetSectionUpdatedAt(section);
+  if (sectionUpdatedAt.empty())
+    return nullptr;
+
+  CPlexSectionCachePtr cache = client->GetSectionCache(section, nodeName);
+  if (cache->ItemsValid() && !cache->NeedFullSync())
+  {
+    if (cache->GetSectionUpdatedAt() == sectionUpdatedAt)
+      return cache->GetItems();
+
+    // section changed, ask only for what changed since our watermark
+    CURL deltaUrl(curl);
+    deltaUrl.SetProtocolOptions(deltaUrl.GetProtocolOptions() +
+      StringUtils::Format("&updatedAt>=%lld", (long long)cache->GetUpdatedAtWatermark()));
+    CVariant delta = GetPlexCVariant(deltaUrl.Get());
+    if (!delta.isNull() && delta.isObject() && delta.isMember("MediaContainer"))
+    {
+      int merged = cache->MergeItems(delta["MediaContainer"], sectionUpdatedAt);
+
+      // deltas cannot tell us about deleted items, compare against the
+      // server side total (an empty page) and fall back to a full crawl.
+      CURL totalUrl(curl);
+      totalUrl.SetProtocolOptions(totalUrl.GetProtocolOptions() + "&X-Plex-Container-Start=0&X-Plex-Container-Size=0");
+      CVariant total = GetPlexCVariant(totalUrl.Get());
+      if (!total.isNull() && total.isObject() &&
+          total["MediaContainer"]["totalSize"].asUnsignedInteger() == cache->GetSize())
+      {
+        CLog::Log(LOGDEBUG, "CPlexUtils::GetPlexSectionItems %s merged %d changed items",
+          section.c_str(), merged);
+        cache->Save();
+        return cache->GetItems();
+      }
+    }
+  }
+
+  CVariant variant = GetPlexCVariant(url);
+  if (variant.isNull() || !variant.isObject() || !variant.isMember("MediaContainer"))
+    return nullptr;
+
+  cache->SetItems(variant["MediaContainer"], sectionUpdatedAt);
+  cache->Save();
+  return cache->GetItems();
+}
+
 bool CPlexUtils::GetPlexSeasons(CFileItemList &items, const std::string url)
 {
   bool rtn = false;
@@ -1203,16 +1280,11 @@ bool CPlexUtils::GetPlexSeasons(CFileItemList &items, const std::string url)
 
 bool CPlexUtils::GetPlexEpisodes(CFileItemList &items, const std::string url)
 {
-  bool rtn = false;
   CURL curl(url);
-  CVariant variant = GetPlexCVariant(url);
-  if (!variant.isNull() && variant.isObject() && variant.isMember("MediaContainer"))
-  {
-    int season = variant["MediaContainer"]["parentIndex"].asInteger();
-    rtn = ParsePlexVideos(items, curl, variant["MediaContainer"]["Video"], MediaTypeEpisode, true, season);
-    if (rtn)
-      items.SetLabel(variant["MediaContainer"]["title2"].asString());
-  }
+  CVariant mediaContainer;
+  bool rtn = ParsePlexVideosStream(items, curl, MediaTypeEpisode, true, mediaContainer);
+  if (rtn)
+    items.SetLabel(mediaContainer["title2"].asString());
 
   return rtn;
 }
@@ -1584,144 +1656,75 @@ bool CPlexUtils::ParsePlexVideos(CFileItemList &items, CURL url, const CVariant
   if (videos.isNull())
     return rtn;
 
-  std::string value;
-  std::string imagePath;
   url.RemoveProtocolOption("type");
   url.RemoveProtocolOption("X-Plex-Container-Start");
   url.RemoveProtocolOption("X-Plex-Container-Size");
-  const CVariant variantVideo = makeVariantArrayIfSingleItem(videos);
+  // only copy when we have to wrap a single item
+  const CVariant singleVideo = videos.isArray() ? CVariant(CVariant::VariantTypeNull) : makeVariantArrayIfSingleItem(videos);
+  const CVariant &variantVideo = videos.isArray() ? videos : singleVideo;
   for (auto variantIt = variantVideo.begin_array(); variantIt != variantVideo.end_array(); ++variantIt)
   {
     if (*variantIt == CVariant::VariantTypeNull)
       continue;
-    const auto item = *variantIt;
 
     rtn = true;
-    CFileItemPtr plexItem(new CFileItem());
-
-    std::string fanart;
-    std::string value;
-    // if we have season means we are listing episodes, we need to get the fanart from rootXmlNode.
-    // movies has it in videoNode
-    if (season > -1)
-    {
-      value = item["thumb"].asString();
-      removeLeadingSlash(value);
-      url.SetFileName(value);
-      imagePath = url.Get();
-      plexItem->SetArt("thumb", imagePath);
-      plexItem->SetArt("tvshow.thumb", imagePath);
-      plexItem->SetIconImage(imagePath);
-      fanart = item["art"].asString();
-      plexItem->GetVideoInfoTag()->m_iSeason = season;
-      plexItem->GetVideoInfoTag()->m_iEpisode = item["index"].asInteger();
-      plexItem->GetVideoInfoTag()->m_strShowTitle = item["grandparentTitle"].asString();
-    }
-    else if (!item["grandparentTitle"].isNull()) // only recently added episodes have this
-    {
-      fanart = item["art"].asString();
-
-      plexItem->GetVideoInfoTag()->m_iSeason = item["parentIndex"].asInteger();
-      plexItem->GetVideoInfoTag()->m_iEpisode = item["index"].asInteger();
-      plexItem->GetVideoInfoTag()->m_strShowTitle = item["grandparentTitle"].asString();
-
-      value = item["thumb"].asString();
-      removeLeadingSlash(value);
-      url.SetFileName(value);
-      imagePath = url.Get();
-      plexItem->SetArt("thumb", imagePath);
-
-      value = item["parentThumb"].asString();
-      removeLeadingSlash(value);
-      url.SetFileName(value);
-      imagePath = url.Get();
-      plexItem->SetArt("season.poster", imagePath);
-
-      value = item["grandparentThumb"].asString();
-      removeLeadingSlash(value);
-      url.SetFileName(value);
-      imagePath = url.Get();
-      plexItem->SetArt("tvshow.poster", imagePath);
-      plexItem->SetArt("tvshow.thumb", imagePath);
-
-      plexItem->SetIconImage(imagePath);
-
-      std::string seasonEpisode = StringUtils::Format("S%02iE%02i", plexItem->GetVideoInfoTag()->m_iSeason, plexItem->GetVideoInfoTag()->m_iEpisode);
-      plexItem->SetProperty("SeasonEpisode", seasonEpisode);
-    }
-    else
-    {
-      fanart = item["art"].asString();
-      plexItem->SetLabel(item["title"].asString());
-
-      value = item["thumb"].asString();
-      removeLeadingSlash(value);
-      url.SetFileName(value);
-      imagePath = url.Get();
-      plexItem->SetArt("thumb", imagePath);
-      plexItem->SetIconImage(imagePath);
-    }
-
-    std::string title = item["title"].asString();
-    plexItem->SetLabel(title);
-    plexItem->GetVideoInfoTag()->m_strTitle = title;
-    plexItem->SetMediaServiceId(item["ratingKey"].asString());
-    plexItem->SetProperty("PlexShowKey", item["grandparentRatingKey"].asString());
-    plexItem->GetVideoInfoTag()->m_type = type;
-    plexItem->GetVideoInfoTag()->SetPlotOutline(item["tagline"].asString());
-    plexItem->GetVideoInfoTag()->SetPlot(item["summary"].asString());
-
-    CDateTime firstAired;
-    firstAired.SetFromDBDate(item["originallyAvailableAt"].asString());
-    plexItem->GetVideoInfoTag()->m_firstAired = firstAired;
-
-    time_t addedTime = item["addedAt"].asInteger();
-    plexItem->GetVideoInfoTag()->m_dateAdded = CDateTime(addedTime);
-    
-    time_t lastPlayed = item["lastViewedAt"].asInteger();
-    plexItem->GetVideoInfoTag()->m_lastPlayed = CDateTime(lastPlayed);
-
-    removeLeadingSlash(fanart);
-    url.SetFileName(fanart);
-    plexItem->SetArt("fanart", url.Get());
+    items.Add(ParsePlexVideo(url, *variantIt, type, formatLabel, season));
+  }
+  // this is needed to display movies/episodes properly ... dont ask
+  // good thing it didnt take 2 days to figure it out
+//  items.SetProperty("library.filter", "true");
+  SetPlexItemProperties(items);
 
-    plexItem->GetVideoInfoTag()->SetYear(item["year"].asInteger());
-    
-    // Set ratings
-    SetPlexRatingProperties(*plexItem, item);
-    
-    // lastViewedAt means that it was watched, if so we set m_playCount to 1 and set overlay.
-    // If we have "viewOffset" that means we are partially watched and shoudl not set m_playCount to 1
-    if (item.isMember("lastViewedAt") && !item.isMember("viewOffset"))
-      plexItem->GetVideoInfoTag()->m_playCount = 1;
+  return rtn;
+}
 
-    plexItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, plexItem->HasVideoInfoTag() && plexItem->GetVideoInfoTag()->m_playCount > 0);
+bool CPlexUtils::ParsePlexVideosStream(CFileItemList &items, CURL url, const std::string &type, bool formatLabel, CVariant &mediaContainer, int season /* = -2 */)
+{
+  // same as GetPlexCVariant + ParsePlexVideos but Video items are turned
+  // into CFileItems as they are parsed, the full CVariant tree is never built.
+  // season -2 means take it from the MediaContainer (episode listings).
+  XFILE::CCurlFile curlfile;
+  if (!OpenPlexResponse(url.Get(), "", curlfile))
+    return false;
 
-    GetVideoDetails(*plexItem, item);
+#if defined(PLEX_DEBUG_TIMING)
+  unsigned int currentTime = XbmcThreads::SystemClockMillis();
+  int itemCount = 0;
+#endif
+  bool rtn = false;
+  CURL itemUrl(url);
+  itemUrl.RemoveProtocolOption("type");
+  itemUrl.RemoveProtocolOption("X-Plex-Container-Start");
+  itemUrl.RemoveProtocolOption("X-Plex-Container-Size");
+  CVariant resultObject;
+  const std::vector<std::string> videoPath = { "MediaContainer", "Video" };
+  bool parsed = CXMLVariantParser::Parse(PlexResponseReader(curlfile), videoPath, [&](CVariant &item)
+  {
+    if (item == CVariant::VariantTypeNull)
+      return true;
 
-    CBookmark m_bookmark;
-    m_bookmark.timeInSeconds = item["viewOffset"].asInteger() / 1000;
-    m_bookmark.totalTimeInSeconds = item["duration"].asInteger() / 1000;;
-    plexItem->GetVideoInfoTag()->m_resumePoint = m_bookmark;
-    plexItem->m_lStartOffset = item["viewOffset"].asInteger() / 1000;
+#if defined(PLEX_DEBUG_TIMING)
+    itemCount++;
+#endif
+    // the MediaContainer attributes are parsed ahead of its children
+    int itemSeason = season;
+    if (itemSeason == -2)
+      itemSeason = resultObject["MediaContainer"]["parentIndex"].asInteger();
+    rtn = true;
+    items.Add(ParsePlexVideo(itemUrl, item, type, formatLabel, itemSeason));
+    return true;
+  }, resultObject);
 
-    const CVariant media = makeVariantArrayIfSingleItem(item["Media"]);
-    GetMediaDetals(*plexItem, url, media[0]);
+  if (!parsed || !resultObject.isObject() || !resultObject.isMember("MediaContainer"))
+    return false;
 
-    if (formatLabel)
-    {
-      CLabelFormatter formatter("%H. %T", "");
-      formatter.FormatLabel(plexItem.get());
-      plexItem->SetLabelPreformated(true);
-    }
-    SetPlexItemProperties(*plexItem);
-    items.Add(plexItem);
-  }
-  // this is needed to display movies/episodes properly ... dont ask
-  // good thing it didnt take 2 days to figure it out
-//  items.SetProperty("library.filter", "true");
   SetPlexItemProperties(items);
+  mediaContainer = std::move(resultObject["MediaContainer"]);
 
+#if defined(PLEX_DEBUG_TIMING)
+  CLog::Log(LOGDEBUG, "CPlexUtils::ParsePlexVideosStream %d(msec) for %d items",
+    XbmcThreads::SystemClockMillis() - currentTime, itemCount);
+#endif
   return rtn;
 }
 
@@ -2100,6 +2103,130 @@ bool CPlexUtils::ParsePlexArtistsAlbum(CFileItemList &items, const CURL &url, co
 }
 
 #pragma mark - Plex private
+CFileItemPtr CPlexUtils::ParsePlexVideo(CURL &url, const CVariant &item, const std::string &type, bool formatLabel, int season)
+{
+  std::string imagePath;
+  CFileItemPtr plexItem(new CFileItem());
+
+  std::string fanart;
+  std::string value;
+  // if we have season means we are listing episodes, we need to get the fanart from rootXmlNode.
+  // movies has it in videoNode
+  if (season > -1)
+  {
+    value = item["thumb"].asString();
+    removeLeadingSlash(value);
+    url.SetFileName(value);
+    imagePath = url.Get();
+    plexItem->SetArt("thumb", imagePath);
+    plexItem->SetArt("tvshow.thumb", imagePath);
+    plexItem->SetIconImage(imagePath);
+    fanart = item["art"].asString();
+    plexItem->GetVideoInfoTag()->m_iSeason = season;
+    plexItem->GetVideoInfoTag()->m_iEpisode = item["index"].asInteger();
+    plexItem->GetVideoInfoTag()->m_strShowTitle = item["grandparentTitle"].asString();
+  }
+  else if (!item["grandparentTitle"].isNull()) // only recently added episodes have this
+  {
+    fanart = item["art"].asString();
+
+    plexItem->GetVideoInfoTag()->m_iSeason = item["parentIndex"].asInteger();
+    plexItem->GetVideoInfoTag()->m_iEpisode = item["index"].asInteger();
+    plexItem->GetVideoInfoTag()->m_strShowTitle = item["grandparentTitle"].asString();
+
+    value = item["thumb"].asString();
+    removeLeadingSlash(value);
+    url.SetFileName(value);
+    imagePath = url.Get();
+    plexItem->SetArt("thumb", imagePath);
+
+    value = item["parentThumb"].asString();
+    removeLeadingSlash(value);
+    url.SetFileName(value);
+    imagePath = url.Get();
+    plexItem->SetArt("season.poster", imagePath);
+
+    value = item["grandparentThumb"].asString();
+    removeLeadingSlash(value);
+    url.SetFileName(value);
+    imagePath = url.Get();
+    plexItem->SetArt("tvshow.poster", imagePath);
+    plexItem->SetArt("tvshow.thumb", imagePath);
+
+    plexItem->SetIconImage(imagePath);
+
+    std::string seasonEpisode = StringUtils::Format("S%02iE%02i", plexItem->GetVideoInfoTag()->m_iSeason, plexItem->GetVideoInfoTag()->m_iEpisode);
+    plexItem->SetProperty("SeasonEpisode", seasonEpisode);
+  }
+  else
+  {
+    fanart = item["art"].asString();
+    plexItem->SetLabel(item["title"].asString());
+
+    value = item["thumb"].asString();
+    removeLeadingSlash(value);
+    url.SetFileName(value);
+    imagePath = url.Get();
+    plexItem->SetArt("thumb", imagePath);
+    plexItem->SetIconImage(imagePath);
+  }
+
+  std::string title = item["title"].asString();
+  plexItem->SetLabel(title);
+  plexItem->GetVideoInfoTag()->m_strTitle = title;
+  plexItem->SetMediaServiceId(item["ratingKey"].asString());
+  plexItem->SetProperty("PlexShowKey", item["grandparentRatingKey"].asString());
+  plexItem->GetVideoInfoTag()->m_type = type;
+  plexItem->GetVideoInfoTag()->SetPlotOutline(item["tagline"].asString());
+  plexItem->GetVideoInfoTag()->SetPlot(item["summary"].asString());
+
+  CDateTime firstAired;
+  firstAired.SetFromDBDate(item["originallyAvailableAt"].asString());
+  plexItem->GetVideoInfoTag()->m_firstAired = firstAired;
+
+  time_t addedTime = item["addedAt"].asInteger();
+  plexItem->GetVideoInfoTag()->m_dateAdded = CDateTime(addedTime);
+  
+  time_t lastPlayed = item["lastViewedAt"].asInteger();
+  plexItem->GetVideoInfoTag()->m_lastPlayed = CDateTime(lastPlayed);
+
+  removeLeadingSlash(fanart);
+  url.SetFileName(fanart);
+  plexItem->SetArt("fanart", url.Get());
+
+  plexItem->GetVideoInfoTag()->SetYear(item["year"].asInteger());
+  
+  // Set ratings
+  SetPlexRatingProperties(*plexItem, item);
+  
+  // lastViewedAt means that it was watched, if so we set m_playCount to 1 and set overlay.
+  // If we have "viewOffset" that means we are partially watched and shoudl not set m_playCount to 1
+  if (item.isMember("lastViewedAt") && !item.isMember("viewOffset"))
+    plexItem->GetVideoInfoTag()->m_playCount = 1;
+
+  plexItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, plexItem->HasVideoInfoTag() && plexItem->GetVideoInfoTag()->m_playCount > 0);
+
+  GetVideoDetails(*plexItem, item);
+
+  CBookmark m_bookmark;
+  m_bookmark.timeInSeconds = item["viewOffset"].asInteger() / 1000;
+  m_bookmark.totalTimeInSeconds = item["duration"].asInteger() / 1000;;
+  plexItem->GetVideoInfoTag()->m_resumePoint = m_bookmark;
+  plexItem->m_lStartOffset = item["viewOffset"].asInteger() / 1000;
+
+  const CVariant media = makeVariantArrayIfSingleItem(item["Media"]);
+  GetMediaDetals(*plexItem, url, media[0]);
+
+  if (formatLabel)
+  {
+    CLabelFormatter formatter("%H. %T", "");
+    formatter.FormatLabel(plexItem.get());
+    plexItem->SetLabelPreformated(true);
+  }
+  SetPlexItemProperties(*plexItem);
+  return plexItem;
+}
+
 void CPlexUtils::ReportToServer(std::string url, std::string filename)
 {
   CURL url2(url);
@@ -2370,53 +2497,18 @@ void CPlexUtils::GetMediaDetals(CFileItem &item, CURL url, const CVariant &media
 
 CVariant CPlexUtils::GetPlexCVariant(std::string url, std::string filter)
 {
-#if defined(PLEX_DEBUG_TIMING)
-  unsigned int currentTime = XbmcThreads::SystemClockMillis();
-#endif
   XFILE::CCurlFile curlfile;
-  curlfile.SetRequestHeader("Accept-Encoding", "gzip");
-  GetDefaultHeaders(&curlfile);
-
-  StringUtils::Replace(url, "|","?");
-  CURL curl(url);
-  // this is key to get back gzip encoded content
-  curl.SetProtocolOption("seekable", "0");
-  if (!filter.empty())
-    curl.SetFileName(curl.GetFileName() + filter);
-
-  std::string response;
-  if (curlfile.Get(curl.Get(), response))
+  if (OpenPlexResponse(url, filter, curlfile))
   {
-
 #if defined(PLEX_DEBUG_TIMING)
-    CLog::Log(LOGDEBUG, "CPlexUtils::GetPlexCVariant %d(msec) for %lu bytes",
-              XbmcThreads::SystemClockMillis() - currentTime, response.size());
+    unsigned int currentTime = XbmcThreads::SystemClockMillis();
 #endif
-
-    if (curlfile.GetContentEncoding() == "gzip")
-    {
-      std::string buffer;
-      if (XFILE::CZipFile::DecompressGzip(response, buffer))
-        response = std::move(buffer);
-      else
-        return CVariant(CVariant::VariantTypeNull);
-    }
-
-#if defined(PLEX_DEBUG_VERBOSE)
-    CLog::Log(LOGDEBUG, "CPlexUtils::GetPlexCVariant %s", curl.Get().c_str());
-    CLog::Log(LOGDEBUG, "CPlexUtils::GetPlexCVariant %s", response.c_str());
-#endif
-#if defined(PLEX_DEBUG_TIMING)
-    currentTime = XbmcThreads::SystemClockMillis();
-#endif
-    // be careful, xml2json will mess with response somehow
-    // so make a copy of you want to use it later.
-    std::string jsonBody = xml2json(response.c_str());
+    // parse the xml while it downloads, laid out as xml2json would
     CVariant resultObject;
-    if (CJSONVariantParser::Parse(jsonBody, resultObject))
+    if (CXMLVariantParser::Parse(PlexResponseReader(curlfile), resultObject))
     {
   #if defined(PLEX_DEBUG_TIMING)
-      CLog::Log(LOGDEBUG, "CPlexUtils::GetPlexCVariant parsed in %d(msec)",
+      CLog::Log(LOGDEBUG, "CPlexUtils::GetPlexCVariant fetched and parsed in %d(msec)",
                   XbmcThreads::SystemClockMillis() - currentTime);
   #endif
       // recently added does not return proper object, we make one up later
@@ -2428,6 +2520,34 @@ CVariant CPlexUtils::GetPlexCVariant(std::string url, std::string filter)
   return CVariant(CVariant::VariantTypeNull);
 }
 
+bool CPlexUtils::OpenPlexResponse(std::string url, std::string filter, XFILE::CCurlFile &curlfile)
+{
+  // curl asks for gzip and inflates it as it arrives
+  curlfile.SetContentEncoding("gzip");
+  GetDefaultHeaders(&curlfile);
+
+  StringUtils::Replace(url, "|","?");
+  CURL curl(url);
+  // this is key to get back gzip encoded content
+  curl.SetProtocolOption("seekable", "0");
+  if (!filter.empty())
+    curl.SetFileName(curl.GetFileName() + filter);
+
+#if defined(PLEX_DEBUG_VERBOSE)
+  CLog::Log(LOGDEBUG, "CPlexUtils::OpenPlexResponse %s", curl.Get().c_str());
+#endif
+  return curlfile.Open(curl);
+}
+
+CJSONVariantParser::ReadCallback CPlexUtils::PlexResponseReader(XFILE::CCurlFile &curlfile)
+{
+  return [&curlfile](char *buffer, size_t size) -> size_t
+  {
+    ssize_t read = curlfile.Read(buffer, size);
+    return read > 0 ? read : 0;
+  };
+}
+
 TiXmlDocument CPlexUtils::GetPlexXML(std::string url, std::string filter)
 {
 #if defined(PLEX_DEBUG_TIMING)
@@ -23,6 +23,7 @@
 #include "FileItem.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/XMLUtils.h"
+#include "utils/JSONVariantParser.h"
 #include "services/ServicesManager.h"
 
 //#define PLEX_DEBUG_VERBOSE
@@ -101,6 +102,7 @@ public:
 
   // Plex parsers
   static bool ParsePlexVideos(CFileItemList &items, CURL url, const CVariant &video, std::string type, bool formatLabel, int season = -1);
+  static bool ParsePlexVideosStream(CFileItemList &items, CURL url, const std::string &type, bool formatLabel, CVariant &mediaContainer, int season = -2);
   static bool ParsePlexSeries(CFileItemList &items, const CURL &url, const CVariant &directory);
   static bool ParsePlexSeasons(CFileItemList &items, const CURL &url, const CVariant &mediacontainer, const CVariant &directory);
   static bool ParsePlexSongs(CFileItemList &items, const CURL &url, const CVariant &track);
@@ -114,6 +116,10 @@ private:
   static void GetMusicDetails(CFileItem &item, const CVariant &video);
   static void GetMediaDetals(CFileItem &item, CURL url, const CVariant &media, std::string id = "0");
   static CVariant GetPlexCVariant(std::string url, std::string filter = "");
+  static bool OpenPlexResponse(std::string url, std::string filter, XFILE::CCurlFile &curlfile);
+  static CJSONVariantParser::ReadCallback PlexResponseReader(XFILE::CCurlFile &curlfile);
+  static CFileItemPtr ParsePlexVideo(CURL &url, const CVariant &item, const std::string &type, bool formatLabel, int season);
+  static std::shared_ptr<const CVariant> GetPlexSectionItems(const std::string &url, const std::string &nodeName);
   static TiXmlDocument GetPlexXML(std::string url, std::string filter = "");
   static int ParsePlexCVariant(const CVariant &item);
   static int ParsePlexMediaXML(TiXmlDocument xml);
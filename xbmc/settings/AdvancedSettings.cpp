@@ -177,6 +177,7 @@ void CAdvancedSettings::Initialize()
   m_videoSubsDelayRange = 60;
   m_videoAudioDelayRange = 10;
   m_videoUseTimeSeeking = true;
+  m_videoMemoryMapLocalFiles = false;
   m_videoTimeSeekForward = 30;
   m_videoTimeSeekBackward = -30;
   m_videoTimeSeekForwardBig = 600;
@@ -333,6 +334,7 @@ void CAdvancedSettings::Initialize()
   m_sambadoscodepage = "";
 
   m_bHTTPDirectoryStatFilesize = false;
+  m_httpSegments = 0;
 
   m_bFTPThumbs = false;
 
@@ -352,6 +354,7 @@ void CAdvancedSettings::Initialize()
   m_iVideoLibraryRecentlyAddedItems = 25;
   m_bVideoLibraryCleanOnUpdate = false;
   m_bVideoLibraryUseFastHash = true;
+  m_iVideoLibraryScanThreads = 4;
   m_bVideoLibraryExportAutoThumbs = false;
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
@@ -421,6 +424,8 @@ void CAdvancedSettings::Initialize()
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webserverThreadPool = 0;
+
   m_enableMultimediaKeys = false;
 
 #if defined(TARGET_DARWIN_IOS)
@@ -574,6 +579,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetFloat(pElement, "ignorepercentatend", m_videoIgnorePercentAtEnd, 0, 100.0f);
 
     XMLUtils::GetBoolean(pElement, "usetimeseeking", m_videoUseTimeSeeking);
+    XMLUtils::GetBoolean(pElement, "mmaplocalfiles", m_videoMemoryMapLocalFiles);
     XMLUtils::GetInt(pElement, "timeseekforward", m_videoTimeSeekForward, 0, 6000);
     XMLUtils::GetInt(pElement, "timeseekbackward", m_videoTimeSeekBackward, -6000, 0);
     XMLUtils::GetInt(pElement, "timeseekforwardbig", m_videoTimeSeekForwardBig, 0, 6000);
@@ -781,6 +787,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "recentlyaddeditems", m_iVideoLibraryRecentlyAddedItems, 1, INT_MAX);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", m_bVideoLibraryCleanOnUpdate);
     XMLUtils::GetBoolean(pElement, "usefasthash", m_bVideoLibraryUseFastHash);
+    XMLUtils::GetInt(pElement, "scanthreads", m_iVideoLibraryScanThreads, 1, 16);
     XMLUtils::GetString(pElement, "itemseparator", m_videoItemSeparator);
     XMLUtils::GetBoolean(pElement, "exportautothumbs", m_bVideoLibraryExportAutoThumbs);
     XMLUtils::GetBoolean(pElement, "importwatchedstate", m_bVideoLibraryImportWatchedState);
@@ -823,6 +830,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+    XMLUtils::GetInt(pElement, "threadpool", m_webserverThreadPool, 0, 64);
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -833,6 +844,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   if (pElement)
     XMLUtils::GetBoolean(pElement, "statfilesize", m_bHTTPDirectoryStatFilesize);
 
+  pElement = pRootElement->FirstChildElement("http");
+  if (pElement)
+    XMLUtils::GetInt(pElement, "segments", m_httpSegments, 0, 16);
+
   pElement = pRootElement->FirstChildElement("ftp");
   if (pElement)
   {
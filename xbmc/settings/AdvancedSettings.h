@@ -154,6 +154,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler, CJob
     float m_videoSubsDelayRange;
     float m_videoAudioDelayRange;
     bool m_videoUseTimeSeeking;
+    bool m_videoMemoryMapLocalFiles;
     int m_videoTimeSeekForward;
     int m_videoTimeSeekBackward;
     int m_videoTimeSeekForwardBig;
@@ -253,6 +254,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler, CJob
     std::string m_sambadoscodepage;
 
     bool m_bHTTPDirectoryStatFilesize;
+    int m_httpSegments; ///< \brief parallel range requests for large http files, 0 or 1 to disable
 
     bool m_bFTPThumbs;
 
@@ -274,6 +276,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler, CJob
     int m_iVideoLibraryRecentlyAddedItems;
     bool m_bVideoLibraryCleanOnUpdate;
     bool m_bVideoLibraryUseFastHash;
+    int m_iVideoLibraryScanThreads;
     bool m_bVideoLibraryExportAutoThumbs;
     bool m_bVideoLibraryImportWatchedState;
     bool m_bVideoLibraryImportResumePoint;
@@ -347,6 +350,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler, CJob
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    int m_webserverThreadPool; ///< \brief webserver threads polling all connections, 0 for one thread per connection
+
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
     void ParseSettingsFile(const std::string &file);
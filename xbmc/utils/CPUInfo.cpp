@@ -283,6 +283,10 @@ CCPUInfo::CCPUInfo(void)
               m_cpuFeatures |= CPU_FEATURE_3DNOW;
             else if (0 == strcmp(tok, "3dnowext"))
               m_cpuFeatures |= CPU_FEATURE_3DNOWEXT;
+            else if (0 == strcmp(tok, "avx"))
+              m_cpuFeatures |= CPU_FEATURE_AVX;
+            else if (0 == strcmp(tok, "avx2"))
+              m_cpuFeatures |= CPU_FEATURE_AVX2;
             tok = strtok_r(NULL, " ", &save);
           }
         }
@@ -693,9 +697,20 @@ void CCPUInfo::ReadCPUFeatures()
         m_cpuFeatures |= CPU_FEATURE_3DNOW;
       if (strstr(buffer,"3DNOWEXT "))
        m_cpuFeatures |= CPU_FEATURE_3DNOWEXT;
+      if (strstr(buffer,"AVX1.0 "))
+        m_cpuFeatures |= CPU_FEATURE_AVX;
     }
     else
       m_cpuFeatures |= CPU_FEATURE_MMX;
+
+    len = 512 - 1;
+    memset(buffer, 0, sizeof(buffer));
+    if (sysctlbyname("machdep.cpu.leaf7_features", &buffer, &len, NULL, 0) == 0)
+    {
+      strcat(buffer, " ");
+      if (strstr(buffer,"AVX2 "))
+        m_cpuFeatures |= CPU_FEATURE_AVX2;
+    }
   #endif
 #elif defined(LINUX)
 // empty on purpose, the implementation is in the constructor
@@ -0,0 +1,373 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FrozenVariant.h"
+
+#include <algorithm>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+// string values up to this length are interned like keys,
+// media server payloads repeat short values ("Movie", "VideoFile", ...)
+#define FROZENVARIANT_INTERN_MAX 32
+
+static size_t alignUp(size_t size, size_t alignment)
+{
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+class CFrozenVariant::CBuilder
+{
+public:
+  uint32_t Freeze(const CVariant &variant)
+  {
+    Node node;
+    memset(&node, 0, sizeof(node));
+    node.type = variant.type();
+    switch (variant.type())
+    {
+      case CVariant::VariantTypeInteger:
+        node.integer = variant.asInteger();
+        break;
+      case CVariant::VariantTypeUnsignedInteger:
+        node.unsignedinteger = variant.asUnsignedInteger();
+        break;
+      case CVariant::VariantTypeBoolean:
+        node.boolean = variant.asBoolean();
+        break;
+      case CVariant::VariantTypeDouble:
+        node.dvalue = variant.asDouble();
+        break;
+      case CVariant::VariantTypeString:
+      {
+        const std::string &str = variant.asString();
+        if (str.size() <= FROZENVARIANT_INTERN_MAX)
+          return Intern(str);
+        return AddString(str.c_str(), str.size(), str.size(), CVariant::VariantTypeString);
+      }
+      case CVariant::VariantTypeWideString:
+      {
+        const std::wstring str = variant.asWideString();
+        return AddString(reinterpret_cast<const char*>(str.c_str()), str.size() * sizeof(wchar_t),
+          str.size(), CVariant::VariantTypeWideString);
+      }
+      case CVariant::VariantTypeArray:
+      {
+        const uint32_t index = AddNode(node);
+        const uint32_t offset = children.size();
+        children.resize(offset + variant.size());
+        uint32_t k = 0;
+        for (auto it = variant.begin_array(); it != variant.end_array(); ++it, ++k)
+        {
+          // children may be reallocated by the recursion, do not hold a reference
+          const uint32_t child = Freeze(*it);
+          children[offset + k] = child;
+        }
+        nodes[index].size = k;
+        nodes[index].offset = offset;
+        return index;
+      }
+      case CVariant::VariantTypeObject:
+      {
+        // std::map already keeps the keys sorted the way CompareKey wants
+        const uint32_t index = AddNode(node);
+        const uint32_t offset = members.size();
+        members.resize(offset + variant.size());
+        uint32_t k = 0;
+        for (auto it = variant.begin_map(); it != variant.end_map(); ++it, ++k)
+        {
+          const uint32_t key = Intern(it->first);
+          const uint32_t value = Freeze(it->second);
+          members[offset + k].key = key;
+          members[offset + k].value = value;
+        }
+        nodes[index].size = k;
+        nodes[index].offset = offset;
+        return index;
+      }
+      default:
+        node.type = CVariant::VariantTypeNull;
+        break;
+    }
+    return AddNode(node);
+  }
+
+  std::vector<Node> nodes;
+  std::vector<uint32_t> children;
+  std::vector<Member> members;
+  std::vector<char> strings;
+
+private:
+  uint32_t AddNode(const Node &node)
+  {
+    nodes.push_back(node);
+    return nodes.size() - 1;
+  }
+
+  uint32_t AddString(const char *str, size_t bytes, size_t length, CVariant::VariantType type)
+  {
+    Node node;
+    memset(&node, 0, sizeof(node));
+    node.type = type;
+    node.size = length;
+    node.offset = strings.size();
+    strings.insert(strings.end(), str, str + bytes);
+    // keep strings terminated and wide strings aligned
+    strings.resize(alignUp(strings.size() + 1, sizeof(wchar_t)), '\0');
+    return AddNode(node);
+  }
+
+  uint32_t Intern(const std::string &str)
+  {
+    const auto it = m_interned.find(str);
+    if (it != m_interned.end())
+      return it->second;
+
+    const uint32_t index = AddString(str.c_str(), str.size(), str.size(), CVariant::VariantTypeString);
+    m_interned.emplace(str, index);
+    return index;
+  }
+
+  std::unordered_map<std::string, uint32_t> m_interned;
+};
+
+CFrozenVariant::CFrozenVariant()
+  : CFrozenVariant(CVariant(CVariant::VariantTypeNull))
+{
+}
+
+CFrozenVariant::CFrozenVariant(const CVariant &variant)
+  : m_arenaSize(0)
+  , m_nodes(nullptr)
+  , m_children(nullptr)
+  , m_members(nullptr)
+  , m_strings(nullptr)
+  , m_nodeCount(0)
+{
+  CBuilder builder;
+  builder.Freeze(variant);
+
+  // move everything into one allocation, nodes first as they
+  // have the strictest alignment, the root is always node 0.
+  const size_t nodesSize = builder.nodes.size() * sizeof(Node);
+  const size_t membersOffset = alignUp(nodesSize, alignof(Member));
+  const size_t membersSize = builder.members.size() * sizeof(Member);
+  const size_t childrenOffset = alignUp(membersOffset + membersSize, alignof(uint32_t));
+  const size_t childrenSize = builder.children.size() * sizeof(uint32_t);
+  const size_t stringsOffset = alignUp(childrenOffset + childrenSize, alignof(wchar_t));
+  m_arenaSize = stringsOffset + builder.strings.size();
+
+  m_arena.reset(new char[m_arenaSize]);
+  char *arena = m_arena.get();
+  if (nodesSize)
+    memcpy(arena, builder.nodes.data(), nodesSize);
+  if (membersSize)
+    memcpy(arena + membersOffset, builder.members.data(), membersSize);
+  if (childrenSize)
+    memcpy(arena + childrenOffset, builder.children.data(), childrenSize);
+  if (!builder.strings.empty())
+    memcpy(arena + stringsOffset, builder.strings.data(), builder.strings.size());
+
+  m_nodes = reinterpret_cast<const Node*>(arena);
+  m_members = reinterpret_cast<const Member*>(arena + membersOffset);
+  m_children = reinterpret_cast<const uint32_t*>(arena + childrenOffset);
+  m_strings = arena + stringsOffset;
+  m_nodeCount = builder.nodes.size();
+}
+
+CFrozenVariant::~CFrozenVariant()
+{
+}
+
+CFrozenVariant::CRef CFrozenVariant::Root() const
+{
+  return CRef(this, 0);
+}
+
+int CFrozenVariant::CompareKey(uint32_t keyNode, const std::string &key) const
+{
+  const Node &node = m_nodes[keyNode];
+  const size_t length = std::min<size_t>(node.size, key.size());
+  int result = memcmp(String(node), key.c_str(), length);
+  if (result != 0)
+    return result;
+  if (node.size < key.size())
+    return -1;
+  return node.size > key.size() ? 1 : 0;
+}
+
+CVariant::VariantType CFrozenVariant::CRef::type() const
+{
+  if (m_variant == nullptr)
+    return CVariant::VariantTypeNull;
+  return static_cast<CVariant::VariantType>(m_variant->m_nodes[m_node].type);
+}
+
+bool CFrozenVariant::CRef::isNull() const
+{
+  CVariant::VariantType nodeType = type();
+  return nodeType == CVariant::VariantTypeNull || nodeType == CVariant::VariantTypeConstNull;
+}
+
+int64_t CFrozenVariant::CRef::asInteger(int64_t fallback) const
+{
+  if (isArray() || isObject())
+    return fallback;
+  return ToVariant().asInteger(fallback);
+}
+
+uint64_t CFrozenVariant::CRef::asUnsignedInteger(uint64_t fallback) const
+{
+  if (isArray() || isObject())
+    return fallback;
+  return ToVariant().asUnsignedInteger(fallback);
+}
+
+bool CFrozenVariant::CRef::asBoolean(bool fallback) const
+{
+  if (isArray() || isObject())
+    return fallback;
+  return ToVariant().asBoolean(fallback);
+}
+
+std::string CFrozenVariant::CRef::asString(const std::string &fallback) const
+{
+  if (isString())
+  {
+    const Node &node = m_variant->m_nodes[m_node];
+    return std::string(m_variant->String(node), node.size);
+  }
+  if (isArray() || isObject())
+    return fallback;
+  return ToVariant().asString(fallback);
+}
+
+double CFrozenVariant::CRef::asDouble(double fallback) const
+{
+  if (isArray() || isObject())
+    return fallback;
+  return ToVariant().asDouble(fallback);
+}
+
+unsigned int CFrozenVariant::CRef::size() const
+{
+  if (isArray() || isObject())
+    return m_variant->m_nodes[m_node].size;
+  return 0;
+}
+
+bool CFrozenVariant::CRef::isMember(const std::string &key) const
+{
+  return (*this)[key].m_variant != nullptr;
+}
+
+CFrozenVariant::CRef CFrozenVariant::CRef::operator[](const std::string &key) const
+{
+  if (!isObject())
+    return CRef();
+
+  const Node &node = m_variant->m_nodes[m_node];
+  uint32_t first = node.offset;
+  uint32_t last = node.offset + node.size;
+  while (first < last)
+  {
+    const uint32_t middle = first + (last - first) / 2;
+    const Member &member = m_variant->m_members[middle];
+    int result = m_variant->CompareKey(member.key, key);
+    if (result == 0)
+      return CRef(m_variant, member.value);
+    if (result < 0)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  return CRef();
+}
+
+CFrozenVariant::CRef CFrozenVariant::CRef::operator[](unsigned int position) const
+{
+  if (!isArray() || position >= size())
+    return CRef();
+
+  const Node &node = m_variant->m_nodes[m_node];
+  return CRef(m_variant, m_variant->m_children[node.offset + position]);
+}
+
+const std::string CFrozenVariant::CRef::key(unsigned int position) const
+{
+  if (!isObject() || position >= size())
+    return "";
+
+  const Node &node = m_variant->m_nodes[m_node];
+  return CRef(m_variant, m_variant->m_members[node.offset + position].key).asString();
+}
+
+CFrozenVariant::CRef CFrozenVariant::CRef::value(unsigned int position) const
+{
+  if (!isObject() || position >= size())
+    return CRef();
+
+  const Node &node = m_variant->m_nodes[m_node];
+  return CRef(m_variant, m_variant->m_members[node.offset + position].value);
+}
+
+CVariant CFrozenVariant::CRef::ToVariant() const
+{
+  if (m_variant == nullptr)
+    return CVariant(CVariant::VariantTypeNull);
+
+  const Node &node = m_variant->m_nodes[m_node];
+  switch (node.type)
+  {
+    case CVariant::VariantTypeInteger:
+      return CVariant(node.integer);
+    case CVariant::VariantTypeUnsignedInteger:
+      return CVariant(node.unsignedinteger);
+    case CVariant::VariantTypeBoolean:
+      return CVariant(node.boolean);
+    case CVariant::VariantTypeDouble:
+      return CVariant(node.dvalue);
+    case CVariant::VariantTypeString:
+      return CVariant(m_variant->String(node), node.size);
+    case CVariant::VariantTypeWideString:
+      return CVariant(reinterpret_cast<const wchar_t*>(m_variant->String(node)), node.size);
+    case CVariant::VariantTypeArray:
+    {
+      CVariant array(CVariant::VariantTypeArray);
+      for (uint32_t k = 0; k < node.size; ++k)
+        array.push_back(CRef(m_variant, m_variant->m_children[node.offset + k]).ToVariant());
+      return array;
+    }
+    case CVariant::VariantTypeObject:
+    {
+      CVariant object(CVariant::VariantTypeObject);
+      for (uint32_t k = 0; k < node.size; ++k)
+      {
+        const Member &member = m_variant->m_members[node.offset + k];
+        object[CRef(m_variant, member.key).asString()] = CRef(m_variant, member.value).ToVariant();
+      }
+      return object;
+    }
+    default:
+      break;
+  }
+  return CVariant(CVariant::VariantTypeNull);
+}
@@ -0,0 +1,126 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+#include "utils/Variant.h"
+
+/*!
+ \brief Immutable, compact copy of a CVariant tree.
+
+ All nodes, array/object children and strings live in one arena,
+ object keys (and short string values) are interned and object members
+ are kept sorted so lookups are a binary search. Meant for large
+ read-mostly documents (ie. media server views) that would otherwise
+ be thousands of small heap allocations as a CVariant.
+ */
+class CFrozenVariant
+{
+public:
+  class CRef
+  {
+  public:
+    CRef() : m_variant(nullptr), m_node(0) { }
+
+    CVariant::VariantType type() const;
+    bool isInteger() const          { return type() == CVariant::VariantTypeInteger; }
+    bool isUnsignedInteger() const  { return type() == CVariant::VariantTypeUnsignedInteger; }
+    bool isBoolean() const          { return type() == CVariant::VariantTypeBoolean; }
+    bool isString() const           { return type() == CVariant::VariantTypeString; }
+    bool isDouble() const           { return type() == CVariant::VariantTypeDouble; }
+    bool isArray() const            { return type() == CVariant::VariantTypeArray; }
+    bool isObject() const           { return type() == CVariant::VariantTypeObject; }
+    bool isNull() const;
+
+    int64_t asInteger(int64_t fallback = 0) const;
+    uint64_t asUnsignedInteger(uint64_t fallback = 0u) const;
+    bool asBoolean(bool fallback = false) const;
+    std::string asString(const std::string &fallback = "") const;
+    double asDouble(double fallback = 0.0) const;
+
+    unsigned int size() const;
+    bool empty() const                { return size() == 0; }
+    bool isMember(const std::string &key) const;
+    // null ref if the key/position does not exist, same as CVariant
+    CRef operator[](const std::string &key) const;
+    CRef operator[](unsigned int position) const;
+    // object members in key order
+    const std::string key(unsigned int position) const;
+    CRef value(unsigned int position) const;
+
+    CVariant ToVariant() const;
+
+  private:
+    friend class CFrozenVariant;
+    CRef(const CFrozenVariant *variant, uint32_t node) : m_variant(variant), m_node(node) { }
+
+    const CFrozenVariant *m_variant;
+    uint32_t m_node;
+  };
+
+  CFrozenVariant();
+  explicit CFrozenVariant(const CVariant &variant);
+ ~CFrozenVariant();
+
+  CRef Root() const;
+  CVariant ToVariant() const       { return Root().ToVariant(); }
+  // bytes held by the arena
+  size_t GetMemoryUsage() const    { return m_arenaSize; }
+
+private:
+  CFrozenVariant(const CFrozenVariant&) = delete;
+  CFrozenVariant& operator=(const CFrozenVariant&) = delete;
+
+  struct Node
+  {
+    uint8_t  type;
+    uint32_t size;      // string length or child count
+    union
+    {
+      int64_t  integer;
+      uint64_t unsignedinteger;
+      double   dvalue;
+      bool     boolean;
+      uint32_t offset;  // into strings, children or members
+    };
+  };
+  struct Member
+  {
+    uint32_t key;       // node index of the interned key string
+    uint32_t value;     // node index of the value
+  };
+  class CBuilder;
+
+  const char* String(const Node &node) const { return m_strings + node.offset; }
+  int CompareKey(uint32_t keyNode, const std::string &key) const;
+
+  std::unique_ptr<char[]> m_arena;
+  size_t m_arenaSize;
+  const Node     *m_nodes;
+  const uint32_t *m_children;
+  const Member   *m_members;
+  const char     *m_strings;
+  uint32_t        m_nodeCount;
+};
+
+typedef std::shared_ptr<const CFrozenVariant> CFrozenVariantPtr;
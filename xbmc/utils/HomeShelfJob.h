@@ -34,6 +34,7 @@ public:
   ~CHomeButtonJob();
   
   virtual bool DoWork();
+  virtual const char *GetType() const { return "homebutton"; }
 };
 
 class CHomeShelfJob : public CJob
@@ -54,6 +55,7 @@ public:
   const int GetFlag() const { return m_flag; };
 
   virtual bool DoWork();
+  virtual const char *GetType() const { return "homeshelf"; }
 
 private:
   int m_flag;
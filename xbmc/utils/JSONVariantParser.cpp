@@ -20,12 +20,66 @@
 
 #include "JSONVariantParser.h"
 
+#include <assert.h>
+#include <memory>
+
 #include <rapidjson/reader.h>
 
+// rapidjson input stream refilled from a CJSONVariantParser::ReadCallback
+class CJSONVariantParserReadStream
+{
+public:
+  typedef char Ch;
+
+  CJSONVariantParserReadStream(const CJSONVariantParser::ReadCallback& read)
+    : m_read(read)
+    , m_current(m_buffer)
+    , m_end(m_buffer)
+    , m_count(0)
+  {
+    Fill();
+  }
+
+  Ch Peek() const { return m_current < m_end ? *m_current : '\0'; }
+  Ch Take()
+  {
+    if (m_current >= m_end)
+      return '\0';
+    Ch c = *m_current++;
+    if (m_current == m_end)
+      Fill();
+    return c;
+  }
+  size_t Tell() const { return m_count + (m_current - m_buffer); }
+
+  // not used for reading
+  Ch* PutBegin() { assert(false); return nullptr; }
+  void Put(Ch) { assert(false); }
+  void Flush() { assert(false); }
+  size_t PutEnd(Ch*) { assert(false); return 0; }
+
+private:
+  void Fill()
+  {
+    m_count += m_end - m_buffer;
+    size_t read = m_read(m_buffer, sizeof(m_buffer));
+    m_current = m_buffer;
+    m_end = m_buffer + read;
+  }
+
+  const CJSONVariantParser::ReadCallback& m_read;
+  char m_buffer[16384];
+  char *m_current;
+  char *m_end;
+  size_t m_count;
+};
+
 class CJSONVariantParserHandler
 {
 public:
   CJSONVariantParserHandler(CVariant& parsedObject);
+  CJSONVariantParserHandler(CVariant& parsedObject, const std::vector<std::string>& streamPath,
+                            const CJSONVariantParser::ItemCallback& callback);
 
   bool Null();
   bool Bool(bool b);
@@ -49,16 +103,25 @@ private:
     PushObject(CVariant(std::forward<TArgs>(args)...));
     PopObject();
 
-    return true;
+    return !m_aborted;
   }
 
   void PushObject(CVariant variant);
   void PopObject();
+  bool IsStreamPath() const;
 
   CVariant& m_parsedObject;
   std::vector<CVariant *> m_parse;
   std::string m_key;
 
+  // only used when streaming the elements of one array
+  const std::vector<std::string>* m_streamPath;
+  const CJSONVariantParser::ItemCallback* m_callback;
+  std::vector<std::string> m_keyPath;
+  CVariant* m_streamArray;
+  std::unique_ptr<CVariant> m_streamItem;
+  bool m_aborted;
+
   enum class PARSE_STATUS
   {
     Variable,
@@ -72,6 +135,22 @@ CJSONVariantParserHandler::CJSONVariantParserHandler(CVariant& parsedObject)
   : m_parsedObject(parsedObject),
     m_parse(),
     m_key(),
+    m_streamPath(nullptr),
+    m_callback(nullptr),
+    m_streamArray(nullptr),
+    m_aborted(false),
+    m_status(PARSE_STATUS::Variable)
+{ }
+
+CJSONVariantParserHandler::CJSONVariantParserHandler(CVariant& parsedObject, const std::vector<std::string>& streamPath,
+                                                     const CJSONVariantParser::ItemCallback& callback)
+  : m_parsedObject(parsedObject),
+    m_parse(),
+    m_key(),
+    m_streamPath(&streamPath),
+    m_callback(&callback),
+    m_streamArray(nullptr),
+    m_aborted(false),
     m_status(PARSE_STATUS::Variable)
 { }
 
@@ -80,7 +159,7 @@ bool CJSONVariantParserHandler::Null()
   PushObject(CVariant::ConstNullVariant);
   PopObject();
 
-  return true;
+  return !m_aborted;
 }
 
 bool CJSONVariantParserHandler::Bool(bool b)
@@ -141,7 +220,7 @@ bool CJSONVariantParserHandler::EndObject(rapidjson::SizeType memberCount)
 {
   PopObject();
 
-  return true;
+  return !m_aborted;
 }
 
 bool CJSONVariantParserHandler::StartArray()
@@ -155,29 +234,56 @@ bool CJSONVariantParserHandler::EndArray(rapidjson::SizeType elementCount)
 {
   PopObject();
 
-  return true;
+  return !m_aborted;
 }
 
 void CJSONVariantParserHandler::PushObject(CVariant variant)
 {
-  if (m_status == PARSE_STATUS::Object)
+  if (m_status == PARSE_STATUS::Array && m_streamArray != nullptr && m_parse[m_parse.size() - 1] == m_streamArray)
+  {
+    // element of the streamed array, build it on its own
+    m_streamItem.reset(new CVariant(std::move(variant)));
+    m_parse.push_back(m_streamItem.get());
+    m_keyPath.push_back("");
+  }
+  else if (m_status == PARSE_STATUS::Object)
   {
     (*m_parse[m_parse.size() - 1])[m_key] = variant;
     m_parse.push_back(&(*m_parse[m_parse.size() - 1])[m_key]);
+    if (m_streamPath)
+      m_keyPath.push_back(m_key);
   }
   else if (m_status == PARSE_STATUS::Array)
   {
     CVariant *temp = m_parse[m_parse.size() - 1];
     temp->push_back(variant);
     m_parse.push_back(&(*temp)[temp->size() - 1]);
+    if (m_streamPath)
+      m_keyPath.push_back("");
   }
   else if (m_parse.empty())
-    m_parse.push_back(new CVariant(variant));
+  {
+    if (m_streamPath)
+    {
+      // build straight into the result so the callback can look
+      // at what precedes the array (ie. container attributes)
+      m_parsedObject = variant;
+      m_parse.push_back(&m_parsedObject);
+      m_keyPath.push_back("");
+    }
+    else
+      m_parse.push_back(new CVariant(variant));
+  }
 
-  if (variant.isObject())
+  const CVariant *top = m_parse[m_parse.size() - 1];
+  if (top->isObject())
     m_status = PARSE_STATUS::Object;
-  else if (variant.isArray())
+  else if (top->isArray())
+  {
     m_status = PARSE_STATUS::Array;
+    if (m_streamPath && m_streamArray == nullptr && IsStreamPath())
+      m_streamArray = m_parse[m_parse.size() - 1];
+  }
   else
     m_status = PARSE_STATUS::Variable;
 }
@@ -186,9 +292,18 @@ void CJSONVariantParserHandler::PopObject()
 {
   CVariant *variant = m_parse[m_parse.size() - 1];
   m_parse.pop_back();
+  if (m_streamPath)
+    m_keyPath.pop_back();
 
   if (!m_parse.empty())
   {
+    if (variant == m_streamItem.get())
+    {
+      if (!(*m_callback)(*m_streamItem))
+        m_aborted = true;
+      m_streamItem.reset();
+    }
+
     variant = m_parse[m_parse.size() - 1];
     if (variant->isObject())
       m_status = PARSE_STATUS::Object;
@@ -199,13 +314,30 @@ void CJSONVariantParserHandler::PopObject()
   }
   else
   {
-    m_parsedObject = *variant;
-    delete variant;
+    if (!m_streamPath)
+    {
+      m_parsedObject = std::move(*variant);
+      delete variant;
+    }
 
     m_status = PARSE_STATUS::Variable;
   }
 }
 
+bool CJSONVariantParserHandler::IsStreamPath() const
+{
+  // m_keyPath[0] is the root, the rest must match the requested keys
+  if (m_keyPath.size() != m_streamPath->size() + 1)
+    return false;
+
+  for (size_t i = 0; i < m_streamPath->size(); ++i)
+  {
+    if (m_keyPath[i + 1].empty() || m_keyPath[i + 1] != (*m_streamPath)[i])
+      return false;
+  }
+  return true;
+}
+
 bool CJSONVariantParser::Parse(const char* json, CVariant& data)
 {
   if (json == nullptr)
@@ -227,3 +359,47 @@ bool CJSONVariantParser::Parse(const std::string& json, CVariant& data)
 {
   return Parse(json.c_str(), data);
 }
+
+bool CJSONVariantParser::Parse(const char* json, const std::vector<std::string>& arrayPath, const ItemCallback& callback, CVariant& data)
+{
+  if (json == nullptr)
+    return false;
+
+  rapidjson::Reader reader;
+  rapidjson::StringStream stringStream(json);
+
+  CJSONVariantParserHandler handler(data, arrayPath, callback);
+  if (reader.Parse<rapidjson::kParseIterativeFlag>(stringStream, handler))
+    return true;
+
+  return false;
+}
+
+bool CJSONVariantParser::Parse(const std::string& json, const std::vector<std::string>& arrayPath, const ItemCallback& callback, CVariant& data)
+{
+  return Parse(json.c_str(), arrayPath, callback, data);
+}
+
+bool CJSONVariantParser::Parse(const ReadCallback& read, CVariant& data)
+{
+  rapidjson::Reader reader;
+  CJSONVariantParserReadStream readStream(read);
+
+  CJSONVariantParserHandler handler(data);
+  if (reader.Parse<rapidjson::kParseIterativeFlag>(readStream, handler))
+    return true;
+
+  return false;
+}
+
+bool CJSONVariantParser::Parse(const ReadCallback& read, const std::vector<std::string>& arrayPath, const ItemCallback& callback, CVariant& data)
+{
+  rapidjson::Reader reader;
+  CJSONVariantParserReadStream readStream(read);
+
+  CJSONVariantParserHandler handler(data, arrayPath, callback);
+  if (reader.Parse<rapidjson::kParseIterativeFlag>(readStream, handler))
+    return true;
+
+  return false;
+}
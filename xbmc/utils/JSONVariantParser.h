@@ -19,7 +19,9 @@
  *
  */
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "utils/Variant.h"
 
@@ -30,4 +32,25 @@ public:
 
   static bool Parse(const char* json, CVariant& data);
   static bool Parse(const std::string& json, CVariant& data);
+
+  /*!
+   \brief Parse json but hand every element of the array found at arrayPath
+   (a chain of object keys from the root) to callback as soon as it is
+   complete instead of storing it, so memory use does not grow with the
+   number of elements. Everything else ends up in data, with an empty
+   array left at arrayPath. Returning false from callback stops parsing.
+   */
+  typedef std::function<bool(CVariant& item)> ItemCallback;
+  static bool Parse(const char* json, const std::vector<std::string>& arrayPath, const ItemCallback& callback, CVariant& data);
+  static bool Parse(const std::string& json, const std::vector<std::string>& arrayPath, const ItemCallback& callback, CVariant& data);
+
+  /*!
+   \brief Same as above but the json is pulled from read as it is parsed
+   (ie. straight from a network stream) so the document text is never
+   held in memory. read fills up to size bytes of buffer and returns how
+   many it wrote, 0 at the end of the input or on error.
+   */
+  typedef std::function<size_t(char* buffer, size_t size)> ReadCallback;
+  static bool Parse(const ReadCallback& read, CVariant& data);
+  static bool Parse(const ReadCallback& read, const std::vector<std::string>& arrayPath, const ItemCallback& callback, CVariant& data);
 };
@@ -111,6 +111,15 @@ public:
     PRIORITY_NORMAL,
     PRIORITY_HIGH
   };
+
+  /*!
+   \brief Worker pools of the CJobManager, each with its own thread budget.
+   \sa CJobManager, GetLane()
+   */
+  enum LANE {
+    LANE_IO = 0,
+    LANE_CPU
+  };
   CJob() { m_callback = NULL; };
 
   /*!
@@ -146,6 +155,18 @@ public:
    */
   virtual const char *GetType() const { return ""; };
 
+  /*!
+   \brief Function that returns the worker pool the job runs in.
+
+   Jobs that keep a core busy for most of their run (decoding, encoding, compressing) should
+   return LANE_CPU. Those are limited to about one worker per core, and can't hold up the jobs
+   of LANE_IO that spend their time waiting on disk or network.
+
+   \return the lane of this job, LANE_IO by default.
+   \sa CJobManager
+   */
+  virtual LANE GetLane() const { return LANE_IO; };
+
   virtual bool operator==(const CJob* job) const
   {
     return false;
@@ -20,10 +20,19 @@
 
 #include "JobManager.h"
 #include <algorithm>
+#include <cstdlib>
+#include <cxxabi.h>
 #include <functional>
 #include <stdexcept>
+#include <typeinfo>
+#include "filesystem/File.h"
 #include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+#include "utils/JSONVariantWriter.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
 
 #include "system.h"
 
@@ -34,9 +43,11 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, CJob::LANE lane, unsigned int queue) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_lane = lane;
+  m_queue = queue;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -176,11 +187,107 @@ CJobManager &CJobManager::GetInstance()
   return sJobManager;
 }
 
+#define JOB_TRACE_FILE       "special://temp/jobtrace.json"
+#define JOB_TRACE_MAX_EVENTS 100000
+
+static const unsigned int histogramBounds[CJobManager::HistogramBuckets] = {
+  1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 0
+};
+
+static const char *priorityNames[] = { "lowpausable", "low", "normal", "high" };
+static const char *laneNames[] = { "io", "cpu" };
+
+static unsigned int HostCounterToMillis(int64_t counter)
+{
+  static const int64_t frequency = CurrentHostFrequency();
+  return (unsigned int)(counter * 1000 / frequency);
+}
+
+static int64_t HostCounterToMicros(int64_t counter)
+{
+  static const int64_t frequency = CurrentHostFrequency();
+  return counter * 1000000 / frequency;
+}
+
+static std::string GetJobType(const CJob *job)
+{
+  // jobs without a type are known by their class name
+  const char *type = job->GetType();
+  if (*type)
+    return type;
+
+  const char *name = typeid(*job).name();
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(name, NULL, NULL, &status);
+  if (!demangled)
+    return name;
+
+  std::string className(demangled);
+  free(demangled);
+  return className;
+}
+
+CJobManager::CTypeCounters::CTypeCounters()
+{
+  m_queued = 0;
+  m_running = 0;
+  m_completed = 0;
+  m_cancelled = 0;
+  for (unsigned int i = 0; i < HistogramBuckets; ++i)
+  {
+    m_wait[i] = 0;
+    m_run[i] = 0;
+  }
+}
+
+CJobManager::CPriorityCounters::CPriorityCounters()
+{
+  m_jobs = 0;
+  m_waitTotal = 0;
+  m_waitMax = 0;
+  m_runTotal = 0;
+  m_runMax = 0;
+}
+
+CJobManager::CWorkItem::CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback, CTypeCounters *counters)
+  : m_job(job),
+    m_id(id),
+    m_callback(callback),
+    m_priority(priority),
+    m_counters(counters),
+    m_home(NULL),
+    m_queued(CurrentHostCounter()),
+    m_started(0),
+    m_processing(false),
+    m_cancelled(false)
+{
+}
+
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
   m_running = true;
   m_pauseJobs = false;
+  m_tracing = false;
+  m_traceStart = 0;
+
+  // jobs waiting on disk or network keep the 5 workers they always had, more on bigger
+  // machines. cpu bound jobs get a worker per core, bar one for the render thread
+  int cores = std::max(g_cpuInfo.getCPUCount(), 1);
+  InitLane(CJob::LANE_IO, std::max(5, cores + 1));
+  InitLane(CJob::LANE_CPU, std::max(1, cores - 1));
+}
+
+void CJobManager::InitLane(CJob::LANE lane, unsigned int budget)
+{
+  CLane &l = m_lanes[lane];
+  for (unsigned int i = 0; i < budget; ++i)
+    l.m_queues.push_back(std::unique_ptr<CWorkerQueue>(new CWorkerQueue));
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    l.m_queued[priority] = 0;
+  l.m_busy = 0;
+  l.m_workers = 0;
+  l.m_nextQueue = 0;
 }
 
 void CJobManager::Restart()
@@ -197,21 +304,47 @@ void CJobManager::CancelJobs()
   CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  // clear any pending jobs, they are freed once we let go of the lock
+  std::vector<CWorkItem*> cancelled;
+  for (CLane &lane : m_lanes)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), [](CWorkItem& wi) { wi.FreeJob(); });
-    m_jobQueue[priority].clear();
+    for (auto &queue : lane.m_queues)
+    {
+      CSingleLock queueLock(queue->m_section);
+      for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+      {
+        for (CWorkItem *work : queue->m_jobs[priority])
+        {
+          work->m_counters->m_queued--;
+          work->m_counters->m_cancelled++;
+          queue->m_items.erase(work->m_id);
+          cancelled.push_back(work);
+        }
+        queue->m_jobs[priority].clear();
+        lane.m_queued[priority] = 0;
+      }
+
+      // cancel any callbacks on jobs still processing
+      for (WorkItems::iterator it = queue->m_items.begin(); it != queue->m_items.end(); ++it)
+      {
+        if (!it->second->m_cancelled)
+          it->second->m_counters->m_cancelled++;
+        it->second->Cancel();
+      }
+    }
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), [](CWorkItem& wi) { wi.Cancel(); });
+  lock.Leave();
+  for (CWorkItem *work : cancelled)
+    FreeWorkItem(work);
+  lock.Enter();
 
   // tell our workers to finish
-  while (m_workers.size())
+  while (HasWorkers())
   {
     lock.Leave();
-    m_jobEvent.Set();
+    for (CLane &lane : m_lanes)
+      lane.m_jobEvent.Set();
     Sleep(0); // yield after setting the event to give the workers some time to die
     lock.Enter();
   }
@@ -223,6 +356,7 @@ CJobManager::~CJobManager()
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
+  const std::string type = GetJobType(job);
   CSingleLock lock(m_section);
 
   if (!m_running)
@@ -234,72 +368,173 @@ unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORI
     m_jobCounter++;
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CTypeCounters &counters = m_typeCounters[type];
+  CWorkItem *work = new CWorkItem(job, m_jobCounter, priority, callback, &counters);
+  counters.m_queued++;
 
-  StartWorkers(priority);
-  return work.m_id;
+  CLane &lane = m_lanes[job->GetLane()];
+  CWorkerQueue &queue = *lane.m_queues[SelectQueue(job->GetLane())];
+  work->m_home = &queue;
+  {
+    CSingleLock queueLock(queue.m_section);
+    queue.m_items[work->m_id] = work;
+    queue.m_jobs[priority].push_back(work);
+    lane.m_queued[priority]++;
+  }
+  lane.m_jobEvent.Set();
+  // the work item may be done with already, the counter is still ours
+  return m_jobCounter;
 }
 
-void CJobManager::CancelJob(unsigned int jobID)
+unsigned int CJobManager::SelectQueue(CJob::LANE lane)
 {
-  CSingleLock lock(m_section);
+  CLane &l = m_lanes[lane];
 
-  // check whether we have this job in the queue
+  // everyone is busy - we need more workers. this comes first, so that a job waiting
+  // on a job it added to its own lane always has someone to run it
+  unsigned int pending = l.m_busy;
   for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    pending += l.m_queued[priority];
+  if (pending >= l.m_workers && l.m_workers < l.m_queues.size())
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    for (unsigned int i = 0; i < l.m_queues.size(); ++i)
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
+      if (!l.m_queues[i]->m_worker)
+      {
+        l.m_queues[i]->m_worker = new CJobWorker(this, lane, i);
+        l.m_workers++;
+        return i;
+      }
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+
+  // jobs added from one of the lane's workers stay with it, unless someone idle steals them
+  CJobWorker *worker = dynamic_cast<CJobWorker*>(CThread::GetCurrentThread());
+  if (worker && worker->m_jobManager == this && worker->m_lane == lane)
+    return worker->m_queue;
+
+  // otherwise hand out the jobs round robin
+  for (unsigned int n = 0; n < l.m_queues.size(); ++n)
+  {
+    unsigned int i = (l.m_nextQueue + n) % l.m_queues.size();
+    if (l.m_queues[i]->m_worker)
+    {
+      l.m_nextQueue = i + 1;
+      return i;
+    }
+  }
+  return 0;
 }
 
-void CJobManager::StartWorkers(CJob::PRIORITY priority)
+void CJobManager::CancelJob(unsigned int jobID)
 {
   CSingleLock lock(m_section);
 
-  // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
-    return;
-
-  // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  // a job is known to the queue it was added to until it's freed, which can't happen
+  // while we hold that queue's lock
+  for (CLane &lane : m_lanes)
   {
-    m_jobEvent.Set();
-    return;
+    for (auto &queue : lane.m_queues)
+    {
+      CSingleLock queueLock(queue->m_section);
+      WorkItems::iterator it = queue->m_items.find(jobID);
+      if (it == queue->m_items.end())
+        continue;
+
+      // if it's being processed the only thing to do is to remove the callback. a queued
+      // job is freed here, or by the worker taking it should it be stolen meanwhile
+      CWorkItem *work = it->second;
+      if (!work->m_cancelled)
+        work->m_counters->m_cancelled++;
+      work->Cancel();
+      if (work->m_processing)
+        return;
+
+      std::deque<CWorkItem*> &jobs = queue->m_jobs[work->m_priority];
+      std::deque<CWorkItem*>::iterator i = find(jobs.begin(), jobs.end(), work);
+      if (i == jobs.end())
+        return;
+
+      jobs.erase(i);
+      lane.m_queued[work->m_priority]--;
+      work->m_counters->m_queued--;
+      queue->m_items.erase(it);
+      queueLock.Leave();
+      lock.Leave();
+      FreeWorkItem(work);
+      return;
+    }
   }
+}
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+void CJobManager::FreeWorkItem(CWorkItem *work)
+{
+  {
+    CSingleLock lock(work->m_home->m_section);
+    work->m_home->m_items.erase(work->m_id);
+  }
+  // job destructors may call back into us, so they must not run under a lock of ours
+  work->FreeJob();
+  delete work;
 }
 
-CJob *CJobManager::PopJob()
+CJob *CJobManager::PopJob(CJob::LANE lane, unsigned int queue)
 {
-  CSingleLock lock(m_section);
+  CLane &l = m_lanes[lane];
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    while (l.m_queued[priority] > 0)
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      // check how many free threads we have, and claim one
+      unsigned int max = GetMaxWorkers(lane, CJob::PRIORITY(priority));
+      unsigned int busy = l.m_busy;
+      if (busy >= max)
+        break;
+      if (!l.m_busy.compare_exchange_weak(busy, busy + 1))
+        continue;
+
+      CWorkItem *work = TakeJob(l, queue, priority);
+      if (!work)
+      {
+        l.m_busy--;
+        break;
+      }
+      if (work->m_cancelled)
+      {
+        l.m_busy--;
+        FreeWorkItem(work);
+        continue;
+      }
+
+      work->m_started = CurrentHostCounter();
+      work->m_processing = true;
+      work->m_counters->m_running++;
+      work->m_job->m_callback = this;
+      l.m_queues[queue]->m_current = work;
+      return work->m_job;
+    }
+  }
+  return NULL;
+}
+
+CJobManager::CWorkItem *CJobManager::TakeJob(CLane &lane, unsigned int queue, int priority)
+{
+  // oldest job of our own queue first, then steal from the others
+  for (unsigned int n = 0; n < lane.m_queues.size(); ++n)
+  {
+    CWorkerQueue &q = *lane.m_queues[(queue + n) % lane.m_queues.size()];
+    CSingleLock lock(q.m_section);
+    if (!q.m_jobs[priority].empty())
+    {
+      CWorkItem *work = q.m_jobs[priority].front();
+      q.m_jobs[priority].pop_front();
+      lane.m_queued[priority]--;
+      work->m_counters->m_queued--;
+      return work;
     }
   }
   return NULL;
@@ -315,19 +550,26 @@ void CJobManager::UnPauseJobs()
 {
   CSingleLock lock(m_section);
   m_pauseJobs = false;
+  for (CLane &lane : m_lanes)
+    lane.m_jobEvent.Set();
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (const CLane &lane : m_lanes)
   {
-    if (priority == it->m_priority)
-      return true;
+    for (const auto &queue : lane.m_queues)
+    {
+      CSingleLock lock(queue->m_section);
+      for (WorkItems::const_iterator it = queue->m_items.begin(); it != queue->m_items.end(); ++it)
+      {
+        if (it->second->m_processing && priority == it->second->m_priority)
+          return true;
+      }
+    }
   }
   return false;
 }
@@ -335,102 +577,359 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (const CLane &lane : m_lanes)
   {
-    if (type == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    for (const auto &queue : lane.m_queues)
+    {
+      CSingleLock lock(queue->m_section);
+      for (WorkItems::const_iterator it = queue->m_items.begin(); it != queue->m_items.end(); ++it)
+      {
+        if (it->second->m_processing && type == std::string(it->second->m_job->GetType()))
+          jobsMatched++;
+      }
+    }
   }
   return jobsMatched;
 }
 
-CJob *CJobManager::GetNextJob(const CJobWorker *worker)
+void CJobManager::GetStatistics(Statistics &stats) const
 {
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
+    const CPriorityCounters &counters = m_priorities[priority];
+    PriorityStatistics &priorityStats = stats.priorities[priority];
+    priorityStats.jobs = counters.m_jobs;
+    priorityStats.waitTotal = counters.m_waitTotal;
+    priorityStats.waitMax = counters.m_waitMax;
+    priorityStats.runTotal = counters.m_runTotal;
+    priorityStats.runMax = counters.m_runMax;
+  }
+
   CSingleLock lock(m_section);
-  while (m_running)
+  for (unsigned int lane = CJob::LANE_IO; lane <= CJob::LANE_CPU; ++lane)
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
-    if (job)
-      return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
+    const CLane &l = m_lanes[lane];
+    LaneStatistics &laneStats = stats.lanes[lane];
+    laneStats.budget = l.m_queues.size();
+    laneStats.workers = l.m_workers;
+    laneStats.busy = l.m_busy;
+    laneStats.queued = 0;
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+      laneStats.queued += l.m_queued[priority];
+  }
+}
+
+CJob *CJobManager::GetNextJob(const CJobWorker *worker)
+{
+  CLane &lane = m_lanes[worker->m_lane];
+  while (true)
+  {
+    while (m_running)
+    {
+      // grab a job off the queue if we have one
+      CJob *job = PopJob(worker->m_lane, worker->m_queue);
+      if (job)
+        return job;
+      // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+      if (!lane.m_jobEvent.WaitMSec(30000))
+        break;
+    }
+
+    CSingleLock lock(m_section);
+    if (!m_running)
       break;
+
+    // ensure no jobs have come in during the period after
+    // timeout and before we held the lock
+    if (HasRunnableJobs(worker->m_lane))
+      continue;
+
+    // jobs that are paused or over budget stay with us until they can run
+    bool empty = true;
+    {
+      CWorkerQueue &queue = *lane.m_queues[worker->m_queue];
+      CSingleLock queueLock(queue.m_section);
+      for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+        empty &= queue.m_jobs[priority].empty();
+    }
+    if (empty)
+    {
+      // retire while we still hold the lock, so AddJob can't hand our queue a job meanwhile
+      RemoveWorker(worker);
+      return NULL;
+    }
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
   // have no jobs
   RemoveWorker(worker);
   return NULL;
 }
 
+bool CJobManager::HasRunnableJobs(CJob::LANE lane) const
+{
+  const CLane &l = m_lanes[lane];
+  for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
+  {
+    if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
+      continue;
+    if (l.m_queued[priority] > 0 && l.m_busy < GetMaxWorkers(lane, CJob::PRIORITY(priority)))
+      return true;
+  }
+  return false;
+}
+
+CJobManager::CWorkItem *CJobManager::GetCurrentWorkItem(const CJob *job) const
+{
+  // jobs report from their worker's thread, so we don't need to look them up
+  CJobWorker *worker = dynamic_cast<CJobWorker*>(CThread::GetCurrentThread());
+  if (worker && worker->m_jobManager == this)
+  {
+    CWorkItem *work = m_lanes[worker->m_lane].m_queues[worker->m_queue]->m_current;
+    if (work && work->m_job == job)
+      return work;
+  }
+  return NULL;
+}
+
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  unsigned int id = 0;
+  IJobCallback *callback = NULL;
+
+  CWorkItem *work = GetCurrentWorkItem(job);
+  if (work)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    id = work->m_id;
+    callback = work->m_callback;
+  }
+  else
+  { // a thread of the job's own
+    for (const CLane &lane : m_lanes)
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      for (const auto &queue : lane.m_queues)
+      {
+        CSingleLock lock(queue->m_section);
+        for (WorkItems::const_iterator it = queue->m_items.begin(); it != queue->m_items.end(); ++it)
+        {
+          if (it->second->m_job == job)
+          {
+            id = it->second->m_id;
+            callback = it->second->m_callback;
+            break;
+          }
+        }
+        if (id)
+          break;
+      }
+      if (id)
+        break;
     }
   }
+
+  // check whether it's cancelled (no callback)
+  if (callback)
+  {
+    callback->OnJobProgress(id, progress, total, job);
+    return false;
+  }
   return true; // couldn't find the job, or it's been cancelled
 }
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
+{
+  CWorkItem *work = GetCurrentWorkItem(job);
+  if (!work)
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  IJobCallback *callback = work->m_callback;
+  try
+  {
+    if (callback)
+      callback->OnJobComplete(work->m_id, success, work->m_job);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, work->m_job->GetType());
+  }
+
+  CJobWorker *worker = dynamic_cast<CJobWorker*>(CThread::GetCurrentThread());
+  CLane &lane = m_lanes[job->GetLane()];
+  int64_t now = CurrentHostCounter();
+  unsigned int wait = HostCounterToMillis(work->m_started - work->m_queued);
+  unsigned int run = HostCounterToMillis(now - work->m_started);
+
+  CTypeCounters &counters = *work->m_counters;
+  counters.m_running--;
+  counters.m_completed++;
+  counters.m_wait[GetHistogramBucket(wait)]++;
+  counters.m_run[GetHistogramBucket(run)]++;
+
+  CPriorityCounters &stats = m_priorities[work->m_priority];
+  stats.m_jobs++;
+  stats.m_waitTotal += wait;
+  UpdateMax(stats.m_waitMax, wait);
+  stats.m_runTotal += run;
+  UpdateMax(stats.m_runMax, run);
+
+  if (m_tracing)
+  {
+    CSingleLock lock(m_section);
+    if (m_tracing)
+      TraceJob(work, worker, now);
+  }
+
+  lane.m_queues[worker->m_queue]->m_current = NULL;
+  lane.m_busy--;
+  FreeWorkItem(work);
+}
+
+void CJobManager::GetTypeStatistics(std::map<std::string, TypeStatistics> &stats) const
 {
   CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  stats.clear();
+  for (std::map<std::string, CTypeCounters>::const_iterator it = m_typeCounters.begin(); it != m_typeCounters.end(); ++it)
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
+    const CTypeCounters &counters = it->second;
+    TypeStatistics &typeStats = stats[it->first];
+    typeStats.queued = counters.m_queued;
+    typeStats.running = counters.m_running;
+    typeStats.completed = counters.m_completed;
+    typeStats.cancelled = counters.m_cancelled;
+    for (unsigned int i = 0; i < HistogramBuckets; ++i)
     {
-      if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
+      typeStats.waitHistogram[i] = counters.m_wait[i];
+      typeStats.runHistogram[i] = counters.m_run[i];
     }
-    catch (...)
+  }
+}
+
+void CJobManager::UpdateMax(std::atomic<unsigned int> &max, unsigned int value)
+{
+  unsigned int current = max;
+  while (value > current && !max.compare_exchange_weak(current, value))
+    ;
+}
+
+unsigned int CJobManager::GetHistogramBound(unsigned int bucket)
+{
+  return bucket < HistogramBuckets ? histogramBounds[bucket] : 0;
+}
+
+unsigned int CJobManager::GetHistogramBucket(unsigned int ms)
+{
+  unsigned int bucket = 0;
+  while (bucket < HistogramBuckets - 1 && ms >= histogramBounds[bucket])
+    bucket++;
+  return bucket;
+}
+
+std::string CJobManager::SetTracing(bool enable)
+{
+  std::vector<std::string> events;
+  int64_t start;
+  {
+    CSingleLock lock(m_section);
+    if (enable == m_tracing)
+      return "";
+
+    m_tracing = enable;
+    if (enable)
     {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
+      m_traceStart = CurrentHostCounter();
+      m_traceEvents.clear();
+      CLog::Log(LOGNOTICE, "%s - started tracing jobs", __FUNCTION__);
+      return "";
     }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
+    events.swap(m_traceEvents);
+    start = m_traceStart;
+  }
+
+  // name the worker threads, they're numbered per lane
+  std::string trace = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (unsigned int lane = CJob::LANE_IO; lane <= CJob::LANE_CPU; ++lane)
+  {
+    for (unsigned int queue = 0; queue < m_lanes[lane].m_queues.size(); ++queue)
+      trace += StringUtils::Format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                                   "\"args\":{\"name\":\"%s worker %u\"}},",
+                                   lane * 100 + queue + 1, laneNames[lane], queue);
   }
+  for (std::vector<std::string>::const_iterator it = events.begin(); it != events.end(); ++it)
+  {
+    trace += *it;
+    trace += ',';
+  }
+  trace.back() = ']';
+  trace += '}';
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(JOB_TRACE_FILE, true) ||
+      file.Write(trace.c_str(), trace.size()) != (ssize_t)trace.size())
+  {
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, JOB_TRACE_FILE);
+    return "";
+  }
+  file.Close();
+
+  CLog::Log(LOGNOTICE, "%s - wrote %u jobs traced over %u ms to %s", __FUNCTION__, (unsigned int)events.size(),
+            HostCounterToMillis(CurrentHostCounter() - start), JOB_TRACE_FILE);
+  return JOB_TRACE_FILE;
+}
+
+void CJobManager::TraceJob(const CWorkItem *work, const CJobWorker *worker, int64_t finished)
+{
+  // jobs started before the trace are left out, queued ones still show how long they waited
+  if (m_traceEvents.size() >= JOB_TRACE_MAX_EVENTS || work->m_started < m_traceStart)
+    return;
+
+  CVariant event(CVariant::VariantTypeObject);
+  event["name"] = GetJobType(work->m_job);
+  event["cat"] = laneNames[worker->m_lane];
+  event["ph"] = "X";
+  event["pid"] = 1;
+  event["tid"] = worker->m_lane * 100 + worker->m_queue + 1;
+  event["ts"] = HostCounterToMicros(work->m_started - m_traceStart);
+  event["dur"] = HostCounterToMicros(finished - work->m_started);
+  event["args"]["id"] = work->m_id;
+  event["args"]["priority"] = priorityNames[work->m_priority];
+  event["args"]["wait"] = HostCounterToMillis(work->m_started - work->m_queued);
+  event["args"]["cancelled"] = (bool)work->m_cancelled;
+
+  std::string json;
+  if (CJSONVariantWriter::Write(event, json, true))
+    m_traceEvents.push_back(json);
+}
+
+bool CJobManager::HasWorkers() const
+{
+  CSingleLock lock(m_section);
+  for (const CLane &lane : m_lanes)
+  {
+    if (lane.m_workers)
+      return true;
+  }
+  return false;
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
 {
   CSingleLock lock(m_section);
-  // remove our worker
-  Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
-  if (i != m_workers.end())
-    m_workers.erase(i); // workers auto-delete
+  // remove our worker, its queue is left for the next one
+  CLane &lane = m_lanes[worker->m_lane];
+  CWorkerQueue &queue = *lane.m_queues[worker->m_queue];
+  if (queue.m_worker == worker)
+  {
+    queue.m_worker = NULL;
+    lane.m_workers--; // workers auto-delete
+  }
 }
 
-unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
+unsigned int CJobManager::GetMaxWorkers(CJob::LANE lane, CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  // keep workers free for higher priority jobs, as far as the budget allows
+  int max_workers = m_lanes[lane].m_queues.size();
+  return std::max(max_workers - (CJob::PRIORITY_HIGH - priority), 1);
 }
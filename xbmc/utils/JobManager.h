@@ -19,6 +19,10 @@
  *
  */
 
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <memory>
 #include <queue>
 #include <vector>
 #include <string>
@@ -31,12 +35,15 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, CJob::LANE lane, unsigned int queue);
   virtual ~CJobWorker();
 
   void Process();
 private:
+  friend class CJobManager;
   CJobManager  *m_jobManager;
+  CJob::LANE    m_lane;
+  unsigned int  m_queue;  ///< index of our own job queue in the lane
 };
 
 /*!
@@ -170,28 +177,49 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Jobs run in one of two lanes (see CJob::GetLane()), each with a fixed budget of workers
+ based on the number of cores. Every worker has its own job queue which jobs are added to
+ round robin (or directly, for jobs added by the worker itself), and idle workers steal
+ jobs from the queues of busy ones, so picking up a job doesn't contend on a global lock.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
 {
+public:
+  /*! \brief Number of buckets of the wait and run time histograms \sa GetHistogramBound() */
+  static const unsigned int HistogramBuckets = 14;
+
+private:
+  class CTypeCounters
+  {
+  public:
+    CTypeCounters();
+    std::atomic<unsigned int> m_queued;
+    std::atomic<unsigned int> m_running;
+    std::atomic<uint64_t> m_completed;
+    std::atomic<uint64_t> m_cancelled;
+    std::atomic<uint64_t> m_wait[HistogramBuckets];
+    std::atomic<uint64_t> m_run[HistogramBuckets];
+  };
+
+  class CPriorityCounters
+  {
+  public:
+    CPriorityCounters();
+    std::atomic<uint64_t> m_jobs;
+    std::atomic<uint64_t> m_waitTotal;
+    std::atomic<unsigned int> m_waitMax;
+    std::atomic<uint64_t> m_runTotal;
+    std::atomic<unsigned int> m_runMax;
+  };
+
+  class CWorkerQueue;
+
   class CWorkItem
   {
   public:
-    CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
-    {
-      m_job = job;
-      m_id = id;
-      m_callback = callback;
-      m_priority = priority;
-    }
-    bool operator==(unsigned int jobID) const
-    {
-      return m_id == jobID;
-    };
-    bool operator==(const CJob *job) const
-    {
-      return m_job == job;
-    };
+    CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback, CTypeCounters *counters);
     void FreeJob()
     {
       delete m_job;
@@ -200,13 +228,45 @@ class CJobManager
     void Cancel()
     {
       m_callback = NULL;
+      m_cancelled = true;
     };
     CJob         *m_job;
     unsigned int  m_id;
-    IJobCallback *m_callback;
+    std::atomic<IJobCallback*> m_callback;
     CJob::PRIORITY m_priority;
+    CTypeCounters *m_counters;
+    CWorkerQueue  *m_home;        ///< the queue the job was added to
+    int64_t       m_queued;       ///< host counter when the job was added
+    int64_t       m_started;      ///< host counter when a worker picked the job up
+    std::atomic<bool> m_processing;
+    std::atomic<bool> m_cancelled;
   };
-  
+
+  /*! \brief The job queue owned by one worker of a lane.
+   The queue outlives its worker, the next one started for the lane takes it over.
+   */
+  class CWorkerQueue
+  {
+  public:
+    CWorkerQueue() : m_worker(NULL), m_current(NULL) {};
+    CCriticalSection m_section;
+    std::deque<CWorkItem*> m_jobs[CJob::PRIORITY_HIGH+1]; ///< guarded by m_section
+    std::map<unsigned int, CWorkItem*> m_items; ///< queued and processing jobs added here by id, guarded by m_section
+    CJobWorker *m_worker;   ///< guarded by the manager's m_section
+    CWorkItem  *m_current;  ///< only touched from m_worker's thread
+  };
+
+  class CLane
+  {
+  public:
+    std::vector<std::unique_ptr<CWorkerQueue> > m_queues; ///< one per worker of the budget
+    std::atomic<unsigned int> m_queued[CJob::PRIORITY_HIGH+1];
+    std::atomic<unsigned int> m_busy;
+    unsigned int m_workers;   ///< guarded by the manager's m_section
+    unsigned int m_nextQueue; ///< guarded by the manager's m_section
+    CEvent m_jobEvent;
+  };
+
   template<typename F>
   class CLambdaJob : public CJob
   {
@@ -296,6 +356,76 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Latency of the jobs run at one priority since startup, in milliseconds.
+   */
+  struct PriorityStatistics
+  {
+    uint64_t     jobs = 0;
+    uint64_t     waitTotal = 0;  ///< time spent queued
+    unsigned int waitMax = 0;
+    uint64_t     runTotal = 0;   ///< time spent in CJob::DoWork()
+    unsigned int runMax = 0;
+  };
+
+  struct LaneStatistics
+  {
+    unsigned int budget = 0;     ///< maximum number of workers
+    unsigned int workers = 0;
+    unsigned int busy = 0;
+    unsigned int queued = 0;
+  };
+
+  struct Statistics
+  {
+    PriorityStatistics priorities[CJob::PRIORITY_HIGH+1];
+    LaneStatistics     lanes[CJob::LANE_CPU+1];
+  };
+
+  /*!
+   \brief Get the job latencies per priority and the current load of each lane.
+   \param stats the statistics to fill in.
+   */
+  void GetStatistics(Statistics &stats) const;
+
+  /*!
+   \brief Counters and latency histograms of the jobs of one type (CJob::GetType()) since startup.
+   Jobs without a type are counted under their class name.
+   */
+  struct TypeStatistics
+  {
+    unsigned int queued = 0;
+    unsigned int running = 0;
+    uint64_t     completed = 0;
+    uint64_t     cancelled = 0;
+    uint64_t     waitHistogram[HistogramBuckets] = {};  ///< time spent queued
+    uint64_t     runHistogram[HistogramBuckets] = {};   ///< time spent in CJob::DoWork()
+  };
+
+  /*!
+   \brief Get the counters of each job type seen so far.
+   \param stats the statistics to fill in, keyed by job type.
+   */
+  void GetTypeStatistics(std::map<std::string, TypeStatistics> &stats) const;
+
+  /*!
+   \brief Upper bound of a histogram bucket of TypeStatistics.
+   \param bucket the index of the bucket.
+   \return the bound in milliseconds, 0 for the last bucket which has none.
+   */
+  static unsigned int GetHistogramBound(unsigned int bucket);
+
+  /*!
+   \brief Start or stop recording a trace of the jobs run.
+   While tracing, each completed job is recorded with its type, priority, worker and timings.
+   Stopping writes the events in the Chrome trace event format (open it with chrome://tracing)
+   to special://temp/jobtrace.json.
+   \param enable whether to trace.
+   \return the path of the trace file when stopping, empty otherwise or if it couldn't be written.
+   */
+  std::string SetTracing(bool enable);
+  bool IsTracing() const { return m_tracing; }
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -334,27 +464,43 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off our own job queue, or steal one from another worker of the lane
+   \param lane the lane of the calling worker.
+   \param queue the index of the calling worker's own queue.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(CJob::LANE lane, unsigned int queue);
+  CWorkItem *TakeJob(CLane &lane, unsigned int queue, int priority);
+  bool HasRunnableJobs(CJob::LANE lane) const;
 
-  void StartWorkers(CJob::PRIORITY priority);
+  /*! \brief Pick the queue of the lane a new job is added to, starting a worker if needed.
+   Must be called with m_section held.
+   */
+  unsigned int SelectQueue(CJob::LANE lane);
+  void FreeWorkItem(CWorkItem *work);
+  CWorkItem *GetCurrentWorkItem(const CJob *job) const;
+  static void UpdateMax(std::atomic<unsigned int> &max, unsigned int value);
+  bool HasWorkers() const;
+
+  void InitLane(CJob::LANE lane, unsigned int budget);
+  void TraceJob(const CWorkItem *work, const CJobWorker *worker, int64_t finished);
+  static unsigned int GetHistogramBucket(unsigned int ms);
   void RemoveWorker(const CJobWorker *worker);
-  static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
+  unsigned int GetMaxWorkers(CJob::LANE lane, CJob::PRIORITY priority) const;
 
   unsigned int m_jobCounter;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
-  typedef std::vector<CJobWorker*> Workers;
+  typedef std::map<unsigned int, CWorkItem*> WorkItems;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_pauseJobs;
-  Processing m_processing;
-  Workers    m_workers;
+  CLane      m_lanes[CJob::LANE_CPU+1];
+  std::atomic<bool> m_pauseJobs;
+  CPriorityCounters m_priorities[CJob::PRIORITY_HIGH+1];
+  std::map<std::string, CTypeCounters> m_typeCounters; ///< insertions guarded by m_section
+
+  std::atomic<bool> m_tracing;
+  int64_t    m_traceStart;
+  std::vector<std::string> m_traceEvents; ///< guarded by m_section
 
   CCriticalSection m_section;
-  CEvent           m_jobEvent;
-  bool             m_running;
+  std::atomic<bool> m_running;
 };
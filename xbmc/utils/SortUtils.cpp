@@ -240,7 +240,9 @@ std::string BySortTitle(SortAttribute attributes, const SortItem &values)
 
 std::string ByRating(SortAttribute attributes, const SortItem &values)
 {
-  return StringUtils::Format("%f %s", values.at(FieldRating).asFloat(), ByLabel(attributes, values).c_str());
+  // format the value as the database returned it, going through a float can merge or reorder
+  // ratings the database keeps apart, see GetLeadingOrderField
+  return StringUtils::Format("%f %s", values.at(FieldRating).asDouble(), ByLabel(attributes, values).c_str());
 }
 
 std::string ByUserRating(SortAttribute attributes, const SortItem &values)
@@ -522,6 +524,36 @@ bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortIt
   return SorterIgnoreFoldersDescending(*left, *right);
 }
 
+class SortKeysSorter
+{
+public:
+  SortKeysSorter(const SortKeys &keys, bool handleFolder, bool descending)
+    : m_keys(keys), m_handleFolder(handleFolder), m_descending(descending)
+  { }
+
+  // same ordering as SorterAscending/SorterDescending and friends
+  bool operator()(size_t left, size_t right) const
+  {
+    const SortSpecial leftSortSpecial = (SortSpecial)m_keys.special[left];
+    const SortSpecial rightSortSpecial = (SortSpecial)m_keys.special[right];
+    if (leftSortSpecial != rightSortSpecial)
+      return leftSortSpecial == SortSpecialOnTop || rightSortSpecial == SortSpecialOnBottom;
+    else if (leftSortSpecial != SortSpecialNone)
+      return false;
+
+    if (m_handleFolder && m_keys.folder[left] != m_keys.folder[right])
+      return m_keys.folder[left] != 0;
+
+    const int compare = StringUtils::AlphaNumericCompare(m_keys.labels[left].c_str(), m_keys.labels[right].c_str());
+    return m_descending ? compare > 0 : compare < 0;
+  }
+
+private:
+  const SortKeys &m_keys;
+  bool m_handleFolder;
+  bool m_descending;
+};
+
 std::map<SortBy, SortUtils::SortPreparator> fillPreparators()
 {
   std::map<SortBy, SortUtils::SortPreparator> preparators;
@@ -749,6 +781,52 @@ void SortUtils::Sort(const SortDescription &sortDescription, SortItems& items)
   Sort(sortDescription.sortBy, sortDescription.sortOrder, sortDescription.sortAttributes, items, sortDescription.limitEnd, sortDescription.limitStart);
 }
 
+void SortUtils::AppendSortKey(SortKeys &keys, SortItem &item)
+{
+  std::wstring sortLabel;
+  SortPreparator preparator = getPreparator(keys.sortBy);
+  if (preparator != NULL)
+  {
+    // add all fields to the item that are required for sorting if they are currently missing
+    const Fields &sortingFields = GetFieldsForSorting(keys.sortBy);
+    for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
+    {
+      if (item.find(*field) == item.end())
+        item.insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+    }
+
+    g_charsetConverter.utf8ToW(preparator(keys.sortAttributes, item), sortLabel, false);
+  }
+
+  SortSpecial sortSpecial = SortSpecialNone;
+  SortItem::const_iterator it = item.find(FieldSortSpecial);
+  if (it != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+    sortSpecial = (SortSpecial)it->second.asInteger();
+
+  it = item.find(FieldFolder);
+  keys.labels.push_back(std::move(sortLabel));
+  keys.special.push_back((uint8_t)sortSpecial);
+  keys.folder.push_back(it != item.end() && it->second.asBoolean() ? 1 : 0);
+}
+
+void SortUtils::Sort(const SortKeys &keys, SortOrder sortOrder, SortAttribute attributes, std::vector<size_t> &order, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+{
+  order.resize(keys.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  if (keys.sortBy != SortByNone && getPreparator(keys.sortBy) != NULL)
+    std::stable_sort(order.begin(), order.end(), SortKeysSorter(keys, !(attributes & SortAttributeIgnoreFolders), sortOrder == SortOrderDescending));
+
+  if (limitStart > 0 && (size_t)limitStart < order.size())
+  {
+    order.erase(order.begin(), order.begin() + limitStart);
+    limitEnd -= limitStart;
+  }
+  if (limitEnd > 0 && (size_t)limitEnd < order.size())
+    order.erase(order.begin() + limitEnd, order.end());
+}
+
 bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
 {
   FieldList fields;
@@ -770,6 +848,63 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const Me
   return true;
 }
 
+bool SortUtils::BuildOrderClause(const SortDescription &sortDescription, const MediaType &mediaType, std::string &orderClause)
+{
+  std::string direction = sortDescription.sortOrder == SortOrderDescending ? " DESC" : " ASC";
+
+  switch (sortDescription.sortBy)
+  {
+    case SortByDateAdded:
+    {
+      // ByDateAdded compares "<date added> <id>", the fixed width timestamps compare the same way in SQL
+      std::string dateAdded = DatabaseUtils::GetField(FieldDateAdded, mediaType, DatabaseQueryPartOrderBy);
+      std::string id = DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartOrderBy);
+      if (dateAdded.empty() || id.empty())
+        return false;
+
+      orderClause = dateAdded + direction + ", " + id + direction;
+      return true;
+    }
+
+    case SortByRandom:
+      orderClause = DatabaseUtils::GetField(FieldRandom, mediaType, DatabaseQueryPartOrderBy);
+      return !orderClause.empty();
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
+bool SortUtils::GetLeadingOrderField(const SortDescription &sortDescription, const MediaType &mediaType, std::string &orderField)
+{
+  Field field;
+  switch (sortDescription.sortBy)
+  {
+    // ByRating and ByUserRating start with the unsigned number, which AlphaNumericCompare
+    // compares by value, and the label comes after it. Items without one sort as 0. ratings
+    // are stored with at most six decimals so their %f form orders like the column does.
+    case SortByRating:
+      field = FieldRating;
+      break;
+
+    case SortByUserRating:
+      field = FieldUserRating;
+      break;
+
+    default:
+      return false;
+  }
+
+  std::string column = DatabaseUtils::GetField(field, mediaType, DatabaseQueryPartOrderBy);
+  if (column.empty())
+    return false;
+
+  orderField = "COALESCE(" + column + ", 0)";
+  return true;
+}
+
 const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
 {
   std::map<SortBy, SortPreparator>::const_iterator it = m_preparators.find(sortBy);
@@ -22,6 +22,8 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
+#include <stdint.h>
 
 #include "DatabaseUtils.h"
 #include "SortFileItem.h"
@@ -121,6 +123,28 @@ typedef DatabaseResult SortItem;
 typedef std::shared_ptr<SortItem> SortItemPtr;
 typedef std::vector<SortItemPtr> SortItems;
 
+/*!
+ \brief Precomputed sort keys of a list of items, one entry per item.
+
+ The keys only depend on the sort method and the ignore article attribute
+ so they can be reused to sort the same items again in another order.
+ \sa SortUtils::AppendSortKey, SortUtils::Sort
+ */
+typedef struct SortKeys
+{
+  SortBy sortBy;
+  SortAttribute sortAttributes;
+  std::vector<std::wstring> labels;
+  std::vector<uint8_t> special;
+  std::vector<uint8_t> folder;
+
+  SortKeys()
+    : sortBy(SortByNone), sortAttributes(SortAttributeNone)
+  { }
+  size_t size() const { return labels.size(); }
+  void clear() { sortBy = SortByNone; labels.clear(); special.clear(); folder.clear(); }
+} SortKeys;
+
 class SortUtils
 {
 public:
@@ -142,7 +166,35 @@ public:
   static void Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd = -1, int limitStart = 0);
   static void Sort(const SortDescription &sortDescription, DatabaseResults& items);
   static void Sort(const SortDescription &sortDescription, SortItems& items);
+  /*! \brief prepare the sort key of an item and append it to the given keys
+   \param keys the keys to append to, keys.sortBy and keys.sortAttributes select how the key is made
+   \param item the sortable values of the item, missing sorting fields are added
+   */
+  static void AppendSortKey(SortKeys &keys, SortItem &item);
+  /*! \brief sort by precomputed keys without touching the items themselves
+   \param keys the keys of the items to sort
+   \param order filled with the item indices in sorted order
+   */
+  static void Sort(const SortKeys &keys, SortOrder sortOrder, SortAttribute attributes, std::vector<size_t> &order, int limitEnd = -1, int limitStart = 0);
   static bool SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  /*! \brief build an SQL ORDER BY clause that orders rows the same way Sort() orders them
+   \param sortDescription the sorting to translate, its limits are ignored
+   \param mediaType the media type of the queried view
+   \param orderClause filled with the clause without the ORDER BY keywords
+   \return false if the database can't reproduce the order, e.g. for labels compared naturally or without articles
+   */
+  static bool BuildOrderClause(const SortDescription &sortDescription, const MediaType &mediaType, std::string &orderClause);
+  /*! \brief get an SQL expression that orders rows like the leading part of the sort keys Sort() builds
+   Rows with different values of the expression are ordered the same way by Sort(), rows with the same
+   value still have to be ordered by Sort().
+   \param sortDescription the sorting to translate, its limits are ignored
+   \param mediaType the media type of the queried view
+   \param orderField filled with the expression
+   \return false if the leading part of the sort keys can't be reproduced by the database. Only rating and
+   user rating are supported: titles compare with the locale collation (ICU on Android) and numbers by value,
+   and years are parsed from several date formats, neither of which SQL can reproduce exactly.
+   */
+  static bool GetLeadingOrderField(const SortDescription &sortDescription, const MediaType &mediaType, std::string &orderField);
   
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
@@ -0,0 +1,380 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "XMLVariantParser.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+
+static const char XMLTextName[] = "#text";
+
+class CXMLVariantParserHandler
+{
+public:
+  CXMLVariantParserHandler(CVariant& data, const std::vector<std::string>* elementPath,
+                           const CJSONVariantParser::ItemCallback* callback);
+
+  void SetContext(xmlParserCtxtPtr context) { m_context = context; }
+  bool IsAborted() const { return m_aborted; }
+  bool IsComplete() const { return m_complete; }
+
+  // libxml2 SAX2 callbacks, ctx is the handler
+  static void StartElement(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI,
+                           int nb_namespaces, const xmlChar** namespaces,
+                           int nb_attributes, int nb_defaulted, const xmlChar** attributes);
+  static void EndElement(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI);
+  static void Characters(void* ctx, const xmlChar* ch, int len);
+  static void CData(void* ctx, const xmlChar* value, int len);
+
+private:
+  struct Element
+  {
+    std::string name;
+    CVariant value;     // attributes and child elements
+    bool hasAttributes;
+    bool streamed;      // handed to the callback instead of stored
+    int children;
+    bool hasText;       // the only child so far is text, held in text
+    std::string text;
+  };
+
+  void OnStartElement(std::string&& name, int attributeCount, const xmlChar** attributes);
+  void OnEndElement();
+  void OnText(const char* text, int length, bool cdata);
+  void FlushText();
+  void AddChild(Element& element);
+  bool IsElementPath() const;
+
+  static std::string GetName(const xmlChar* localname, const xmlChar* prefix);
+  static void AddMember(CVariant& object, const std::string& name, CVariant&& value);
+  static CVariant ToValue(const std::string& value);
+
+  CVariant& m_data;
+  const std::vector<std::string>* m_elementPath;
+  const CJSONVariantParser::ItemCallback* m_callback;
+  xmlParserCtxtPtr m_context;
+  std::vector<Element> m_elements;
+  std::string m_text;   // character data not yet added to the current element
+  bool m_textIsCData;
+  bool m_aborted;
+  bool m_complete;
+};
+
+CXMLVariantParserHandler::CXMLVariantParserHandler(CVariant& data, const std::vector<std::string>* elementPath,
+                                                   const CJSONVariantParser::ItemCallback* callback)
+  : m_data(data)
+  , m_elementPath(elementPath)
+  , m_callback(callback)
+  , m_context(nullptr)
+  , m_textIsCData(false)
+  , m_aborted(false)
+  , m_complete(false)
+{
+  m_data = CVariant(CVariant::VariantTypeObject);
+}
+
+void CXMLVariantParserHandler::StartElement(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI,
+                                            int nb_namespaces, const xmlChar** namespaces,
+                                            int nb_attributes, int nb_defaulted, const xmlChar** attributes)
+{
+  static_cast<CXMLVariantParserHandler*>(ctx)->OnStartElement(GetName(localname, prefix), nb_attributes, attributes);
+}
+
+void CXMLVariantParserHandler::EndElement(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI)
+{
+  static_cast<CXMLVariantParserHandler*>(ctx)->OnEndElement();
+}
+
+void CXMLVariantParserHandler::Characters(void* ctx, const xmlChar* ch, int len)
+{
+  static_cast<CXMLVariantParserHandler*>(ctx)->OnText(reinterpret_cast<const char*>(ch), len, false);
+}
+
+void CXMLVariantParserHandler::CData(void* ctx, const xmlChar* value, int len)
+{
+  static_cast<CXMLVariantParserHandler*>(ctx)->OnText(reinterpret_cast<const char*>(value), len, true);
+}
+
+void CXMLVariantParserHandler::OnStartElement(std::string&& name, int attributeCount, const xmlChar** attributes)
+{
+  if (m_aborted)
+    return;
+
+  FlushText();
+  if (!m_elements.empty())
+    AddChild(m_elements.back());
+
+  Element element;
+  element.name = std::move(name);
+  element.value = CVariant(CVariant::VariantTypeObject);
+  element.hasAttributes = attributeCount > 0;
+  element.streamed = false;
+  element.children = 0;
+  element.hasText = false;
+  // localname, prefix, URI, value and end of value for each attribute
+  for (int i = 0; i < attributeCount; ++i, attributes += 5)
+  {
+    std::string value(reinterpret_cast<const char*>(attributes[3]), attributes[4] - attributes[3]);
+    element.value[GetName(attributes[0], attributes[1])] = ToValue(value);
+  }
+  m_elements.push_back(std::move(element));
+
+  if (m_elementPath != nullptr)
+    m_elements.back().streamed = IsElementPath();
+  // let the callback look at the root attributes (ie. the container)
+  if (m_elements.size() == 1)
+    m_data[m_elements.back().name] = m_elements.back().value;
+}
+
+void CXMLVariantParserHandler::OnEndElement()
+{
+  if (m_aborted || m_elements.empty())
+    return;
+
+  FlushText();
+  Element element = std::move(m_elements.back());
+  m_elements.pop_back();
+
+  CVariant value;
+  if (element.children == 0)
+  {
+    // <e/> is null, <e attr="x"/> only has its attributes
+    if (element.hasAttributes)
+      value = std::move(element.value);
+    else
+      value = CVariant::ConstNullVariant;
+  }
+  else if (element.hasText)
+  {
+    // <e attr="x">text</e> keeps text as is, <e>text</e> might be a number
+    if (element.hasAttributes)
+    {
+      element.value[XMLTextName] = CVariant(std::move(element.text));
+      value = std::move(element.value);
+    }
+    else
+      value = ToValue(element.text);
+  }
+  else
+    value = std::move(element.value);
+
+  if (m_elements.empty())
+  {
+    m_data[element.name] = std::move(value);
+    m_complete = true;
+  }
+  else if (element.streamed)
+  {
+    if (!(*m_callback)(value))
+    {
+      m_aborted = true;
+      xmlStopParser(m_context);
+    }
+  }
+  else
+    AddMember(m_elements.back().value, element.name, std::move(value));
+}
+
+void CXMLVariantParserHandler::OnText(const char* text, int length, bool cdata)
+{
+  if (m_aborted || m_elements.empty())
+    return;
+
+  // a cdata section and the text around it are separate children
+  if (cdata != m_textIsCData)
+  {
+    FlushText();
+    m_textIsCData = cdata;
+  }
+  m_text.append(text, length);
+}
+
+void CXMLVariantParserHandler::FlushText()
+{
+  if (m_text.empty())
+    return;
+
+  // whitespace between elements is not text
+  if (!m_textIsCData && m_text.find_first_not_of(" \t\r\n") == std::string::npos)
+  {
+    m_text.clear();
+    return;
+  }
+
+  Element& element = m_elements.back();
+  if (element.children == 0 && !m_textIsCData)
+  {
+    // hold on to it, this might be <e>text</e>
+    element.children = 1;
+    element.hasText = true;
+    element.text = std::move(m_text);
+  }
+  else
+  {
+    AddChild(element);
+    AddMember(element.value, XMLTextName, CVariant(std::move(m_text)));
+  }
+  m_text.clear();
+}
+
+void CXMLVariantParserHandler::AddChild(Element& element)
+{
+  if (element.hasText)
+  {
+    // the text was not the only child after all
+    element.hasText = false;
+    AddMember(element.value, XMLTextName, CVariant(std::move(element.text)));
+  }
+  element.children++;
+}
+
+bool CXMLVariantParserHandler::IsElementPath() const
+{
+  if (m_elements.size() != m_elementPath->size())
+    return false;
+
+  for (size_t i = 0; i < m_elements.size(); ++i)
+  {
+    if (m_elements[i].name != (*m_elementPath)[i])
+      return false;
+  }
+  return true;
+}
+
+std::string CXMLVariantParserHandler::GetName(const xmlChar* localname, const xmlChar* prefix)
+{
+  std::string name;
+  if (prefix != nullptr)
+  {
+    name = reinterpret_cast<const char*>(prefix);
+    name += ":";
+  }
+  name += reinterpret_cast<const char*>(localname);
+  return name;
+}
+
+void CXMLVariantParserHandler::AddMember(CVariant& object, const std::string& name, CVariant&& value)
+{
+  if (!object.isMember(name))
+  {
+    object[name] = std::move(value);
+    return;
+  }
+
+  // repeated children are collected in an array
+  CVariant& member = object[name];
+  if (!member.isArray())
+  {
+    CVariant array(CVariant::VariantTypeArray);
+    array.push_back(std::move(member));
+    member = std::move(array);
+  }
+  member.push_back(std::move(value));
+}
+
+CVariant CXMLVariantParserHandler::ToValue(const std::string& value)
+{
+  // same rules as xml2json, digits with at most one '.' are a number
+  bool hasDecimal = false;
+  for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+  {
+    if (*it == '.')
+    {
+      if (hasDecimal)
+        return CVariant(value);
+      hasDecimal = true;
+    }
+    else if (ispunct(static_cast<unsigned char>(*it)) || isalpha(static_cast<unsigned char>(*it)))
+      return CVariant(value);
+  }
+  if (value.empty())
+    return CVariant(value);
+
+  const char* begin = value.c_str();
+  char* end = nullptr;
+  if (hasDecimal)
+  {
+    double number = strtod(begin, &end);
+    if (end != begin)
+      return CVariant(number);
+  }
+  else
+  {
+    // base 10, leading zeros (ie. "007") must not turn the value octal
+    uint64_t number = strtoull(begin, &end, 10);
+    if (end != begin)
+      return CVariant(number);
+  }
+  return CVariant(value);
+}
+
+static bool ParseXML(const CJSONVariantParser::ReadCallback& read, CXMLVariantParserHandler& handler)
+{
+  xmlSAXHandler sax;
+  memset(&sax, 0, sizeof(sax));
+  sax.initialized = XML_SAX2_MAGIC;
+  sax.startElementNs = CXMLVariantParserHandler::StartElement;
+  sax.endElementNs = CXMLVariantParserHandler::EndElement;
+  sax.characters = CXMLVariantParserHandler::Characters;
+  sax.ignorableWhitespace = CXMLVariantParserHandler::Characters;
+  sax.cdataBlock = CXMLVariantParserHandler::CData;
+
+  // the first chunk lets libxml2 detect the encoding
+  char buffer[16384];
+  size_t size = read(buffer, sizeof(buffer));
+  if (size == 0)
+    return false;
+
+  xmlParserCtxtPtr context = xmlCreatePushParserCtxt(&sax, &handler, buffer, size, nullptr);
+  if (context == nullptr)
+    return false;
+  // NOENT so "&amp;" in attribute values is not handed over as "&#38;",
+  // there are no entity declaration callbacks so only the predefined
+  // entities and character references get replaced
+  xmlCtxtUseOptions(context, XML_PARSE_NOENT | XML_PARSE_NONET | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+  handler.SetContext(context);
+
+  int result = 0;
+  do
+  {
+    size = read(buffer, sizeof(buffer));
+    result = xmlParseChunk(context, buffer, size, size == 0);
+  } while (size > 0 && result == 0 && !handler.IsAborted());
+
+  bool parsed = result == 0 && context->wellFormed && !handler.IsAborted() && handler.IsComplete();
+  xmlFreeParserCtxt(context);
+  return parsed;
+}
+
+bool CXMLVariantParser::Parse(const CJSONVariantParser::ReadCallback& read, CVariant& data)
+{
+  CXMLVariantParserHandler handler(data, nullptr, nullptr);
+  return ParseXML(read, handler);
+}
+
+bool CXMLVariantParser::Parse(const CJSONVariantParser::ReadCallback& read, const std::vector<std::string>& elementPath,
+                              const CJSONVariantParser::ItemCallback& callback, CVariant& data)
+{
+  CXMLVariantParserHandler handler(data, &elementPath, &callback);
+  return ParseXML(read, handler);
+}
@@ -0,0 +1,52 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "utils/JSONVariantParser.h"
+#include "utils/Variant.h"
+
+/*!
+ \brief Parses xml into a CVariant while it is read, laid out the same
+ way xml2json followed by CJSONVariantParser lays it out: the root element
+ is the only member of data, attributes and child elements are members of
+ their element, repeated child elements become an array, text is "#text"
+ and attribute or text values that look like numbers become numbers.
+ */
+class CXMLVariantParser
+{
+public:
+  CXMLVariantParser() = delete;
+
+  static bool Parse(const CJSONVariantParser::ReadCallback& read, CVariant& data);
+
+  /*!
+   \brief Parse but hand every element found at elementPath (a chain of
+   element names starting at the root) to callback as soon as it is
+   complete instead of storing it. A single element is handed over too,
+   xml2json would not have made an array of it. The attributes of the
+   root are already in data when callback runs. Returning false from
+   callback stops parsing.
+   */
+  static bool Parse(const CJSONVariantParser::ReadCallback& read, const std::vector<std::string>& elementPath,
+                    const CJSONVariantParser::ItemCallback& callback, CVariant& data);
+};
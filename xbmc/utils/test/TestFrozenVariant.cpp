@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2017 Team MrMC
+ *      https://github.com/MrMC
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with MrMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/FrozenVariant.h"
+
+#include "gtest/gtest.h"
+
+static CVariant MakeItem(int id)
+{
+  CVariant item(CVariant::VariantTypeObject);
+  item["Id"] = "item" + std::to_string(id);
+  item["Name"] = "Name " + std::to_string(id);
+  item["IndexNumber"] = id;
+  item["RunTimeTicks"] = (uint64_t)id * 10000000;
+  item["CommunityRating"] = 7.5;
+  item["IsFolder"] = false;
+  item["Overview"] = CVariant(CVariant::VariantTypeNull);
+  item["UserData"]["Played"] = (id % 2) == 0;
+  item["UserData"]["PlaybackPositionTicks"] = (int64_t)-1;
+  item["Genres"].push_back("Drama");
+  item["Genres"].push_back("Comedy");
+  return item;
+}
+
+// CVariant::operator== never matches null against null
+static bool Equal(const CVariant &lhs, const CVariant &rhs)
+{
+  if (lhs.isNull() || rhs.isNull())
+    return lhs.isNull() && rhs.isNull();
+  if (lhs.type() != rhs.type() || lhs.size() != rhs.size())
+    return false;
+  if (lhs.isArray())
+  {
+    for (unsigned int i = 0; i < lhs.size(); ++i)
+      if (!Equal(lhs[i], rhs[i]))
+        return false;
+    return true;
+  }
+  if (lhs.isObject())
+  {
+    for (auto it = lhs.begin_map(); it != lhs.end_map(); ++it)
+      if (!rhs.isMember(it->first) || !Equal(it->second, rhs[it->first]))
+        return false;
+    return true;
+  }
+  return lhs == rhs;
+}
+
+TEST(TestFrozenVariant, EmptyVariant)
+{
+  CFrozenVariant frozen;
+  EXPECT_TRUE(frozen.Root().isNull());
+  EXPECT_EQ(0u, frozen.Root().size());
+  EXPECT_TRUE(frozen.ToVariant().isNull());
+
+  CFrozenVariant emptyObject((CVariant(CVariant::VariantTypeObject)));
+  EXPECT_TRUE(emptyObject.Root().isObject());
+  EXPECT_TRUE(emptyObject.Root().empty());
+  EXPECT_TRUE(emptyObject.Root()["missing"].isNull());
+
+  CFrozenVariant emptyArray((CVariant(CVariant::VariantTypeArray)));
+  EXPECT_TRUE(emptyArray.Root().isArray());
+  EXPECT_TRUE(emptyArray.Root()[0u].isNull());
+}
+
+TEST(TestFrozenVariant, Scalars)
+{
+  EXPECT_EQ(-42, CFrozenVariant(CVariant((int64_t)-42)).Root().asInteger());
+  EXPECT_EQ(UINT64_MAX, CFrozenVariant(CVariant((uint64_t)UINT64_MAX)).Root().asUnsignedInteger());
+  EXPECT_TRUE(CFrozenVariant(CVariant(true)).Root().asBoolean());
+  EXPECT_DOUBLE_EQ(0.25, CFrozenVariant(CVariant(0.25)).Root().asDouble());
+  EXPECT_EQ("text", CFrozenVariant(CVariant("text")).Root().asString());
+  EXPECT_EQ("", CFrozenVariant(CVariant("")).Root().asString());
+  EXPECT_TRUE(CFrozenVariant(CVariant(L"wide")).Root().ToVariant() == CVariant(L"wide"));
+
+  // embedded nul bytes survive
+  const std::string binary("a\0b", 3);
+  EXPECT_EQ(binary, CFrozenVariant(CVariant(binary)).Root().asString());
+}
+
+TEST(TestFrozenVariant, RoundTrip)
+{
+  CVariant view(CVariant::VariantTypeObject);
+  view["TotalRecordCount"] = 100;
+  for (int i = 0; i < 100; ++i)
+    view["Items"].push_back(MakeItem(i));
+  view["Nested"]["a"]["b"]["c"].push_back(CVariant(CVariant::VariantTypeArray));
+
+  CFrozenVariant frozen(view);
+  EXPECT_TRUE(Equal(view, frozen.ToVariant()));
+  EXPECT_GT(frozen.GetMemoryUsage(), 0u);
+
+  // a second freeze of the thawed copy gives the same tree
+  CFrozenVariant refrozen(frozen.ToVariant());
+  EXPECT_TRUE(Equal(view, refrozen.ToVariant()));
+}
+
+TEST(TestFrozenVariant, Lookup)
+{
+  CVariant view(CVariant::VariantTypeObject);
+  for (int i = 0; i < 10; ++i)
+    view["Items"].push_back(MakeItem(i));
+
+  CFrozenVariant frozen(view);
+  CFrozenVariant::CRef items = frozen.Root()["Items"];
+  ASSERT_TRUE(items.isArray());
+  EXPECT_EQ(10u, items.size());
+
+  CFrozenVariant::CRef item = items[3u];
+  EXPECT_TRUE(item.isMember("Id"));
+  EXPECT_FALSE(item.isMember("id"));
+  EXPECT_FALSE(item.isMember(""));
+  EXPECT_EQ("item3", item["Id"].asString());
+  EXPECT_EQ(3, item["IndexNumber"].asInteger());
+  EXPECT_EQ(30000000u, item["RunTimeTicks"].asUnsignedInteger());
+  EXPECT_FALSE(item["UserData"]["Played"].asBoolean());
+  EXPECT_EQ(-1, item["UserData"]["PlaybackPositionTicks"].asInteger());
+  EXPECT_EQ("Comedy", item["Genres"][1u].asString());
+  EXPECT_TRUE(item["Overview"].isNull());
+  EXPECT_TRUE(item.isMember("Overview"));
+
+  // missing keys and positions give null refs, like CVariant
+  EXPECT_TRUE(item["Missing"].isNull());
+  EXPECT_TRUE(item["Missing"]["Deeper"].isNull());
+  EXPECT_TRUE(items[10u].isNull());
+  EXPECT_TRUE(item["Id"]["NotAnObject"].isNull());
+  EXPECT_EQ("fallback", item["Missing"].asString("fallback"));
+  EXPECT_EQ(7, item["Missing"].asInteger(7));
+}
+
+TEST(TestFrozenVariant, KeyOrder)
+{
+  CVariant object(CVariant::VariantTypeObject);
+  object["zulu"] = 1;
+  object["alpha"] = 2;
+  object["Mike"] = 3;
+  object["bravo"] = 4;
+
+  CFrozenVariant frozen(object);
+  CFrozenVariant::CRef root = frozen.Root();
+  ASSERT_EQ(4u, root.size());
+  for (unsigned int i = 1; i < root.size(); ++i)
+    EXPECT_LT(root.key(i - 1), root.key(i));
+  for (unsigned int i = 0; i < root.size(); ++i)
+    EXPECT_EQ(object[root.key(i)].asInteger(), root.value(i).asInteger());
+  EXPECT_EQ("", root.key(4));
+  EXPECT_TRUE(root.value(4).isNull());
+}
@@ -565,12 +565,16 @@ int CVideoDatabase::GetPathId(const std::string& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL);
-    if (!m_pDS->eof())
-      idPath = m_pDS->fv("path.idPath").get_asInt();
+    // called for every file while scanning, keep it on a prepared statement
+    strSQL = "select idPath from path where strPath=?";
+    std::unique_ptr<dbiplus::Cursor> cursor = PrepareCursor(strSQL);
+    if (!cursor)
+      return -1;
+
+    cursor->bind(1, strPath1);
+    if (cursor->step())
+      idPath = cursor->column_int(0);
 
-    m_pDS->close();
     return idPath;
   }
   catch (...)
@@ -717,6 +721,58 @@ int CVideoDatabase::RunQuery(const std::string &sql)
   return rows;
 }
 
+bool CVideoDatabase::BuildSortedPageSQL(const std::string &sql, const Filter &filter, const MediaType &mediaType, SortDescription &sorting, std::string &sqlExtra, int &total)
+{
+  std::string orderField;
+  if (!filter.order.empty() || !filter.group.empty() || !filter.limit.empty() ||
+     (sorting.limitStart <= 0 && sorting.limitEnd <= 0) ||
+     !SortUtils::GetLeadingOrderField(sorting, mediaType, orderField))
+    return false;
+
+  std::string filterSQL;
+  if (!CDatabase::BuildSQL("", filter, filterSQL))
+    return false;
+
+  int rows = (int)strtol(GetSingleValue(PrepareSQL(sql, "COUNT(1)") + filterSQL, m_pDS).c_str(), NULL, 10);
+  int start = std::max(sorting.limitStart, 0);
+  int end = sorting.limitEnd > 0 ? std::min(sorting.limitEnd, rows) : rows;
+  if (start >= end)
+  {
+    sqlExtra = filterSQL + DatabaseUtils::BuildLimitClause(0);
+    total = rows;
+    return true;
+  }
+
+  // the leading field of the first and the last row of the page, these stay subqueries so
+  // the values are never converted to strings and back
+  bool descending = sorting.sortOrder == SortOrderDescending;
+  std::string orderBy = " ORDER BY " + orderField + (descending ? " DESC" : " ASC");
+  std::string first = "(" + PrepareSQL(sql, orderField.c_str()) + filterSQL + orderBy + DatabaseUtils::BuildLimitClause(start + 1, start) + ")";
+  std::string last = "(" + PrepareSQL(sql, orderField.c_str()) + filterSQL + orderBy + DatabaseUtils::BuildLimitClause(end, end - 1) + ")";
+
+  // rows whose leading field sorts before the one of the first row come before the page
+  Filter skippedFilter(filter);
+  skippedFilter.AppendWhere(orderField + (descending ? " > " : " < ") + first);
+  std::string skippedSQL;
+  if (!CDatabase::BuildSQL("", skippedFilter, skippedSQL))
+    return false;
+  int skipped = (int)strtol(GetSingleValue(PrepareSQL(sql, "COUNT(1)") + skippedSQL, m_pDS).c_str(), NULL, 10);
+
+  // the rest of the sort keys only orders the rows sharing the leading field with the first or the
+  // last row of the page, ordering by id gives rows with equal sort keys the same order on every page
+  Filter pageFilter(filter);
+  pageFilter.AppendWhere(orderField + (descending ? " <= " : " >= ") + first);
+  pageFilter.AppendWhere(orderField + (descending ? " >= " : " <= ") + last);
+  pageFilter.order = DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartOrderBy);
+  if (!CDatabase::BuildSQL("", pageFilter, sqlExtra))
+    return false;
+
+  sorting.limitStart = start - skipped;
+  sorting.limitEnd = end - skipped;
+  total = rows;
+  return true;
+}
+
 bool CVideoDatabase::GetSubPaths(const std::string &basepath, std::vector<std::pair<int, std::string>>& subpaths)
 {
   std::string sql;
@@ -753,9 +809,16 @@ int CVideoDatabase::AddPath(const std::string& strPath, const std::string &paren
   std::string strSQL;
   try
   {
-    int idPath = GetPathId(strPath);
+    int idPath = GetCachedLookupId("path", strPath);
+    if (idPath >= 0)
+      return idPath;
+
+    idPath = GetPathId(strPath);
     if (idPath >= 0)
+    {
+      CacheLookupId("path", strPath, idPath);
       return idPath; // already have the path
+    }
 
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
@@ -785,6 +848,7 @@ int CVideoDatabase::AddPath(const std::string& strPath, const std::string &paren
     }
     m_pDS->exec(strSQL);
     idPath = (int)m_pDS->lastinsertid();
+    CacheLookupId("path", strPath, idPath);
     return idPath;
   }
   catch (...)
@@ -1109,15 +1173,14 @@ int CVideoDatabase::GetFileId(const std::string& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      std::string strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL);
-      if (m_pDS->num_rows() > 0)
-      {
-        int idFile = m_pDS->fv("files.idFile").get_asInt();
-        m_pDS->close();
-        return idFile;
-      }
+      std::unique_ptr<dbiplus::Cursor> cursor = PrepareCursor("select idFile from files where strFileName=? and idPath=?");
+      if (!cursor)
+        return -1;
+
+      cursor->bind(1, strFileName);
+      cursor->bind(2, idPath);
+      if (cursor->step())
+        return cursor->column_int(0);
     }
   }
   catch (...)
@@ -1166,18 +1229,26 @@ int CVideoDatabase::GetMovieId(const std::string& strFilenameAndPath)
     if (idFile == -1 && strPath != strFilenameAndPath)
       return -1;
 
-    std::string strSQL;
+    std::unique_ptr<dbiplus::Cursor> cursor;
     if (idFile == -1)
-      strSQL=PrepareSQL("select idMovie from movie join files on files.idFile=movie.idFile where files.idPath=%i",idPath);
+    {
+      cursor = PrepareCursor("select idMovie from movie join files on files.idFile=movie.idFile where files.idPath=?");
+      if (cursor)
+        cursor->bind(1, idPath);
+    }
     else
-      strSQL=PrepareSQL("select idMovie from movie where idFile=%i", idFile);
+    {
+      cursor = PrepareCursor("select idMovie from movie where idFile=?");
+      if (cursor)
+        cursor->bind(1, idFile);
+    }
+    if (!cursor)
+      return -1;
 
     if (g_advancedSettings.CanLogComponent(LOGDATABASE))
-      CLog::Log(LOGDEBUG, "%s (%s), query = %s", __FUNCTION__, CURL::GetRedacted(strFilenameAndPath).c_str(), strSQL.c_str());
-    m_pDS->query(strSQL);
-    if (m_pDS->num_rows() > 0)
-      idMovie = m_pDS->fv("idMovie").get_asInt();
-    m_pDS->close();
+      CLog::Log(LOGDEBUG, "%s (%s), idFile = %i, idPath = %i", __FUNCTION__, CURL::GetRedacted(strFilenameAndPath).c_str(), idFile, idPath);
+    if (cursor->step())
+      idMovie = cursor->column_int(0);
 
     return idMovie;
   }
@@ -1201,33 +1272,31 @@ int CVideoDatabase::GetTvShowId(const std::string& strPath)
     if (idPath < 0)
       return -1;
 
-    std::string strSQL;
     std::string strPath1=strPath;
     std::string strParent;
-    int iFound=0;
 
-    strSQL=PrepareSQL("select idShow from tvshowlinkpath where tvshowlinkpath.idPath=%i",idPath);
-    m_pDS->query(strSQL);
-    if (!m_pDS->eof())
-      iFound = 1;
+    // called for every episode while scanning, keep it on prepared statements
+    std::unique_ptr<dbiplus::Cursor> cursor = PrepareCursor("select idShow from tvshowlinkpath where tvshowlinkpath.idPath=?");
+    if (!cursor)
+      return -1;
+
+    cursor->bind(1, idPath);
+    if (cursor->step())
+      return cursor->column_int(0);
+
+    cursor = PrepareCursor("SELECT idShow FROM path INNER JOIN tvshowlinkpath ON tvshowlinkpath.idPath=path.idPath WHERE strPath=?");
+    if (!cursor)
+      return -1;
 
-    while (iFound == 0 && URIUtils::GetParentPath(strPath1, strParent))
+    while (idTvShow == -1 && URIUtils::GetParentPath(strPath1, strParent))
     {
-      strSQL=PrepareSQL("SELECT idShow FROM path INNER JOIN tvshowlinkpath ON tvshowlinkpath.idPath=path.idPath WHERE strPath='%s'",strParent.c_str());
-      m_pDS->query(strSQL);
-      if (!m_pDS->eof())
-      {
-        int idShow = m_pDS->fv("idShow").get_asInt();
-        if (idShow != -1)
-          iFound = 2;
-      }
+      cursor->reset();
+      cursor->bind(1, strParent);
+      if (cursor->step())
+        idTvShow = cursor->column_int(0);
       strPath1 = strParent;
     }
 
-    if (m_pDS->num_rows() > 0)
-      idTvShow = m_pDS->fv("idShow").get_asInt();
-    m_pDS->close();
-
     return idTvShow;
   }
   catch (...)
@@ -1244,48 +1313,40 @@ int CVideoDatabase::GetEpisodeId(const std::string& strFilenameAndPath, int idEp
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
-    // need this due to the nested GetEpisodeInfo query
-    std::unique_ptr<Dataset> pDS;
-    pDS.reset(m_pDB->CreateDataset());
-    if (NULL == pDS.get()) return -1;
-
     int idFile = GetFileId(strFilenameAndPath);
     if (idFile < 0)
       return -1;
 
-    std::string strSQL=PrepareSQL("select idEpisode from episode where idFile=%i", idFile);
+    // the ids are read before the nested GetEpisodeInfo queries run
+    std::unique_ptr<dbiplus::Cursor> cursor = PrepareCursor("select idEpisode from episode where idFile=?");
+    if (!cursor)
+      return -1;
 
     if (g_advancedSettings.CanLogComponent(LOGDATABASE))
-      CLog::Log(LOGDEBUG, "%s (%s), query = %s", __FUNCTION__, CURL::GetRedacted(strFilenameAndPath).c_str(), strSQL.c_str());
-    pDS->query(strSQL);
-    if (pDS->num_rows() > 0)
+      CLog::Log(LOGDEBUG, "%s (%s), idFile = %i", __FUNCTION__, CURL::GetRedacted(strFilenameAndPath).c_str(), idFile);
+    cursor->bind(1, idFile);
+    std::vector<int> episodes;
+    while (cursor->step())
+      episodes.push_back(cursor->column_int(0));
+    cursor.reset();
+
+    if (episodes.empty())
+      return -1;
+    if (idEpisode == -1)
+      return episodes.front();
+
+    // use the hint!
+    for (std::vector<int>::const_iterator it = episodes.begin(); it != episodes.end(); ++it)
     {
-      if (idEpisode == -1)
-        idEpisode = pDS->fv("episode.idEpisode").get_asInt();
-      else // use the hint!
+      CVideoInfoTag tag;
+      GetEpisodeInfo(strFilenameAndPath, tag, *it, VideoDbDetailsNone);
+      if (tag.m_iEpisode == idEpisode && (idSeason == -1 || tag.m_iSeason == idSeason))
       {
-        while (!pDS->eof())
-        {
-          CVideoInfoTag tag;
-          int idTmpEpisode = pDS->fv("episode.idEpisode").get_asInt();
-          GetEpisodeInfo(strFilenameAndPath, tag, idTmpEpisode, VideoDbDetailsNone);
-          if (tag.m_iEpisode == idEpisode && (idSeason == -1 || tag.m_iSeason == idSeason)) {
-            // match on the episode hint, and there's no season hint or a season hint match
-            idEpisode = idTmpEpisode;
-            break;
-          }
-          pDS->next();
-        }
-        if (pDS->eof())
-          idEpisode = -1;
+        // match on the episode hint, and there's no season hint or a season hint match
+        return *it;
       }
     }
-    else
-      idEpisode = -1;
-
-    pDS->close();
-
-    return idEpisode;
+    return -1;
   }
   catch (...)
   {
@@ -1305,15 +1366,16 @@ int CVideoDatabase::GetMusicVideoId(const std::string& strFilenameAndPath)
     if (idFile < 0)
       return -1;
 
-    std::string strSQL=PrepareSQL("select idMVideo from musicvideo where idFile=%i", idFile);
+    std::unique_ptr<dbiplus::Cursor> cursor = PrepareCursor("select idMVideo from musicvideo where idFile=?");
+    if (!cursor)
+      return -1;
 
     if (g_advancedSettings.CanLogComponent(LOGDATABASE))
-      CLog::Log(LOGDEBUG, "%s (%s), query = %s", __FUNCTION__, CURL::GetRedacted(strFilenameAndPath).c_str(), strSQL.c_str());
-    m_pDS->query(strSQL);
+      CLog::Log(LOGDEBUG, "%s (%s), idFile = %i", __FUNCTION__, CURL::GetRedacted(strFilenameAndPath).c_str(), idFile);
+    cursor->bind(1, idFile);
     int idMVideo=-1;
-    if (m_pDS->num_rows() > 0)
-      idMVideo = m_pDS->fv("idMVideo").get_asInt();
-    m_pDS->close();
+    if (cursor->step())
+      idMVideo = cursor->column_int(0);
 
     return idMVideo;
   }
@@ -1460,23 +1522,34 @@ int CVideoDatabase::AddToTable(const std::string& table, const std::string& firs
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
+    // tags are removed by a trigger once their last link goes, so they can't be cached
+    bool cache = table != "tag";
+    if (cache)
+    {
+      int id = GetCachedLookupId(table, value);
+      if (id >= 0)
+        return id;
+    }
+
     std::string strSQL = PrepareSQL("select %s from %s where %s like '%s'", firstField.c_str(), table.c_str(), secondField.c_str(), value.substr(0, 255).c_str());
     m_pDS->query(strSQL);
+    int id;
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
       strSQL = PrepareSQL("insert into %s (%s, %s) values(NULL, '%s')", table.c_str(), firstField.c_str(), secondField.c_str(), value.substr(0, 255).c_str());
       m_pDS->exec(strSQL);
-      int id = (int)m_pDS->lastinsertid();
-      return id;
+      id = (int)m_pDS->lastinsertid();
     }
     else
     {
-      int id = m_pDS->fv(firstField.c_str()).get_asInt();
+      id = m_pDS->fv(firstField.c_str()).get_asInt();
       m_pDS->close();
-      return id;
     }
+    if (cache)
+      CacheLookupId(table, value, id);
+    return id;
   }
   catch (...)
   {
@@ -1663,27 +1736,36 @@ int CVideoDatabase::AddActor(const std::string& name, const std::string& thumbUR
     std::string trimmedName = name.c_str();
     StringUtils::Trim(trimmedName);
 
-    std::string strSQL=PrepareSQL("select actor_id from actor where name like '%s'", trimmedName.substr(0, 255).c_str());
-    m_pDS->query(strSQL);
-    if (m_pDS->num_rows() == 0)
-    {
-      m_pDS->close();
-      // doesnt exists, add it
-      strSQL=PrepareSQL("insert into actor (actor_id, name, art_urls) values(NULL, '%s', '%s')", trimmedName.substr(0,255).c_str(), thumbURLs.c_str());
-      m_pDS->exec(strSQL);
-      idActor = (int)m_pDS->lastinsertid();
-    }
-    else
+    std::string strSQL;
+    bool added = false;
+    idActor = GetCachedLookupId("actor", trimmedName);
+    if (idActor < 0)
     {
-      idActor = m_pDS->fv(0).get_asInt();
-      m_pDS->close();
-      // update the thumb url's
-      if (!thumbURLs.empty())
+      strSQL=PrepareSQL("select actor_id from actor where name like '%s'", trimmedName.substr(0, 255).c_str());
+      m_pDS->query(strSQL);
+      if (m_pDS->num_rows() == 0)
       {
-        strSQL=PrepareSQL("update actor set art_urls = '%s' where actor_id = %i", thumbURLs.c_str(), idActor);
+        m_pDS->close();
+        // doesnt exists, add it
+        strSQL=PrepareSQL("insert into actor (actor_id, name, art_urls) values(NULL, '%s', '%s')", trimmedName.substr(0,255).c_str(), thumbURLs.c_str());
         m_pDS->exec(strSQL);
+        idActor = (int)m_pDS->lastinsertid();
+        CacheLookupId("actor", trimmedName, idActor);
+        added = true;
+      }
+      else
+      {
+        idActor = m_pDS->fv(0).get_asInt();
+        m_pDS->close();
+        CacheLookupId("actor", trimmedName, idActor);
       }
     }
+    // update the thumb url's of an existing actor
+    if (!added && !thumbURLs.empty())
+    {
+      strSQL=PrepareSQL("update actor set art_urls = '%s' where actor_id = %i", thumbURLs.c_str(), idActor);
+      m_pDS->exec(strSQL);
+    }
     // add artwork
     if (!thumb.empty())
       SetArtForItem(idActor, "actor", "thumb", thumb);
@@ -6805,14 +6887,26 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
     if (!CDatabase::BuildSQL(strSQLExtra, extFilter, strSQLExtra))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
+    // Apply the limiting directly here if there's no special sorting but limiting,
+    // or if the database can sort exactly like SortUtils would
+    std::string orderClause;
+    SortDescription rowSorting = sortDescription;
     if (extFilter.limit.empty() &&
-        sorting.sortBy == SortByNone &&
-       (sorting.limitStart > 0 || sorting.limitEnd > 0))
+       (sorting.limitStart > 0 || sorting.limitEnd > 0) &&
+       (sorting.sortBy == SortByNone ||
+       (extFilter.order.empty() && SortUtils::BuildOrderClause(sorting, MediaTypeMovie, orderClause))))
     {
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+      if (!orderClause.empty())
+      {
+        strSQLExtra += " ORDER BY " + orderClause;
+        rowSorting = SortDescription();
+      }
       strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
     }
+    // otherwise only query the rows around the page if the database can order by the start of the sort keys
+    else
+      BuildSortedPageSQL(strSQL, extFilter, MediaTypeMovie, rowSorting, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -6828,7 +6922,7 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
     DatabaseResults results;
     results.reserve(iRowsFound);
 
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+    if (!SortUtils::SortFromDataset(rowSorting, MediaTypeMovie, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -6913,14 +7007,26 @@ bool CVideoDatabase::GetTvShowsByWhere(const std::string& strBaseDir, const Filt
     if (!BuildSQL(strBaseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl, sorting))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
+    // Apply the limiting directly here if there's no special sorting but limiting,
+    // or if the database can sort exactly like SortUtils would
+    std::string orderClause;
+    SortDescription rowSorting = sorting;
     if (extFilter.limit.empty() &&
-        sorting.sortBy == SortByNone &&
-        (sorting.limitStart > 0 || sorting.limitEnd > 0))
+       (sorting.limitStart > 0 || sorting.limitEnd > 0) &&
+       (sorting.sortBy == SortByNone ||
+       (extFilter.order.empty() && SortUtils::BuildOrderClause(sorting, MediaTypeTvShow, orderClause))))
     {
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+      if (!orderClause.empty())
+      {
+        strSQLExtra += " ORDER BY " + orderClause;
+        rowSorting = SortDescription();
+      }
       strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
     }
+    // otherwise only query the rows around the page if the database can order by the start of the sort keys
+    else
+      BuildSortedPageSQL(strSQL, extFilter, MediaTypeTvShow, rowSorting, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -6935,7 +7041,7 @@ bool CVideoDatabase::GetTvShowsByWhere(const std::string& strBaseDir, const Filt
     
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeTvShow, m_pDS, results))
+    if (!SortUtils::SortFromDataset(rowSorting, MediaTypeTvShow, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -7039,14 +7145,26 @@ bool CVideoDatabase::GetEpisodesByWhere(const std::string& strBaseDir, const Fil
     if (!BuildSQL(strBaseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl, sorting))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
+    // Apply the limiting directly here if there's no special sorting but limiting,
+    // or if the database can sort exactly like SortUtils would
+    std::string orderClause;
+    SortDescription rowSorting = sorting;
     if (extFilter.limit.empty() &&
-      sorting.sortBy == SortByNone &&
-      (sorting.limitStart > 0 || sorting.limitEnd > 0))
+       (sorting.limitStart > 0 || sorting.limitEnd > 0) &&
+       (sorting.sortBy == SortByNone ||
+       (extFilter.order.empty() && SortUtils::BuildOrderClause(sorting, MediaTypeEpisode, orderClause))))
     {
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+      if (!orderClause.empty())
+      {
+        strSQLExtra += " ORDER BY " + orderClause;
+        rowSorting = SortDescription();
+      }
       strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
     }
+    // otherwise only query the rows around the page if the database can order by the start of the sort keys
+    else
+      BuildSortedPageSQL(strSQL, extFilter, MediaTypeEpisode, rowSorting, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -7061,7 +7179,7 @@ bool CVideoDatabase::GetEpisodesByWhere(const std::string& strBaseDir, const Fil
     
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeEpisode, m_pDS, results))
+    if (!SortUtils::SortFromDataset(rowSorting, MediaTypeEpisode, m_pDS, results))
       return false;
     
     // get data from returned rows
@@ -7896,14 +8014,26 @@ bool CVideoDatabase::GetMusicVideosByWhere(const std::string &baseDir, const Fil
     if (!BuildSQL(baseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl, sorting))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
+    // Apply the limiting directly here if there's no special sorting but limiting,
+    // or if the database can sort exactly like SortUtils would
+    std::string orderClause;
+    SortDescription rowSorting = sorting;
     if (extFilter.limit.empty() &&
-      sorting.sortBy == SortByNone &&
-      (sorting.limitStart > 0 || sorting.limitEnd > 0))
+       (sorting.limitStart > 0 || sorting.limitEnd > 0) &&
+       (sorting.sortBy == SortByNone ||
+       (extFilter.order.empty() && SortUtils::BuildOrderClause(sorting, MediaTypeMusicVideo, orderClause))))
     {
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+      if (!orderClause.empty())
+      {
+        strSQLExtra += " ORDER BY " + orderClause;
+        rowSorting = SortDescription();
+      }
       strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
     }
+    // otherwise only query the rows around the page if the database can order by the start of the sort keys
+    else
+      BuildSortedPageSQL(strSQL, extFilter, MediaTypeMusicVideo, rowSorting, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -7918,7 +8048,7 @@ bool CVideoDatabase::GetMusicVideosByWhere(const std::string &baseDir, const Fil
     
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeMusicVideo, m_pDS, results))
+    if (!SortUtils::SortFromDataset(rowSorting, MediaTypeMusicVideo, m_pDS, results))
       return false;
     
     // get data from returned rows
@@ -9691,9 +9821,13 @@ bool CVideoDatabase::CommitTransaction()
 {
   if (CDatabase::CommitTransaction())
   { // number of items in the db has likely changed, so recalculate
-    g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, HasContent(VIDEODB_CONTENT_MOVIES));
-    g_infoManager.SetLibraryBool(LIBRARY_HAS_TVSHOWS, HasContent(VIDEODB_CONTENT_TVSHOWS));
-    g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSICVIDEOS, HasContent(VIDEODB_CONTENT_MUSICVIDEOS));
+    // (a bulk ingest does this once it has ended)
+    if (!InBulkIngest())
+    {
+      g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, HasContent(VIDEODB_CONTENT_MOVIES));
+      g_infoManager.SetLibraryBool(LIBRARY_HAS_TVSHOWS, HasContent(VIDEODB_CONTENT_TVSHOWS));
+      g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSICVIDEOS, HasContent(VIDEODB_CONTENT_MUSICVIDEOS));
+    }
     return true;
   }
   return false;
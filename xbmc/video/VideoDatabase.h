@@ -954,6 +954,19 @@ private:
    */
   int RunQuery(const std::string &sql);
 
+  /*! \brief Narrow a sorted and limited query down to the rows around the requested page
+   If the database can order the rows by the leading part of the sort keys, only the rows sharing
+   that part with the rows of the page are queried. The limits of the sorting are moved to these rows.
+   \param sql the query with a placeholder for the selected columns
+   \param filter the filter of the query
+   \param mediaType the media type of the queried view
+   \param sorting the sorting with the requested page, its limits are updated if the query is narrowed down
+   \param sqlExtra filled with the conditions and order to append to the query
+   \param total filled with the number of rows matching the filter
+   \return false if the query can't be narrowed down, sqlExtra and total are left untouched then
+   */
+  bool BuildSortedPageSQL(const std::string &sql, const Filter &filter, const MediaType &mediaType, SortDescription &sorting, std::string &sqlExtra, int &total);
+
   void AppendIdLinkFilter(const char* field, const char *table, const MediaType& mediaType, const char *view, const char *viewKey, const CUrlOptions::UrlOptions& options, Filter &filter);
   void AppendLinkFilter(const char* field, const char *table, const MediaType& mediaType, const char *view, const char *viewKey, const CUrlOptions::UrlOptions& options, Filter &filter);
 
@@ -43,9 +43,11 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "TextureCache.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
 #include "Util.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/md5.h"
 #include "utils/RegExp.h"
@@ -65,6 +67,73 @@ using KODI::MESSAGING::HELPERS::DialogResponse;
 namespace VIDEO
 {
 
+  class CVideoInfoScanner::CPrefetchJob : public CJob
+  {
+  public:
+    CPrefetchJob(const CVideoInfoScanner *scanner, const std::string &strDirectory, const SPrefetchedDirPtr &dir)
+      : m_scanner(scanner), m_strDirectory(strDirectory), m_dir(dir)
+    {
+    }
+
+    virtual const char *GetType() const { return "videoscanprefetch"; }
+
+    virtual bool DoWork()
+    {
+      {
+        CSingleLock lock(m_dir->section);
+        // picked up by the scanner thread already
+        if (m_dir->state != SPrefetchedDir::QUEUED)
+          return false;
+        m_dir->state = SPrefetchedDir::RUNNING;
+      }
+
+      m_scanner->PrefetchDirectory(m_strDirectory, *m_dir);
+
+      CSingleLock lock(m_dir->section);
+      m_dir->state = SPrefetchedDir::DONE;
+      m_dir->done.Set();
+      return true;
+    }
+
+  private:
+    const CVideoInfoScanner *m_scanner;
+    std::string m_strDirectory;
+    SPrefetchedDirPtr m_dir;
+  };
+
+  class CVideoInfoScanner::CLookupJob : public CJob
+  {
+  public:
+    CLookupJob(const CVideoInfoScanner *scanner, const SScraperLookupPtr &lookup)
+      : m_scanner(scanner), m_lookup(lookup)
+    {
+    }
+
+    virtual const char *GetType() const { return "videoscanlookup"; }
+
+    virtual bool DoWork()
+    {
+      {
+        CSingleLock lock(m_lookup->section);
+        // picked up by the scanner thread already
+        if (m_lookup->state != SScraperLookup::QUEUED)
+          return false;
+        m_lookup->state = SScraperLookup::RUNNING;
+      }
+
+      m_scanner->LookupVideo(*m_lookup);
+
+      CSingleLock lock(m_lookup->section);
+      m_lookup->state = SScraperLookup::DONE;
+      m_lookup->done.Set();
+      return true;
+    }
+
+  private:
+    const CVideoInfoScanner *m_scanner;
+    SScraperLookupPtr m_lookup;
+  };
+
   CVideoInfoScanner::CVideoInfoScanner()
   {
     m_bStop = false;
@@ -80,6 +149,8 @@ namespace VIDEO
 
   CVideoInfoScanner::~CVideoInfoScanner()
   {
+    ClearPrefetched();
+    ClearLookups();
   }
 
   void CVideoInfoScanner::Process()
@@ -124,11 +195,22 @@ namespace VIDEO
       m_currentItem = 0;
       m_itemCount = -1;
 
+      // list directories and look up movies ahead of the scan,
+      // the database writes stay on this thread
+      if (g_advancedSettings.m_iVideoLibraryScanThreads > 1)
+      {
+        m_prefetchQueue.reset(new CJobQueue(false, g_advancedSettings.m_iVideoLibraryScanThreads, CJob::PRIORITY_LOW));
+        m_lookupQueue.reset(new CJobQueue(false, g_advancedSettings.m_iVideoLibraryScanThreads, CJob::PRIORITY_LOW));
+      }
+
       // Database operations should not be canceled
       // using Interupt() while scanning as it could
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      // write the items in batches rather than one transaction each
+      m_database.BeginBulkIngest();
+
       bool bCancelled = false;
       while (!bCancelled && !m_pathsToScan.empty())
       {
@@ -148,11 +230,17 @@ namespace VIDEO
            */
           CLog::Log(LOGWARNING, "%s directory '%s' does not exist - skipping scan%s.", __FUNCTION__, CURL::GetRedacted(directory).c_str(), m_bClean ? " and clean" : "");
           m_pathsToScan.erase(m_pathsToScan.begin());
+          TakePrefetched(directory);
         }
         else if (!DoScan(directory))
           bCancelled = true;
       }
 
+      ClearPrefetched();
+      ClearLookups();
+      m_lookupQueue.reset();
+      m_database.EndBulkIngest();
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -175,7 +263,11 @@ namespace VIDEO
     {
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
     }
-    
+
+    m_database.EndBulkIngest();
+    ClearPrefetched();
+    ClearLookups();
+    m_lookupQueue.reset();
     m_bRunning = false;
     ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnScanFinished");
     
@@ -264,9 +356,21 @@ namespace VIDEO
     bool bSkip = false;
 
     SScanSettings settings;
-    ScraperPtr info = m_database.GetScraperForPath(strDirectory, settings, foundDirectly);
+    ScraperPtr info;
+    SPrefetchedDirPtr prefetched = TakePrefetched(strDirectory);
+    if (prefetched)
+    {
+      info = prefetched->info;
+      settings = prefetched->settings;
+      foundDirectly = prefetched->foundDirectly;
+    }
+    else
+      info = m_database.GetScraperForPath(strDirectory, settings, foundDirectly);
     CONTENT_TYPE content = info ? info->Content() : CONTENT_NONE;
 
+    // keep the jobs busy with what comes next while we work on this one
+    PrefetchAhead();
+
     // exclude folders that match our exclude regexps
     const std::vector<std::string> &regexps = content == CONTENT_TVSHOWS ? g_advancedSettings.m_tvshowExcludeFromScanRegExps
                                                          : g_advancedSettings.m_moviesExcludeFromScanRegExps;
@@ -274,7 +378,7 @@ namespace VIDEO
     if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
       return true;
 
-    if (IsExcluded(strDirectory))
+    if (prefetched ? prefetched->excluded : IsExcluded(strDirectory))
     {
       CLog::Log(LOGWARNING, "Skipping item '%s' with '.nomedia' file in parent directory, it won't be added to the library.", CURL::GetRedacted(strDirectory).c_str());
       return true;
@@ -294,17 +398,33 @@ namespace VIDEO
       }
 
       std::string fastHash;
-      if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        fastHash = GetFastHash(strDirectory, regexps);
+      bool haveDbHash;
+      if (prefetched)
+      {
+        fastHash = prefetched->fastHash;
+        dbHash = prefetched->dbHash;
+        haveDbHash = prefetched->haveDbHash;
+      }
+      else
+      {
+        if (g_advancedSettings.m_bVideoLibraryUseFastHash)
+          fastHash = GetFastHash(strDirectory, regexps);
+        haveDbHash = m_database.GetPathHash(strDirectory, dbHash);
+      }
 
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
+      if (haveDbHash && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         hash = fastHash;
       }
       else
       { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
-        items.Stack();
+        if (prefetched && prefetched->listed)
+          items.Assign(prefetched->items);
+        else
+        {
+          CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+          items.Stack();
+        }
 
         // check whether to re-use previously computed fast hash
         if (!CanFastHash(items, regexps) || fastHash.empty())
@@ -341,7 +461,10 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+        if (prefetched && prefetched->listed)
+          items.Assign(prefetched->items);
+        else
+          CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
@@ -387,6 +510,20 @@ namespace VIDEO
     if (m_handle)
       OnDirectoryScanned(strDirectory);
 
+    if (prefetched)
+      prefetched->items.Clear();
+    prefetched.reset();
+
+    if (settings.recurse > 0 && content != CONTENT_TVSHOWS)
+    {
+      for (int i = 0; i < items.Size(); ++i)
+      {
+        const CFileItemPtr pItem = items[i];
+        if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
+          Prefetch(pItem->GetPath());
+      }
+    }
+
     for (int i = 0; i < items.Size(); ++i)
     {
       CFileItemPtr pItem = items[i];
@@ -407,6 +544,240 @@ namespace VIDEO
     return !m_bStop;
   }
 
+  void CVideoInfoScanner::Prefetch(const std::string &strDirectory)
+  {
+    // at most two directories per job waiting on the scanner
+    if (!m_prefetchQueue || m_prefetched.size() >= (size_t)g_advancedSettings.m_iVideoLibraryScanThreads * 2)
+      return;
+    if (m_prefetched.find(strDirectory) != m_prefetched.end())
+      return;
+
+    SPrefetchedDirPtr dir(new SPrefetchedDir);
+    dir->info = m_database.GetScraperForPath(strDirectory, dir->settings, dir->foundDirectly);
+    CONTENT_TYPE content = dir->info ? dir->info->Content() : CONTENT_NONE;
+    if (content == CONTENT_NONE || (!m_scanAll && dir->settings.noupdate))
+      return;
+
+    dir->regexps = content == CONTENT_TVSHOWS ? &g_advancedSettings.m_tvshowExcludeFromScanRegExps
+                                              : &g_advancedSettings.m_moviesExcludeFromScanRegExps;
+    if (CUtil::ExcludeFileOrFolder(strDirectory, *dir->regexps))
+      return;
+
+    if (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS)
+      dir->haveDbHash = m_database.GetPathHash(strDirectory, dir->dbHash);
+
+    m_prefetched[strDirectory] = dir;
+    m_prefetchQueue->AddJob(new CPrefetchJob(this, strDirectory, dir));
+  }
+
+  void CVideoInfoScanner::PrefetchAhead()
+  {
+    if (!m_prefetchQueue)
+      return;
+
+    const size_t window = (size_t)g_advancedSettings.m_iVideoLibraryScanThreads * 2;
+    std::set<std::string>::const_iterator it = m_pathsToScan.begin();
+    for (size_t i = 0; it != m_pathsToScan.end() && i < window && m_prefetched.size() < window; ++it, ++i)
+      Prefetch(*it);
+  }
+
+  CVideoInfoScanner::SPrefetchedDirPtr CVideoInfoScanner::TakePrefetched(const std::string &strDirectory)
+  {
+    std::map<std::string, SPrefetchedDirPtr>::iterator it = m_prefetched.find(strDirectory);
+    if (it == m_prefetched.end())
+      return SPrefetchedDirPtr();
+
+    SPrefetchedDirPtr dir = it->second;
+    m_prefetched.erase(it);
+
+    bool queued;
+    {
+      CSingleLock lock(dir->section);
+      queued = dir->state == SPrefetchedDir::QUEUED;
+      if (queued)
+        dir->state = SPrefetchedDir::RUNNING;
+    }
+
+    if (queued)
+    { // not started yet, no point in waiting for a free job
+      PrefetchDirectory(strDirectory, *dir);
+      CSingleLock lock(dir->section);
+      dir->state = SPrefetchedDir::DONE;
+    }
+    else
+      dir->done.Wait();
+
+    return dir;
+  }
+
+  void CVideoInfoScanner::ClearPrefetched()
+  {
+    for (std::map<std::string, SPrefetchedDirPtr>::iterator it = m_prefetched.begin(); it != m_prefetched.end(); ++it)
+    {
+      SPrefetchedDirPtr dir = it->second;
+      bool running;
+      {
+        CSingleLock lock(dir->section);
+        running = dir->state == SPrefetchedDir::RUNNING;
+        if (dir->state == SPrefetchedDir::QUEUED)
+          dir->state = SPrefetchedDir::DONE;
+      }
+      // the job uses the scanner, it must not outlive it
+      if (running)
+        dir->done.Wait();
+    }
+    m_prefetched.clear();
+    m_prefetchQueue.reset();
+  }
+
+  void CVideoInfoScanner::PrefetchDirectory(const std::string &strDirectory, SPrefetchedDir &dir) const
+  {
+    // same steps as DoScan, without touching the database
+    dir.excluded = IsExcluded(strDirectory);
+    if (dir.excluded)
+      return;
+
+    CONTENT_TYPE content = dir.info->Content();
+    if (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS)
+    {
+      if (g_advancedSettings.m_bVideoLibraryUseFastHash)
+        dir.fastHash = GetFastHash(strDirectory, *dir.regexps);
+
+      if (!dir.haveDbHash || dir.fastHash.empty() || dir.fastHash != dir.dbHash)
+      {
+        CDirectory::GetDirectory(strDirectory, dir.items, g_advancedSettings.m_videoExtensions);
+        dir.items.Stack();
+        dir.listed = true;
+      }
+    }
+    else if (content == CONTENT_TVSHOWS && dir.foundDirectly && !dir.settings.parent_name_root)
+    {
+      CDirectory::GetDirectory(strDirectory, dir.items, g_advancedSettings.m_videoExtensions);
+      dir.listed = true;
+    }
+  }
+
+  void CVideoInfoScanner::LookupAhead(const CFileItemList &items, int &next, bool bDirNames, bool useLocal)
+  {
+    if (!m_lookupQueue)
+      return;
+
+    // at most two items per job waiting on the scanner
+    const size_t window = (size_t)g_advancedSettings.m_iVideoLibraryScanThreads * 2;
+    for (; next < items.Size() && m_lookups.size() < window; next++)
+    {
+      const CFileItemPtr pItem = items[next];
+      if (pItem->m_bIsFolder || !pItem->IsVideo() || pItem->IsNFO() ||
+         (pItem->IsPlayList() && !URIUtils::HasExtension(pItem->GetPath(), ".strm")))
+        continue;
+      if (m_lookups.find(pItem->GetPath()) != m_lookups.end())
+        continue;
+
+      // same checks as RetrieveVideoInfo and RetrieveInfoForMovie, with an
+      // instance of the scraper for this lookup only
+      SScraperLookupPtr lookup(new SScraperLookup);
+      lookup->scraper = m_database.GetScraperForPath(items.GetPath());
+      CONTENT_TYPE content = lookup->scraper ? lookup->scraper->Content() : CONTENT_NONE;
+      if (content != CONTENT_MOVIES && content != CONTENT_MUSICVIDEOS)
+        continue;
+      if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), g_advancedSettings.m_moviesExcludeFromScanRegExps))
+        continue;
+      if (content == CONTENT_MOVIES ? m_database.HasMovieInfo(pItem->GetPath())
+                                    : m_database.HasMusicVideoInfo(pItem->GetPath()))
+        continue;
+
+      lookup->item = *pItem;
+      lookup->videoName = pItem->GetMovieName(bDirNames);
+      lookup->grabAny = bDirNames;
+      lookup->useLocal = useLocal;
+      m_lookups[pItem->GetPath()] = lookup;
+      m_lookupQueue->AddJob(new CLookupJob(this, lookup));
+    }
+  }
+
+  CVideoInfoScanner::SScraperLookupPtr CVideoInfoScanner::TakeLookup(const std::string &strPath)
+  {
+    std::map<std::string, SScraperLookupPtr>::iterator it = m_lookups.find(strPath);
+    if (it == m_lookups.end())
+      return SScraperLookupPtr();
+
+    SScraperLookupPtr lookup = it->second;
+    m_lookups.erase(it);
+
+    bool queued, done;
+    {
+      CSingleLock lock(lookup->section);
+      queued = lookup->state == SScraperLookup::QUEUED;
+      done = lookup->state == SScraperLookup::DONE;
+      if (queued)
+        lookup->state = SScraperLookup::RUNNING;
+    }
+
+    // don't keep the database locked while waiting on the scraper
+    if (!done)
+      m_database.FlushBulkIngest();
+
+    if (queued)
+    { // not started yet, no point in waiting for a free job
+      LookupVideo(*lookup);
+      CSingleLock lock(lookup->section);
+      lookup->state = SScraperLookup::DONE;
+    }
+    else if (!done)
+      lookup->done.Wait();
+
+    if (lookup->hasNfo)
+      return SScraperLookupPtr();
+    return lookup;
+  }
+
+  void CVideoInfoScanner::DropLookup(const std::string &strPath)
+  {
+    std::map<std::string, SScraperLookupPtr>::iterator it = m_lookups.find(strPath);
+    if (it == m_lookups.end())
+      return;
+
+    SScraperLookupPtr lookup = it->second;
+    m_lookups.erase(it);
+
+    bool running;
+    {
+      CSingleLock lock(lookup->section);
+      running = lookup->state == SScraperLookup::RUNNING;
+      if (lookup->state == SScraperLookup::QUEUED)
+        lookup->state = SScraperLookup::DONE;
+    }
+    // the job uses the scanner, it must not outlive it
+    if (running)
+      lookup->done.Wait();
+  }
+
+  void CVideoInfoScanner::ClearLookups()
+  {
+    while (!m_lookups.empty())
+    {
+      std::string path = m_lookups.begin()->first;
+      DropLookup(path);
+    }
+  }
+
+  void CVideoInfoScanner::LookupVideo(SScraperLookup &lookup) const
+  {
+    // an .nfo may name the url to use or hold all of the details,
+    // RetrieveInfoForMovie reads it on the scanner thread
+    if (lookup.useLocal && !GetnfoFile(&lookup.item, lookup.grabAny).empty())
+    {
+      lookup.hasNfo = true;
+      return;
+    }
+
+    // same steps as FindVideo and GetDetails, without touching the database
+    CVideoInfoDownloader imdb(lookup.scraper);
+    lookup.findResult = imdb.FindMovie(lookup.videoName, lookup.results);
+    if (lookup.findResult > 0 && !lookup.results.empty())
+      lookup.haveDetails = imdb.GetDetails(lookup.results[0], lookup.details);
+  }
+
   bool CVideoInfoScanner::RetrieveVideoInfo(CFileItemList& items, bool bDirNames, CONTENT_TYPE content, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress)
   {
     if (pDlgProgress)
@@ -426,11 +797,18 @@ namespace VIDEO
 
     bool FoundSomeInfo = false;
     std::vector<int> seenPaths;
+    int lookupNext = 1;
     for (int i = 0; i < (int)items.Size(); ++i)
     {
       m_nfoReader.Close();
       CFileItemPtr pItem = items[i];
 
+      // look up the next items online while this one is worked on
+      if (lookupNext <= i)
+        lookupNext = i + 1;
+      if (!pDlgProgress)
+        LookupAhead(items, lookupNext, bDirNames, useLocal);
+
       // we do this since we may have a override per dir
       ScraperPtr info2 = m_database.GetScraperForPath(pItem->m_bIsFolder ? pItem->GetPath() : items.GetPath());
       if (!info2) // skip
@@ -463,6 +841,9 @@ namespace VIDEO
         FoundSomeInfo = false;
         break;
       }
+      // an .nfo may have made the lookup unnecessary
+      DropLookup(pItem->GetPath());
+
       if (ret == INFO_CANCELLED || ret == INFO_ERROR)
       {
         FoundSomeInfo = false;
@@ -505,6 +886,7 @@ namespace VIDEO
     if(pDlgProgress)
       pDlgProgress->ShowProgressBar(false);
 
+    ClearLookups();
     m_database.Close();
     return FoundSomeInfo;
   }
@@ -617,11 +999,13 @@ namespace VIDEO
     if (result == CNfoFile::URL_NFO || result == CNfoFile::COMBINED_NFO)
       pURL = &scrUrl;
 
+    SScraperLookupPtr lookup = pURL ? SScraperLookupPtr() : TakeLookup(pItem->GetPath());
     CScraperUrl url;
     int retVal = 0;
     if (pURL)
       url = *pURL;
-    else if ((retVal = FindVideo(pItem->GetMovieName(bDirNames), info2, url, pDlgProgress)) <= 0)
+    else if ((retVal = lookup ? FindVideo(lookup->findResult, lookup->results, url, pDlgProgress)
+                              : FindVideo(pItem->GetMovieName(bDirNames), info2, url, pDlgProgress)) <= 0)
     {
       if (retVal < 0) 
         return INFO_CANCELLED;
@@ -637,7 +1021,9 @@ namespace VIDEO
         return INFO_NOT_FOUND;
     }
 
-    if (GetDetails(pItem, url, info2, result == CNfoFile::COMBINED_NFO ? &m_nfoReader : NULL, pDlgProgress) || CSettings::GetInstance().GetBool(CSettings::SETTING_VIDEOLIBRARY_IMPORTALL))
+    bool found = lookup ? GetDetails(pItem, url, *lookup, pDlgProgress)
+                        : GetDetails(pItem, url, info2, result == CNfoFile::COMBINED_NFO ? &m_nfoReader : NULL, pDlgProgress);
+    if (found || CSettings::GetInstance().GetBool(CSettings::SETTING_VIDEOLIBRARY_IMPORTALL))
     {
       if (AddVideo(pItem, info2->Content(), bDirNames, useLocal) < 0)
         return INFO_ERROR;
@@ -680,14 +1066,17 @@ namespace VIDEO
     if (result == CNfoFile::URL_NFO || result == CNfoFile::COMBINED_NFO)
       pURL = &scrUrl;
 
+    SScraperLookupPtr lookup = pURL ? SScraperLookupPtr() : TakeLookup(pItem->GetPath());
     CScraperUrl url;
     int retVal = 0;
     if (pURL)
       url = *pURL;
-    else if ((retVal = FindVideo(pItem->GetMovieName(bDirNames), info2, url, pDlgProgress)) <= 0)
+    else if ((retVal = lookup ? FindVideo(lookup->findResult, lookup->results, url, pDlgProgress)
+                              : FindVideo(pItem->GetMovieName(bDirNames), info2, url, pDlgProgress)) <= 0)
       return retVal < 0 ? INFO_CANCELLED : INFO_NOT_FOUND;
 
-    if (GetDetails(pItem, url, info2, result == CNfoFile::COMBINED_NFO ? &m_nfoReader : NULL, pDlgProgress))
+    if (lookup ? GetDetails(pItem, url, *lookup, pDlgProgress)
+               : GetDetails(pItem, url, info2, result == CNfoFile::COMBINED_NFO ? &m_nfoReader : NULL, pDlgProgress))
     {
       if (AddVideo(pItem, info2->Content(), bDirNames, useLocal) < 0)
         return INFO_ERROR;
@@ -1838,6 +2227,9 @@ namespace VIDEO
     if (m_handle && !url.strTitle.empty())
       m_handle->SetText(url.strTitle);
 
+    // don't keep the database locked while waiting on the scraper
+    m_database.FlushBulkIngest();
+
     CVideoInfoDownloader imdb(scraper);
     bool ret = imdb.GetDetails(url, movieDetails, pDialog);
 
@@ -1846,21 +2238,37 @@ namespace VIDEO
       if (nfoFile)
         nfoFile->GetDetails(movieDetails,NULL,true);
 
-      if (m_handle && url.strTitle.empty())
-        m_handle->SetText(movieDetails.m_strTitle);
-
-      if (pDialog)
-      {
-        pDialog->SetLine(1, CVariant{movieDetails.m_strTitle});
-        pDialog->Progress();
-      }
-
-      pItem->GetVideoInfoTag()->Enrich(movieDetails);
+      ApplyDetails(pItem, url, movieDetails, pDialog);
       return true;
     }
     return false; // no info found, or cancelled
   }
 
+  bool CVideoInfoScanner::GetDetails(CFileItem *pItem, const CScraperUrl &url, const SScraperLookup &lookup, CGUIDialogProgress* pDialog /* = NULL */)
+  {
+    if (!lookup.haveDetails)
+      return false;
+
+    if (m_handle && !url.strTitle.empty())
+      m_handle->SetText(url.strTitle);
+    ApplyDetails(pItem, url, lookup.details, pDialog);
+    return true;
+  }
+
+  void CVideoInfoScanner::ApplyDetails(CFileItem *pItem, const CScraperUrl &url, const CVideoInfoTag &details, CGUIDialogProgress* pDialog)
+  {
+    if (m_handle && url.strTitle.empty())
+      m_handle->SetText(details.m_strTitle);
+
+    if (pDialog)
+    {
+      pDialog->SetLine(1, CVariant{details.m_strTitle});
+      pDialog->Progress();
+    }
+
+    pItem->GetVideoInfoTag()->Enrich(details);
+  }
+
   void CVideoInfoScanner::ApplyThumbToFolder(const std::string &folder, const std::string &imdbThumb)
   {
     // copy icon to folder also;
@@ -2174,8 +2582,14 @@ namespace VIDEO
   int CVideoInfoScanner::FindVideo(const std::string &videoName, const ScraperPtr &scraper, CScraperUrl &url, CGUIDialogProgress *progress)
   {
     MOVIELIST movielist;
+    m_database.FlushBulkIngest();
     CVideoInfoDownloader imdb(scraper);
     int returncode = imdb.FindMovie(videoName, movielist, progress);
+    return FindVideo(returncode, movielist, url, progress);
+  }
+
+  int CVideoInfoScanner::FindVideo(int returncode, const std::vector<CScraperUrl> &movielist, CScraperUrl &url, CGUIDialogProgress *progress)
+  {
     if (returncode < 0 || (returncode == 0 && (m_bStop || !DownloadFailed(progress))))
     { // scraper reported an error, or we had an error and user wants to cancel the scan
       m_bStop = true;
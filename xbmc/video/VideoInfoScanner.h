@@ -18,9 +18,17 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <map>
+#include <memory>
+
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
+#include "FileItem.h"
 #include "NfoFile.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+class CJobQueue;
 
 class CRegExp;
 class CFileItem;
@@ -121,6 +129,94 @@ namespace VIDEO
     bool EnumerateEpisodeItem(const CFileItem *item, EPISODELIST& episodeList);
 
   protected:
+    /*! \brief A directory resolved ahead of DoScan.
+     Scraper settings and the stored hash are looked up on the scanner thread,
+     the .nomedia check, fast hash and directory listing are done by a job so
+     that several folders on slow (network) shares are listed at once.
+     \sa Prefetch, TakePrefetched
+     */
+    typedef struct SPrefetchedDir
+    {
+      enum STATE { QUEUED, RUNNING, DONE };
+
+      SPrefetchedDir() : foundDirectly(false), haveDbHash(false), regexps(NULL), state(QUEUED), excluded(false), listed(false) { }
+      ADDON::ScraperPtr info;
+      SScanSettings settings;
+      bool foundDirectly;
+      std::string dbHash;
+      bool haveDbHash;
+      const std::vector<std::string> *regexps;
+
+      CCriticalSection section;
+      CEvent done;
+      STATE state;
+      bool excluded;
+      std::string fastHash;
+      bool listed;
+      CFileItemList items;
+    } SPrefetchedDir;
+    typedef std::shared_ptr<SPrefetchedDir> SPrefetchedDirPtr;
+    class CPrefetchJob;
+
+    /*! \brief Queue prefetching of a directory DoScan will visit.
+     Does nothing if prefetching is disabled or enough directories are queued already.
+     */
+    void Prefetch(const std::string &strDirectory);
+    /*! \brief Queue prefetching of the next directories in m_pathsToScan. */
+    void PrefetchAhead();
+    /*! \brief Take the prefetched state of a directory, waiting for its job if needed.
+     \return the prefetched directory, empty if it was never queued.
+     */
+    SPrefetchedDirPtr TakePrefetched(const std::string &strDirectory);
+    /*! \brief Drop all prefetched directories, waits for jobs still running. */
+    void ClearPrefetched();
+    void PrefetchDirectory(const std::string &strDirectory, SPrefetchedDir &dir) const;
+
+    /*! \brief A scraper lookup done ahead of RetrieveVideoInfo.
+     Movies and music videos are searched for and their details downloaded by
+     a job with a scraper instance of its own, as scrapers keep state between
+     calls. Checking the results and writing them to the database stays on the
+     scanner thread.
+     \sa LookupAhead, TakeLookup
+     */
+    typedef struct SScraperLookup
+    {
+      enum STATE { QUEUED, RUNNING, DONE };
+
+      SScraperLookup() : grabAny(false), useLocal(false), state(QUEUED), hasNfo(false), findResult(0), haveDetails(false) { }
+      ADDON::ScraperPtr scraper;
+      CFileItem item;
+      std::string videoName;
+      bool grabAny;
+      bool useLocal;
+
+      CCriticalSection section;
+      CEvent done;
+      STATE state;
+      bool hasNfo;
+      int findResult;
+      std::vector<CScraperUrl> results;
+      CVideoInfoTag details;
+      bool haveDetails;
+    } SScraperLookup;
+    typedef std::shared_ptr<SScraperLookup> SScraperLookupPtr;
+    class CLookupJob;
+
+    /*! \brief Queue lookups for the items RetrieveVideoInfo gets to next.
+     \param items the items being retrieved.
+     \param next [in/out] the first item not considered yet, moved past the items looked at.
+     */
+    void LookupAhead(const CFileItemList &items, int &next, bool bDirNames, bool useLocal);
+    /*! \brief Take the lookup of an item, waiting for its job if needed.
+     \return the lookup, empty if it was never queued or the item has an .nfo file to handle first.
+     */
+    SScraperLookupPtr TakeLookup(const std::string &strPath);
+    /*! \brief Drop the lookup of an item that did not need it, waits for its job if it is running. */
+    void DropLookup(const std::string &strPath);
+    /*! \brief Drop all lookups, waits for jobs still running. */
+    void ClearLookups();
+    void LookupVideo(SScraperLookup &lookup) const;
+
     virtual void Process();
     bool DoScan(const std::string& strDirectory);
     bool IsExcluded(const std::string& strDirectory) const;
@@ -147,6 +243,13 @@ namespace VIDEO
      */
     int FindVideo(const std::string &videoName, const ADDON::ScraperPtr &scraper, CScraperUrl &url, CGUIDialogProgress *progress);
 
+    /*! \brief Check the results of a search done by CVideoInfoDownloader::FindMovie
+     \param returncode return value of FindMovie
+     \param movielist results of FindMovie
+     \sa FindVideo
+     */
+    int FindVideo(int returncode, const std::vector<CScraperUrl> &movielist, CScraperUrl &url, CGUIDialogProgress *progress);
+
     /*! \brief Retrieve detailed information for an item from an online source, optionally supplemented with local data
      TODO: sort out some better return codes.
      \param pItem item to retrieve online details for.
@@ -158,6 +261,12 @@ namespace VIDEO
      */
     bool GetDetails(CFileItem *pItem, CScraperUrl &url, const ADDON::ScraperPtr &scraper, CNfoFile *nfoFile=NULL, CGUIDialogProgress* pDialog=NULL);
 
+    /*! \brief Use the details a lookup job downloaded like GetDetails does its own
+     \sa GetDetails
+     */
+    bool GetDetails(CFileItem *pItem, const CScraperUrl &url, const SScraperLookup &lookup, CGUIDialogProgress* pDialog=NULL);
+    void ApplyDetails(CFileItem *pItem, const CScraperUrl &url, const CVideoInfoTag &details, CGUIDialogProgress* pDialog);
+
     /*! \brief Extract episode and season numbers from a processed regexp
      \param reg Regular expression object with at least 2 matches
      \param episodeInfo Episode information to fill in.
@@ -249,6 +358,10 @@ namespace VIDEO
     std::set<std::string> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    std::unique_ptr<CJobQueue> m_prefetchQueue;
+    std::map<std::string, SPrefetchedDirPtr> m_prefetched;
+    std::unique_ptr<CJobQueue> m_lookupQueue;
+    std::map<std::string, SScraperLookupPtr> m_lookups;
   };
 }
 
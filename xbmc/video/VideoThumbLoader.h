@@ -51,6 +51,11 @@ public:
     return kJobTypeMediaFlags;
   }
 
+  virtual LANE GetLane() const
+  {
+    return LANE_CPU; // decodes a frame to grab the thumb
+  }
+
   virtual bool operator==(const CJob* job) const;
 
   std::string m_target; ///< thumbpath